@@ -34,6 +34,15 @@
 #include "md5.h"
 #include "DSFDefs.h"
 #include "DSFPointPool.h"
+#include "FileUtils.h"
+
+#if APL || LIN
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+#elif IBM
+	#include "GUI_Unicode.h"
+#endif
 
 #if USE_7Z
 	#include "7z.h"
@@ -117,33 +126,164 @@ double	R_DECODE_SCALED32(
 	return lon_raw;
 }*/
 
-#define	DECODE_SCALED(__index, __pool, __points, __depths) 	((&*__points[__pool].begin())+__index * __depths[__pool])
+/*
+	DSFPointPoolReader - one point pool atom, decoded the first time a command asks for one of its vertices.
+	Passes that never touch geometry (properties, definitions) and object-only scans of mesh tiles thus
+	never pay for decoding the pools they don't use.
+
+	Normally the whole pool is decoded to doubles on first use.  In raw mode (dsf_CmdRawPools) the pool keeps
+	its 16/32-bit samples - a quarter or half the memory - and the scale and offset are applied as each vertex
+	is handed out.  The math is the same as DecompressShortToDoubleInterleaved, so the results are identical,
+	but the returned coordinates are only valid until the next vertex is fetched.
+*/
+template <class T>
+struct	DSFPointPoolReader {
+
+	XAtomPlanerNumericTable		atom;
+	int							depth;
+	int							size;
+	double *					scales;
+	double *					offsets;
+	double						reduce;
+	bool						raw;
+	bool						decoded;
+	vector<double>				coords;		// Whole pool, or one vertex in raw mode
+	vector<T>					samples;	// Raw mode only
+
+	DSFPointPoolReader(const XAtomPlanerNumericTable& inAtom, double * inScales, double * inOffsets, double inReduce, bool inRaw) :
+		atom(inAtom), scales(inScales), offsets(inOffsets), reduce(inReduce), raw(inRaw), decoded(false)
+	{
+		depth = atom.GetPlaneCount();
+		size = atom.GetArraySize();
+	}
 
-#define	DECODE_SCALED_CURRENT(__index) 									(currentPoolPtr+__index * currentDepth)
+	inline double * vertex(unsigned int index)
+	{
+		if (!decoded)
+			decode();
+		if (!raw)
+			return coords.data() + index * depth;
+
+		const T * src = samples.data() + index * depth;
+		for (int p = 0; p < depth; ++p)
+			coords[p] = scales[p] ? ((double) src[p]) * scales[p] * reduce + offsets[p] : src[p];
+		return coords.data();
+	}
 
-#define	DECODE_SCALED32_CURRENT(__index)					 			(currentPoolPtr32 +__index * currentDepth32)
+	void	decode(void);
+};
 
+template <>
+void	DSFPointPoolReader<uint16_t>::decode(void)
+{
+	if (raw)
+	{
+		samples.resize(size * depth);
+		coords.resize(depth);
+		atom.DecompressShort(depth, size, 1, (int16_t *) samples.data());
+	}
+	else
+	{
+		coords.resize(size * depth);
+		atom.DecompressShortToDoubleInterleaved(depth, size, coords.data(), scales, reduce, offsets);
+	}
+	decoded = true;
+}
 
-int		DSFReadFile(
-			const char *		inPath,  
-			void * (*			malloc_func)(size_t s), 
-			void (*				free_func)(void * ptr), 
-			DSFCallbacks_t *	inCallbacks, 
-			const int *			inPasses, 
-			void *				inRef)
+template <>
+void	DSFPointPoolReader<uint32_t>::decode(void)
 {
-	char *		mem = nullptr;
-	size_t		uncomp_size = 0;
-	int			result = dsf_ErrOK;
-	FILE * 		fi = nullptr;
-		
+	if (raw)
+	{
+		samples.resize(size * depth);
+		coords.resize(depth);
+		atom.DecompressInt(depth, size, 1, (int32_t *) samples.data());
+	}
+	else
+	{
+		coords.resize(size * depth);
+		atom.DecompressIntToDoubleInterleaved(depth, size, coords.data(), scales, reduce, offsets);
+	}
+	decoded = true;
+}
+
+#define	DECODE_SCALED(__index, __pool, __pools) 	 					(__pools[__pool].vertex(__index))
+
+#define	DECODE_SCALED_CURRENT(__index) 									(currentPoolPtr->vertex(__index))
+
+#define	DECODE_SCALED32_CURRENT(__index)					 			(currentPoolPtr32->vertex(__index))
+
+
 #if USE_7Z
-	size_t 		mem_offset = 0;
-	size_t		mem_size = 0;
-	UInt32		blockIndex = 0;
+/*
+	7z decoder context - one per thread.  The look-ahead buffer is small and kept between DSFReadFile calls.
+	The LZMA decoder writes straight into the extraction buffer (the buffer is its dictionary), so the DSF is
+	never held twice.  That buffer is as big as the decoded tile, so by default it is dropped again as soon
+	as the tile is read.  Batch loaders can ask to keep it with DSFKeepDecoderCache, then it only ever grows
+	until they turn that off again.
+*/
+struct	DSF7zContext {
+	Byte *		look_buf;
+	Byte *		unpack_buf;
+	size_t		unpack_capacity;
+	bool		keep_unpack;
+
+	DSF7zContext() : look_buf(NULL), unpack_buf(NULL), unpack_capacity(0), keep_unpack(false) { }
+	~DSF7zContext() { release(); }
+
+	void release(void)
+	{
+		SzFree(NULL, look_buf);		look_buf = NULL;
+		release_unpack_buf();
+	}
+
+	void release_unpack_buf(void)
+	{
+		SzFree(NULL, unpack_buf);	unpack_buf = NULL;
+		unpack_capacity = 0;
+	}
+
+	Byte * get_unpack_buf(size_t inSize)
+	{
+		if (inSize > unpack_capacity)
+		{
+			SzFree(NULL, unpack_buf);
+			unpack_buf = (Byte *) SzAlloc(NULL, inSize);
+			unpack_capacity = unpack_buf ? inSize : 0;
+		}
+		return unpack_buf;
+	}
+};
+
+static thread_local DSF7zContext	s7zContext;
+
+void	DSFKeepDecoderCache(bool inKeep)
+{
+	s7zContext.keep_unpack = inKeep;
+	if (!inKeep)
+		s7zContext.release_unpack_buf();
+}
+
+void	DSFReleaseDecoderCache(void)
+{
+	s7zContext.release();
+}
+
+/* If the file is a 7z archive, extract the DSF and read it.  Returns false if the file is not a 7z archive,
+   in which case the caller should read it as a plain DSF. */
+static bool	DSFRead7zFile(
+			const char *		inPath,
+			DSFCallbacks_t *	inCallbacks,
+			const int *			inPasses,
+			void *				inRef,
+			int&				outResult)
+{
 	bool 		dsf_compressed = true;
-		
-	CrcGenerateTable();
+
+	static const bool crc_ready = (CrcGenerateTable(), true);	// thread-safe, once per process
+	(void) crc_ready;
+
+	outResult = dsf_ErrOK;
 
 	CSzArEx 	db;
 	SzArEx_Init(&db);
@@ -155,53 +295,179 @@ int		DSFReadFile(
 	CLookToRead2 lookStream;
 	
 	if (InFile_Open(&archiveStream.file, inPath))
-		result = dsf_ErrCouldNotOpenFile;
+		outResult = dsf_ErrCouldNotOpenFile;
 	else
 	{
+		if (!s7zContext.look_buf)
+			s7zContext.look_buf = (Byte *) ISzAlloc_Alloc(&allocImp, kInputBufSize);
+
 		FileInStream_CreateVTable(&archiveStream);
 		LookToRead2_CreateVTable(&lookStream, False);
-		lookStream.buf = (Byte *)ISzAlloc_Alloc(&allocImp, kInputBufSize);
+		lookStream.buf = s7zContext.look_buf;
 		lookStream.bufSize = kInputBufSize;
 		lookStream.realStream = &archiveStream.vt;
 		LookToRead2_Init(&lookStream);
 
-		if (SzArEx_Open(&db, &lookStream.vt, &allocImp, &allocTempImp))
+		if (!lookStream.buf)
+			outResult = dsf_ErrOutOfMemory;
+		else if (SzArEx_Open(&db, &lookStream.vt, &allocImp, &allocTempImp))
 			dsf_compressed = false;
 		else
 		{
-			// no need to skip over directory-only entries. New api keeps directories vs files separate. So fileIndex = 0 is always the first real file
-			if (SzArEx_Extract(&db, &lookStream.vt, 0 , &blockIndex, (Byte **) &mem, &mem_size, &mem_offset, &uncomp_size, &allocImp, &allocTempImp) == 0)
+			// no need to skip over directory-only entries. New api keeps directories vs files separate. So fileIndex = 0 is always the first real file.
+			// This is SzArEx_Extract, except that the folder is decoded into our reusable buffer.
+			UInt32 folderIndex = db.NumFiles ? db.FileToFolder[0] : (UInt32) -1;
+			if (folderIndex == (UInt32) -1)
+				outResult = dsf_ErrNoAtoms;
+			else
 			{
-				result = DSFReadMem(mem + mem_offset, mem + mem_offset + uncomp_size, inCallbacks, inPasses, inRef);
+				UInt64	unpack_size = SzAr_GetFolderUnpackSize(&db.db, folderIndex);
+				size_t	file_offset = db.UnpackPositions[0] - db.UnpackPositions[db.FolderToFile[folderIndex]];
+				size_t	file_size = SzArEx_GetFileSize(&db, 0);
+				Byte *	mem = (unpack_size == (size_t) unpack_size) ? s7zContext.get_unpack_buf(unpack_size) : NULL;
+
+				if (!mem)
+					outResult = dsf_ErrOutOfMemory;
+				else if (file_offset + file_size > unpack_size ||
+						SzAr_DecodeFolder(&db.db, folderIndex, &lookStream.vt, db.dataPos, mem, unpack_size, &allocTempImp) != SZ_OK)
+					outResult = dsf_ErrCouldNotReadFile;
+				else if (SzBitWithVals_Check(&db.CRCs, 0) && CrcCalc(mem + file_offset, file_size) != db.CRCs.Vals[0])
+					outResult = dsf_ErrCouldNotReadFile;
+				else
+					outResult = DSFReadMem((const char *) mem + file_offset, (const char *) mem + file_offset + file_size, inCallbacks, inPasses, inRef);
+
+				if (!s7zContext.keep_unpack)
+					s7zContext.release_unpack_buf();
 			}
 			SzArEx_Free(&db, &allocImp);
 		}
-		ISzAlloc_Free(&allocImp, lookStream.buf);
 		File_Close(&archiveStream.file);
 	}
-	if(dsf_compressed) return result;
+	return dsf_compressed;
+}
+#else
+void	DSFKeepDecoderCache(bool inKeep)
+{
+}
+
+void	DSFReleaseDecoderCache(void)
+{
+}
 #endif
+
+/* Read an uncompressed DSF by pulling the whole file into a block from malloc_func. */
+static int	DSFReadFileBuffered(
+			const char *		inPath,
+			void * (*			malloc_func)(size_t s),
+			void (*				free_func)(void * ptr),
+			DSFCallbacks_t *	inCallbacks,
+			const int *			inPasses,
+			void *				inRef)
+{
+	char *		mem = nullptr;
+	size_t		file_size = 0;
+	int			result = dsf_ErrOK;
+	FILE * 		fi = nullptr;
+
 	fi = fopen(inPath, "rb");
 	if (!fi) { result = dsf_ErrCouldNotOpenFile; goto bail; }
 
 	fseek(fi, 0L, SEEK_END);
-	uncomp_size = ftell(fi);
+	file_size = ftell(fi);
 	fseek(fi, 0L, SEEK_SET);
 
-	mem = (char *) malloc_func(uncomp_size);
+	mem = (char *) malloc_func(file_size);
 	if (!mem) { result = dsf_ErrOutOfMemory; goto bail; }
 
-	if (fread(mem, 1, uncomp_size, fi) != uncomp_size)
+	if (fread(mem, 1, file_size, fi) != file_size)
 		{ result = dsf_ErrCouldNotReadFile; goto bail; }
 
-	result = DSFReadMem(mem + mem_offset, mem + uncomp_size, inCallbacks, inPasses, inRef);
+	result = DSFReadMem(mem, mem + file_size, inCallbacks, inPasses, inRef);
 
 bail:
 	if (fi) fclose(fi);
-	if (mem) free_func(mem);	
+	if (mem) free_func(mem);
 	return result;
 }
 
+int		DSFReadFile(
+			const char *		inPath,  
+			void * (*			malloc_func)(size_t s), 
+			void (*				free_func)(void * ptr), 
+			DSFCallbacks_t *	inCallbacks, 
+			const int *			inPasses, 
+			void *				inRef)
+{
+#if USE_7Z
+	int result;
+	if (DSFRead7zFile(inPath, inCallbacks, inPasses, inRef, result))
+		return result;
+#endif
+	return DSFReadFileBuffered(inPath, malloc_func, free_func, inCallbacks, inPasses, inRef);
+}
+
+int		DSFReadFileMapped(
+			const char *		inPath,
+			DSFCallbacks_t *	inCallbacks,
+			const int *			inPasses,
+			void *				inRef)
+{
+	int result;
+#if USE_7Z
+	if (DSFRead7zFile(inPath, inCallbacks, inPasses, inRef, result))
+		return result;
+#endif
+
+#if APL || LIN
+	FILE_case_correct_path path(inPath);
+	int fd = open(path, O_RDONLY, 0);
+	if (fd != -1)
+	{
+		struct stat ss;
+		if (fstat(fd, &ss) == 0 && ss.st_size > 0)
+		{
+			void * addr = mmap(NULL, ss.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (addr != MAP_FAILED)
+			{
+				// DSFReadMem hops between atoms and decodes pools as commands need them, so the access
+				// pattern is not sequential - but every page gets used, so ask for all of it up front.
+				madvise(addr, ss.st_size, MADV_WILLNEED);
+				result = DSFReadMem((const char *) addr, (const char *) addr + ss.st_size, inCallbacks, inPasses, inRef);
+				munmap(addr, ss.st_size);
+				close(fd);
+				return result;
+			}
+		}
+		close(fd);
+	}
+#elif IBM
+	HANDLE winFile = CreateFileW(convert_str_to_utf16(inPath).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (winFile != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER file_size;
+		HANDLE winFileMapping = NULL;
+		if (GetFileSizeEx(winFile, &file_size) && file_size.QuadPart > 0)
+			winFileMapping = CreateFileMapping(winFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (winFileMapping)
+		{
+			const char * addr = (const char *) MapViewOfFile(winFileMapping, FILE_MAP_READ, 0, 0, 0);
+			if (addr)
+			{
+				result = DSFReadMem(addr, addr + file_size.QuadPart, inCallbacks, inPasses, inRef);
+				UnmapViewOfFile(addr);
+				CloseHandle(winFileMapping);
+				CloseHandle(winFile);
+				return result;
+			}
+			CloseHandle(winFileMapping);
+		}
+		CloseHandle(winFile);
+	}
+#endif
+	// Mapping failed (e.g. a file system that can't map) - fall back to reading the whole file.
+	return DSFReadFileBuffered(inPath, malloc, free, inCallbacks, inPasses, inRef);
+}
+
 int		DSFCheckSignature(const char * inPath)
 {
 	FILE *			fi = NULL;
@@ -542,15 +808,13 @@ someday check footer when in sloooow mode
 	/* Read raw geodata. */
 
 	int n;	//,i,p;
-//	vector<vector<unsigned short> >	planarDataRaw;	// Per plane array of shorts
-	vector<vector<double> 		>	planarData;		// Per plane array of doubles
+	vector<DSFPointPoolReader<uint16_t> >	planarData;	// Per plane pool, decoded on demand
 	vector<int>						planeDepths;	// Per plane plane count
 	vector<int>						planeSizes;		// Per plane length of plane
 	vector<vector<double> >			planeScales;	// Per plane scaling factor
 	vector<vector<double> >			planeOffsets;	// Per plane offset
 
-//	vector<vector<unsigned int> >	planarData32Raw;// Per plane array of shorts
-	vector<vector<double> >			planarData32;	// Per plane array of shorts
+	vector<DSFPointPoolReader<uint32_t> >	planarData32;	// Per plane pool, decoded on demand
 	vector<int>						planeDepths32;	// Per plane plane count
 	vector<int>						planeSizes32;	// Per plane length of plane
 	vector<vector<double> >			planeScales32;	// Per plane scaling factor
@@ -601,45 +865,40 @@ someday check footer when in sloooow mode
 
 
 	
+	bool	raw_pools = inPasses && (inPasses[0] & dsf_CmdRawPools);
+
 	n = 0;
 	while (geodContainer.GetNthAtomOfID(def_PointPoolAtom, n, poolAtom))
 	{
-		int aSize = poolAtom.GetArraySize();
-		int pCount = poolAtom.GetPlaneCount();
-		planeDepths.push_back(pCount);
-		planeSizes.push_back(aSize);
-//		planarDataRaw.push_back(vector<unsigned short>());
-//		planarDataRaw.back().resize(aSize * pCount);
-		planarData.push_back(vector<double>());
-		planarData.back().resize(aSize * pCount);
-//		poolAtom.DecompressShort(pCount, aSize, 1, (short *) &*planarDataRaw.back().begin());
-		poolAtom.DecompressShortToDoubleInterleaved(pCount, aSize, &*planarData.back().begin(),
-					&*planeScales[n].begin(),
-					recip_65535,
-					&*planeOffsets[n].begin());
+		if (n >= planeScales.size())
+		{
+#if DEBUG_MESSAGES
+			printf("DSF ERROR: Point pool %d has no 16-bit scaling atom.\n", n);
+#endif
+			return dsf_ErrMisformattedScalingAtom;
+		}
+		planarData.push_back(DSFPointPoolReader<uint16_t>(poolAtom, &*planeScales[n].begin(), &*planeOffsets[n].begin(), recip_65535, raw_pools));
+		planeDepths.push_back(planarData.back().depth);
+		planeSizes.push_back(planarData.back().size);
 		++n;
 	}
 
 	n = 0;
 	while (geodContainer.GetNthAtomOfID(def_PointPool32Atom, n, poolAtom))
 	{
-		int aSize = poolAtom.GetArraySize();
-		int pCount = poolAtom.GetPlaneCount();
-		planeDepths32.push_back(pCount);
-		planeSizes32.push_back(aSize);
-//		planarData32Raw.push_back(vector<unsigned int>());
-//		planarData32Raw.back().resize(aSize * pCount);
-		planarData32.push_back(vector<double>());
-		planarData32.back().resize(aSize * pCount);
-//		poolAtom.DecompressInt(pCount, aSize, 1, (int *) &*planarData32Raw.back().begin());
-
-		poolAtom.DecompressIntToDoubleInterleaved(pCount, aSize, &*planarData32.back().begin(),
-					&*planeScales32[n].begin(),
-					recip_4294967295,
-					&*planeOffsets32[n].begin());
+		if (n >= planeScales32.size())
+		{
+#if DEBUG_MESSAGES
+			printf("DSF ERROR: Point pool %d has no 32-bit scaling atom.\n", n);
+#endif
+			return dsf_ErrMisformattedScalingAtom;
+		}
+		planarData32.push_back(DSFPointPoolReader<uint32_t>(poolAtom, &*planeScales32[n].begin(), &*planeOffsets32[n].begin(), recip_4294967295, raw_pools));
+		planeDepths32.push_back(planarData32.back().depth);
+		planeSizes32.push_back(planarData32.back().size);
 		++n;
-	}	
-	
+	}
+
 	if (inCallbacks->PointPoolInfo_f)
 	{
 		vector<string> pp_info;
@@ -695,10 +954,13 @@ someday check footer when in sloooow mode
 		else
 			pp_info.push_back(string("# obj_pools found: " + to_string(ptPools.size())));
 
+		int hgt_plane = is_overlay ? 2 : 3;
 		for (auto p : ptPools)
 		{
-			double scal = planeScales[p][is_overlay ? 2 : 3];
-			double pmin = planeOffsets[p][is_overlay ? 2 : 3];
+			if (hgt_plane >= planeDepths[p])		// draped objects have no MSL plane
+				continue;
+			double scal = planeScales[p][hgt_plane];
+			double pmin = planeOffsets[p][hgt_plane];
 			double pmax = pmin + scal;
 
 			if (pmin < min_all_pools) min_all_pools = pmin;
@@ -713,64 +975,6 @@ someday check footer when in sloooow mode
 		inCallbacks->PointPoolInfo_f(divisions, hgt_scale, hgt_offs, pp_info, ref);
 	}
 
-	/*
-	for (n = 0; n < planarData.size(); ++n)
-	for (p = 0; p < planeDepths[n]; ++p)
-	{
-		int skip = planeDepths[n];		
-		double * dst = &*planarData[n].begin() + p;
-		unsigned short * src = &*planarDataRaw[n].begin() + p;
-		double sc = planeScales[n][p];
-		double dl = planeOffsets[n][p];
-		i = planeSizes[n];
-		if (sc)
-		{
-			while (i--)
-			{
-				*dst = (((double) *src) * sc * recip_65535) + dl;
-				dst += skip;
-				src += skip;
-			}
-		} else {
-			while (i--)
-			{
-				*dst = *src;
-				dst += skip;
-				src += skip;
-			}
-		}
-	}
-*/			
-/*
-	for (n = 0; n < planarData32.size(); ++n)
-	for (p = 0; p < planeDepths32[n]; ++p)
-	{
-		int skip = planeDepths32[n];		
-		double * dst = &*planarData32[n].begin() + p;
-		unsigned int * src = &*planarData32Raw[n].begin() + p;
-		double sc = planeScales32[n][p];
-		double dl = planeOffsets32[n][p];
-		i = planeSizes32[n];
-		if (sc)
-		{
-			while (i--)
-			{
-				*dst = (((double) *src) * sc * recip_4294967295) + dl;
-				dst += skip;
-				src += skip;
-			}
-		} else {
-			while (i--)
-			{
-				*dst = *src;
-				dst += skip;
-				src += skip;
-			}
-		}
-	}
-	*/
-//	planarData32Raw.clear();
-//	planarDataRaw.clear();
 
 
 	const char * str;
@@ -875,10 +1079,8 @@ someday check footer when in sloooow mode
 		double				patchLODFar = -1.0;
 		unsigned char		patchFlags = 0xFF;
 		bool				patchOpen = false;
-		double *			currentPoolPtr = NULL;
-		double *			currentPoolPtr32 = NULL;
-		int					currentDepth = -1;
-		int					currentDepth32 = -1;
+		DSFPointPoolReader<uint16_t> *	currentPoolPtr = NULL;
+		DSFPointPoolReader<uint32_t> *	currentPoolPtr32 = NULL;
 
 	cmdsAtom.Reset();
 	while (!cmdsAtom.Done())
@@ -919,8 +1121,8 @@ someday check footer when in sloooow mode
 				return dsf_ErrPoolOutOfRange;
 			}
 			
-			if (currentPool < planarData.size())	{ currentPoolPtr   = &*planarData  [currentPool].begin(); currentDepth   = planeDepths  [currentPool]; } else currentPoolPtr = NULL;
-			if (currentPool < planarData32.size())	{ currentPoolPtr32 = &*planarData32[currentPool].begin(); currentDepth32 = planeDepths32[currentPool]; } else currentPoolPtr32 = NULL;
+			currentPoolPtr   = currentPool < planarData.size()   ? &planarData  [currentPool] : NULL;
+			currentPoolPtr32 = currentPool < planarData32.size() ? &planarData32[currentPool] : NULL;
 			break;
 		case dsf_Cmd_JunctionOffsetSelect		:
 			junctionOffset = cmdsAtom.ReadUInt32();
@@ -1046,7 +1248,7 @@ someday check footer when in sloooow mode
 			while(count--)
 			{
 				index = cmdsAtom.ReadUInt16();
-				if (dsf_CmdPolys)
+				if (flags & dsf_CmdPolys)
 				{
 					inCallbacks->AddPolygonPoint_f(DECODE_SCALED_CURRENT(index), ref);
 				}
@@ -1205,7 +1407,7 @@ someday check footer when in sloooow mode
 				index = cmdsAtom.ReadUInt16();
 					if (flags & dsf_CmdPatches)
 					{
-					inCallbacks->AddPatchVertex_f(DECODE_SCALED(index, pool, planarData, planeDepths), ref);
+					inCallbacks->AddPatchVertex_f(DECODE_SCALED(index, pool, planarData), ref);
 			}
 				}
 				if (flags & dsf_CmdPatches)
@@ -1260,7 +1462,7 @@ someday check footer when in sloooow mode
 				index = cmdsAtom.ReadUInt16();
 					if (flags & dsf_CmdPatches)
 					{
-					inCallbacks->AddPatchVertex_f(DECODE_SCALED(index, pool, planarData, planeDepths), ref);
+					inCallbacks->AddPatchVertex_f(DECODE_SCALED(index, pool, planarData), ref);
 			}
 				}
 				if (flags & dsf_CmdPatches)
@@ -1318,7 +1520,7 @@ someday check footer when in sloooow mode
 
 					if (flags & dsf_CmdPatches)
 					{
-					inCallbacks->AddPatchVertex_f(DECODE_SCALED(index, pool, planarData, planeDepths), ref);
+					inCallbacks->AddPatchVertex_f(DECODE_SCALED(index, pool, planarData), ref);
 			}
 				}
 				if (flags & dsf_CmdPatches)
@@ -71,7 +71,11 @@ enum {
 	dsf_CmdObjects = 0x20,	/* Return objects								*/
 	dsf_CmdSign	   = 0x40,	/* Do MD5 signature of data						*/
 	dsf_CmdRaster	=0x80,	/* Raster data									*/
-	dsf_CmdAll	   = 0xFF	/* Return everything at once.					*/
+	dsf_CmdAll	   = 0xFF,	/* Return everything at once.					*/
+
+	/* Read mode flags - these are only honored in the first pass. */
+	dsf_CmdRawPools = 0x100	/* Keep point pools as raw 16/32-bit samples and scale each vertex as it is returned.
+							   Uses far less memory on mesh tiles, but callback coordinates are only valid during the callback. */
 };
 
 enum obj_elev_mode {
@@ -218,6 +222,20 @@ struct	DSFCallbacks_t {
  * read outside the block and will not write to it, so you
  * can use a read-only memory mapped file.
  *
+ * DSFReadFileMapped does exactly that for uncompressed DSFs: the
+ * file is mapped read-only and handed straight to DSFReadMem with
+ * no copy.  7z-compressed DSFs are extracted as with DSFReadFile,
+ * and if the file cannot be mapped it falls back to reading the
+ * whole file into memory from malloc.
+ *
+ * Compressed DSFs are decoded into a buffer as big as the tile,
+ * which is freed once the tile is read.  A thread that reads many
+ * compressed tiles in a row can call DSFKeepDecoderCache(true) to
+ * keep that buffer for the next tile instead, and
+ * DSFKeepDecoderCache(false) to free it again when done.
+ * DSFReleaseDecoderCache also frees the small per-thread look-ahead
+ * buffer.
+ *
  * inRef is a void * passed to each of your callbacks.
  *
  * if inPasses is not NULL, it is an array of ints with a
@@ -227,6 +245,10 @@ struct	DSFCallbacks_t {
  * int in the array should be 0 to indicate the end of
  * the array.
  *
+ * Point pools are decoded the first time a command needs
+ * them, so passes that only want properties or definitions
+ * never decode them at all.
+ *
  * These functions return an error code.  See DSFLib.cpp for
  * #defines to control debug diagnostic output.
  *
@@ -234,6 +256,9 @@ struct	DSFCallbacks_t {
 
 /* Returns true if successful, false if not. */
 int		DSFReadFile(const char * inPath, void * (* malloc_func)(size_t s), void (* free_func)(void * ptr), DSFCallbacks_t * inCallbacks, const int * inPasses, void * inRef);
+int		DSFReadFileMapped(const char * inPath, DSFCallbacks_t * inCallbacks, const int * inPasses, void * inRef);
+void	DSFKeepDecoderCache(bool inKeep);
+void	DSFReleaseDecoderCache(void);
 int		DSFReadMem(const char * inStart, const char * inStop, DSFCallbacks_t * inCallbacks, const int * inPasses, void * inRef);
 int		DSFCheckSignature(const char * inPath);
 /************************************************************
@@ -249,6 +274,9 @@ int		DSFCheckSignature(const char * inPath);
  * of the file and the number of divisions to cut the file into
  * for a point pool.  WorldEditor currently uses 8 divisions.
  *
+ * The output only depends on the data and the order it was added in:
+ * writing the same calls twice gives the same file, byte for byte.
+ *
  */
 
 void *	DSFCreateWriter(double inWest, double inSouth, double inNorth, double inEast, double inElevMin, double inElevMax, int divisions);
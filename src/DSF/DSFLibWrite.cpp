@@ -36,6 +36,8 @@
 
 #include <set>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 #define	POLY_POINT_POOL_COUNT	12
 
@@ -783,67 +785,84 @@ void DSFFileWriterImp::WriteToFile(const char * inPath)
 	}
 
 #if ENCODING_STATS
-	int total_prim_v_contig = 0;
-	int	total_prim_v_shared = 0;
+	atomic<int> total_prim_v_contig(0);
+	atomic<int>	total_prim_v_shared(0);
 #endif
 
-	// Sort these lists by size, and try to sink any non-shared primitive.
-	for (prims = all_primitives.begin(); prims != all_primitives.end(); ++prims)
+	// Every coordinate depth has its own shared pool, so the depths are sunk in parallel.  Within one depth the primitives
+	// go in strictly in the order they were accepted, so the pool assignment does not depend on threads or heap addresses.
+	// (We used to sort them by pointer, which put each patch's vertices wherever malloc had put its primitives.  The pools
+	// hold the same points either way, but their order - and so the exact bytes of the DSF - differs from older builds.)
+	auto sink_depth = [&](DSFSharedPointPool& pool, TPV& depth_prims)
 	{
-		sort(prims->second.begin(), prims->second.end());
+		pair<int, int> loc;
+#if ALLOW_CONTIGUOUS_PRIMITIVES
+		// Sort these lists by size, and try to sink any non-shared primitive.
+		stable_sort(depth_prims.begin(), depth_prims.end(), [](const TriPrimitive * a, const TriPrimitive * b) { return a->vertices.size() > b->vertices.size(); });
 
-		for (prim = prims->second.begin(); prim != prims->second.end(); ++prim)
+		for (TPV::iterator prim = depth_prims.begin(); prim != depth_prims.end(); ++prim)
 		{
-			if (ALLOW_CONTIGUOUS_PRIMITIVES &&
-					terrainPool[prims->first].CountShared((*prim)->vertices) == 0 &&
-					terrainPool[prims->first].CanBeContiguous((*prim)->vertices))
+			if (pool.CountShared((*prim)->vertices) == 0 &&
+				pool.CanBeContiguous((*prim)->vertices))
 			{
 				Assert((*prim)->vertices.size() < 65536);
-				loc = terrainPool[prims->first].AcceptContiguous((*prim)->vertices);
+				loc = pool.AcceptContiguous((*prim)->vertices);
 				if (loc.first != -1 && loc.second != -1)
 				{
 #if ENCODING_STATS
 					total_prim_v_contig += (*prim)->vertices.size();
 #endif
 					(*prim)->is_range = true;
-					for (n = 0; n < (*prim)->vertices.size(); ++n)
+					for (int n = 0; n < (*prim)->vertices.size(); ++n)
 						(*prim)->indices.push_back(DSFPointPoolLoc(loc.first, loc.second + n));
 				}
 			}
 		}
-	}
+#endif
 
-	// Now sink remaining vertices individually.
-	for (prims = all_primitives.begin(); prims != all_primitives.end(); ++prims)
-	for (prim = prims->second.begin(); prim != prims->second.end(); ++prim)
-	if ((*prim)->indices.empty())
-	for (n = 0; n < (*prim)->vertices.size(); ++n)
-	{
-		loc = terrainPool[prims->first].AcceptShared((*prim)->vertices[n]);
-		if(loc.second > 65536)
+		// Now sink remaining vertices individually.
+		for (TPV::iterator prim = depth_prims.begin(); prim != depth_prims.end(); ++prim)
+		if ((*prim)->indices.empty())
+		for (int n = 0; n < (*prim)->vertices.size(); ++n)
 		{
-			printf("ERROR: just sank at %d,%d\n",loc.first,loc.second);
-			Assert("!Out of bounds sink.");
-		}
-		if (loc.first == -1 || loc.second == -1)
-		{
-			(*prim)->vertices[n].dump();
-			printf(" ");
-			(*prim)->vertices[n].dumphex();
-			printf("\n");
-			Assert(!"ERROR: could not sink vertex:\n");
-		}
-		(*prim)->indices.push_back(loc);
+			loc = pool.AcceptShared((*prim)->vertices[n]);
+			if(loc.second > 65536)
+			{
+				printf("ERROR: just sank at %d,%d\n",loc.first,loc.second);
+				Assert("!Out of bounds sink.");
+			}
+			if (loc.first == -1 || loc.second == -1)
+			{
+				(*prim)->vertices[n].dump();
+				printf(" ");
+				(*prim)->vertices[n].dumphex();
+				printf("\n");
+				Assert(!"ERROR: could not sink vertex:\n");
+			}
+			(*prim)->indices.push_back(loc);
 #if ENCODING_STATS
-		++total_prim_v_shared;
+			++total_prim_v_shared;
 #endif
+		}
+	};
+
+	vector<thread>	sinkers;
+	for (prims = all_primitives.begin(); prims != all_primitives.end(); ++prims)
+	{
+		DSFSharedPointPool& pool = terrainPool[prims->first];
+		if (next(prims) == all_primitives.end())
+			sink_depth(pool, prims->second);			// last one on our own thread
+		else
+			sinkers.push_back(thread(sink_depth, ref(pool), ref(prims->second)));
 	}
+	for (vector<thread>::iterator t = sinkers.begin(); t != sinkers.end(); ++t)
+		t->join();
 
 #if ENCODING_STATS
 	int shared = 0;
 	for(DSFSharedPointPoolMap::iterator i = terrainPool.begin(); i != terrainPool.end(); ++i)
 		shared += i->second.Count();
-	printf("%s: Contiguous vertices: %d.  Individual vertices: %d (%d)\n", inPath, total_prim_v_contig, total_prim_v_shared, shared);
+	printf("%s: Contiguous vertices: %d.  Individual vertices: %d (%d)\n", inPath, (int) total_prim_v_contig, (int) total_prim_v_shared, shared);
 #endif
 
 	// Compact final pool data.
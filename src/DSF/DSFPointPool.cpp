@@ -34,6 +34,9 @@
 using namespace	triangle_stripper;
 #endif
 #include <utility>
+#include <math.h>
+#include <atomic>
+#include <thread>
 using std::pair;
 
 
@@ -49,8 +52,7 @@ DSFSharedPointPool::DSFSharedPointPool(
 				const DSFTuple& 		min,
 				const DSFTuple& 		max)
 {
-	mMin = min;
-	mMax = max;
+	SetRange(min, max);
 }
 
 void DSFSharedPointPool::SetRange(
@@ -59,6 +61,54 @@ void DSFSharedPointPool::SetRange(
 {
 	mMin = min;
 	mMax = max;
+
+	mPoolGrid.clear();
+	mAllPools.clear();
+	if (mMin.size() >= 2 && mMax.size() >= 2 && mMax[0] > mMin[0] && mMax[1] > mMin[1])
+		mPoolGrid.resize(kPoolGridSize * kPoolGridSize);
+	for (int p = 0; p < mPools.size(); ++p)
+		IndexPool(p);
+}
+
+int				DSFSharedPointPool::PoolGridCell(double v, int plane) const
+{
+	double	cell = floor((v - mMin[plane]) * kPoolGridSize / (mMax[plane] - mMin[plane]));
+	return	cell < 0.0 ? 0 : (cell >= kPoolGridSize ? kPoolGridSize - 1 : (int) cell);
+}
+
+void			DSFSharedPointPool::IndexPool(int p)
+{
+	mAllPools.push_back(p);
+	if (mPoolGrid.empty())
+		return;
+
+	const SharedSubPool& pool = mPools[p];
+	int x1 = 0, x2 = kPoolGridSize - 1;
+	int y1 = 0, y2 = kPoolGridSize - 1;
+	// A zero scale plane is not scaled at all - that pool could take points from anywhere.
+	// Otherwise pad by a hair, so rounding in encode() can never accept a point from a cell we did not list.
+	if (pool.mScale[0] != 0.0)
+	{
+		double pad = (mMax[0] - mMin[0]) * 1.0e-6;
+		x1 = PoolGridCell(min(pool.mOffset[0], pool.mOffset[0] + pool.mScale[0]) - pad, 0);
+		x2 = PoolGridCell(max(pool.mOffset[0], pool.mOffset[0] + pool.mScale[0]) + pad, 0);
+	}
+	if (pool.mScale[1] != 0.0)
+	{
+		double pad = (mMax[1] - mMin[1]) * 1.0e-6;
+		y1 = PoolGridCell(min(pool.mOffset[1], pool.mOffset[1] + pool.mScale[1]) - pad, 1);
+		y2 = PoolGridCell(max(pool.mOffset[1], pool.mOffset[1] + pool.mScale[1]) + pad, 1);
+	}
+	for (int y = y1; y <= y2; ++y)
+	for (int x = x1; x <= x2; ++x)
+		mPoolGrid[y * kPoolGridSize + x].push_back(p);		// pools only ever get appended, so the cells stay sorted
+}
+
+const vector<int>&	DSFSharedPointPool::PoolsForPoint(const DSFTuple& inPoint) const
+{
+	if (mPoolGrid.empty() || inPoint.size() < 2)
+		return mAllPools;
+	return mPoolGrid[PoolGridCell(inPoint[1], 1) * kPoolGridSize + PoolGridCell(inPoint[0], 0)];
 }
 
 void			DSFSharedPointPool::AddPool(DSFTuple& minFrac, DSFTuple& maxFrac)
@@ -69,6 +119,8 @@ void			DSFSharedPointPool::AddPool(DSFTuple& minFrac, DSFTuple& maxFrac)
 	mPools.push_back(SharedSubPool());
 	mPools.back().mOffset = submin;
 	mPools.back().mScale = submax - submin;
+	mPools.back().mPoints.set_planes(submin.size());
+	IndexPool(mPools.size() - 1);
 }
 
 void			DSFSharedPointPool::AddPoolDirect(DSFTuple& minFrac, DSFTuple& maxFrac)
@@ -79,11 +131,13 @@ void			DSFSharedPointPool::AddPoolDirect(DSFTuple& minFrac, DSFTuple& maxFrac)
 	mPools.push_back(SharedSubPool());
 	mPools.back().mOffset = submin;
 	mPools.back().mScale = submax - submin;
+	mPools.back().mPoints.set_planes(submin.size());
+	IndexPool(mPools.size() - 1);
 }
 
 bool			DSFSharedPointPool::CanBeContiguous(const DSFTupleVector& inPoints)
 {
-	for (list<SharedSubPool>::iterator p = mPools.begin(); p != mPools.end(); ++p)
+	for (vector<SharedSubPool>::iterator p = mPools.begin(); p != mPools.end(); ++p)
 	{
 		// 65535?  yes, really.  The damn cross pool primitive uses [) notation, so it loses 1 unit capacity.
 		if((p->mPoints.size() + inPoints.size()) > 65535)
@@ -109,24 +163,24 @@ bool			DSFSharedPointPool::CanBeContiguous(const DSFTupleVector& inPoints)
 pair<int, int>	DSFSharedPointPool::AcceptContiguous(const DSFTupleVector& inPoints)
 {
 	int n;
-	DSFTupleVector	encoded;
+	vector<uint16_t>	encoded;
 	int	first_ok_pool = -1;
 	int p = 0;
 	SharedSubPool * found = NULL;
 
-	for (list <SharedSubPool>::iterator pool = mPools.begin(); pool != mPools.end(); ++pool, ++p)
+	for (vector<SharedSubPool>::iterator pool = mPools.begin(); pool != mPools.end(); ++pool, ++p)
 	{
 		if((pool->mPoints.size() + inPoints.size()) > 65535)
 		{
 			//printf("Skipping full pool, pool has %d, we need to sink %d.\n", pool->mPoints.size(), inPoints.size());
 			continue;
 		}
+		int planes = pool->mScale.size();
 		bool ok = true;
-		encoded.clear();
+		encoded.resize(inPoints.size() * planes);
 		for (n = 0; n < inPoints.size(); ++n)
 		{
-			encoded.push_back(inPoints[n]);
-			if (!encoded.back().encode(pool->mOffset, pool->mScale))
+			if (!inPoints[n].encode(pool->mOffset, pool->mScale, &encoded[n * planes]))
 			{
 				ok = false;
 				break;
@@ -136,10 +190,9 @@ pair<int, int>	DSFSharedPointPool::AcceptContiguous(const DSFTupleVector& inPoin
 		{
 			// This is the first pool we've found where we at least could
 			// all fit.  Check for sharing.
-			for (n = 0; n < encoded.size(); ++n)
+			for (n = 0; n < inPoints.size(); ++n)
 			{
-				if (pool->mPointsIndex.find(encoded[n]) !=
-					pool->mPointsIndex.end())
+				if (pool->mPoints.find(&encoded[n * planes]) != -1)
 				{
 					return pair<int,int>(-1,-1);
 				}
@@ -157,13 +210,11 @@ pair<int, int>	DSFSharedPointPool::AcceptContiguousPool(int p, SharedSubPool * p
 {
 	int n;
 	pair<int,int> retval(p, (int)pool->mPoints.size());
+	uint16_t	pt[MAX_TUPLE_LEN];
 	for (n = 0; n < inPoints.size(); ++n)
 	{
-		DSFTuple	pt(inPoints[n]);
-		pt.encode(pool->mOffset,pool->mScale);
-		pool->mPointsIndex.insert(hash_map<DSFTuple, int>::value_type(
-					pt, (int)pool->mPoints.size()));
-		pool->mPoints.push_back(pt);
+		inPoints[n].encode(pool->mOffset,pool->mScale,pt);
+		pool->mPoints.append(pt);
 	}
 	return retval;
 }
@@ -174,13 +225,13 @@ int	DSFSharedPointPool::CountShared(const DSFTupleVector& inPoints)
 	for(int n = 0; n < inPoints.size(); ++n)
 	{
 		// First check every scale for the point already existing.
-		for (list<SharedSubPool>::iterator pool = mPools.begin(); pool != mPools.end(); ++pool)
+		const vector<int>& pools = PoolsForPoint(inPoints[n]);
+		for (vector<int>::const_iterator p = pools.begin(); p != pools.end(); ++p)
 		{
-			DSFTuple	point(inPoints[n]);
-			if (point.encode(pool->mOffset, pool->mScale))
+			uint16_t	point[MAX_TUPLE_LEN];
+			if (inPoints[n].encode(mPools[*p].mOffset, mPools[*p].mScale, point))
 			{
-				hash_map<DSFTuple,int>::iterator iter = pool->mPointsIndex.find(point);
-				if (iter != pool->mPointsIndex.end())
+				if (mPools[*p].mPoints.find(point) != -1)
 					++c;
 			}
 		}
@@ -190,55 +241,50 @@ int	DSFSharedPointPool::CountShared(const DSFTupleVector& inPoints)
 
 pair<int, int>	DSFSharedPointPool::AcceptShared(const DSFTuple& inPoint)
 {
-	int p = 0;
+	const vector<int>& pools = PoolsForPoint(inPoint);
+	vector<int>::const_iterator p;
+	uint16_t	point[MAX_TUPLE_LEN];
 	// First check every scale for the point already existing.
-	for (list<SharedSubPool>::iterator pool = mPools.begin(); pool != mPools.end(); ++pool, ++p)
+	for (p = pools.begin(); p != pools.end(); ++p)
 	{
-		DSFTuple	point(inPoint);
-		if (point.encode(pool->mOffset, pool->mScale))
+		SharedSubPool& pool = mPools[*p];
+		if (inPoint.encode(pool.mOffset, pool.mScale, point))
 		{
-			hash_map<DSFTuple,int>::iterator iter = pool->mPointsIndex.find(point);
-			if (iter != pool->mPointsIndex.end())
-				return pair<int,int>(p, iter->second);
+			int iter = pool.mPoints.find(point);
+			if (iter != -1)
+				return pair<int,int>(*p, iter);
 		}
 	}
 	// Hrm...doesn't exist.  Try to add it.
-	p = 0;
-	
-	list<SharedSubPool>::iterator exemplar = mPools.end();
-	for (list<SharedSubPool>::iterator pool = mPools.begin(); pool != mPools.end(); ++pool, ++p)
+	int exemplar = -1;
+	for (p = pools.begin(); p != pools.end(); ++p)
 	{
-		DSFTuple	point(inPoint);
-		if (point.encode(pool->mOffset, pool->mScale))
+		SharedSubPool& pool = mPools[*p];
+		if (inPoint.encode(pool.mOffset, pool.mScale, point))
 		{
-			if(pool->mPoints.size() < 65535)
+			if(pool.mPoints.size() < 65535)
 			{
-				int our_pos = pool->mPoints.size();
-				pool->mPoints.push_back(point);
-				pool->mPointsIndex.insert(hash_map<DSFTuple, int>::value_type(point, our_pos));
-				return pair<int, int>(p, our_pos);
+				int our_pos = pool.mPoints.append(point);
+				return pair<int, int>(*p, our_pos);
 			}
-			else if(exemplar == mPools.end())
-				exemplar = pool;
+			else if(exemplar == -1)
+				exemplar = *p;
 		}
 	}
 	
-	if(exemplar != mPools.end())
+	if(exemplar != -1)
 	{
-		DSFTuple	point(inPoint);
-		if (!point.encode(exemplar->mOffset, exemplar->mScale))
+		if (!inPoint.encode(mPools[exemplar].mOffset, mPools[exemplar].mScale, point))
 			Assert(!"Failure to re-encode into copied pool. This should never happen.");
 
-		mPools.push_back(SharedSubPool());
-		mPools.back().mOffset = exemplar->mOffset;
-		mPools.back().mScale = exemplar->mScale;
-
-		exemplar = mPools.end();
-		--exemplar;
+		SharedSubPool	clone;
+		clone.mOffset = mPools[exemplar].mOffset;
+		clone.mScale = mPools[exemplar].mScale;
+		clone.mPoints.set_planes(mPools[exemplar].mPoints.planes());
+		mPools.push_back(clone);			// invalidates pools - we are done with it
+		IndexPool(mPools.size() - 1);
 
-		int our_pos = exemplar->mPoints.size();
-		exemplar->mPoints.push_back(point);
-		exemplar->mPointsIndex.insert(hash_map<DSFTuple, int>::value_type(point, our_pos));
+		int our_pos = mPools.back().mPoints.append(point);
 		return pair<int, int>((int)mPools.size()-1, our_pos);
 	}
 
@@ -248,14 +294,14 @@ pair<int, int>	DSFSharedPointPool::AcceptShared(const DSFTuple& inPoint)
 
 void			DSFSharedPointPool::Trim(void)
 {
-	for (list<SharedSubPool>::iterator i = mPools.begin(); i != mPools.end(); ++i)
-		trim(i->mPoints);
+	for (vector<SharedSubPool>::iterator i = mPools.begin(); i != mPools.end(); ++i)
+		i->mPoints.trim();
 }
 
 int				DSFSharedPointPool::Count() const
 {
 	int t = 0;
-	for (list<SharedSubPool>::const_iterator i = mPools.begin(); i != mPools.end(); ++i)
+	for (vector<SharedSubPool>::const_iterator i = mPools.begin(); i != mPools.end(); ++i)
 		t += (i->mPoints.size());
 	return t;
 }
@@ -264,21 +310,8 @@ int				DSFSharedPointPool::Count() const
 void			DSFSharedPointPool::ProcessPoints(void)
 {
 	int new_p = 0;
-	for (list<SharedSubPool>::iterator i = mPools.begin(); i != mPools.end(); )
+	for (vector<SharedSubPool>::iterator i = mPools.begin(); i != mPools.end(); )
 	{
-/*
-		map<int, int> counts;
-		for (hash_map<DSFTuple, int>::const_iterator c = i->mPointsIndex.begin(); c != i->mPointsIndex.end(); ++c)
-		{
-			counts[i->mPointsIndex.collision(c)]++;
-		}
-		printf("32 bit pool buckets = %d pts = %d\n", i->mPointsIndex.bucket_count(), i->mPointsIndex.size());
-		for (map<int, int>::iterator j = counts.begin(); j != counts.end(); ++j)
-		{
-			printf("   %d loading     %d times\n", j->first, j->second);
-		}
-*/
-
 		if (i->mPoints.empty())
 		{
 			i = mPools.erase(i);
@@ -289,6 +322,7 @@ void			DSFSharedPointPool::ProcessPoints(void)
 			++new_p;
 		}
 	}
+	SetRange(mMin, mMax);		// pool numbers changed - rebuild the grid
 }
 
 int				DSFSharedPointPool::MapPoolNumber(int n)
@@ -303,26 +337,37 @@ int			DSFSharedPointPool::WritePoolAtoms(FILE * fi, int32_t id)
 		StFileSizeDebugger how_big(fi,"shared point pool total");
 	#endif
 
-	for (list<SharedSubPool>::iterator pool = mPools.begin(); pool != mPools.end(); ++pool)
+	// The sub-pools are independent, so their atoms are encoded on worker threads into memory and then
+	// written in pool order - the file comes out exactly as if each one had been encoded in turn.
+	vector<vector<uint8_t> >	encoded(mPools.size());
+	atomic<int>					next_pool(0);
+	auto encode_pools = [&]()
+	{
+		int p;
+		while ((p = next_pool++) < (int) mPools.size())
+			EncodePlanarNumericAtomShort(encoded[p], mPools[p].mScale.size(), mPools[p].mPoints.size(), xpna_Mode_RLE_Differenced, 1, (int16_t *) mPools[p].mPoints.data());
+	};
+
+	int num_threads = min((int) mPools.size(), (int) thread::hardware_concurrency()) - 1;
+	vector<thread>	encoders;
+	for (int t = 0; t < num_threads; ++t)
+		encoders.push_back(thread(encode_pools));
+	encode_pools();
+	for (vector<thread>::iterator t = encoders.begin(); t != encoders.end(); ++t)
+		t->join();
+
+	for (vector<vector<uint8_t> >::iterator pool = encoded.begin(); pool != encoded.end(); ++pool)
 	{
 		StAtomWriter	poolAtom(fi, id, true);
-		vector<uint16_t>	shorts;
-		for (DSFTupleVector::iterator i = pool->mPoints.begin();
-			i != pool->mPoints.end(); ++i)
-		{
-			for (int j = 0; j < i->size(); ++j)
-			{
-				shorts.push_back((*i)[j]);
-			}
-		}
-		WritePlanarNumericAtomShort(fi, pool->mScale.size(), pool->mPoints.size(), xpna_Mode_RLE_Differenced, 1, (int16_t *) &*shorts.begin());
+		if (!pool->empty())
+			fwrite(&*pool->begin(), 1, pool->size(), fi);
 	}
 	return mPools.size();
 }
 
 int			DSFSharedPointPool::WriteScaleAtoms(FILE * fi, int32_t id)
 {
-	for (list<SharedSubPool>::iterator pool = mPools.begin(); pool != mPools.end(); ++pool)
+	for (vector<SharedSubPool>::iterator pool = mPools.begin(); pool != mPools.end(); ++pool)
 	{
 		StAtomWriter	scaleAtom(fi, id, true);
 		for (int d = 0; d < pool->mScale.size(); ++d)
@@ -528,17 +573,18 @@ void			DSF32BitPointPool::SetRange(
 	mMin = min; mMax = max;
 	mOffset = min;
 	mScale = mMax - mMin;
+	mPoints.set_planes(mScale.size());
 }
 
 int				DSF32BitPointPool::CountShared(const DSFTupleVector& inPoints)
 {
 	int count = 0;
+	uint32_t	pt[MAX_TUPLE_LEN];
 	for (int n = 0; n < inPoints.size(); ++n)
 	{
-		DSFTuple	pt(inPoints[n]);
-		if (!pt.encode32(mOffset, mScale))
+		if (!inPoints[n].encode32(mOffset, mScale, pt))
 			return -1;
-		if (mPointsIndex.find(pt) != mPointsIndex.end())
+		if (mPoints.find(pt) != -1)
 			++count;
 	}
 	return count;
@@ -547,39 +593,35 @@ int				DSF32BitPointPool::CountShared(const DSFTupleVector& inPoints)
 DSFPointPoolLoc	DSF32BitPointPool::AcceptContiguous(const DSFTupleVector& inPoints)
 {
 	DSFPointPoolLoc	result(0, (int)mPoints.size());
+	uint32_t	pt[MAX_TUPLE_LEN];
 	for (int n = 0; n < inPoints.size(); ++n)
 	{
-		DSFTuple	pt(inPoints[n]);
-		if (!pt.encode32(mOffset, mScale))
+		if (!inPoints[n].encode32(mOffset, mScale, pt))
 		{
 			return DSFPointPoolLoc(-1, -1);
 		}
 
-		mPointsIndex.insert(hash_map<DSFTuple, int>::value_type(pt, (int)mPoints.size()));
-		mPoints.push_back(pt);
+		mPoints.append(pt);
 	}
 	return result;
 }
 
 DSFPointPoolLoc	DSF32BitPointPool::AcceptShared(const DSFTuple& inPoint)
 {
-	DSFTuple	pt(inPoint);
-	if (!pt.encode32(mOffset, mScale))
+	uint32_t	pt[MAX_TUPLE_LEN];
+	if (!inPoint.encode32(mOffset, mScale, pt))
 		return DSFPointPoolLoc(-1, -1);
 
-	hash_map<DSFTuple, int>::iterator iter = mPointsIndex.find(pt);
-	if (iter != mPointsIndex.end())
-		return DSFPointPoolLoc(0, iter->second);
+	int iter = mPoints.find(pt);
+	if (iter != -1)
+		return DSFPointPoolLoc(0, iter);
 
-	DSFPointPoolLoc	result(0, (int)mPoints.size());
-	mPointsIndex.insert(hash_map<DSFTuple, int>::value_type(pt, (int)mPoints.size()));
-	mPoints.push_back(pt);
-	return result;
+	return DSFPointPoolLoc(0, mPoints.append(pt));
 }
 
 void				DSF32BitPointPool::Trim(void)
 {
-	trim(mPoints);
+	mPoints.trim();
 }
 
 int				DSF32BitPointPool::WritePoolAtoms(FILE * fi, int32_t id)
@@ -589,16 +631,7 @@ int				DSF32BitPointPool::WritePoolAtoms(FILE * fi, int32_t id)
 		StFileSizeDebugger how_big(fi,"32-bit point pool total");
 	#endif
 	StAtomWriter	poolAtom(fi, id, true);
-	vector<uint32_t>	longs;
-	for (DSFTupleVector::iterator i = mPoints.begin();
-		i != mPoints.end(); ++i)
-	{
-		for (int j = 0; j < i->size(); ++j)
-		{
-			longs.push_back((*i)[j]);
-		}
-	}
-	WritePlanarNumericAtomInt(fi, mScale.size(), mPoints.size(), xpna_Mode_RLE_Differenced, 1, (int *) &*longs.begin());
+	WritePlanarNumericAtomInt(fi, mScale.size(), mPoints.size(), xpna_Mode_RLE_Differenced, 1, (int *) mPoints.data());
 
 	return 1;
 }
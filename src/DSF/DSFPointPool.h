@@ -77,6 +77,9 @@ public:
 	inline bool in_range(const DSFTuple& offset, const DSFTuple& scale) const;
 	inline bool encode(const DSFTuple& offset, const DSFTuple& scale);
 	inline bool encode32(const DSFTuple& offset, const DSFTuple& scale);
+	// Same math, but straight into the quantized values written to the DSF - stops at the first plane out of range.
+	inline bool encode(const DSFTuple& offset, const DSFTuple& scale, uint16_t * out) const;
+	inline bool encode32(const DSFTuple& offset, const DSFTuple& scale, uint32_t * out) const;
 
 	inline int size() const 				{ return mLen; 		}
 	inline double operator[](int n) const 	{ return mData[n]; 	}
@@ -110,6 +113,44 @@ HASH_MAP_NAMESPACE_END
 typedef	vector<DSFTuple>			DSFTupleVector;
 typedef list<DSFTupleVector>		DSFTupleVectorVector;
 
+/* A pool's points, stored quantized - one row of 16 or 32 bit values per point,
+ * exactly what gets written to the DSF.  The index is an open addressing hash
+ * table of row numbers keyed on those values, so finding a shared point never
+ * compares or hashes doubles, and costs a few bytes per point instead of a
+ * hash_map node holding a whole DSFTuple. */
+
+template <class T>
+class	DSFPointIndex {
+public:
+
+	DSFPointIndex(int planes = 0) : mPlanes(planes), mCount(0), mUnique(0) { }
+
+	void		set_planes(int planes) { mPlanes = planes; }
+	int			planes() const { return mPlanes; }
+	int			size() const { return mCount; }
+	bool		empty() const { return mCount == 0; }
+	const T *	data() const { return mValues.empty() ? NULL : &mValues[0]; }
+
+	// Returns the row of the first point with these values, or -1.
+	int			find(const T * values) const;
+	// Appends a row and returns it.  Duplicates are stored but find still
+	// returns the first copy.
+	int			append(const T * values);
+	void		trim();
+
+private:
+
+	inline size_t	hash(const T * values) const;
+	void			rehash(size_t slots);
+
+	int				mPlanes;
+	int				mCount;
+	int				mUnique;
+	vector<T>		mValues;
+	vector<int32_t>	mSlots;		// -1 = empty, size is a power of 2
+
+};
+
 /* A shared point pool.  Every point is pooled, and the
  * points are sorted spatially.  The shared point pool
  * is really N sub-point-pools, so each point ends up
@@ -169,14 +210,24 @@ private:
 		DSFTuple					mOffset;
 		DSFTuple					mScale;
 
-		DSFTupleVector				mPoints;			// These are our points
-		hash_map<DSFTuple, int>		mPointsIndex;		// This is used to see if we already have a point.
+		DSFPointIndex<uint16_t>		mPoints;			// These are our points, encoded and indexed for sharing.
 
 	};
 
-	list<SharedSubPool>			mPools;
+	vector<SharedSubPool>		mPools;
 	vector<int>					mUsageMapping;
 
+	// The pools bucketed by lon/lat: every cell lists (in pool order) the pools whose
+	// range touches it, so sharing a point only tries the few pools around it, not all
+	// DIVISIONS^2 of them.  Empty if the range has no extent - then we try every pool.
+	enum { kPoolGridSize = 64 };
+	vector<vector<int> >		mPoolGrid;
+	vector<int>					mAllPools;
+
+	void				IndexPool(int p);
+	const vector<int>&	PoolsForPoint(const DSFTuple& inPoint) const;
+	int					PoolGridCell(double v, int plane) const;
+
 	DSFPointPoolLoc	AcceptContiguousPool(int pp, SharedSubPool * pool, const DSFTupleVector& inPoints);
 
 };
@@ -256,8 +307,7 @@ private:
 	DSFTuple					mOffset;
 	DSFTuple					mScale;
 
-	DSFTupleVector				mPoints;			// These are our points
-	hash_map<DSFTuple, int>		mPointsIndex;		// This is used to see if we already have a point.
+	DSFPointIndex<uint32_t>		mPoints;			// These are our points, encoded and indexed for sharing.
 
 };
 
@@ -500,6 +550,46 @@ inline bool DSFTuple::encode32(const DSFTuple& offset, const DSFTuple& scale)
 	return true;
 }
 
+inline bool DSFTuple::encode(const DSFTuple& offset, const DSFTuple& scale, uint16_t * out) const
+{
+	if (size() != offset.size()) return false;
+	if (size() != scale.size()) return false;
+
+	const double * i = mData;
+	const double * j = offset.mData;
+	const double * k = scale.mData;
+	int c = mLen;
+	while (c--)
+	{
+		double v = *k ? ((*i - *j) * 65535.0 / (*k) ) : *i;
+		if (v < 0.0 || v > 65535.0)
+			return false;
+		*out++ = v;
+		++i, ++j, ++k;
+	}
+	return true;
+}
+
+inline bool DSFTuple::encode32(const DSFTuple& offset, const DSFTuple& scale, uint32_t * out) const
+{
+	if (size() != offset.size()) return false;
+	if (size() != scale.size()) return false;
+
+	const double * i = mData;
+	const double * j = offset.mData;
+	const double * k = scale.mData;
+	int c = mLen;
+	while (c--)
+	{
+		double v = *k ? ((*i - *j) * 4294967295.0 / (*k) ) : *i;
+		if (v < 0.0 || v > 4294967295.0)
+			return false;
+		*out++ = v;
+		++i, ++j, ++k;
+	}
+	return true;
+}
+
 inline void DSFTuple::push_back(double v)
 {
 #if DEV
@@ -569,6 +659,80 @@ inline size_t DSFTuple::hash(void) const
 }
 
 
+#pragma mark -
+
+template <class T>
+inline size_t DSFPointIndex<T>::hash(const T * values) const
+{
+	uint32_t	ret = 2166136261u;
+	for (int n = 0; n < mPlanes; ++n)
+		ret = (ret ^ (uint32_t) values[n]) * 16777619u;
+	return ret ^ (ret >> 15);
+}
+
+template <class T>
+void DSFPointIndex<T>::rehash(size_t slots)
+{
+	mSlots.assign(slots, -1);
+	size_t mask = slots - 1;
+	for (int row = 0; row < mCount; ++row)
+	{
+		const T * v = &mValues[row * mPlanes];
+		size_t s = hash(v) & mask;
+		while (mSlots[s] != -1)
+		{
+			if (equal(v, v + mPlanes, &mValues[mSlots[s] * mPlanes]))	// duplicate row - the first copy is in already
+				break;
+			s = (s + 1) & mask;
+		}
+		if (mSlots[s] == -1)
+			mSlots[s] = row;
+	}
+}
+
+template <class T>
+int DSFPointIndex<T>::find(const T * values) const
+{
+	if (mSlots.empty()) return -1;
+	size_t mask = mSlots.size() - 1;
+	size_t s = hash(values) & mask;
+	while (mSlots[s] != -1)
+	{
+		if (equal(values, values + mPlanes, &mValues[mSlots[s] * mPlanes]))
+			return mSlots[s];
+		s = (s + 1) & mask;
+	}
+	return -1;
+}
+
+template <class T>
+int DSFPointIndex<T>::append(const T * values)
+{
+	if ((mUnique + 1) * 2 > (int) mSlots.size())
+		rehash(max<size_t>(64, mSlots.size() * 2));
+
+	int row = mCount++;
+	mValues.insert(mValues.end(), values, values + mPlanes);
+
+	size_t mask = mSlots.size() - 1;
+	size_t s = hash(values) & mask;
+	while (mSlots[s] != -1)
+	{
+		if (equal(values, values + mPlanes, &mValues[mSlots[s] * mPlanes]))
+			return row;
+		s = (s + 1) & mask;
+	}
+	mSlots[s] = row;
+	++mUnique;
+	return row;
+}
+
+template <class T>
+void DSFPointIndex<T>::trim()
+{
+	::trim(mValues);
+}
+
 #endif
 
 
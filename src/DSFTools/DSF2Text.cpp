@@ -23,9 +23,20 @@
 #include <stdio.h>
 #include "DSF2Text.h"
 #include "DSFLib.h"
+#include "XChunkyFileUtils.h"
 #include "../XPTools/version.h"
 
+#include "FileUtils.h"
+
 #include <list>
+#include <chrono>
+#include <algorithm>
+
+#if LIN || APL
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 using std::list;
 
@@ -361,7 +372,7 @@ bool DSF2Text(char ** inDSF, int n, const char * inFileName)
 	while(n--)
 	{
 		fprintf(fi,"# file: %s\n\n",*inDSF);
-		int result = DSFReadFile(*inDSF, malloc, free, &cbs, NULL, &pf);
+		int result = DSFReadFileMapped(*inDSF, &cbs, NULL, &pf);
 
 		fprintf(fi, "# Result code: %d\n", result);
 		if(result == dsf_ErrNoAtoms || result == dsf_ErrBadCookie || result == dsf_ErrBadVersion)
@@ -385,6 +396,267 @@ bool DSF2Text(char ** inDSF, int n, const char * inFileName)
 	return true;
 }
 
+static int DSFBench_Discard(void *, const char *, ...)
+{
+	return 0;
+}
+
+// Reads every file once, with the dsf2text callbacks and the output thrown away.
+static bool DSFBench_ReadAll(const vector<string>& files, bool mapped, double& out_ms)
+{
+	DSFCallbacks_t	cbs;
+	DSF2Text_CreateWriterCallbacks(&cbs);
+
+	print_funcs_s pf;
+	pf.print_func = DSFBench_Discard;
+	pf.ref = NULL;
+
+	bool ok = true;
+	auto t0 = std::chrono::steady_clock::now();
+	for (auto& f : files)
+	{
+		int result = mapped ? DSFReadFileMapped(f.c_str(), &cbs, NULL, &pf)
+							: DSFReadFile(f.c_str(), malloc, free, &cbs, NULL, &pf);
+		if (result != dsf_ErrOK)
+		{
+			fprintf(stderr, "Error %d reading %s.\n", result, f.c_str());
+			ok = false;
+			break;
+		}
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - t0;
+	out_ms = elapsed.count();
+
+	count_ter = count_obj = count_pol = count_net = 0;
+	dem_names.clear();
+	return ok;
+}
+
+// One pass of one reader over all files.  On Linux and macOS each pass runs in a child process, so the
+// peak resident set the child reports on exit belongs to that reader alone.  reader 0 reads nothing, which
+// gives the baseline every child starts from.  out_peak_kb is -1 where we can't tell.
+static bool DSFBench_Pass(const vector<string>& files, int reader, double& out_ms, long& out_peak_kb)
+{
+	out_ms = 0.0;
+	out_peak_kb = -1;
+#if LIN || APL
+	int fd[2];
+	if (pipe(fd) != 0)
+		return false;
+	fflush(stdout);
+	fflush(stderr);
+	pid_t pid = fork();
+	if (pid < 0)
+	{
+		close(fd[0]);
+		close(fd[1]);
+		return false;
+	}
+	if (pid == 0)
+	{
+		close(fd[0]);
+		double ms = 0.0;
+		bool ok = reader == 0 || DSFBench_ReadAll(files, reader == 2, ms);
+		ok = write(fd[1], &ms, sizeof(ms)) == sizeof(ms) && ok;
+		_exit(ok ? 0 : 1);
+	}
+	close(fd[1]);
+	bool got = read(fd[0], &out_ms, sizeof(out_ms)) == sizeof(out_ms);
+	close(fd[0]);
+
+	int status;
+	struct rusage ru;
+	if (wait4(pid, &status, 0, &ru) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !got)
+		return false;
+#if APL
+	out_peak_kb = ru.ru_maxrss / 1024;			// bytes on macOS, KB on Linux
+#else
+	out_peak_kb = ru.ru_maxrss;
+#endif
+	return true;
+#else
+	return reader == 0 || DSFBench_ReadAll(files, reader == 2, out_ms);
+#endif
+}
+
+bool DSFBenchRead(const char * inPath, int passes)
+{
+	base_name.clear();				// don't write out raster data
+
+	vector<string> files, dirs;
+	if (FILE_get_directory(inPath, NULL, NULL) < 0)
+		files.push_back(inPath);
+	else
+	{
+		vector<string> all;
+		FILE_get_directory_recursive(inPath, all, dirs);
+		for (auto& f : all)
+		{
+			string ext = FILE_get_file_extension(f);
+			if (ext == "dsf" || ext == "DSF")
+				files.push_back(f);
+		}
+		sort(files.begin(), files.end());
+		if (files.empty())
+		{
+			fprintf(stderr, "No DSF files in %s.\n", inPath);
+			return false;
+		}
+	}
+
+	long	base_kb;
+	double	t;
+	if (!DSFBench_Pass(files, 0, t, base_kb))
+		return false;
+
+	// Alternate the two readers, so neither one gets all of the cold-cache passes.
+	double	ms[3] = { 0.0 };
+	long	peak_kb[3] = { 0 };
+	for (int n = 0; n < passes; ++n)
+	for (int reader = 1; reader <= 2; ++reader)
+	{
+		long kb;
+		if (!DSFBench_Pass(files, reader, t, kb))
+		{
+			fprintf(stderr, "Reading %s failed.\n", inPath);
+			return false;
+		}
+		ms[reader] += t;
+		peak_kb[reader] = max(peak_kb[reader], kb);
+	}
+	count_ter = count_obj = count_pol = count_net = 0;
+	dem_names.clear();
+
+	printf("%s: %d file(s), %d passes.\n", inPath, (int) files.size(), passes);
+	for (int reader = 1; reader <= 2; ++reader)
+	{
+		printf("  %-17s %10.3lf ms per pass, %8.3lf ms per file", reader == 1 ? "DSFReadFile" : "DSFReadFileMapped",
+			ms[reader] / passes, ms[reader] / passes / files.size());
+		if (base_kb >= 0)
+			printf(", peak RSS %7.1lf MB (%.1lf MB over an idle process)", peak_kb[reader] / 1024.0,
+				(peak_kb[reader] - base_kb) / 1024.0);
+		printf("\n");
+	}
+	return true;
+}
+
+// Records every decoded coordinate instead of printing it.  The callbacks we don't override
+// still print through pf, so it has to come first.
+struct simd_rec_s {
+	print_funcs_s	pf;
+	vector<double>	vals;
+	int				patch_depth;
+	int				poly_depth;
+};
+
+static void SIMDRec_BeginPatch(unsigned int, double, double, unsigned char, int inCoordDepth, void * inRef)
+{
+	((simd_rec_s *) inRef)->patch_depth = inCoordDepth;
+}
+
+static void SIMDRec_AddPatchVertex(double inCoordinates[], void * inRef)
+{
+	simd_rec_s * r = (simd_rec_s *) inRef;
+	r->vals.insert(r->vals.end(), inCoordinates, inCoordinates + r->patch_depth);
+}
+
+static void SIMDRec_AddObjectWithMode(unsigned int, double inCoordinates[], obj_elev_mode inMode, void * inRef)
+{
+	simd_rec_s * r = (simd_rec_s *) inRef;
+	r->vals.insert(r->vals.end(), inCoordinates, inCoordinates + (inMode == obj_ModeDraped ? 3 : 4));
+}
+
+static void SIMDRec_EndSegment(double inCoordinates[], bool inCurved, void * inRef)
+{
+	simd_rec_s * r = (simd_rec_s *) inRef;
+	r->vals.insert(r->vals.end(), inCoordinates, inCoordinates + (inCurved ? 7 : 4));
+}
+
+static void SIMDRec_BeginSegment(unsigned int, unsigned int, double inCoordinates[], bool inCurved, void * inRef)
+{
+	SIMDRec_EndSegment(inCoordinates, inCurved, inRef);
+}
+
+static void SIMDRec_AddSegmentShapePoint(double inCoordinates[], bool inCurved, void * inRef)
+{
+	simd_rec_s * r = (simd_rec_s *) inRef;
+	r->vals.insert(r->vals.end(), inCoordinates, inCoordinates + (inCurved ? 6 : 3));
+}
+
+static void SIMDRec_BeginPolygon(unsigned int, unsigned short, int inCoordDepth, void * inRef)
+{
+	((simd_rec_s *) inRef)->poly_depth = inCoordDepth;
+}
+
+static void SIMDRec_AddPolygonPoint(double * inCoordinates, void * inRef)
+{
+	simd_rec_s * r = (simd_rec_s *) inRef;
+	r->vals.insert(r->vals.end(), inCoordinates, inCoordinates + r->poly_depth);
+}
+
+bool DSFCheckSIMD(const char * inDSF)
+{
+	base_name.clear();
+	DSFCallbacks_t	cbs;
+	DSF2Text_CreateWriterCallbacks(&cbs);
+	cbs.BeginPatch_f			= SIMDRec_BeginPatch;
+	cbs.AddPatchVertex_f		= SIMDRec_AddPatchVertex;
+	cbs.AddObjectWithMode_f		= SIMDRec_AddObjectWithMode;
+	cbs.BeginSegment_f			= SIMDRec_BeginSegment;
+	cbs.AddSegmentShapePoint_f	= SIMDRec_AddSegmentShapePoint;
+	cbs.EndSegment_f			= SIMDRec_EndSegment;
+	cbs.BeginPolygon_f			= SIMDRec_BeginPolygon;
+	cbs.AddPolygonPoint_f		= SIMDRec_AddPolygonPoint;
+
+	static const char * names[] = { "scalar", "SSE2", "AVX2" };
+	int		best = SetPlanarNumericSIMD(xpna_SIMD_AVX2);
+	bool	ok = true;
+	vector<double>	reference;
+
+	for (int level = xpna_SIMD_None; level <= best; ++level)
+	{
+		SetPlanarNumericSIMD(level);
+
+		simd_rec_s rec;
+		rec.pf.print_func = DSFBench_Discard;
+		rec.pf.ref = NULL;
+		rec.patch_depth = rec.poly_depth = 0;
+
+		int result = DSFReadFileMapped(inDSF, &cbs, NULL, &rec);
+		count_ter = count_obj = count_pol = count_net = 0;
+		if (result != dsf_ErrOK)
+		{
+			fprintf(stderr, "Error %d reading %s.\n", result, inDSF);
+			ok = false;
+			break;
+		}
+
+		if (level == xpna_SIMD_None)
+		{
+			reference.swap(rec.vals);
+			printf("%s: %zu coordinates decoded by the scalar decoder.\n", inDSF, reference.size());
+			continue;
+		}
+
+		size_t n = 0;
+		while (n < reference.size() && n < rec.vals.size() && memcmp(&reference[n], &rec.vals[n], sizeof(double)) == 0)
+			++n;
+		if (n == reference.size() && n == rec.vals.size())
+			printf("%s: %s matches bit for bit.\n", inDSF, names[level]);
+		else
+		{
+			if (n < reference.size() && n < rec.vals.size())
+				printf("%s: %s differs at coordinate %zu: %.17g vs %.17g.\n", inDSF, names[level], n, reference[n], rec.vals[n]);
+			else
+				printf("%s: %s decoded %zu coordinates, scalar %zu.\n", inDSF, names[level], rec.vals.size(), reference.size());
+			ok = false;
+		}
+	}
+	SetPlanarNumericSIMD(best);
+	dem_names.clear();
+	return ok;
+}
+
 static char * strip_and_clean(char * raw)
 {
 	char * r = raw;
@@ -47,5 +47,14 @@ void DSF2Text_CreateWriterCallbacks(DSFCallbacks_t * cbs);
 // Complete tranlsation from binary to text.
 bool DSF2Text(char ** inDSF, int n, const char * inFileName);
 
+// Time reading a DSF, or every DSF under a directory, passes times through DSFReadFile and
+// DSFReadFileMapped, with the text writer callbacks printing to nowhere.  Prints the time and,
+// where the OS tells us, the peak resident memory of each reader to stdout.
+bool DSFBenchRead(const char * inPath, int passes);
+
+// Read a DSF with the scalar point pool decoder and with every SIMD level the
+// CPU has, and check that all coordinates come out bit for bit the same.
+bool DSFCheckSIMD(const char * inDSF);
+
 
 #endif /* DSF2Text_H */
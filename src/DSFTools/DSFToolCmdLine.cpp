@@ -88,6 +88,25 @@ int main(int argc, char * argv[])
 			else
 				{ fprintf(err_fi, "ERROR: Error convertiong %s to %s\n", f1, f2); exit(1); }
 		}
+		if (!strcmp(argv[n], "--bench_read"))
+		{
+			++n;
+			if (n >= argc) goto help;
+			const char * f1 = argv[n];
+			int passes = 10;
+			if (n + 1 < argc && atoi(argv[n+1]) > 0)
+				passes = atoi(argv[++n]);
+
+			if (!DSFBenchRead(f1, passes))
+				exit(1);
+		}
+		if (!strcmp(argv[n], "--check_simd"))
+		{
+			++n;
+			if (n >= argc) goto help;
+			if (!DSFCheckSIMD(argv[n]))
+				exit(1);
+		}
 		if (!strcmp(argv[n], "--version"))
 		{
 			print_product_version("DSFTool", DSFTOOL_VER, DSFTOOL_EXTRAVER);
@@ -98,6 +117,8 @@ int main(int argc, char * argv[])
 help:
 	fprintf(err_fi, "Usage: %s --dsf2text [dsffile] [textfile]\n",argv[0]);
 	fprintf(err_fi, "       %s --text2dsf [textfile] [dsffile]\n",argv[0]);
+	fprintf(err_fi, "       %s --bench_read [dsffile or directory] <passes>\n",argv[0]);
+	fprintf(err_fi, "       %s --check_simd [dsffile]\n",argv[0]);
 	fprintf(err_fi, "       %s --version\n",argv[0]);
 	fprintf(err_fi, "Please note: dsftool still supports single-hyphen (-dsf2text) syntax for backward compatibility.\n");
 	return 1;
@@ -38,6 +38,12 @@
 #include <execinfo.h>
 #include <stdarg.h>
 #endif
+#if LIN || APL
+#include <sys/wait.h>
+#include <unistd.h>
+#include <errno.h>
+#include <thread>
+#endif
 
 
 void	CGALFailure(
@@ -84,326 +90,524 @@ static void die_parse2(const char * msg, va_list va)
 
 
 
-int	main(int argc, char * argv[])
+// Builds one DSF from one script.  Like the rest of MeshTool, a bad input is fatal: we print and exit(1).
+static void make_one_tile(
+					rf_region		region,
+					const char *	script_path,
+					const char *	xes_path,
+					const char *	dem_path,
+					const char *	dir_base,
+					const char *	dsf_path,
+					const char *	temp_prefix)
 {
-	if(argc == 2 && !strcmp(argv[1],"--version"))
+	DEMGeo	dem_elev;
+
+	if(strstr(dem_path,".bil"))
 	{
-		print_product_version("MeshTool", MESHTOOL_VER, MESHTOOL_EXTRAVER);
-		exit(0);
+		DEMSpec	spec;
+
+		spec.mPost = 1;
+		spec.mBigEndian = true;
+		spec.mBits = 16;
+		spec.mNoData = DEM_NO_DATA; // Use OUR no data flag...this means that no data is re-flagged if the header doesn't have a void flag.  User can fix this later with the n flag.
+		spec.mFloat = false;
+		spec.mHeaderBytes = 0;
+	
+		ReadHDR(dem_path, spec, false);
+	
+		if(!ReadRawWithHeader(dem_elev, dem_path, spec))
+		{
+			fprintf(stderr,"Could not read bil file: %s\n", dem_path);
+			exit(1);
+		}
 	}
-
-	if(argc == 2 && !strcmp(argv[1],"--auto_config"))
+	if(strstr(dem_path,".hgt"))
 	{
-		exit(0);
+		if (!ReadRawHGT(dem_elev, dem_path))
+		{
+			fprintf(stderr,"Could not read HGT file: %s\n", dem_path);
+			exit(1);
+		}
+	}
+	else if(strstr(dem_path,".tif"))
+	{
+		int align = dem_want_Post;
+		if (!ExtractGeoTiff(dem_elev, dem_path, align,false))
+		{
+			fprintf(stderr,"Could not read GeoTIFF file: %s\n", dem_path);
+			exit(1);
+		}
+	}
+	else
+	{
+		fprintf(stderr,"ERROR: unknown file extension for DEM: %s\n", dem_path);
+		exit(1);
 	}
-	
-	rf_region region = rf_usa;
 
-	try {
+	char dump_f[24];
+	sprintf(dump_f,DIR_STR "%+03d%+04d",latlon_bucket(round(dem_elev.mSouth)),latlon_bucket(round(dem_elev.mWest)));
+	string dump_dir = string(dir_base) + dump_f;
+	FILE_make_dir_exist(dump_dir.c_str());
 
-		// Set CGAL to throw an exception rather than just
-		// call exit!
-		CGAL::set_error_handler(CGALFailure);
+	FILE * script = fopen(script_path, "r");
+	fname=script_path;
+	if(!script)
+	{
+		fprintf(stderr, "ERROR: could not open %s\n", script_path);
+		exit(1);
+	}
 
-		XESInit(region,false);			// no forests
-		MakeDirectRules();
+	int								terrain_type;
+	int								layer_type = NO_VALUE;
+	double							coords[4];
+	char							shp_path[2048];
+	char							cus_ter[256];
+	char							typ[256];
+	char							buf[1024];
+	double							proj_lon[4],proj_lat[4],proj_s[4],proj_t[4];
 
-		if(argc != 6)
-		{
-			fprintf(stderr, "USAGE: MeshTool <script.txt> <file.xes> <file.hgt> <dir_base> <file.dsf>\n");
-			exit(1);
-		}
+	int				proj_pt = -1;
 
-		DEMGeo	dem_elev;
 
-		if(strstr(argv[3],".bil"))
-		{
-			DEMSpec	spec;
+	int				use_wat;
+	int				zlimit=0;
+	int				is_layer = 0;
+	int				param1;
+	float			param2;
+	MT_Job * job = MT_StartCreate(xes_path, dem_elev, die_parse2);
+	MT_SetTempPrefix(job, temp_prefix);
 
-			spec.mPost = 1;
-			spec.mBigEndian = true;
-			spec.mBits = 16;
-			spec.mNoData = DEM_NO_DATA; // Use OUR no data flag...this means that no data is re-flagged if the header doesn't have a void flag.  User can fix this later with the n flag.
-			spec.mFloat = false;
-			spec.mHeaderBytes = 0;
+	line_num=0;
+	while (fgets(buf, sizeof(buf), script))
+	{
+		++line_num;
 		
-			ReadHDR(argv[3], spec, false);
+		if(sscanf(buf,"GENERATE_DDS %d", &param1)==1)
+		{
+			printf("%s DDS generation.\n", param1 ? "Enabling" : "Disabling");
+			MT_EnableDDSGeneration(job, param1);
+		}
 		
-			if(!ReadRawWithHeader(dem_elev, argv[3], spec))
+		if(strncmp(buf,"CHECKPOINTS",strlen("CHECKPOINTS"))==0)
+		{
+			int flags = 0;
+			for(char * t = strtok(buf + strlen("CHECKPOINTS")," \t\r\n"); t; t = strtok(NULL," \t\r\n"))
 			{
-				fprintf(stderr,"Could not read bil file: %s\n", argv[3]);
-				exit(1);
+				if(strcmp(t,"none") == 0)			;
+				else if(strcmp(t,"mesh") == 0)		flags |= mt_ckpt_mesh;
+				else if(strcmp(t,"terrain") == 0)	flags |= mt_ckpt_terrain;
+				else if(strcmp(t,"resume") == 0)	flags |= mt_ckpt_resume;
+				else
+					die_parse("ERROR: unknown checkpoint option '%s' - use none, mesh, terrain or resume.\n", t);
 			}
+			MT_SetCheckpoints(job, flags);
+			continue;
 		}
-		if(strstr(argv[3],".hgt"))
+
+		if(sscanf(buf,"MESH_SPECS %d %f", &param1, &param2) == 2)
 		{
-			if (!ReadRawHGT(dem_elev, argv[3]))
-			{
-				fprintf(stderr,"Could not read HGT file: %s\n", argv[3]);
-				exit(1);
-			}
+			printf("Setting mesh specs to: %d height points max, %f minimum error.\n", param1, param2);
+			MT_SetMeshSpecs(param1, param2);
+		}
+		
+		if(sscanf(buf,"DEFINE_CUSTOM_TERRAIN %d %s",&use_wat, cus_ter)==2)
+		{
+			proj_pt = 0;
 		}
-		else if(strstr(argv[3],".tif"))
+		if(sscanf(buf,"PROJECT_POINT %lf %lf %lf %lf",coords,coords+1,coords+2,coords+3)==4)
 		{
-			int align = dem_want_Post;
-			if (!ExtractGeoTiff(dem_elev, argv[3], align,false))
+			if(proj_pt==-1)
+				die_parse("ERROR: PROJECT_POINT not allowed until custom terrain defined, or you have more than 4 projection pooints.\n");
+
+			proj_lon[proj_pt] = coords[0];
+			proj_lat[proj_pt] = coords[1];
+			proj_s  [proj_pt] = coords[2];
+			proj_t  [proj_pt] = coords[3];
+
+			proj_pt++;
+			if(proj_pt==4)
 			{
-				fprintf(stderr,"Could not read GeoTIFF file: %s\n", argv[3]);
-				exit(1);
+				MT_CreateCustomTerrain(job, cus_ter,proj_lon,proj_lat,proj_s,proj_t,use_wat);
+				proj_pt=-1;
 			}
 		}
-		else
+
+		if(sscanf(buf,"SHAPEFILE_TERRAIN %s %s",cus_ter,shp_path)==2)
 		{
-			fprintf(stderr,"ERROR: unknown file extension for DEM: %s\n", argv[3]);
-			exit(1);
+			MT_LayerShapefile(job, shp_path,cus_ter);
 		}
 
-		char dump_f[24];
-		sprintf(dump_f,DIR_STR "%+03d%+04d",latlon_bucket(round(dem_elev.mSouth)),latlon_bucket(round(dem_elev.mWest)));
-		string dump_dir = string(argv[4]) + dump_f;
-		FILE_make_dir_exist(dump_dir.c_str());
-
-		FILE * script = fopen(argv[1], "r");
-		fname=argv[1];
-		if(!script)
+		if(sscanf(buf,"BACKGROUND %s",cus_ter)==1)
 		{
-			fprintf(stderr, "ERROR: could not open %s\n", argv[1]);
-			exit(1);
+			MT_LayerBackground(job, cus_ter);
 		}
 
-		int								terrain_type;
-		int								layer_type = NO_VALUE;
-		double							coords[4];
-		char							shp_path[2048];
-		char							cus_ter[256];
-		char							typ[256];
-		char							buf[1024];
-		double							proj_lon[4],proj_lat[4],proj_s[4],proj_t[4];
-
-		int				proj_pt = -1;
-
-
-		int				use_wat;
-		int				zlimit=0;
-		int				is_layer = 0;
-		int				param1;
-		float			param2;
-		MT_StartCreate(argv[2], dem_elev, die_parse2);
+		if(strncmp(buf,"BEGIN_LAYER",strlen("BEGIN_LAYER"))==0)
+		{
+			is_layer=1;
+			layer_type = NO_VALUE;
+		}
 
-		line_num=0;
-		while (fgets(buf, sizeof(buf), script))
+		if(sscanf(buf,"BEGIN_POLYGON %s",cus_ter)==1)
 		{
-			++line_num;
-			
-			if(sscanf(buf,"GENERATE_DDS %d", &param1)==1)
+			terrain_type = LookupToken(cus_ter);
+			if(terrain_type == -1)
+				die_parse("ERROR: cannot find custom terrain type '%s'\n", cus_ter);
+			if(layer_type == NO_VALUE)
 			{
-				printf("%s DDS generation.\n", param1 ? "Enabling" : "Disabling");
-				MT_EnableDDSGeneration(param1);
+				layer_type = terrain_type;
+				MT_LayerStart(job, layer_type);
+				MT_PolygonStart(job);
 			}
-			
-			if(sscanf(buf,"MESH_SPECS %d %f", &param1, &param2) == 2)
-			{
-				printf("Setting mesh specs to: %d height points max, %f minimum error.\n", param1, param2);
-				MT_SetMeshSpecs(param1, param2);
-			}
-			
-			if(sscanf(buf,"DEFINE_CUSTOM_TERRAIN %d %s",&use_wat, cus_ter)==2)
+			else
+				die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
+		}
+
+		if(sscanf(buf,"CUSTOM_POLY %s",cus_ter)==1)
+		{
+			terrain_type = LookupToken(cus_ter);
+			if(terrain_type == -1)
+				die_parse("ERROR: cannot find custom terrain type '%s'\n", cus_ter);
+			if(layer_type == NO_VALUE)
 			{
-				proj_pt = 0;
+				layer_type = terrain_type;
+				MT_LayerStart(job, layer_type);
+				MT_PolygonStart(job);
 			}
-			if(sscanf(buf,"PROJECT_POINT %lf %lf %lf %lf",coords,coords+1,coords+2,coords+3)==4)
+			else
+				die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
+		}
+
+		if(strncmp(buf,"LAND_POLY",strlen("LAND_POLY"))==0)
+		{
+			if(layer_type == NO_VALUE)
 			{
-				if(proj_pt==-1)
-					die_parse("ERROR: PROJECT_POINT not allowed until custom terrain defined, or you have more than 4 projection pooints.\n");
-
-				proj_lon[proj_pt] = coords[0];
-				proj_lat[proj_pt] = coords[1];
-				proj_s  [proj_pt] = coords[2];
-				proj_t  [proj_pt] = coords[3];
-
-				proj_pt++;
-				if(proj_pt==4)
-				{
-					MT_CreateCustomTerrain(cus_ter,proj_lon,proj_lat,proj_s,proj_t,use_wat);
-					proj_pt=-1;
-				}
+				layer_type = terrain_Natural;
+				MT_LayerStart(job, layer_type);
+				MT_PolygonStart(job);
 			}
-
-			if(sscanf(buf,"SHAPEFILE_TERRAIN %s %s",cus_ter,shp_path)==2)
+			else
+				die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
+		}
+		if(strncmp(buf,"WATER_POLY",strlen("WATER_POLY"))==0)
+		{
+			if(layer_type == NO_VALUE)
 			{
-				MT_LayerShapefile(shp_path,cus_ter);
+				layer_type = terrain_Water;
+				MT_LayerStart(job, layer_type);
+				MT_PolygonStart(job);
 			}
-
-			if(sscanf(buf,"BACKGROUND %s",cus_ter)==1)
+			else
+				die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
+		}
+		if(strncmp(buf,"APT_POLY",strlen("APT_POLY"))==0)
+		{
+			if(layer_type == NO_VALUE)
 			{
-				MT_LayerBackground(cus_ter);
+				layer_type = terrain_Airport;
+				MT_LayerStart(job, layer_type);
+				MT_PolygonStart(job);
 			}
+			else
+				die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
+		}
+		if(strncmp(buf,"BEGIN_HOLE",strlen("BEGIN_HOLE"))==0)
+		{
+			MT_HoleStart(job);
+		}
+		if(strncmp(buf,"END_HOLE",strlen("END_HOLE"))==0)
+		{
+			MT_HoleEnd(job);
+		}
+		if(strncmp(buf,"END_POLY",strlen("END_POLY"))==0)
+		{
+			MT_PolygonEnd(job);
 
-			if(strncmp(buf,"BEGIN_LAYER",strlen("BEGIN_LAYER"))==0)
+			if(!is_layer)
 			{
-				is_layer=1;
+				MT_LayerEnd(job);
 				layer_type = NO_VALUE;
 			}
+		}
+		if(strncmp(buf,"END_LAYER",strlen("END_LAYER"))==0)
+		{
+			MT_LayerEnd(job);
+			is_layer=0;
+			layer_type=NO_VALUE;
+		}
+		if (sscanf(buf, "POLYGON_POINT %lf %lf", &coords[0], &coords[1])==2)
+		{
+			MT_PolygonPoint(job, coords[0],coords[1]);
+		}
+		if (sscanf(buf, "HOLE_POINT %lf %lf", &coords[0], &coords[1])==2)
+		{
+			MT_HolePoint(job, coords[0],coords[1]);
+		}
+		if (sscanf(buf, "ZLIMIT %d", &zlimit)==1)
+		{
+			MT_LimitZ(job, zlimit);
+		}
+		if(sscanf(buf,"BEGIN_NET %s",typ)==1)
+		{
+			MT_NetStart(job, typ);
+		}
+		if (sscanf(buf, "NET_SEG %lf %lf %lf %lf", &coords[0], &coords[1], &coords[2], &coords[3])==4)
+		{
+			MT_NetSegment(job, coords[0],coords[1],coords[2],coords[3]);
+		}
+		if(strncmp(buf,"END_NET",strlen("END_NET"))==0)
+		{
+			MT_NetEnd(job);
+		}
 
-			if(sscanf(buf,"BEGIN_POLYGON %s",cus_ter)==1)
-			{
-				terrain_type = LookupToken(cus_ter);
-				if(terrain_type == -1)
-					die_parse("ERROR: cannot find custom terrain type '%s'\n", cus_ter);
-				if(layer_type == NO_VALUE)
-				{
-					layer_type = terrain_type;
-					MT_LayerStart(layer_type);
-					MT_PolygonStart();
-				}
-				else
-					die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
-			}
+		if(sscanf(buf,"QMID_PATH %s",cus_ter)==1)
+		{
+			MT_QMID_Prefix(job, cus_ter);
+		}
+		if(sscanf(buf,"QMID %d %s",&use_wat,cus_ter)==2)
+		{
+			MT_QMID(job, cus_ter, use_wat);
+		}
 
-			if(sscanf(buf,"CUSTOM_POLY %s",cus_ter)==1)
-			{
-				terrain_type = LookupToken(cus_ter);
-				if(terrain_type == -1)
-					die_parse("ERROR: cannot find custom terrain type '%s'\n", cus_ter);
-				if(layer_type == NO_VALUE)
-				{
-					layer_type = terrain_type;
-					MT_LayerStart(layer_type);
-					MT_PolygonStart();
-				}
-				else
-					die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
-			}
+		if(sscanf(buf,"GEOTIFF %d %s",&use_wat,cus_ter)==2)
+		{
+			MT_GeoTiff(job, cus_ter, use_wat);
+		}
 
-			if(strncmp(buf,"LAND_POLY",strlen("LAND_POLY"))==0)
-			{
-				if(layer_type == NO_VALUE)
-				{
-					layer_type = terrain_Natural;
-					MT_LayerStart(layer_type);
-					MT_PolygonStart();
-				}
-				else
-					die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
-			}
-			if(strncmp(buf,"WATER_POLY",strlen("WATER_POLY"))==0)
-			{
-				if(layer_type == NO_VALUE)
-				{
-					layer_type = terrain_Water;
-					MT_LayerStart(layer_type);
-					MT_PolygonStart();
-				}
-				else
-					die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
-			}
-			if(strncmp(buf,"APT_POLY",strlen("APT_POLY"))==0)
-			{
-				if(layer_type == NO_VALUE)
-				{
-					layer_type = terrain_Airport;
-					MT_LayerStart(layer_type);
-					MT_PolygonStart();
-				}
-				else
-					die_parse("ERROR: you cannot use two different terrains inside a single layer.\n");
-			}
-			if(strncmp(buf,"BEGIN_HOLE",strlen("BEGIN_HOLE"))==0)
-			{
-				MT_HoleStart();
-			}
-			if(strncmp(buf,"END_HOLE",strlen("END_HOLE"))==0)
-			{
-				MT_HoleEnd();
-			}
-			if(strncmp(buf,"END_POLY",strlen("END_POLY"))==0)
-			{
-				MT_PolygonEnd();
+		if(sscanf(buf,"ORTHOPHOTO %d %lf %lf %lf %lf %lf %lf %lf %lf %s",&use_wat,
+				&proj_lon[0],&proj_lat[0],
+				&proj_lon[1],&proj_lat[1],
+				&proj_lon[2],&proj_lat[2],
+				&proj_lon[3],&proj_lat[3],
+				cus_ter) == 10)
+		{
+			proj_s[0] = proj_s[3] = 0.0;
+			proj_s[1] = proj_s[2] = 1.0;
+			proj_t[0] = proj_t[1] = 0.0;
+			proj_t[2] = proj_t[3] = 1.0;
+			MT_OrthoPhoto(job, cus_ter, proj_lon, proj_lat, proj_s,proj_t,use_wat);
+		}
+		if(sscanf(buf,"SHAPEFILE_MASK %s",shp_path)==1)
+		{
+			MT_Mask(job, shp_path);
+		}
+		if(sscanf(buf,"SHAPEFILE_CONTOUR %s",shp_path)==1)
+		{
+			MT_Contour(job, shp_path);
+		}
+		if(strncmp(buf,"CLEAR_MASK",strlen("CLEAR_MASK"))==0)
+		{
+			MT_Mask(job, NULL);
+		}
 
-				if(!is_layer)
-				{
-					MT_LayerEnd();
-					layer_type = NO_VALUE;
-				}
-			}
-			if(strncmp(buf,"END_LAYER",strlen("END_LAYER"))==0)
-			{
-				MT_LayerEnd();
-				is_layer=0;
-				layer_type=NO_VALUE;
-			}
-			if (sscanf(buf, "POLYGON_POINT %lf %lf", &coords[0], &coords[1])==2)
-			{
-				MT_PolygonPoint(coords[0],coords[1]);
-			}
-			if (sscanf(buf, "HOLE_POINT %lf %lf", &coords[0], &coords[1])==2)
-			{
-				MT_HolePoint(coords[0],coords[1]);
-			}
-			if (sscanf(buf, "ZLIMIT %d", &zlimit)==1)
-			{
-				MT_LimitZ(zlimit);
-			}
-			if(sscanf(buf,"BEGIN_NET %s",typ)==1)
-			{
-				MT_NetStart(typ);
-			}
-			if (sscanf(buf, "NET_SEG %lf %lf %lf %lf", &coords[0], &coords[1], &coords[2], &coords[3])==4)
-			{
-				MT_NetSegment(coords[0],coords[1],coords[2],coords[3]);
-			}
-			if(strncmp(buf,"END_NET",strlen("END_NET"))==0)
-			{
-				MT_NetEnd();
-			}
+	}
+	fclose(script);
 
-			if(sscanf(buf,"QMID_PATH %s",cus_ter)==1)
-			{
-				MT_QMID_Prefix(cus_ter);
-			}
-			if(sscanf(buf,"QMID %d %s",&use_wat,cus_ter)==2)
-			{
-				MT_QMID(cus_ter, use_wat);
-			}
+	MT_FinishCreate(job);
 
-			if(sscanf(buf,"GEOTIFF %d %s",&use_wat,cus_ter)==2)
-			{
-				MT_GeoTiff(cus_ter, use_wat);
-			}
+	MT_MakeDSF(job, region, dir_base, dsf_path);
 
-			if(sscanf(buf,"ORTHOPHOTO %d %lf %lf %lf %lf %lf %lf %lf %lf %s",&use_wat,
-					&proj_lon[0],&proj_lat[0],
-					&proj_lon[1],&proj_lat[1],
-					&proj_lon[2],&proj_lat[2],
-					&proj_lon[3],&proj_lat[3],
-					cus_ter) == 10)
-			{
-				proj_s[0] = proj_s[3] = 0.0;
-				proj_s[1] = proj_s[2] = 1.0;
-				proj_t[0] = proj_t[1] = 0.0;
-				proj_t[2] = proj_t[3] = 1.0;
-				MT_OrthoPhoto(cus_ter, proj_lon, proj_lat, proj_s,proj_t,use_wat);
-			}
-			if(sscanf(buf,"SHAPEFILE_MASK %s",shp_path)==1)
-			{
-				MT_Mask(shp_path);
+	MT_Cleanup(job);
+}
+
+#if LIN || APL
+
+struct	batch_job_t {
+	string	script, xes, dem, dir_base, dsf;
+	int		has_tile = 0;
+	int		lat = 0, lon = 0;
+	pid_t	pid = 0;
+	int		state = 0;		// 0 = waiting, 1 = running, 2 = finished
+	int		ok = 0;
+};
+
+// Tiles read and write their borders in the dump directory, so two neighbors sharing a dump directory can't be
+// built at the same time.  We get the tile from the DSF name (+DD-DDD.dsf); if we can't, the job runs alone.
+static bool	batch_jobs_conflict(const batch_job_t& a, const batch_job_t& b)
+{
+	if(a.dir_base != b.dir_base)
+		return false;
+	if(!a.has_tile || !b.has_tile)
+		return true;
+	return abs(a.lat - b.lat) <= 1 && abs(a.lon - b.lon) <= 1;
+}
+
+// Batch mode: one line per tile in the job file, holding the same five arguments as a single-tile run.
+// Each tile is built in its own forked child.  The config tables (DEMTables, zoning rules, etc.) are loaded
+// once by the parent and shared copy-on-write, but every child gets a private copy of the mutable global
+// state (custom terrain tokens, mesh specs, CGAL's lazy-exact caches), none of which is thread safe.  (Lazy
+// numbers refine themselves in place the first time they are needed exactly; a whole tile build creates and
+// refines them everywhere.  Block fill's process_blocks can only share a map between threads because it makes
+// every shared number exact first and then only reads them.)  A crash
+// or CGAL failure in one tile only takes out that tile.  stdout/stderr for each tile go to <file.dsf>.log.
+static int run_batch(rf_region region, const char * job_file, int max_jobs)
+{
+	FILE * fi = fopen(job_file, "r");
+	if(!fi)
+	{
+		fprintf(stderr, "ERROR: could not open %s\n", job_file);
+		return 1;
+	}
+
+	vector<batch_job_t>	jobs;
+	char	buf[5 * 1024], a1[1024], a2[1024], a3[1024], a4[1024], a5[1024];
+	int		ln = 0;
+	while(fgets(buf, sizeof(buf), fi))
+	{
+		++ln;
+		char * p = buf;
+		while(*p == ' ' || *p == '\t') ++p;
+		if(*p == '#' || *p == '\n' || *p == '\r' || *p == 0)
+			continue;
+		if(sscanf(p, "%1023s %1023s %1023s %1023s %1023s", a1, a2, a3, a4, a5) != 5)
+		{
+			fprintf(stderr, "ERROR: expected <script.txt> <file.xes> <file.hgt> <dir_base> <file.dsf> (%s: line %d.)\n", job_file, ln);
+			fclose(fi);
+			return 1;
+		}
+		batch_job_t j;
+		j.script = a1; j.xes = a2; j.dem = a3; j.dir_base = a4; j.dsf = a5;
+		j.has_tile = sscanf(FILE_get_file_name(j.dsf).c_str(), "%d%d", &j.lat, &j.lon) == 2;
+		jobs.push_back(j);
+	}
+	fclose(fi);
+
+	if(max_jobs <= 0)
+		max_jobs = thread::hardware_concurrency();
+	if(max_jobs <= 0)
+		max_jobs = 1;
+
+	printf("Building %d tiles, %d at a time.\n", (int) jobs.size(), max_jobs);
+
+	int running = 0, failed = 0, done = 0;
+	while(done < (int) jobs.size())
+	{
+		for(vector<batch_job_t>::iterator j = jobs.begin(); j != jobs.end() && running < max_jobs; ++j)
+		if(j->state == 0)
+		{
+			bool blocked = false;
+			for(vector<batch_job_t>::iterator r = jobs.begin(); r != jobs.end(); ++r)
+			if(r->state == 1 && batch_jobs_conflict(*j, *r))
+			{
+				blocked = true;
+				break;
+			}
+			if(blocked)
+				continue;
+
+			fflush(stdout);
+			fflush(stderr);
+			pid_t pid = fork();
+			if(pid == 0)
+			{
+				string log_path = j->dsf + ".log";
+				if(freopen(log_path.c_str(), "w", stdout))
+					dup2(fileno(stdout), fileno(stderr));
+				int r = 0;
+				try {
+					make_one_tile(region, j->script.c_str(), j->xes.c_str(), j->dem.c_str(), j->dir_base.c_str(), j->dsf.c_str(), (j->dsf + ".").c_str());
+				} catch (std::exception& e) {
+					fprintf(stderr,"ERROR: Caught unknown exception %s.  Exiting.\n", e.what());
+					r = 1;
+				} catch (...) {
+					fprintf(stderr,"ERROR: Caught unknown exception.  Exiting.\n");
+					r = 1;
+				}
+				fflush(stdout);
+				fflush(stderr);
+				_exit(r);
 			}
-			if(sscanf(buf,"SHAPEFILE_CONTOUR %s",shp_path)==1)
+			if(pid < 0)
 			{
-				MT_Contour(shp_path);
+				fprintf(stderr, "ERROR: could not start a process for %s: %s\n", j->dsf.c_str(), strerror(errno));
+				j->state = 2;
+				++failed;
+				++done;
 			}
-			if(strncmp(buf,"CLEAR_MASK",strlen("CLEAR_MASK"))==0)
+			else
 			{
-				MT_Mask(NULL);
+				j->pid = pid;
+				j->state = 1;
+				++running;
 			}
+		}
+
+		if(running == 0)
+			continue;
 
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		if(pid < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			fprintf(stderr, "ERROR: waitpid failed: %s\n", strerror(errno));
+			return 1;
 		}
-		fclose(script);
+		for(vector<batch_job_t>::iterator j = jobs.begin(); j != jobs.end(); ++j)
+		if(j->state == 1 && j->pid == pid)
+		{
+			--running;
+			++done;
+			j->state = 2;
+			j->ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+			if(!j->ok)
+				++failed;
+			printf("[%d/%d] %s: %s\n", done, (int) jobs.size(), j->dsf.c_str(), j->ok ? "done" : "FAILED (see log)");
+			fflush(stdout);
+			break;
+		}
+	}
 
-		MT_FinishCreate();
+	if(failed)
+		fprintf(stderr, "%d of %d tiles failed.\n", failed, (int) jobs.size());
+	return failed ? 1 : 0;
+}
 
-		MT_MakeDSF(region, argv[4], argv[5]);
+#endif
 
+int	main(int argc, char * argv[])
+{
+	if(argc == 2 && !strcmp(argv[1],"--version"))
+	{
+		print_product_version("MeshTool", MESHTOOL_VER, MESHTOOL_EXTRAVER);
+		exit(0);
+	}
+
+	if(argc == 2 && !strcmp(argv[1],"--auto_config"))
+	{
+		exit(0);
+	}
+	
+	rf_region region = rf_usa;
+
+	try {
+
+		// Set CGAL to throw an exception rather than just
+		// call exit!
+		CGAL::set_error_handler(CGALFailure);
+
+		XESInit(region,false);			// no forests
+		MakeDirectRules();
+
+		if(argc >= 3 && argc <= 4 && !strcmp(argv[1],"--batch"))
+		{
+#if LIN || APL
+			exit(run_batch(region, argv[2], argc == 4 ? atoi(argv[3]) : 0));
+#else
+			fprintf(stderr, "ERROR: --batch is not supported on this platform.\n");
+			exit(1);
+#endif
+		}
+
+		if(argc != 6)
+		{
+			fprintf(stderr, "USAGE: MeshTool <script.txt> <file.xes> <file.hgt> <dir_base> <file.dsf>\n");
+			fprintf(stderr, "       MeshTool --batch <jobs.txt> [max_jobs]\n");
+			exit(1);
+		}
+
+		make_one_tile(region, argv[1], argv[2], argv[3], argv[4], argv[5], "");
 
 	} catch (std::exception& e) {
 		fprintf(stdout,"****************************************************************************\n");
@@ -420,6 +624,4 @@ int	main(int argc, char * argv[])
 		fprintf(stderr,"ERROR: Caught unknown exception.  Exiting.\n");
 		exit(0);
 	}
-
-	MT_Cleanup();
 }
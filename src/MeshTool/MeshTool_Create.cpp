@@ -50,60 +50,65 @@
 #include "ObjTables.h"
 #include "ShapeIO.h"
 #include "FileUtils.h"
+#include "SimpleIO.h"
 #include "NetAlgs.h"
 
 #define MT_GAMMA 2.2f
 #define MT_USE_WIN_GAMMA (1)
 
-static DEMGeoMap			sDem;
-static CDT					sMesh;
-static AptVector			sApts;
-static AptIndex				sAptIndex;
-static double				sBounds[4];
-static string				g_qmid_prefix;
-
-static int					sMakeDDS = 0;
-
-static Pmwx *							the_map = NULL;
-static int								layer_type = NO_VALUE;
-static Polygon_2						ring, the_hole;
-static vector<Polygon_2>				holes;
-static vector<Polygon_with_holes_2>		layer;
-static Polygon_set_2					layer_mask;
-static vector<X_monotone_curve_2>		net;
-static int								zlimit=0,zmin=30000,zmax=-2000;
-static MT_Error_f						err_f=NULL;
-static int								net_type=NO_VALUE;
-
-static int								num_cus_terrains=0;
-
-static void die_err(const char * msg, ...)
+// Everything one tile needs while it is being built.  Nothing here is shared between jobs; the config tables
+// (DEMTables, zoning, etc.) are global and loaded once per process.
+struct	MT_Job {
+	DEMGeoMap						mDem;
+	CDT								mMesh;
+	AptVector						mApts;
+	AptIndex						mAptIndex;
+	double							mBounds[4];
+	string							mQmidPrefix;
+	string							mTempPrefix;
+	int								mCheckpoints = mt_ckpt_default;
+
+	int								mMakeDDS = 0;
+
+	Pmwx *							mMap = NULL;
+	int								mLayerType = NO_VALUE;
+	Polygon_2						mRing, mHole;
+	vector<Polygon_2>				mHoles;
+	vector<Polygon_with_holes_2>	mLayer;
+	Polygon_set_2					mLayerMask;
+	vector<X_monotone_curve_2>		mNet;
+	int								mZLimit = 0, mZMin = 30000, mZMax = -2000;
+	MT_Error_f						mErr = NULL;
+	int								mNetType = NO_VALUE;
+};
+
+static void die_err(MT_Job * job, const char * msg, ...)
 {
 	va_list l;
 	va_start(l,msg);
-	if(err_f)
-		err_f(msg,l);
+	if(job->mErr)
+		job->mErr(msg,l);
 	else
 		vfprintf(stderr,msg,l);
 }
 
-void MT_StartCreate(const char * xes_path, const DEMGeo& in_dem, MT_Error_f err_handler)
+MT_Job * MT_StartCreate(const char * xes_path, const DEMGeo& in_dem, MT_Error_f err_handler)
 {
 	DebugAssert(err_handler != NULL);
-	DebugAssert(the_map == NULL);
-	err_f = err_handler;
-	the_map = new Pmwx;
+	MT_Job * job = new MT_Job;
+	job->mErr = err_handler;
+	job->mMap = new Pmwx;
 
 	MFMemFile *	xes = MemFile_Open(xes_path);
 	if(xes == NULL)
 	{
-		die_err("ERROR: could not read XES file:%s\n", xes_path);
-		return;
+		die_err(job, "ERROR: could not read XES file:%s\n", xes_path);
+		return job;
 	}
 
 	{
-		ReadXESFile(xes, NULL, NULL, &sDem, NULL, ConsoleProgressFunc);
-		DEMGeo& lu(sDem[dem_LandUse]);
+		ReadXESFile(xes, NULL, NULL, &job->mDem, NULL, ConsoleProgressFunc);
+		DEMGeo& lu(job->mDem[dem_LandUse]);
 		for(int y = 0; y < lu.mHeight; ++y)
 		for(int x = 0; x < lu.mWidth ; ++x)
 			if (lu.get(x,y) == lu_usgs_INLAND_WATER ||
@@ -112,96 +117,404 @@ void MT_StartCreate(const char * xes_path, const DEMGeo& in_dem, MT_Error_f err_
 	}
 	MemFile_Close(xes);
 	
-	sDem[dem_Elevation] = in_dem;
+	job->mDem[dem_Elevation] = in_dem;
 	
 	// First: snap-round the DEM to the tile bounds.
-	sDem[dem_Elevation].mWest = round(sDem[dem_Elevation].mWest );
-	sDem[dem_Elevation].mEast = round(sDem[dem_Elevation].mEast );
-	sDem[dem_Elevation].mNorth= round(sDem[dem_Elevation].mNorth);
-	sDem[dem_Elevation].mSouth= round(sDem[dem_Elevation].mSouth);
+	job->mDem[dem_Elevation].mWest = round(job->mDem[dem_Elevation].mWest );
+	job->mDem[dem_Elevation].mEast = round(job->mDem[dem_Elevation].mEast );
+	job->mDem[dem_Elevation].mNorth= round(job->mDem[dem_Elevation].mNorth);
+	job->mDem[dem_Elevation].mSouth= round(job->mDem[dem_Elevation].mSouth);
 	
 	// Err check: DEM bounds don't match our XES tile?  That's a fatal error...almost certainly
 	// indicates a wrong set of resources put together, or a very, very borked GeoTiff!
 	
-	if(sDem[dem_Elevation].mWest != sDem[dem_Temperature].mWest)	{ die_err("Error: west edge of DEM and XES data do not match.  DEM is: %lf, XES is: %lf\n",sDem[dem_Elevation].mWest,sDem[dem_Temperature].mWest); return; }
-	if(sDem[dem_Elevation].mEast != sDem[dem_Temperature].mEast)	{ die_err("Error: east edge of DEM and XES data do not match.  DEM is: %lf, XES is: %lf\n",sDem[dem_Elevation].mEast,sDem[dem_Temperature].mEast); return; }
-	if(sDem[dem_Elevation].mNorth != sDem[dem_Temperature].mNorth)	{ die_err("Error: north edge of DEM and XES data do not match.  DEM is: %lf, XES is: %lf\n",sDem[dem_Elevation].mNorth,sDem[dem_Temperature].mNorth); return; }
-	if(sDem[dem_Elevation].mSouth != sDem[dem_Temperature].mSouth)	{ die_err("Error: south edge of DEM and XES data do not match.  DEM is: %lf, XES is: %lf\n",sDem[dem_Elevation].mSouth,sDem[dem_Temperature].mSouth); return; }
+	if(job->mDem[dem_Elevation].mWest != job->mDem[dem_Temperature].mWest)	{ die_err(job, "Error: west edge of DEM and XES data do not match.  DEM is: %lf, XES is: %lf\n",job->mDem[dem_Elevation].mWest,job->mDem[dem_Temperature].mWest); return job; }
+	if(job->mDem[dem_Elevation].mEast != job->mDem[dem_Temperature].mEast)	{ die_err(job, "Error: east edge of DEM and XES data do not match.  DEM is: %lf, XES is: %lf\n",job->mDem[dem_Elevation].mEast,job->mDem[dem_Temperature].mEast); return job; }
+	if(job->mDem[dem_Elevation].mNorth != job->mDem[dem_Temperature].mNorth)	{ die_err(job, "Error: north edge of DEM and XES data do not match.  DEM is: %lf, XES is: %lf\n",job->mDem[dem_Elevation].mNorth,job->mDem[dem_Temperature].mNorth); return job; }
+	if(job->mDem[dem_Elevation].mSouth != job->mDem[dem_Temperature].mSouth)	{ die_err(job, "Error: south edge of DEM and XES data do not match.  DEM is: %lf, XES is: %lf\n",job->mDem[dem_Elevation].mSouth,job->mDem[dem_Temperature].mSouth); return job; }
 
 	// Err check: if the DEM had to be snap-rounded by more than 1%, that's probably a borked GeoTiff.  Barf.
 	#define SNAP_ERR 0.01
-	if(fabs(sDem[dem_Elevation].mWest -in_dem.mWest ) > SNAP_ERR)	{ die_err("Error: the west edge of your DEM (%lf) is more than 1% away from the tile boundary.  This is probably a bad mesh.\n", in_dem.mWest ); return; }
-	if(fabs(sDem[dem_Elevation].mEast -in_dem.mEast ) > SNAP_ERR)	{ die_err("Error: the east edge of your DEM (%lf) is more than 1% away from the tile boundary.  This is probably a bad mesh.\n", in_dem.mEast ); return; }
-	if(fabs(sDem[dem_Elevation].mNorth-in_dem.mNorth) > SNAP_ERR)	{ die_err("Error: the north edge of your DEM (%lf) is more than 1% away from the tile boundary.  This is probably a bad mesh.\n", in_dem.mNorth); return; }
-	if(fabs(sDem[dem_Elevation].mSouth-in_dem.mSouth) > SNAP_ERR)	{ die_err("Error: the south edge of your DEM (%lf) is more than 1% away from the tile boundary.  This is probably a bad mesh.\n", in_dem.mSouth); return; }
+	if(fabs(job->mDem[dem_Elevation].mWest -in_dem.mWest ) > SNAP_ERR)	{ die_err(job, "Error: the west edge of your DEM (%lf) is more than 1% away from the tile boundary.  This is probably a bad mesh.\n", in_dem.mWest ); return job; }
+	if(fabs(job->mDem[dem_Elevation].mEast -in_dem.mEast ) > SNAP_ERR)	{ die_err(job, "Error: the east edge of your DEM (%lf) is more than 1% away from the tile boundary.  This is probably a bad mesh.\n", in_dem.mEast ); return job; }
+	if(fabs(job->mDem[dem_Elevation].mNorth-in_dem.mNorth) > SNAP_ERR)	{ die_err(job, "Error: the north edge of your DEM (%lf) is more than 1% away from the tile boundary.  This is probably a bad mesh.\n", in_dem.mNorth); return job; }
+	if(fabs(job->mDem[dem_Elevation].mSouth-in_dem.mSouth) > SNAP_ERR)	{ die_err(job, "Error: the south edge of your DEM (%lf) is more than 1% away from the tile boundary.  This is probably a bad mesh.\n", in_dem.mSouth); return job; }
 
 	// aArnings if the alignment is, um, goofy!
-	if(sDem[dem_Elevation].mWest !=in_dem.mWest  )	{ printf("Warning: the west edge of your DEM (%lf) is not aligned to the tile boundary.  This is probably a bad mesh.\n", in_dem.mWest ); }
-	if(sDem[dem_Elevation].mEast !=in_dem.mEast  )	{ printf("warning: the east edge of your DEM (%lf) is not aligned to the tile boundary.  This is probably a bad mesh.\n", in_dem.mEast ); }
-	if(sDem[dem_Elevation].mNorth!=in_dem.mNorth )	{ printf("Warning: the north edge of your DEM (%lf) is not aligned to the tile boundary.  This is probably a bad mesh.\n", in_dem.mNorth); }
-	if(sDem[dem_Elevation].mSouth!=in_dem.mSouth )	{ printf("Warning: the south edge of your DEM (%lf) is not aligned to the tile boundary.  This is probably a bad mesh.\n", in_dem.mSouth); }	
+	if(job->mDem[dem_Elevation].mWest !=in_dem.mWest  )	{ printf("Warning: the west edge of your DEM (%lf) is not aligned to the tile boundary.  This is probably a bad mesh.\n", in_dem.mWest ); }
+	if(job->mDem[dem_Elevation].mEast !=in_dem.mEast  )	{ printf("warning: the east edge of your DEM (%lf) is not aligned to the tile boundary.  This is probably a bad mesh.\n", in_dem.mEast ); }
+	if(job->mDem[dem_Elevation].mNorth!=in_dem.mNorth )	{ printf("Warning: the north edge of your DEM (%lf) is not aligned to the tile boundary.  This is probably a bad mesh.\n", in_dem.mNorth); }
+	if(job->mDem[dem_Elevation].mSouth!=in_dem.mSouth )	{ printf("Warning: the south edge of your DEM (%lf) is not aligned to the tile boundary.  This is probably a bad mesh.\n", in_dem.mSouth); }	
 	
-	sBounds[0] = sDem[dem_Elevation].mWest;
-	sBounds[1] = sDem[dem_Elevation].mSouth;
-	sBounds[2] = sDem[dem_Elevation].mEast;
-	sBounds[3] = sDem[dem_Elevation].mNorth;
+	job->mBounds[0] = job->mDem[dem_Elevation].mWest;
+	job->mBounds[1] = job->mDem[dem_Elevation].mSouth;
+	job->mBounds[2] = job->mDem[dem_Elevation].mEast;
+	job->mBounds[3] = job->mDem[dem_Elevation].mNorth;
 	
 	// Err check: voids in the DEM?
 	for(int y = 0; y < in_dem.mHeight; ++y)
 	for(int x = 0; x < in_dem.mWidth ; ++x)
 	if(in_dem.get(x,y) <= -9999)		// -9999 is ESRI void, -32768 is our no data, and hell, -32767 shows up sometimes - no 10 km craters on earth please.
 	{
-		die_err("Error: your DEM is missing data at the point %d,%d.  Meshes must have no gaps or missing data!\n", x,y);
-		return;
+		die_err(job, "Error: your DEM is missing data at the point %d,%d.  Meshes must have no gaps or missing data!\n", x,y);
+		return job;
 	}
+	return job;
 }
 
-void MT_FinishCreate(void)
+void MT_FinishCreate(MT_Job * job)
 {
-	CropMap(*the_map, sBounds[0],sBounds[1],sBounds[2],sBounds[3],false,ConsoleProgressFunc);
+	CropMap(*job->mMap, job->mBounds[0],job->mBounds[1],job->mBounds[2],job->mBounds[3],false,ConsoleProgressFunc);
 
 }
 
-static void print_mesh_stats(void)
+static void print_mesh_stats(MT_Job * job)
 {
 	float minv, maxv, mean, devsq;
-	int n = CalcMeshError(sMesh, sDem[dem_Elevation], minv, maxv,mean,devsq, ConsoleProgressFunc);
+	int n = CalcMeshError(job->mMesh, job->mDem[dem_Elevation], minv, maxv,mean,devsq, ConsoleProgressFunc);
 
 	printf("mean=%f min=%f max=%f std dev = %f", mean, minv, maxv, devsq);
 }
 
-void MT_MakeDSF(rf_region region, const char * dump, const char * out_dsf)
+void MT_SetTempPrefix(MT_Job * job, const char * prefix)
 {
-	// -simplify
-	SimplifyMap(*the_map, true, ConsoleProgressFunc);
+	job->mTempPrefix = prefix;
+}
 
-	//-calcslope
-	CalcSlopeParams(sDem, true, ConsoleProgressFunc);
+void MT_SetCheckpoints(MT_Job * job, int flags)
+{
+	job->mCheckpoints = flags;
+}
 
-	// -upsample
-	UpsampleEnvironmentalParams(sDem, ConsoleProgressFunc);
+// An XES file holds the map and the mesh but not the links between them: orig_vertex and orig_face, the edge
+// feature flags and the edge_of_the_world/explicit_height bits.  Zoning, beaches and explicit heights all need
+// them after the mesh is built, so every checkpoint gets a .links file beside it that stores them by position
+// and re-attaches them to the map when the checkpoint is read back.
+#define CKPT_LINKS_VERSION	1
+
+enum {
+	ckpt_edge_of_world		= 1,
+	ckpt_explicit_height	= 2,
+	ckpt_orig_vertex		= 4
+};
+
+enum {
+	ckpt_face_none,
+	ckpt_face_unbounded,
+	ckpt_face_bounded
+};
+
+typedef pair<double, double>		ckpt_pt;
+typedef pair<ckpt_pt, ckpt_pt>		ckpt_seg;
+
+// Rounded from the exact value, not the lazy approximation, so a key doesn't depend on whether CGAL happened
+// to refine the point before we asked.
+static ckpt_pt ckpt_key(const Point_2& p)
+{
+	return ckpt_pt(CGAL::to_double(p.x().exact()), CGAL::to_double(p.y().exact()));
+}
 
-	// -derivedems
-	DeriveDEMs(*the_map, sDem,sApts, sAptIndex, true, ConsoleProgressFunc);
+// The order WriteMesh numbers the mesh in (vertex 0 is the infinite vertex), which is also the order ReadMesh
+// creates it in - so the n-th record in the links file belongs to the n-th vertex or face after a reload.
+static void ckpt_number_mesh(CDT& mesh, vector<CDT::Vertex_handle>& verts, vector<CDT::Face_handle>& faces)
+{
+	TDS& tds(mesh.tds());
+	verts.push_back(mesh.infinite_vertex());
+	for (TDS::Vertex_iterator v = tds.vertices_begin(); v != tds.vertices_end(); ++v)
+	if (!(&*v == &*mesh.infinite_vertex()))
+		verts.push_back(v);
+	for (TDS::Face_iterator f = tds.face_iterator_base_begin(); f != tds.face_iterator_base_end(); ++f)
+		faces.push_back(f);
+}
 
-	// -zoning
-	ZoneManMadeAreas(*the_map, sDem[dem_Elevation], sDem[dem_LandUse], sDem[dem_ForestType], sDem[dem_ParkType],  sDem[dem_Slope],sApts,Pmwx::Face_handle(),ConsoleProgressFunc);
+static bool write_links(MT_Job * job, const char * path, double xes_size)
+{
+	vector<CDT::Vertex_handle>	verts;
+	vector<CDT::Face_handle>	faces;
+	ckpt_number_mesh(job->mMesh, verts, faces);
 
-	// -calcmesh
-	TriangulateMesh(*the_map, sMesh, sDem, dump, ConsoleProgressFunc);
+	FILE * fi = fopen(path, "wb");
+	if(fi == NULL)
+		return false;
+	{
+		FileWriter		file(fi);
+		WriterBuffer	w(&file);
 
-	WriteXESFile("temp1.xes", *the_map,sMesh,sDem,sApts,ConsoleProgressFunc);
+		w.WriteInt(CKPT_LINKS_VERSION);
+		w.WriteDouble(xes_size);
+		w.WriteInt(verts.size());
+		w.WriteInt(faces.size());
 
-	CalcRoadTypes(*the_map, sDem[dem_Elevation], sDem[dem_UrbanDensity],sDem[dem_Temperature], sDem[dem_Rainfall],ConsoleProgressFunc);
+		for(int n = 1; n < verts.size(); ++n)
+		{
+			const MeshVertexInfo& info(verts[n]->info());
+			ckpt_pt p = ckpt_key(verts[n]->point());
+			int flags = (info.edge_of_the_world ? ckpt_edge_of_world : 0) |
+						(info.explicit_height ? ckpt_explicit_height : 0) |
+						(info.orig_vertex != Vertex_handle() ? ckpt_orig_vertex : 0);
+			w.WriteDouble(p.first);
+			w.WriteDouble(p.second);
+			w.WriteInt(flags);
+			if(flags & ckpt_orig_vertex)
+			{
+				ckpt_pt o = ckpt_key(info.orig_vertex->point());
+				w.WriteDouble(o.first);
+				w.WriteDouble(o.second);
+			}
+		}
 
-	// -assignterrain
-	AssignLandusesToMesh(sDem,sMesh,dump,ConsoleProgressFunc);
-	WriteXESFile("temp2.xes", *the_map,sMesh,sDem,sApts,ConsoleProgressFunc);
+		for(int n = 0; n < faces.size(); ++n)
+		{
+			const MeshFaceInfo& info(faces[n]->info());
+			w.WriteInt((unsigned char) info.edge_flags[0] | ((unsigned char) info.edge_flags[1] << 8) | ((unsigned char) info.edge_flags[2] << 16));
+			if(info.orig_face == Face_handle())
+				w.WriteInt(ckpt_face_none);
+			else if(info.orig_face->is_unbounded())
+				w.WriteInt(ckpt_face_unbounded);
+			else
+			{
+				// Any one halfedge of the outer CCB names the face - source and target pin down the halfedge.
+				Pmwx::Ccb_halfedge_circulator circ(info.orig_face->outer_ccb());
+				ckpt_pt s = ckpt_key(circ->source()->point());
+				ckpt_pt t = ckpt_key(circ->target()->point());
+				w.WriteInt(ckpt_face_bounded);
+				w.WriteDouble(s.first);
+				w.WriteDouble(s.second);
+				w.WriteDouble(t.first);
+				w.WriteDouble(t.second);
+			}
+		}
+
+		// Written last - a short file never gets this far.
+		w.WriteInt(CKPT_LINKS_VERSION);
+	}
+	bool ok = ferror(fi) == 0;
+	fclose(fi);
+	return ok;
+}
+
+// Re-attaches the links to a freshly loaded map and mesh.  Returns NULL on success, else what didn't match.
+static const char * read_links(MT_Job * job, MemFileReader& r)
+{
+	vector<CDT::Vertex_handle>	verts;
+	vector<CDT::Face_handle>	faces;
+	ckpt_number_mesh(job->mMesh, verts, faces);
+
+	int nv = 0, nf = 0;
+	r.ReadInt(nv);
+	r.ReadInt(nf);
+	if(nv != verts.size() || nf != faces.size())
+		return "the mesh has a different number of vertices or faces";
+
+	// Two map vertices that round to the same doubles can't be told apart; we only fail if a link needs one.
+	map<ckpt_pt, Vertex_handle>		pts;
+	set<ckpt_pt>					dup_pts;
+	for(Pmwx::Vertex_iterator v = job->mMap->vertices_begin(); v != job->mMap->vertices_end(); ++v)
+	{
+		ckpt_pt k = ckpt_key(v->point());
+		if(!pts.insert(map<ckpt_pt, Vertex_handle>::value_type(k, v)).second)
+			dup_pts.insert(k);
+	}
+
+	map<ckpt_seg, Face_handle>		segs;
+	set<ckpt_seg>					dup_segs;
+	for(Pmwx::Halfedge_iterator he = job->mMap->halfedges_begin(); he != job->mMap->halfedges_end(); ++he)
+	{
+		ckpt_seg k(ckpt_key(he->source()->point()), ckpt_key(he->target()->point()));
+		if(!segs.insert(map<ckpt_seg, Face_handle>::value_type(k, he->face())).second)
+			dup_segs.insert(k);
+	}
+
+	for(int n = 1; n < nv; ++n)
+	{
+		MeshVertexInfo& info(verts[n]->info());
+		ckpt_pt p, here = ckpt_key(verts[n]->point());
+		int flags = 0;
+		r.ReadDouble(p.first);
+		r.ReadDouble(p.second);
+		r.ReadInt(flags);
+		// The XES stores mesh points as doubles, so allow for the last bit of rounding.
+		if(fabs(p.first - here.first) > 1.0e-9 || fabs(p.second - here.second) > 1.0e-9)
+			return "a mesh vertex has moved";
+		info.edge_of_the_world = (flags & ckpt_edge_of_world) != 0;
+		info.explicit_height = (flags & ckpt_explicit_height) != 0;
+		info.orig_vertex = Vertex_handle();
+		if(flags & ckpt_orig_vertex)
+		{
+			ckpt_pt o;
+			r.ReadDouble(o.first);
+			r.ReadDouble(o.second);
+			map<ckpt_pt, Vertex_handle>::iterator i = pts.find(o);
+			if(i == pts.end() || dup_pts.count(o))
+				return "a mesh vertex's map vertex is missing or ambiguous";
+			info.orig_vertex = i->second;
+		}
+	}
+
+	for(int n = 0; n < nf; ++n)
+	{
+		MeshFaceInfo& info(faces[n]->info());
+		int edges = 0, kind = -1;
+		r.ReadInt(edges);
+		r.ReadInt(kind);
+		info.edge_flags[0] = edges & 0xFF;
+		info.edge_flags[1] = (edges >> 8) & 0xFF;
+		info.edge_flags[2] = (edges >> 16) & 0xFF;
+		if(kind == ckpt_face_none)
+			info.orig_face = Face_handle();
+		else if(kind == ckpt_face_unbounded)
+			info.orig_face = job->mMap->unbounded_face();
+		else if(kind == ckpt_face_bounded)
+		{
+			ckpt_seg k;
+			r.ReadDouble(k.first.first);
+			r.ReadDouble(k.first.second);
+			r.ReadDouble(k.second.first);
+			r.ReadDouble(k.second.second);
+			map<ckpt_seg, Face_handle>::iterator i = segs.find(k);
+			if(i == segs.end() || dup_segs.count(k))
+				return "a mesh triangle's map face is missing or ambiguous";
+			info.orig_face = i->second;
+		}
+		else
+			return "the file is damaged";
+	}
+
+	int tail = 0;
+	r.ReadInt(tail);
+	if(tail != CKPT_LINKS_VERSION)
+		return "the file is truncated";
+	return NULL;
+}
+
+// Both files are written under a scratch name and then replaced in one step, so a run that dies mid-write never
+// leaves a truncated checkpoint that a later resume would trust.  The links file records the size of the XES it
+// goes with; if we die between the two replaces, the pair won't match and the resume ignores it.
+static void write_checkpoint(MT_Job * job, const char * name)
+{
+	string path = job->mTempPrefix + name;
+	string links_path = path + ".links";
+	string tmp_path = path + ".partial";
+	string tmp_links = links_path + ".partial";
+	WriteXESFile(tmp_path.c_str(), *job->mMap,job->mMesh,job->mDem,job->mApts,ConsoleProgressFunc);
+
+	struct stat st;
+	if(FILE_get_file_meta_data(tmp_path, st) != 0 || !write_links(job, tmp_links.c_str(), (double) st.st_size))
+	{
+		die_err(job, "ERROR: could not write checkpoint %s.\n", links_path.c_str());
+		return;
+	}
+	if(FILE_replace_file(tmp_path.c_str(), path.c_str()) != 0 || FILE_replace_file(tmp_links.c_str(), links_path.c_str()) != 0)
+		die_err(job, "ERROR: could not write checkpoint %s.\n", path.c_str());
+}
+
+// Returns 1 if we resumed, 0 if there is no usable checkpoint (we start over), -1 if loading it went wrong
+// after the job was already cleared - the job can't be used then.
+static int read_checkpoint(MT_Job * job, const char * name)
+{
+	string path = job->mTempPrefix + name;
+	string links_path = path + ".links";
+	if(!FILE_exists(path.c_str()))
+		return 0;
+	if(!FILE_exists(links_path.c_str()))
+	{
+		printf("Ignoring checkpoint %s: it has no %s (it is from an older MeshTool), so it can't be resumed.\n", path.c_str(), links_path.c_str());
+		return 0;
+	}
+	MFMemFile * xes = MemFile_Open(path.c_str());
+	if(xes == NULL)
+		return 0;
+	MFMemFile * links = MemFile_Open(links_path.c_str());
+	if(links == NULL)
+	{
+		MemFile_Close(xes);
+		return 0;
+	}
+
+	MemFileReader r(MemFile_GetBegin(links), MemFile_GetEnd(links));
+	int version = 0;
+	double xes_size = -1.0;
+	r.ReadInt(version);
+	r.ReadDouble(xes_size);
+	if(version != CKPT_LINKS_VERSION || xes_size != (double) (MemFile_GetEnd(xes) - MemFile_GetBegin(xes)))
+	{
+		printf("Ignoring checkpoint %s: %s does not belong to it, so it can't be resumed.\n", path.c_str(), links_path.c_str());
+		MemFile_Close(links);
+		MemFile_Close(xes);
+		return 0;
+	}
+
+	printf("Resuming from checkpoint %s.\n", path.c_str());
+	job->mMap->clear();
+	job->mMesh.clear();
+	job->mDem.clear();
+	ReadXESFile(xes, job->mMap, &job->mMesh, &job->mDem, &job->mApts, ConsoleProgressFunc);
+	MemFile_Close(xes);
+
+	const char * why = read_links(job, r);
+	MemFile_Close(links);
+	if(why)
+	{
+		die_err(job, "ERROR: can't resume from checkpoint %s: %s.  Delete it and %s and run again.\n", path.c_str(), why, links_path.c_str());
+		return -1;
+	}
+	return 1;
+}
+
+void MT_MakeDSF(MT_Job * job, rf_region region, const char * dump, const char * out_dsf)
+{
+	// How far along a previous run got: 0 = nothing saved, 1 = mesh built, 2 = terrain assigned.
+	int stage = 0;
+	if(job->mCheckpoints & mt_ckpt_resume)
+	{
+		int r = read_checkpoint(job, "temp2.xes");
+		if(r > 0)
+			stage = 2;
+		else if(r == 0 && (r = read_checkpoint(job, "temp1.xes")) > 0)
+			stage = 1;
+		if(r < 0)
+			return;
+	}
+
+	if(stage < 1)
+	{
+		// -simplify
+		SimplifyMap(*job->mMap, true, ConsoleProgressFunc);
+
+		//-calcslope
+		CalcSlopeParams(job->mDem, true, ConsoleProgressFunc);
+
+		// -upsample
+		UpsampleEnvironmentalParams(job->mDem, ConsoleProgressFunc);
+
+		// -derivedems
+		DeriveDEMs(*job->mMap, job->mDem,job->mApts, job->mAptIndex, true, ConsoleProgressFunc);
+
+		// -zoning
+		ZoneManMadeAreas(*job->mMap, job->mDem[dem_Elevation], job->mDem[dem_LandUse], job->mDem[dem_ForestType], job->mDem[dem_ParkType],  job->mDem[dem_Slope],job->mApts,Pmwx::Face_handle(),ConsoleProgressFunc);
+
+		// -calcmesh
+		TriangulateMesh(*job->mMap, job->mMesh, job->mDem, dump, ConsoleProgressFunc);
+
+		if(job->mCheckpoints & mt_ckpt_mesh)
+			write_checkpoint(job, "temp1.xes");
+	}
+
+	if(stage < 2)
+	{
+		CalcRoadTypes(*job->mMap, job->mDem[dem_Elevation], job->mDem[dem_UrbanDensity],job->mDem[dem_Temperature], job->mDem[dem_Rainfall],ConsoleProgressFunc);
+
+		// -assignterrain
+		AssignLandusesToMesh(job->mDem,job->mMesh,dump,ConsoleProgressFunc);
+
+		if(job->mCheckpoints & mt_ckpt_terrain)
+			write_checkpoint(job, "temp2.xes");
+	}
 
-	print_mesh_stats();
+	print_mesh_stats(job);
 
 	#if DEV
-	for (CDT::Finite_faces_iterator tri = sMesh.finite_faces_begin(); tri != sMesh.finite_faces_end(); ++tri)
+	for (CDT::Finite_faces_iterator tri = job->mMesh.finite_faces_begin(); tri != job->mMesh.finite_faces_end(); ++tri)
 	if (tri->info().terrain == terrain_Water)
 	{
 		DebugAssert(tri->info().terrain == terrain_Water);
@@ -214,21 +527,17 @@ void MT_MakeDSF(rf_region region, const char * dump, const char * out_dsf)
 	#endif
 
 	// -exportDSF
-	BuildDSF(out_dsf, NULL, sDem[dem_Elevation], sDem[dem_Bathymetry], {}, sMesh, /*sTriangulationLo,*/ *the_map, region, ConsoleProgressFunc);
+	BuildDSF(out_dsf, NULL, job->mDem[dem_Elevation], job->mDem[dem_Bathymetry], {}, job->mMesh, /*sTriangulationLo,*/ *job->mMap, region, ConsoleProgressFunc);
 }
 
-void MT_Cleanup(void)
+void MT_Cleanup(MT_Job * job)
 {
-	err_f = NULL;
-	delete the_map;
-	the_map = NULL;
-	sDem.clear();
-	sMesh.clear();
-	sApts.clear();
-	sAptIndex.clear();
+	delete job->mMap;
+	delete job;
 }
 
 int MT_CreateCustomTerrain(
+					MT_Job *	 job,
 					const char * terrain_name,
 					double		proj_lon[4],
 					double		proj_lat[4],
@@ -238,7 +547,7 @@ int MT_CreateCustomTerrain(
 {
 	if(LookupToken(terrain_name) != -1)
 	{
-		die_err("ERROR: The terrain name '%s' already defined or name is reserved.\n", terrain_name);
+		die_err(job, "ERROR: The terrain name '%s' already defined or name is reserved.\n", terrain_name);
 		return NO_VALUE;
 	}
 
@@ -298,63 +607,63 @@ int MT_CreateCustomTerrain(
 	return tt;
 }
 
-void MT_LimitZ(int limit)
+void MT_LimitZ(MT_Job * job, int limit)
 {
 	// store limit^2
-	zlimit *= zlimit;
+	job->mZLimit = limit * limit;
 }
 
-void MT_LayerStart(int in_terrain_type)
+void MT_LayerStart(MT_Job * job, int in_terrain_type)
 {
-	if(layer_type != NO_VALUE)
-		die_err("ERROR: new layer started while a layer is already in effect.\n");
+	if(job->mLayerType != NO_VALUE)
+		die_err(job, "ERROR: new layer started while a layer is already in effect.\n");
 	else if (in_terrain_type == NO_VALUE)
-		die_err("ERROR: new layer needs a valid terrain type.\n");
+		die_err(job, "ERROR: new layer needs a valid terrain type.\n");
 	else
-		layer_type = in_terrain_type;
+		job->mLayerType = in_terrain_type;
 }
 
-void MT_LayerEnd(void)
+void MT_LayerEnd(MT_Job * job)
 {
-	if(layer_type == NO_VALUE)
-		die_err("ERROR: layer cannot be ended - it has not been started.\n");
+	if(job->mLayerType == NO_VALUE)
+		die_err(job, "ERROR: layer cannot be ended - it has not been started.\n");
 	else
 	{
 		Polygon_set_2		layer_map;
-		if (!layer.empty())
+		if (!job->mLayer.empty())
 		{
-			layer_map.join(layer.begin(), layer.end());
-			if(!layer_mask.is_empty())
-				layer_map.intersection(layer_mask);
+			layer_map.join(job->mLayer.begin(), job->mLayer.end());
+			if(!job->mLayerMask.is_empty())
+				layer_map.intersection(job->mLayerMask);
 
 			for(Pmwx::Face_iterator f = layer_map.arrangement().faces_begin(); f != layer_map.arrangement().faces_end(); ++f)
 			if (f->contained())
-				f->data().mTerrainType = layer_type;
+				f->data().mTerrainType = job->mLayerType;
 
 			Pmwx *	new_map = new Pmwx;
-			MapOverlay(*the_map, layer_map.arrangement(), *new_map);
-			delete the_map;
-			the_map = new_map;
+			MapOverlay(*job->mMap, layer_map.arrangement(), *new_map);
+			delete job->mMap;
+			job->mMap = new_map;
 		}
-		layer.clear();
-		layer_type = NO_VALUE;
+		job->mLayer.clear();
+		job->mLayerType = NO_VALUE;
 	}
 }
 
-void MT_LayerBackground(const char * in_terrain_type)
+void MT_LayerBackground(MT_Job * job, const char * in_terrain_type)
 {
 	int t = LookupToken(in_terrain_type);
 	if(t == -1)
 	{
-		die_err("Unknown terrain %s.\n", in_terrain_type);
+		die_err(job, "Unknown terrain %s.\n", in_terrain_type);
 		return;
 	}
 
 	Polygon_2	p;
-	p.push_back(Point_2(sBounds[0],sBounds[1]));
-	p.push_back(Point_2(sBounds[2],sBounds[1]));
-	p.push_back(Point_2(sBounds[2],sBounds[3]));
-	p.push_back(Point_2(sBounds[0],sBounds[3]));
+	p.push_back(Point_2(job->mBounds[0],job->mBounds[1]));
+	p.push_back(Point_2(job->mBounds[2],job->mBounds[1]));
+	p.push_back(Point_2(job->mBounds[2],job->mBounds[3]));
+	p.push_back(Point_2(job->mBounds[0],job->mBounds[3]));
 
 	Polygon_set_2	layer_map(p);
 
@@ -363,135 +672,135 @@ void MT_LayerBackground(const char * in_terrain_type)
 		f->data().mTerrainType = t;
 
 	Pmwx *	new_map = new Pmwx;
-	MapOverlay(*the_map, layer_map.arrangement(), *new_map);
-	delete the_map;
-	the_map = new_map;
+	MapOverlay(*job->mMap, layer_map.arrangement(), *new_map);
+	delete job->mMap;
+	job->mMap = new_map;
 }
 
-void MT_LayerShapefile(const char * fi, const char * in_terrain_type)
+void MT_LayerShapefile(MT_Job * job, const char * fi, const char * in_terrain_type)
 {
 	int lu = LookupToken(in_terrain_type);
 	if(lu == -1) 
 	{
-		die_err("Error: unknown terrain %s.\n", in_terrain_type);
+		die_err(job, "Error: unknown terrain %s.\n", in_terrain_type);
 		return;
 	}
 	
 	Pmwx	layer_map;
-	double b[4] = { sBounds[0],sBounds[1],sBounds[2],sBounds[3] };
+	double b[4] = { job->mBounds[0],job->mBounds[1],job->mBounds[2],job->mBounds[3] };
 	if(!ReadShapeFile(fi,layer_map,shp_Mode_Landuse | shp_Mode_Simple | shp_Use_Crop , in_terrain_type, b, 0.0, 0, ConsoleProgressFunc))
-		die_err("Unable to load shape file: %s\n", fi);
+		die_err(job, "Unable to load shape file: %s\n", fi);
 
 	Pmwx *	new_map = new Pmwx;
-	MapOverlay(*the_map, layer_map, *new_map);
-	delete the_map;
-	the_map = new_map;
+	MapOverlay(*job->mMap, layer_map, *new_map);
+	delete job->mMap;
+	job->mMap = new_map;
 }
 
 
-void MT_PolygonStart(void)
+void MT_PolygonStart(MT_Job * job)
 {
-	zmin=30000,zmax=-2000;
+	job->mZMin=30000,job->mZMax=-2000;
 }
 
-void MT_PolygonPoint(double lon, double lat)
+void MT_PolygonPoint(MT_Job * job, double lon, double lat)
 {
-	ring.push_back(Point_2(lon,lat));
-	if (zlimit != 0) {
-		int z = sDem[dem_Elevation].xy_nearest(lon,lat);
-		if (z<zmin) zmin=z;
-		if (z>zmax) zmax=z;
+	job->mRing.push_back(Point_2(lon,lat));
+	if (job->mZLimit != 0) {
+		int z = job->mDem[dem_Elevation].xy_nearest(lon,lat);
+		if (z<job->mZMin) job->mZMin=z;
+		if (z>job->mZMax) job->mZMax=z;
 	}
 }
 
-bool MT_PolygonEnd(void)
+bool MT_PolygonEnd(MT_Job * job)
 {
 	bool zyes = true;
-	if (zlimit != 0) {
-		Bbox_2 box = ring.bbox();
+	if (job->mZLimit != 0) {
+		Bbox_2 box = job->mRing.bbox();
 		double DEG_TO_NM_LON = DEG_TO_NM_LAT * cos(CGAL::to_double(box.ymin()) * DEG_TO_RAD);
 		double rhs = (pow((box.xmax()-box.xmin())*DEG_TO_NM_LON*NM_TO_MTR,2) + pow((box.ymax()-box.ymin())*DEG_TO_NM_LAT*NM_TO_MTR,2));
-		double lhs = pow((double)(zmax-zmin),2);
+		double lhs = pow((double)(job->mZMax-job->mZMin),2);
 		//fprintf(stderr," %9.0lf,%9.0lf ", rhs, lhs);
-		if (zlimit*lhs > rhs) zyes = false;
+		if (job->mZLimit*lhs > rhs) zyes = false;
 	}
 	if (zyes) {
-		if (ring.is_simple()) {
-			if (ring.orientation() == CGAL::CLOCKWISE)
-				ring.reverse_orientation();
-			Polygon_set_2::Polygon_with_holes_2 P(ring, holes.begin(), holes.end());
-			layer.push_back(P);
+		if (job->mRing.is_simple()) {
+			if (job->mRing.orientation() == CGAL::CLOCKWISE)
+				job->mRing.reverse_orientation();
+			Polygon_set_2::Polygon_with_holes_2 P(job->mRing, job->mHoles.begin(), job->mHoles.end());
+			job->mLayer.push_back(P);
 		} else {
-			die_err("ERROR: this polygon is not simple.  Make sure none of the sides intersect with each other.\n");
+			die_err(job, "ERROR: this polygon is not simple.  Make sure none of the sides intersect with each other.\n");
 		}
 	}
-	holes.clear();
-	ring.clear();
+	job->mHoles.clear();
+	job->mRing.clear();
 	
 	return zyes;
 }
 
-void MT_HoleStart(void)
+void MT_HoleStart(MT_Job * job)
 {
 }
 
-void MT_HolePoint(double lon, double lat)
+void MT_HolePoint(MT_Job * job, double lon, double lat)
 {
-	the_hole.push_back(Point_2(lon,lat));
+	job->mHole.push_back(Point_2(lon,lat));
 }
 
-void MT_HoleEnd(void)
+void MT_HoleEnd(MT_Job * job)
 {
-	if (the_hole.is_simple()) {
-		if (the_hole.orientation() != CGAL::CLOCKWISE)
-			the_hole.reverse_orientation();
-		holes.push_back(the_hole);
-		the_hole.clear();
+	if (job->mHole.is_simple()) {
+		if (job->mHole.orientation() != CGAL::CLOCKWISE)
+			job->mHole.reverse_orientation();
+		job->mHoles.push_back(job->mHole);
+		job->mHole.clear();
 	} else {
-		the_hole.clear();
-		die_err("ERROR: This hole is a non-simple polygon - make sure none of the sides intersect with each other!\n");
+		job->mHole.clear();
+		die_err(job, "ERROR: This hole is a non-simple polygon - make sure none of the sides intersect with each other!\n");
 	}
 }
 
-void MT_NetStart(const char * typ)
+void MT_NetStart(MT_Job * job, const char * typ)
 {
-	net_type = LookupToken(typ);
-	if(net_type == -1) 
+	job->mNetType = LookupToken(typ);
+	if(job->mNetType == -1) 
 	{
-		die_err("Error: unknown network type %s.\n", typ);
+		die_err(job, "Error: unknown network type %s.\n", typ);
 		return;
 	}	
 }
 
-void MT_NetSegment(double lon1, double lat1, double lon2, double lat2)
+void MT_NetSegment(MT_Job * job, double lon1, double lat1, double lon2, double lat2)
 {
-	net.push_back(X_monotone_curve_2(Segment_2(Point_2(lon1,lat1), Point_2(lon2,lat2)),0));
+	job->mNet.push_back(X_monotone_curve_2(Segment_2(Point_2(lon1,lat1), Point_2(lon2,lat2)),0));
 }
 
-void MT_NetEnd(void)
+void MT_NetEnd(MT_Job * job)
 {
-	struct	GISNetworkSegment_t segdata = { net_type, net_type, 0.0, 0.0 };
+	struct	GISNetworkSegment_t segdata = { job->mNetType, job->mNetType, 0.0, 0.0 };
 	Pmwx road_grid;
 
-	if (!net.empty())
+	if (!job->mNet.empty())
 	{
-		CGAL::insert(road_grid, net.begin(), net.end());
+		CGAL::insert(road_grid, job->mNet.begin(), job->mNet.end());
 
 		Pmwx::Edge_iterator the_edge;
 		for (Pmwx::Edge_iterator e = road_grid.edges_begin(); e != road_grid.edges_end(); ++e)
 			e->data().mSegments.push_back(GISNetworkSegment_t(segdata));
 
 		Pmwx * new_map = new Pmwx;
-		MapMerge(*the_map, road_grid,*new_map);
-		delete the_map;
-		the_map = new_map;
-		net.clear();
+		MapMerge(*job->mMap, road_grid,*new_map);
+		delete job->mMap;
+		job->mMap = new_map;
+		job->mNet.clear();
 	}
 }
 
-void MT_EnableDDSGeneration(int create)
+void MT_EnableDDSGeneration(MT_Job * job, int create)
 {
-	sMakeDDS = create;
+	job->mMakeDDS = create;
 }
 
 void MT_SetMeshSpecs(int max_pts, float max_err)
@@ -500,44 +809,45 @@ void MT_SetMeshSpecs(int max_pts, float max_err)
 	gMeshPrefs.max_error = max_err;
 }
 
-void MT_Mask(const char * shapefile)
+void MT_Mask(MT_Job * job, const char * shapefile)
 {
 	if(shapefile == NULL)
-		layer_mask.clear();
+		job->mLayerMask.clear();
 	else
 	{
 		Pmwx	mask_map;
-		double b[4] = { sBounds[0],sBounds[1],sBounds[2],sBounds[3] };
+		double b[4] = { job->mBounds[0],job->mBounds[1],job->mBounds[2],job->mBounds[3] };
 		if(!ReadShapeFile(shapefile,mask_map,shp_Mode_Landuse | shp_Mode_Simple | shp_Use_Crop , "terrain_Water", b, 0.0, 0, ConsoleProgressFunc))
-			die_err("Unable to load shape file: %s\n", shapefile);
+			die_err(job, "Unable to load shape file: %s\n", shapefile);
 
 		for(Pmwx::Face_iterator f = mask_map.faces_begin(); f != mask_map.faces_end(); ++f)
 			f->set_contained(!f->is_unbounded() && f->data().IsWater());
 		
-		layer_mask = mask_map;
+		job->mLayerMask = mask_map;
 	}
 }
 
-void MT_Contour(const char * shapefile)
+void MT_Contour(MT_Job * job, const char * shapefile)
 {
 	const char * lu = FetchTokenString(NO_VALUE);
 	Pmwx	contours;
-	double b[4] = { sBounds[0],sBounds[1],sBounds[2],sBounds[3] };
+	double b[4] = { job->mBounds[0],job->mBounds[1],job->mBounds[2],job->mBounds[3] };
 	if(!ReadShapeFile(shapefile,contours,shp_Mode_Landuse | shp_Mode_Simple | shp_Use_Crop , lu, b, 0.0, 0, ConsoleProgressFunc))
-		die_err("Unable to load shape file: %s\n", shapefile);
+		die_err(job, "Unable to load shape file: %s\n", shapefile);
 
 	for(Pmwx::Edge_iterator e = contours.edges_begin(); e != contours.edges_end(); ++e)
 		e->data().mParams[he_MustBurn] = 1.0;
 
 	Pmwx *	new_map = new Pmwx;
-	MapMerge(*the_map, contours, *new_map);
-	delete the_map;
-	the_map = new_map;
+	MapMerge(*job->mMap, contours, *new_map);
+	delete job->mMap;
+	job->mMap = new_map;
 
 
 }
 
 void MT_OrthoPhoto(
+					MT_Job *	 job,
 					const char * terrain_name,
 					double		 proj_lon[4],
 					double		 proj_lat[4],
@@ -550,13 +860,13 @@ void MT_OrthoPhoto(
 		tname += "_soft";
 	if(back_with_water == 1)
 		tname += "_hard";
-	int t = MT_CreateCustomTerrain(tname.c_str(), proj_lon,proj_lat,proj_s,proj_t,back_with_water);
-	MT_LayerStart(t);
-	MT_PolygonStart();
+	int t = MT_CreateCustomTerrain(job, tname.c_str(), proj_lon,proj_lat,proj_s,proj_t,back_with_water);
+	MT_LayerStart(job, t);
+	MT_PolygonStart(job);
 	for(int n = 0; n < 4; ++n)
-		MT_PolygonPoint(proj_lon[n],proj_lat[n]);
-	MT_PolygonEnd();
-	MT_LayerEnd();
+		MT_PolygonPoint(job, proj_lon[n],proj_lat[n]);
+	MT_PolygonEnd(job);
+	MT_LayerEnd(job);
 }
 
 static void qmid_recurse(int q, double io_lon[4], double io_lat[4])
@@ -603,14 +913,14 @@ inline int near2(int n) {
 	return r;
 }
 
-void MT_GeoTiff(const char * fname, int back_with_water)
+void MT_GeoTiff(MT_Job * job, const char * fname, int back_with_water)
 {
 	double c[8];	// SW, SE, NW, NE lon,lat pairs
 	int align = dem_want_Area;
 	
 	if(!FetchTIFFCorners(fname,c, align))
 	{
-		die_err("Unable to read corner coordinates from %s.\n",fname);
+		die_err(job, "Unable to read corner coordinates from %s.\n",fname);
 		return;
 	}
 
@@ -629,7 +939,7 @@ void MT_GeoTiff(const char * fname, int back_with_water)
 	strcat(tname,"ter");
 	strcat(dname,"dds");
 
-	MT_OrthoPhoto(tname,lon,lat,s,t,back_with_water);
+	MT_OrthoPhoto(job, tname,lon,lat,s,t,back_with_water);
 
 	int meters= LonLatDistMeters(lon[0],lat[0],lon[2],lat[2]);
 
@@ -637,7 +947,7 @@ void MT_GeoTiff(const char * fname, int back_with_water)
 
 	if(!FILE_exists(dname))
 	{
-		if (sMakeDDS)
+		if (job->mMakeDDS)
 		{
 			ImageInfo rgba;
 			if(!CreateBitmapFromTIF(fname,&rgba))
@@ -683,12 +993,12 @@ void MT_GeoTiff(const char * fname, int back_with_water)
 	}
 }
 
-void MT_QMID_Prefix(const char * prefix)
+void MT_QMID_Prefix(MT_Job * job, const char * prefix)
 {
-	g_qmid_prefix = prefix;
+	job->mQmidPrefix = prefix;
 }
 
-void MT_QMID(const char * id, int back_with_water)
+void MT_QMID(MT_Job * job, const char * id, int back_with_water)
 {
 	double lon[4] = { -180.0, 300.0, 300.0, -180.0 };
 	double lat[4] = { -270.0, -270.0, 90.0, 90.0 };
@@ -700,30 +1010,30 @@ void MT_QMID(const char * id, int back_with_water)
 		qmid_recurse((*i++) - '0',lon,lat);
 
 	char fname[1024];
-	sprintf(fname,"%s%s.ter",g_qmid_prefix.c_str(),id);
+	sprintf(fname,"%s%s.ter",job->mQmidPrefix.c_str(),id);
 
 	printf("QMID: %s will go from: %lf,%lf to %lf,%lf\n",
 		id,lon[0],lat[0],lon[2],lat[2]);
 
-	MT_OrthoPhoto(fname, lon, lat, s, t, back_with_water);
+	MT_OrthoPhoto(job, fname, lon, lat, s, t, back_with_water);
 
 	int want_lite = false;
 
 	int isize = 1024;
 
-	sprintf(fname,"%s%s.dds",g_qmid_prefix.c_str(), id);
+	sprintf(fname,"%s%s.dds",job->mQmidPrefix.c_str(), id);
 	if(!FILE_exists(fname))
 	{
-		if(sMakeDDS)
+		if(job->mMakeDDS)
 		{
-			sprintf(fname,"%s%sSu.bmp",g_qmid_prefix.c_str(),id);
+			sprintf(fname,"%s%sSu.bmp",job->mQmidPrefix.c_str(),id);
 			ImageInfo rgb;
 			if(!CreateBitmapFromFile(fname,&rgb))
 			{
 				isize = max(rgb.width,rgb.height);
 				if(!ConvertBitmapToAlpha(&rgb,false))
 				{
-					sprintf(fname,"%s%sBl.bmp",g_qmid_prefix.c_str(),id);
+					sprintf(fname,"%s%sBl.bmp",job->mQmidPrefix.c_str(),id);
 					ImageInfo alpha;
 					if(!CreateBitmapFromFile(fname,&alpha))
 					{
@@ -737,7 +1047,7 @@ void MT_QMID(const char * id, int back_with_water)
 					}
 
 					MakeMipmapStack(&rgb);
-					sprintf(fname,"%s%s.dds",g_qmid_prefix.c_str(),id);
+					sprintf(fname,"%s%s.dds",job->mQmidPrefix.c_str(),id);
 					WriteBitmapToDDS(rgb, 5, fname, MT_USE_WIN_GAMMA);
 				}
 
@@ -751,16 +1061,16 @@ void MT_QMID(const char * id, int back_with_water)
 		DestroyBitmap(&comp);
 	}
 
-	sprintf(fname,"%s%s_LIT.dds",g_qmid_prefix.c_str(),id);
+	sprintf(fname,"%s%s_LIT.dds",job->mQmidPrefix.c_str(),id);
 	if(FILE_exists(fname))
 		want_lite=true;
 	else
 	{
-		sprintf(fname,"%s%sLm.bmp",g_qmid_prefix.c_str(),id);
+		sprintf(fname,"%s%sLm.bmp",job->mQmidPrefix.c_str(),id);
 		ImageInfo lit;
 		if(!CreateBitmapFromFile(fname,&lit))
 		{
-			sprintf(fname,"%s%s_LIT.dds",g_qmid_prefix.c_str(),id);
+			sprintf(fname,"%s%s_LIT.dds",job->mQmidPrefix.c_str(),id);
 			ConvertBitmapToAlpha(&lit,false);
 			MakeMipmapStack(&lit);
 			WriteBitmapToDDS(lit,1,fname, MT_USE_WIN_GAMMA);
@@ -771,7 +1081,7 @@ void MT_QMID(const char * id, int back_with_water)
 
 	int meters= LonLatDistMeters(lon[0],lat[0],lon[2],lat[2]);
 
-	sprintf(fname,"%s%s.ter",g_qmid_prefix.c_str(),id);
+	sprintf(fname,"%s%s.ter",job->mQmidPrefix.c_str(),id);
 	if(!FILE_exists(fname))
 	{
 		FILE * fi = fopen(fname,"w");
@@ -30,12 +30,29 @@ struct	DEMGeo;
 
 typedef	void (* MT_Error_f)(const char * fmt,va_list args);
 
-void MT_StartCreate(const char * xes_path, const DEMGeo& in_dem, MT_Error_f err_handler);
-void MT_FinishCreate(void);
-void MT_MakeDSF(rf_region region, const char * dump_dir, const char * file_name);
-void MT_Cleanup(void);
+// All per-tile state lives in an MT_Job, so one process can build several tiles (one after another) without
+// anything leaking from one into the next.  The terrain/zoning config tables are still process-global.
+struct	MT_Job;
+
+MT_Job * MT_StartCreate(const char * xes_path, const DEMGeo& in_dem, MT_Error_f err_handler);
+void MT_FinishCreate(MT_Job * job);
+void MT_SetTempPrefix(MT_Job * job, const char * prefix);		// Intermediate XES files go to <prefix>temp1.xes, etc.
+
+// Checkpoints are full XES dumps of the job after the expensive stages of MT_MakeDSF.  Each one can be turned
+// off on its own.  With mt_ckpt_resume, MT_MakeDSF picks up from the latest checkpoint it finds on disk instead
+// of redoing that work - it is up to the caller to remove stale checkpoints when the inputs change.
+enum {
+	mt_ckpt_mesh		= 1,		// <prefix>temp1.xes, after triangulation
+	mt_ckpt_terrain		= 2,		// <prefix>temp2.xes, after terrain assignment
+	mt_ckpt_resume		= 4,
+	mt_ckpt_default		= mt_ckpt_mesh | mt_ckpt_terrain
+};
+void MT_SetCheckpoints(MT_Job * job, int flags);
+void MT_MakeDSF(MT_Job * job, rf_region region, const char * dump_dir, const char * file_name);
+void MT_Cleanup(MT_Job * job);										// Deletes the job.
 
 int MT_CreateCustomTerrain(
+					MT_Job *	 job,
 					const char * terrain_name,
 					double		 proj_lon[4],
 					double		 proj_lat[4],
@@ -43,32 +60,33 @@ int MT_CreateCustomTerrain(
 					double		 proj_t[4],
 					int			 back_with_water);
 
-void MT_LimitZ(int limit);
+void MT_LimitZ(MT_Job * job, int limit);
 
-void MT_LayerStart(int in_terrain_type);
-void MT_LayerEnd(void);
-void MT_LayerShapefile(const char * fi, const char * in_terrain_type);
-void MT_LayerBackground(const char * in_terrain_type);
+void MT_LayerStart(MT_Job * job, int in_terrain_type);
+void MT_LayerEnd(MT_Job * job);
+void MT_LayerShapefile(MT_Job * job, const char * fi, const char * in_terrain_type);
+void MT_LayerBackground(MT_Job * job, const char * in_terrain_type);
 
-void MT_PolygonStart(void);
-void MT_PolygonPoint(double lon, double lat);
-bool MT_PolygonEnd(void);						// Returns false if z-limit rejected the polygon.
+void MT_PolygonStart(MT_Job * job);
+void MT_PolygonPoint(MT_Job * job, double lon, double lat);
+bool MT_PolygonEnd(MT_Job * job);						// Returns false if z-limit rejected the polygon.
 
-void MT_HoleStart(void);
-void MT_HolePoint(double lon, double lat);
-void MT_HoleEnd(void);
+void MT_HoleStart(MT_Job * job);
+void MT_HolePoint(MT_Job * job, double lon, double lat);
+void MT_HoleEnd(MT_Job * job);
 
-void MT_NetStart(const char * road_type);
-void MT_NetSegment(double lon1, double lat1, double lon2, double lat2);
-void MT_NetEnd(void);
+void MT_NetStart(MT_Job * job, const char * road_type);
+void MT_NetSegment(MT_Job * job, double lon1, double lat1, double lon2, double lat2);
+void MT_NetEnd(MT_Job * job);
 
-void MT_EnableDDSGeneration(int create);
+void MT_EnableDDSGeneration(MT_Job * job, int create);
 void MT_SetMeshSpecs(int max_pts, float max_err);
 
-void MT_Mask(const char * shapefile);	// or NULL
-void MT_Contour(const char * shapefile);
+void MT_Mask(MT_Job * job, const char * shapefile);	// or NULL
+void MT_Contour(MT_Job * job, const char * shapefile);
 
 void MT_OrthoPhoto(
+					MT_Job *	 job,
 					const char * terrain_name,
 					double		 proj_lon[4],
 					double		 proj_lat[4],
@@ -76,8 +94,8 @@ void MT_OrthoPhoto(
 					double		 proj_t[4],
 					int			 back_with_water);
 
-void MT_GeoTiff(const char * fname, int back_with_water);
-void MT_QMID(const char * id, int back_with_water);
-void MT_QMID_Prefix(const char * prefix);
+void MT_GeoTiff(MT_Job * job, const char * fname, int back_with_water);
+void MT_QMID(MT_Job * job, const char * id, int back_with_water);
+void MT_QMID_Prefix(MT_Job * job, const char * prefix);
 
 #endif /* MeshTool_Create_H */
@@ -29,7 +29,41 @@
 using std::min;
 using std::max;
 
-ObjPointPool::ObjPointPool() : mDepth(8)
+// Murmur3-style mixing: OBJ coordinates are often short binary fractions whose low mantissa bits are
+// all zero, so a plain multiplicative hash would pile them into the same few slots.
+static inline unsigned int	hash_floats(const float pt[], int depth)
+{
+	unsigned int h = depth;
+	for (int n = 0; n < depth; ++n)
+	{
+		float f = pt[n];
+		if (f == 0.0f) f = 0.0f;					// -0 and +0 compare equal, so they must hash equal too.
+		unsigned int k;
+		memcpy(&k, &f, sizeof(k));
+		k *= 0xcc9e2d51u;
+		k = (k << 15) | (k >> 17);
+		k *= 0x1b873593u;
+		h ^= k;
+		h = (h << 13) | (h >> 19);
+		h = h * 5 + 0xe6546b64u;
+	}
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+static inline bool	equal_floats(const float a[], const float b[], int depth)
+{
+	for (int n = 0; n < depth; ++n)
+	if (a[n] != b[n])
+		return false;
+	return true;
+}
+
+ObjPointPool::ObjPointPool() : mIndexCount(0), mDepth(8)
 {
 }
 
@@ -41,6 +75,7 @@ void	ObjPointPool::clear(int depth)
 {
 	mData.clear();
 	mIndex.clear();
+	mIndexCount = 0;
 	mDepth = depth;
 }
 
@@ -48,13 +83,17 @@ void	ObjPointPool::resize(int pts)
 {
 	mData.resize(pts * mDepth);
 	mIndex.clear();
+	mIndexCount = 0;
 }
 
 int		ObjPointPool::accumulate(const float pt[])
 {
-	index_type::iterator iter = mIndex.find(key_type(pt, pt + mDepth));
-	if (iter != mIndex.end())
-		return iter->second;
+	if (!mIndex.empty())
+	{
+		int slot = find_slot(pt);
+		if (mIndex[slot] != -1)
+			return mIndex[slot];
+	}
 	return append(pt);
 }
 
@@ -62,14 +101,65 @@ int		ObjPointPool::append(const float pt[])
 {
 	int ret = mData.size() / mDepth;
 	mData.insert(mData.end(), pt, pt + mDepth);
-	mIndex.insert(index_type::value_type(key_type(pt,pt+mDepth), ret));
+	index_point(ret);
 	return ret;
 }
 
 void	ObjPointPool::set(int n, float pt[])
 {
 	memcpy(&mData[n*mDepth], pt, mDepth * sizeof(float));
-	mIndex.insert(index_type::value_type(key_type(pt,pt+mDepth), n));
+	index_point(n);
+}
+
+void	ObjPointPool::reindex(void)
+{
+	int n = count();
+	int slots = 64;
+	while ((n + 1) * 2 > slots)
+		slots *= 2;
+	mIndex.assign(slots, -1);
+	mIndexCount = 0;
+	for (int i = 0; i < n; ++i)
+		index_point(i);
+}
+
+int		ObjPointPool::find_slot(const float pt[]) const
+{
+	int mask = mIndex.size() - 1;
+	int slot = hash_floats(pt, mDepth) & mask;
+	while (mIndex[slot] != -1 && !equal_floats(&mData[mIndex[slot] * mDepth], pt, mDepth))
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+void	ObjPointPool::index_point(int n)
+{
+	if ((mIndexCount + 1) * 2 > (int) mIndex.size())
+		grow_index();
+	int slot = find_slot(&mData[n * mDepth]);
+	if (mIndex[slot] == -1)
+	{
+		mIndex[slot] = n;
+		++mIndexCount;
+	}
+}
+
+void	ObjPointPool::grow_index(void)
+{
+	vector<int>	old;
+	old.swap(mIndex);
+	mIndex.assign(old.empty() ? 64 : old.size() * 2, -1);
+	mIndexCount = 0;
+	for (vector<int>::iterator i = old.begin(); i != old.end(); ++i)
+	if (*i != -1)
+	{
+		int slot = find_slot(&mData[*i * mDepth]);
+		if (mIndex[slot] == -1)
+		{
+			mIndex[slot] = *i;
+			++mIndexCount;
+		}
+	}
 }
 
 int		ObjPointPool::count(void) const
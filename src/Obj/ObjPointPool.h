@@ -50,6 +50,7 @@ public:
 	int		accumulate(const float pt[]);	// Add a pt, extend if needed
 	int		append(const float pt[]);		// Add a pt to the end
 	void	set(int n, float pt[]);			// Set an existing pt
+	void	reindex(void);					// Index all pts, after filling them in bulk through get()
 
 	int		count(void) const;
 	float *	get(int index);
@@ -59,11 +60,15 @@ public:
 
 private:
 
-	typedef	vector<float>									key_type;
-	typedef map<key_type, int, lex_compare_vector<float> >	index_type;
+	// The index is an open-addressed hash table of point numbers; the key for a slot is the point's floats
+	// in mData, so there is no per-point allocation.  -1 marks an empty slot.  Size is a power of 2, at most half full.
+	int		find_slot(const float pt[]) const;	// Slot holding pt, or the empty slot where it would go
+	void	index_point(int n);					// Add point n to the index unless its value is already there
+	void	grow_index(void);
 
 	vector<float>	mData;
-	index_type		mIndex;
+	vector<int>		mIndex;
+	int				mIndexCount;
 	int				mDepth;
 
 };
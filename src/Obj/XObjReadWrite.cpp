@@ -29,6 +29,7 @@
 #include "AssertUtils.h"
 #include "MemFileUtils.h"
 #include <math.h>
+#include <string.h>
 
 #ifndef CRLF
 	#if APL
@@ -49,6 +50,268 @@ static const char * dataref_or_none(const char * d)
 	return d;
 }
 
+/****************************************************************************************
+ * OBJ 8 KEYWORD TABLE
+ ****************************************************************************************/
+
+// Every line of an OBJ8 starts with a keyword.  Rather than string-compare the line against each command the
+// reader knows in turn, we cut the keyword out once, hash it, and look it up in one table that holds both the
+// commands with their own parsing code below (kw_*) and the generic attributes in gCmds.
+
+enum {
+	kw_none = 0,
+	kw_VT,
+	kw_IDX10,
+	kw_IDX,
+	kw_TEXTURE,
+	kw_TEXTURE_LIT,
+	kw_TEXTURE_NORMAL,
+	kw_TEXTURE_DRAPED,
+	kw_POINT_COUNTS,
+	kw_VLINE,
+	kw_VLIGHT,
+	kw_TRIS,
+	kw_LINES,
+	kw_LIGHTS,
+	kw_ATTR_LOD,
+	kw_ANIM_rotate,
+	kw_ANIM_trans,
+	kw_ANIM_begin,
+	kw_ANIM_end,
+	kw_LIGHT_CUSTOM,
+	kw_LIGHT_NAMED,
+	kw_LIGHT_PARAM,
+	kw_ATTR_layer_group,
+	kw_ATTR_hard,
+	kw_ATTR_hard_deck,
+	kw_ATTR_no_blend,
+	kw_ANIM_hide,
+	kw_ANIM_show,
+	kw_ANIM_rotate_begin,
+	kw_ANIM_trans_begin,
+	kw_ANIM_rotate_key,
+	kw_ANIM_trans_key,
+	kw_ANIM_rotate_end,
+	kw_ANIM_trans_end,
+	kw_ANIM_keyframe_loop,
+	kw_COCKPIT_REGION,
+	kw_ATTR_manip_none,
+	kw_ATTR_manip_drag_xy,
+	kw_ATTR_manip_drag_axis,
+	kw_ATTR_manip_command,
+	kw_ATTR_manip_command_axis,
+	kw_ATTR_manip_noop,
+	kw_ATTR_light_level,
+	kw_ATTR_manip_push,
+	kw_ATTR_manip_radio,
+	kw_ATTR_manip_toggle,
+	kw_ATTR_manip_delta,
+	kw_ATTR_manip_wrap,
+	kw_ATTR_manip_wheel,
+	kw_ATTR_manip_drag_axis_pix,
+	kw_ATTR_manip_command_knob,
+	kw_ATTR_manip_command_switch_up_down,
+	kw_ATTR_manip_command_switch_left_right,
+	kw_ATTR_manip_axis_knob,
+	kw_ATTR_manip_axis_switch_up_down,
+	kw_ATTR_manip_axis_switch_left_right,
+	kw_PARTICLE_SYSTEM,
+	kw_EMITTER,
+	kw_ATTR_cockpit_device,
+	kw_NORMAL_METALNESS,
+	kw_BLEND_GLASS,
+	kw_ATTR_axis_detented,
+	kw_ATTR_manip_drag_rotate,
+	kw_ATTR_manip_keyframe,
+	kw_ATTR_axis_detent_range,
+	kw_ATTR_manip_command_switch_left_right2,
+	kw_ATTR_manip_command_switch_up_down2,
+	kw_ATTR_manip_command_knob2,
+	kw_MAGNET,
+	kw_LOAD_CENTER,
+	kw_fixed_heading,
+	kw_viewpoint_height,
+	kw_wed_text,
+	kw_count
+};
+
+struct obj8_keyword_t {
+	const char *	name;
+	int				kw;
+	bool			eol_ok;		// Keyword may end the line - otherwise it must be followed by an argument.
+};
+
+static const obj8_keyword_t kObj8Keywords[] = {
+	{ "VT", kw_VT, false },
+	{ "IDX10", kw_IDX10, false },
+	{ "IDX", kw_IDX, false },
+	{ "TEXTURE", kw_TEXTURE, false },
+	{ "TEXTURE_LIT", kw_TEXTURE_LIT, false },
+	{ "TEXTURE_NORMAL", kw_TEXTURE_NORMAL, false },
+	{ "TEXTURE_DRAPED", kw_TEXTURE_DRAPED, false },
+	{ "POINT_COUNTS", kw_POINT_COUNTS, false },
+	{ "VLINE", kw_VLINE, false },
+	{ "VLIGHT", kw_VLIGHT, false },
+	{ "TRIS", kw_TRIS, false },
+	{ "LINES", kw_LINES, false },
+	{ "LIGHTS", kw_LIGHTS, false },
+	{ "ATTR_LOD", kw_ATTR_LOD, false },
+	{ "ANIM_rotate", kw_ANIM_rotate, false },
+	{ "ANIM_trans", kw_ANIM_trans, false },
+	{ "ANIM_begin", kw_ANIM_begin, true },
+	{ "ANIM_end", kw_ANIM_end, true },
+	{ "LIGHT_CUSTOM", kw_LIGHT_CUSTOM, false },
+	{ "LIGHT_NAMED", kw_LIGHT_NAMED, false },
+	{ "LIGHT_PARAM", kw_LIGHT_PARAM, false },
+	{ "ATTR_layer_group", kw_ATTR_layer_group, false },
+	{ "ATTR_hard", kw_ATTR_hard, false },
+	{ "ATTR_hard_deck", kw_ATTR_hard_deck, false },
+	{ "ATTR_no_blend", kw_ATTR_no_blend, false },
+	{ "ANIM_hide", kw_ANIM_hide, false },
+	{ "ANIM_show", kw_ANIM_show, false },
+	{ "ANIM_rotate_begin", kw_ANIM_rotate_begin, false },
+	{ "ANIM_trans_begin", kw_ANIM_trans_begin, false },
+	{ "ANIM_rotate_key", kw_ANIM_rotate_key, false },
+	{ "ANIM_trans_key", kw_ANIM_trans_key, false },
+	{ "ANIM_rotate_end", kw_ANIM_rotate_end, true },
+	{ "ANIM_trans_end", kw_ANIM_trans_end, true },
+	{ "ANIM_keyframe_loop", kw_ANIM_keyframe_loop, false },
+	{ "COCKPIT_REGION", kw_COCKPIT_REGION, false },
+	{ "ATTR_manip_none", kw_ATTR_manip_none, true },
+	{ "ATTR_manip_drag_xy", kw_ATTR_manip_drag_xy, false },
+	{ "ATTR_manip_drag_axis", kw_ATTR_manip_drag_axis, false },
+	{ "ATTR_manip_command", kw_ATTR_manip_command, false },
+	{ "ATTR_manip_command_axis", kw_ATTR_manip_command_axis, false },
+	{ "ATTR_manip_noop", kw_ATTR_manip_noop, true },
+	{ "ATTR_light_level", kw_ATTR_light_level, false },
+	{ "ATTR_manip_push", kw_ATTR_manip_push, false },
+	{ "ATTR_manip_radio", kw_ATTR_manip_radio, false },
+	{ "ATTR_manip_toggle", kw_ATTR_manip_toggle, false },
+	{ "ATTR_manip_delta", kw_ATTR_manip_delta, false },
+	{ "ATTR_manip_wrap", kw_ATTR_manip_wrap, false },
+	{ "ATTR_manip_wheel", kw_ATTR_manip_wheel, false },
+	{ "ATTR_manip_drag_axis_pix", kw_ATTR_manip_drag_axis_pix, false },
+	{ "ATTR_manip_command_knob", kw_ATTR_manip_command_knob, false },
+	{ "ATTR_manip_command_switch_up_down", kw_ATTR_manip_command_switch_up_down, false },
+	{ "ATTR_manip_command_switch_left_right", kw_ATTR_manip_command_switch_left_right, false },
+	{ "ATTR_manip_axis_knob", kw_ATTR_manip_axis_knob, false },
+	{ "ATTR_manip_axis_switch_up_down", kw_ATTR_manip_axis_switch_up_down, false },
+	{ "ATTR_manip_axis_switch_left_right", kw_ATTR_manip_axis_switch_left_right, false },
+	{ "PARTICLE_SYSTEM", kw_PARTICLE_SYSTEM, false },
+	{ "EMITTER", kw_EMITTER, false },
+	{ "ATTR_cockpit_device", kw_ATTR_cockpit_device, false },
+	{ "NORMAL_METALNESS", kw_NORMAL_METALNESS, true },
+	{ "BLEND_GLASS", kw_BLEND_GLASS, true },
+	{ "ATTR_axis_detented", kw_ATTR_axis_detented, false },
+	{ "ATTR_manip_drag_rotate", kw_ATTR_manip_drag_rotate, false },
+	{ "ATTR_manip_keyframe", kw_ATTR_manip_keyframe, false },
+	{ "ATTR_axis_detent_range", kw_ATTR_axis_detent_range, false },
+	{ "ATTR_manip_command_switch_left_right2", kw_ATTR_manip_command_switch_left_right2, false },
+	{ "ATTR_manip_command_switch_up_down2", kw_ATTR_manip_command_switch_up_down2, false },
+	{ "ATTR_manip_command_knob2", kw_ATTR_manip_command_knob2, false },
+	{ "MAGNET", kw_MAGNET, false },
+	{ "LOAD_CENTER", kw_LOAD_CENTER, false },
+	{ "#fixed_heading", kw_fixed_heading, false },
+	{ "#viewpoint_height", kw_viewpoint_height, false },
+	{ "#wed_text", kw_wed_text, false },
+	{ NULL, kw_none, false }
+};
+
+class	Obj8KeywordTable {
+public:
+
+	Obj8KeywordTable()
+	{
+		memset(mSlots, 0, sizeof(mSlots));
+		for (const obj8_keyword_t * k = kObj8Keywords; k->name; ++k)
+			slot_for(k->name, strlen(k->name))->keyword = k;
+		// Like FindObjCmd, the first OBJ8 entry for a name wins.
+		for (int n = 0; gCmds[n].name; ++n)
+		if (gCmds[n].v8)
+		{
+			entry_t * e = slot_for(gCmds[n].name, strlen(gCmds[n].name));
+			if (e->cmd_idx == 0)
+				e->cmd_idx = n + 1;
+		}
+	}
+
+	// Consumes the keyword starting at s->cur (after leading blanks).  Returns the kw_ code if it is one of ours
+	// and its arguments (or end of line, if allowed) follow; otherwise returns kw_none.  Either way, out_cmd_idx is
+	// the gCmds index for the word, or gCmdCount, exactly as FindObjCmd would return.
+	int		lookup(MFScanner * s, int& out_cmd_idx) const
+	{
+		while (s->cur < s->end && (*s->cur == ' ' || *s->cur == '\t')) s->cur++;
+		const char * c1 = s->cur;
+		while (s->cur < s->end && *s->cur != ' ' && *s->cur != '\t' && *s->cur != '\n' && *s->cur != '\r') s->cur++;
+
+		out_cmd_idx = gCmdCount;
+		if (s->cur == c1)
+			return kw_none;
+
+		const entry_t * e = find(c1, s->cur - c1);
+		if (e == NULL)
+			return kw_none;
+		if (e->cmd_idx)
+			out_cmd_idx = e->cmd_idx - 1;
+		if (e->keyword)
+		{
+			bool at_eol = s->cur == s->end || *s->cur == '\n' || *s->cur == '\r';
+			if (!at_eol || e->keyword->eol_ok)
+				return e->keyword->kw;
+		}
+		return kw_none;
+	}
+
+private:
+
+	enum { kSlotCount = 512 };		// Power of 2, comfortably more than twice the keyword + gCmds count.
+
+	struct entry_t {
+		const char *			name;
+		int						len;
+		const obj8_keyword_t *	keyword;
+		int						cmd_idx;	// gCmds index + 1, 0 if none
+	};
+
+	static unsigned int	hash(const char * p, int len)
+	{
+		unsigned int h = 2166136261u;
+		while (len--)
+			h = (h ^ (unsigned char) *p++) * 16777619u;
+		return h ^ (h >> 16);
+	}
+
+	const entry_t *	find(const char * p, int len) const
+	{
+		int i = hash(p, len) & (kSlotCount - 1);
+		while (mSlots[i].name)
+		{
+			if (mSlots[i].len == len && memcmp(mSlots[i].name, p, len) == 0)
+				return &mSlots[i];
+			i = (i + 1) & (kSlotCount - 1);
+		}
+		return NULL;
+	}
+
+	entry_t *		slot_for(const char * p, int len)
+	{
+		int i = hash(p, len) & (kSlotCount - 1);
+		while (mSlots[i].name && !(mSlots[i].len == len && memcmp(mSlots[i].name, p, len) == 0))
+			i = (i + 1) & (kSlotCount - 1);
+		mSlots[i].name = p;
+		mSlots[i].len = len;
+		return &mSlots[i];
+	}
+
+	entry_t		mSlots[kSlotCount];
+};
+
+static int	obj8_keyword(MFScanner * s, int& out_cmd_idx)
+{
+	static const Obj8KeywordTable	table;
+	return table.lookup(s, out_cmd_idx);
+}
+
 /****************************************************************************************
  * OBJ 8 READ
  ****************************************************************************************/
@@ -103,8 +366,10 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 	while (!MFS_done(&s))
 	{
 		bool ate_eoln = false;
+		int cmd_idx;
+		int kw = obj8_keyword(&s, cmd_idx);
 		// VT <x> <y> <z> <nx> <ny> <nz> <s> <t>
-		if (MFS_string_match(&s, "VT", false))
+		if (kw == kw_VT)
 		{
 			if (tricount >= trimax) { tricount++; break; }
 			for (int i = 0; i < 8; ++i)
@@ -112,7 +377,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.geo_tri.set(tricount++, stdat);
 		}
 		// IDX10 <n> x 10
-		else if (MFS_string_match(&s, "IDX10", false))
+		else if (kw == kw_IDX10)
 		{
 			if (idxcount + 9 >= idxmax)
 			{
@@ -132,7 +397,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			}
 		}
 		// IDX <n>
-		else if (MFS_string_match(&s, "IDX", false))
+		else if (kw == kw_IDX)
 		{
 			if (idxcount >= idxmax)
 			{
@@ -148,23 +413,23 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 				outObj.indices[idxcount++] = 0;
 			}
 		}
-		else if (MFS_string_match(&s, "TEXTURE", false))
+		else if (kw == kw_TEXTURE)
 		{
 			MFS_string(&s, &outObj.texture);
 		}
-		else if (MFS_string_match(&s, "TEXTURE_LIT", false))
+		else if (kw == kw_TEXTURE_LIT)
 		{
 			MFS_string(&s, &outObj.texture_lit);
 		}
-		else if (MFS_string_match(&s, "TEXTURE_NORMAL", false))
+		else if (kw == kw_TEXTURE_NORMAL)
 		{
 			MFS_string(&s, &outObj.texture_normal_map);
 		}
-		else if (MFS_string_match(&s, "TEXTURE_DRAPED", false))
+		else if (kw == kw_TEXTURE_DRAPED)
 		{
 			MFS_string(&s, &outObj.texture_draped);
 		}
-		else if (MFS_string_match(&s, "POINT_COUNTS", false))
+		else if (kw == kw_POINT_COUNTS)
 		{
 			if(trimax || linemax || lightmax || idxmax)
 				LOG_MSG("E/Obj more than one POINT_COUNTS line in %s\n",inFile);
@@ -181,7 +446,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.geo_lights.resize(lightmax);
 		}
 		// VLINE <x> <y> <z> <r> <g> <b>
-		else if (MFS_string_match(&s, "VLINE", false))
+		else if (kw == kw_VLINE)
 		{
 			if (linecount >= linemax) { linecount++; break; }
 			for (int i = 0; i < 6; ++i)
@@ -189,7 +454,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.geo_lines.set(linecount++, stdat);
 		}
 		// VLIGHT <x> <y> <z> <r> <g> <b>
-		else if (MFS_string_match(&s, "VLIGHT", false))
+		else if (kw == kw_VLIGHT)
 		{
 			if (lightcount >= lightmax) { lightcount++; break; }
 			for (int i = 0; i < 6; ++i)
@@ -197,7 +462,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.geo_lights.set(lightcount++, stdat);
 		}
 		// TRIS offset count
-		else if (MFS_string_match(&s, "TRIS", false))
+		else if (kw == kw_TRIS)
 		{
 			cmd.cmd = obj8_Tris;
 			cmd.idx_offset = MFS_int(&s);
@@ -205,7 +470,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// LINES offset count
-		else if (MFS_string_match(&s, "LINES", false))
+		else if (kw == kw_LINES)
 		{
 			cmd.cmd = obj8_Lines;
 			cmd.idx_offset = MFS_int(&s);
@@ -213,7 +478,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// LIGHTS offset count
-		else if (MFS_string_match(&s, "LIGHTS", false))
+		else if (kw == kw_LIGHTS)
 		{
 			cmd.cmd = obj8_Lights;
 			cmd.idx_offset = MFS_int(&s);
@@ -221,14 +486,14 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// ATTR_LOD near far
-		else if (MFS_string_match(&s, "ATTR_LOD", false))
+		else if (kw == kw_ATTR_LOD)
 		{
 			if (outObj.lods.back().lod_far != 0)	outObj.lods.push_back(XObjLOD8());
 			outObj.lods.back().lod_near = MFS_double(&s);
 			outObj.lods.back().lod_far = MFS_double(&s);
 		}
 		// ANIM_rotate x y z r1 r2 v1 v2 dref
-		else if (MFS_string_match(&s, "ANIM_rotate", false))
+		else if (kw == kw_ANIM_rotate)
 		{
 			animation.keyframes.clear();
 			animation.cmd = anim_Rotate;
@@ -250,7 +515,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.animation.push_back(animation);
 		}
 		// ANIM_trans x1 y1 z1 x2 y2 z2 v1 v2 dref
-		else if (MFS_string_match(&s, "ANIM_trans", false))
+		else if (kw == kw_ANIM_trans)
 		{
 			animation.keyframes.clear();
 			animation.cmd = anim_Translate;
@@ -273,14 +538,14 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.animation.push_back(animation);
 		}
 		// ANIM_begin
-		else if (MFS_string_match(&s, "ANIM_begin", true))
+		else if (kw == kw_ANIM_begin)
 		{
 			anims++;
 			cmd.cmd = anim_Begin;
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// ANIM_end
-		else if (MFS_string_match(&s, "ANIM_end", true))
+		else if (kw == kw_ANIM_end)
 		{
 			anims--;
 			cmd.cmd = anim_End;
@@ -288,7 +553,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 		}
 /******************************************************************************************************************************/
 		// LIGHT_CUSTOM <x> <y> <z> <r> <g> <b> <a> <s><s1> <t1> <s2> <t2> <dataref>
-		else if (MFS_string_match(&s, "LIGHT_CUSTOM", false))
+		else if (kw == kw_LIGHT_CUSTOM)
 		{
 			cmd.cmd = obj8_LightCustom;
 			for (int n = 0; n < 12; ++n)
@@ -297,7 +562,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// LIGHT_NAMED <name> <x> <y> <z>
-		else if (MFS_string_match(&s, "LIGHT_NAMED", false))
+		else if (kw == kw_LIGHT_NAMED)
 		{
 			cmd.cmd = obj8_LightNamed;
 			MFS_string(&s, &cmd.name);
@@ -307,7 +572,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);			
 		}
 		// LIGHT_PARAM <name> <x> <y> <z>
-		else if (MFS_string_match(&s, "LIGHT_PARAM", false))
+		else if (kw == kw_LIGHT_PARAM)
 		{
 			cmd.cmd = obj8_LightNamed;
 			MFS_string(&s, &cmd.name);
@@ -325,7 +590,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);			
 		}
 		// ATTR_layer_group <group name> <offset>
-		else if (MFS_string_match(&s, "ATTR_layer_group", false))
+		else if (kw == kw_ATTR_layer_group)
 		{
 			cmd.cmd = attr_Layer_Group;
 			MFS_string(&s, &cmd.name);
@@ -333,7 +598,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// ATTR_hard [<type>]
-		else if (MFS_string_match(&s, "ATTR_hard", false))
+		else if (kw == kw_ATTR_hard)
 		{
 			cmd.cmd = attr_Hard;
 			MFS_string(&s, &cmd.name);
@@ -341,7 +606,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// ATTR_hard_deck [<type>]
-		else if (MFS_string_match(&s, "ATTR_hard_deck", false))
+		else if (kw == kw_ATTR_hard_deck)
 		{
 			cmd.cmd = attr_Hard_Deck;
 			MFS_string(&s, &cmd.name);
@@ -349,7 +614,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// ATTR_no_blend <level>
-		else if (MFS_string_match(&s, "ATTR_no_blend", false))
+		else if (kw == kw_ATTR_no_blend)
 		{
 			cmd.cmd = attr_No_Blend;
 			cmd.params[0] = MFS_double(&s);
@@ -357,7 +622,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// ANIM_hide <v1> <v2> <dataref>
-		else if (MFS_string_match(&s, "ANIM_hide", false))
+		else if (kw == kw_ANIM_hide)
 		{
 			animation.keyframes.clear();
 			animation.cmd = anim_Hide;
@@ -374,7 +639,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.animation.push_back(animation);
 		}
 		// ANIM_show <v1> <v2> <dataref>
-		else if (MFS_string_match(&s, "ANIM_show", false))
+		else if (kw == kw_ANIM_show)
 		{
 			animation.keyframes.clear();
 			animation.cmd = anim_Show;
@@ -392,7 +657,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 		}
 /******************************************************************************************************************************/
 		// ANIM_rotate_begin x y z dref
-		else if (MFS_string_match(&s, "ANIM_rotate_begin", false))
+		else if (kw == kw_ANIM_rotate_begin)
 		{
 			animation.keyframes.clear();
 			animation.cmd = anim_Rotate;
@@ -408,7 +673,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.animation.push_back(animation);
 		}
 		// ANIM_trans_begin dref
-		else if (MFS_string_match(&s, "ANIM_trans_begin", false))
+		else if (kw == kw_ANIM_trans_begin)
 		{
 			animation.keyframes.clear();
 			animation.cmd = anim_Translate;
@@ -421,14 +686,14 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.animation.push_back(animation);
 		}
 		// ANIM_rotate_key v r
-		else if (MFS_string_match(&s, "ANIM_rotate_key", false))
+		else if (kw == kw_ANIM_rotate_key)
 		{
 			outObj.animation.back().keyframes.push_back(XObjKey());
 			outObj.animation.back().keyframes.back().key = MFS_double(&s);
 			outObj.animation.back().keyframes.back().v[0] = MFS_double(&s);
 		}
 		// ANIM_trans_key v x y z
-		else if (MFS_string_match(&s, "ANIM_trans_key", false))
+		else if (kw == kw_ANIM_trans_key)
 		{
 			outObj.animation.back().keyframes.push_back(XObjKey());
 			outObj.animation.back().keyframes.back().key = MFS_double(&s);
@@ -437,22 +702,22 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.animation.back().keyframes.back().v[2] = MFS_double(&s);
 		}
 		// ANIM_rotate_end
-		else if (MFS_string_match(&s, "ANIM_rotate_end", true))
+		else if (kw == kw_ANIM_rotate_end)
 		{
 		}
 		// ANIM_trans_end
-		else if (MFS_string_match(&s, "ANIM_trans_end", true))
+		else if (kw == kw_ANIM_trans_end)
 		{
 		}
 		// ANIM_keyframe_loop <loop>
-		else if (MFS_string_match(&s, "ANIM_keyframe_loop", false))
+		else if (kw == kw_ANIM_keyframe_loop)
 		{
 			outObj.animation.back().loop = MFS_double(&s);
 		}
 /******************************************************************************************************************************/
 		// COCKPIT_REGION
 /******************************************************************************************************************************/
-		else if (MFS_string_match(&s, "COCKPIT_REGION", false))
+		else if (kw == kw_COCKPIT_REGION)
 		{
 			outObj.regions.push_back(XObjPanelRegion8());
 			outObj.regions.back().left   = MFS_int(&s);
@@ -464,13 +729,13 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 		// MANIPS (920)
 /******************************************************************************************************************************/
 		// ATTR_manip_none
-		else if (MFS_string_match(&s, "ATTR_manip_none", true))
+		else if (kw == kw_ATTR_manip_none)
 		{
 			cmd.cmd = attr_Manip_None;
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// ATTR_manip_drag_xy <cursor> <dx> <dy> <v1min> <v1max> <v2min> <v2max> <dref1> <dref> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_drag_xy", false))
+		else if (kw == kw_ATTR_manip_drag_xy)
 		{
 			cmd.cmd = attr_Manip_Drag_2d;
 			cmd.idx_offset = outObj.manips.size();
@@ -491,7 +756,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_drag_axis <cursor> <dx> <dy> <dz> <v1> <v2> <dataref> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_drag_axis", false))
+		else if (kw == kw_ATTR_manip_drag_axis)
 		{
 			cmd.cmd = attr_Manip_Drag_Axis;
 			cmd.idx_offset = outObj.manips.size();
@@ -510,7 +775,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_command <currsor> <cmnd> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_command", false))
+		else if (kw == kw_ATTR_manip_command)
 		{
 			cmd.cmd = attr_Manip_Command;
 			cmd.idx_offset = outObj.manips.size();
@@ -524,7 +789,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_command_axis <cursor> <dx> <dy> <dz> <positive cmnd> <negative cmnd> <tool tip>
-		else if (MFS_string_match(&s, "ATTR_manip_command_axis", false))
+		else if (kw == kw_ATTR_manip_command_axis)
 		{
 			cmd.cmd = attr_Manip_Command_Axis;
 			cmd.idx_offset = outObj.manips.size();
@@ -542,7 +807,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_noop
-		else if (MFS_string_match(&s, "ATTR_manip_noop", true))
+		else if (kw == kw_ATTR_manip_noop)
 		{
 			cmd.cmd = attr_Manip_Noop;
 			cmd.idx_offset = outObj.manips.size();
@@ -557,7 +822,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 /******************************************************************************************************************************/
 		// LIGHT LEVEL (930)
 /******************************************************************************************************************************/
-		else if (MFS_string_match(&s, "ATTR_light_level", false))
+		else if (kw == kw_ATTR_light_level)
 		{
 			cmd.cmd = attr_Light_Level;
 			cmd.params[0] = MFS_double(&s);
@@ -566,7 +831,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.lods.back().cmds.push_back(cmd);
 		}
 		// ATTR_manip_push <cursor> <v1max> <v1min> <dref1> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_push", false))
+		else if (kw == kw_ATTR_manip_push)
 		{
 			cmd.cmd = attr_Manip_Push;
 			cmd.idx_offset = outObj.manips.size();
@@ -582,7 +847,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_radio <cursor> <v1max> <dref1> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_radio", false))
+		else if (kw == kw_ATTR_manip_radio)
 		{
 			cmd.cmd = attr_Manip_Radio;
 			cmd.idx_offset = outObj.manips.size();
@@ -597,7 +862,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_toggle <cursor> <v1max> <v1min> <dref1> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_toggle", false))
+		else if (kw == kw_ATTR_manip_toggle)
 		{
 			cmd.cmd = attr_Manip_Toggle;
 			cmd.idx_offset = outObj.manips.size();
@@ -614,7 +879,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 		}
 
 		// ATTR_manip_delta <cursor> <v1max> <v1min> <dref1> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_delta", false))
+		else if (kw == kw_ATTR_manip_delta)
 		{
 			cmd.cmd = attr_Manip_Delta;
 			cmd.idx_offset = outObj.manips.size();
@@ -632,7 +897,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_wrap <cursor> <v1max> <v1min> <dref1> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_wrap", false))
+		else if (kw == kw_ATTR_manip_wrap)
 		{
 			cmd.cmd = attr_Manip_Wrap;
 			cmd.idx_offset = outObj.manips.size();
@@ -652,13 +917,13 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 /******************************************************************************************************************************/
 		// NEW MANIPS (1050)
 /******************************************************************************************************************************/
-		else if (MFS_string_match(&s, "ATTR_manip_wheel", false))
+		else if (kw == kw_ATTR_manip_wheel)
 		{
 			if(!outObj.manips.empty())
 				outObj.manips.back().mouse_wheel_delta = MFS_double(&s);
 		}
 		// ATTR_manip_drag_axis_pix <cursor> <dx_pix> <step> <exp> <v1> <v2> <dataref> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_drag_axis_pix", false))
+		else if (kw == kw_ATTR_manip_drag_axis_pix)
 		{
 			cmd.cmd = attr_Manip_Drag_Axis_Pix;;
 			cmd.idx_offset = outObj.manips.size();
@@ -677,7 +942,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_command_knob <cursor> <positive cmnd> <negative cmnd> <tool tip>
-		else if (MFS_string_match(&s, "ATTR_manip_command_knob", false))
+		else if (kw == kw_ATTR_manip_command_knob)
 		{
 			cmd.cmd = attr_Manip_Command_Knob;
 			cmd.idx_offset = outObj.manips.size();
@@ -692,7 +957,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_command_switch_up_down <cursor> <positive cmnd> <negative cmnd> <tool tip>
-		else if (MFS_string_match(&s, "ATTR_manip_command_switch_up_down", false))
+		else if (kw == kw_ATTR_manip_command_switch_up_down)
 		{
 			cmd.cmd = attr_Manip_Command_Switch_Up_Down;
 			cmd.idx_offset = outObj.manips.size();
@@ -707,7 +972,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_command_switch_left_right <cursor> <positive cmnd> <negative cmnd> <tool tip>
-		else if (MFS_string_match(&s, "ATTR_manip_command_switch_left_right", false))
+		else if (kw == kw_ATTR_manip_command_switch_left_right)
 		{
 			cmd.cmd = attr_Manip_Command_Switch_Left_Right;
 			cmd.idx_offset = outObj.manips.size();
@@ -723,7 +988,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 		}
 
 		// ATTR_manip_axis_switch_left_right <cursor>  <v1> <v2> <click step> <hold step> <dref> <tool tip>
-		else if (MFS_string_match(&s, "ATTR_manip_axis_knob", false))
+		else if (kw == kw_ATTR_manip_axis_knob)
 		{
 			cmd.cmd = attr_Manip_Axis_Knob;
 			cmd.idx_offset = outObj.manips.size();
@@ -743,7 +1008,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_axis_switch_up_down <cursor>  <v1> <v2> <click step> <hold step> <dref> <tool tip>
-		else if (MFS_string_match(&s, "ATTR_manip_axis_switch_up_down", false))
+		else if (kw == kw_ATTR_manip_axis_switch_up_down)
 		{
 			cmd.cmd = attr_Manip_Axis_Switch_Up_Down;
 			cmd.idx_offset = outObj.manips.size();
@@ -763,7 +1028,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_axis_switch_left_right <cursor>  <v1> <v2> <click step> <hold step> <dref> <tool tip>
-		else if (MFS_string_match(&s, "ATTR_manip_axis_switch_left_right", false))
+		else if (kw == kw_ATTR_manip_axis_switch_left_right)
 		{
 			cmd.cmd = attr_Manip_Axis_Switch_Left_Right;
 			cmd.idx_offset = outObj.manips.size();
@@ -786,12 +1051,12 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 		// PARTICLE SYSTEM
 /******************************************************************************************************************************/
 		// PARTICLE_SYSTEM <def name>
-		else if (MFS_string_match(&s, "PARTICLE_SYSTEM", false))
+		else if (kw == kw_PARTICLE_SYSTEM)
 		{
 			MFS_string(&s, &outObj.particle_system);
 		}
 		// EMITTER name x y z psi the phi low high dref
-		else if (MFS_string_match(&s, "EMITTER", false))
+		else if (kw == kw_EMITTER)
 		{
 			cmd.cmd = attr_Emitter;
 			cmd.idx_offset = outObj.emitters.size();
@@ -817,7 +1082,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 		// V11 NEW STUFF
 /******************************************************************************************************************************/
 		// ATTR_cockpit_device <device> <bus> <rheostat> <auto_adjust>
-		else if (MFS_string_match(&s, "ATTR_cockpit_device", false))
+		else if (kw == kw_ATTR_cockpit_device)
 		{
 			cmd.cmd = attr_Cockpit_Device;
 			MFS_string(&s, &cmd.name);
@@ -826,16 +1091,16 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			cmd.params[2] = MFS_double(&s);
 			outObj.lods.back().cmds.push_back(cmd);
 		}
-		else if (MFS_string_match(&s, "NORMAL_METALNESS", true))
+		else if (kw == kw_NORMAL_METALNESS)
 		{
 			outObj.use_metalness = 1;
 		}
-		else if (MFS_string_match(&s, "BLEND_GLASS", true))
+		else if (kw == kw_BLEND_GLASS)
 		{
 			outObj.glass_blending = 1;
 		}
 		// ATTR_axis_detented <dx> <dy> <dz> <v1_min> <v1_max> <dref>
-		else if (MFS_string_match(&s, "ATTR_axis_detented", false))
+		else if (kw == kw_ATTR_axis_detented)
 		{
 			XObjManip8& manip(outObj.manips.back());
 			
@@ -848,7 +1113,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			MFS_string(&s, &manip.dataref2);
 		}
 		// ATTR_manip_drag_rotate <cursor> <x> <y> <z> <dx> <dy> <dz> <ange1> <angle2> <lift> <v1min> <v1max> <v2min> <v2max> <dataref1> <dataref2> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_drag_rotate", false))
+		else if (kw == kw_ATTR_manip_drag_rotate)
 		{
 			cmd.cmd = attr_Manip_Drag_Rotate;
 			cmd.idx_offset = outObj.manips.size();
@@ -878,7 +1143,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_keyframe dref angle
-		else if (MFS_string_match(&s, "ATTR_manip_keyframe", false))
+		else if (kw == kw_ATTR_manip_keyframe)
 		{
 			XObjKey k;
 			k.key  = MFS_double(&s);
@@ -886,7 +1151,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.back().rotation_key_frames.push_back(k);
 		}
 		// ATTR_axis_detent_range <lo> <hi> <height>
-		else if (MFS_string_match(&s, "ATTR_axis_detent_range", false))
+		else if (kw == kw_ATTR_axis_detent_range)
 		{
 			XObjDetentRange d;
 			d.lo = MFS_double(&s);
@@ -895,7 +1160,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.back().detents.push_back(d);
 		}
 		// ATTR_manip_command_switch_left_right2 <currsor> <cmnd> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_command_switch_left_right2", false))
+		else if (kw == kw_ATTR_manip_command_switch_left_right2)
 		{
 			cmd.cmd = attr_Manip_Command_Switch_Left_Right2;
 			cmd.idx_offset = outObj.manips.size();
@@ -910,7 +1175,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_command_switch_up_down2 <cursor> <cmnd> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_command_switch_up_down2", false))
+		else if (kw == kw_ATTR_manip_command_switch_up_down2)
 		{
 			cmd.cmd = attr_Manip_Command_Switch_Up_Down2;
 			cmd.idx_offset = outObj.manips.size();
@@ -925,7 +1190,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.manips.push_back(manip);
 		}
 		// ATTR_manip_command_knob2 <currsor> <cmnd> <tooltip>
-		else if (MFS_string_match(&s, "ATTR_manip_command_knob2", false))
+		else if (kw == kw_ATTR_manip_command_knob2)
 		{
 			cmd.cmd = attr_Manip_Command_Knob2;
 			cmd.idx_offset = outObj.manips.size();
@@ -939,7 +1204,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			ate_eoln=true;
 			outObj.manips.push_back(manip);
 		}
-		else if (MFS_string_match(&s, "MAGNET", false))
+		else if (kw == kw_MAGNET)
 		{
 			cmd.cmd = attr_Magnet;
 			// SKIP magnet name - we always write 'magnet'
@@ -952,7 +1217,7 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 
 			outObj.lods.back().cmds.push_back(cmd);
 		}
-		else if (MFS_string_match(&s, "LOAD_CENTER", false))
+		else if (kw == kw_LOAD_CENTER)
 		{
 			outObj.loadCenter_latlon[0] = MFS_double(&s);
 			outObj.loadCenter_latlon[1] = MFS_double(&s);
@@ -960,15 +1225,15 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 			outObj.loadCenter_texSize = MFS_double(&s);
 			outObj.fixed_heading = 0.0;
 		}
-		else if (MFS_string_match(&s, "#fixed_heading", false))
+		else if (kw == kw_fixed_heading)
 		{
 			outObj.fixed_heading = MFS_double(&s);
 		}
-		else if (MFS_string_match(&s, "#viewpoint_height", false))
+		else if (kw == kw_viewpoint_height)
 		{
 			outObj.viewpoint_height = MFS_double(&s);
 		}
-		else if (MFS_string_match(&s, "#wed_text", false))
+		else if (kw == kw_wed_text)
 		{
 			MFS_string_eol(&s, &outObj.description);
 			ate_eoln=true;
@@ -980,9 +1245,6 @@ bool	XObj8Read(const char * inFile, XObj8& outObj)
 		else
 		// Common attribute handling:
 		{
-			string	attr_name;
-			MFS_string(&s, &attr_name);
-			int cmd_idx = FindObjCmd(attr_name.c_str(), true);
 			if (cmd_idx != gCmdCount)
 			{
 				cmd.cmd = gCmds[cmd_idx].cmd_id;
@@ -1541,3 +1803,244 @@ bool	XObj8Write(const char * inFile, const XObj8& outObj, const char * comment)
 	return true;
 }
 
+
+/****************************************************************************************
+ * OBJ 8 BINARY IMAGE
+ ****************************************************************************************/
+
+// A straight dump of the parsed XObj8 in native byte order - for caches on this machine, not for exchange.
+// Bump kXObj8BinaryVersion whenever XObj8 or the layout below changes; readers refuse other versions.
+const int kXObj8BinaryVersion = 1;
+
+struct	obj8_bin_writer {
+	vector<char>&	buf;
+	obj8_bin_writer(vector<char>& b) : buf(b) { }
+
+	void	raw(const void * p, size_t len)	{ buf.insert(buf.end(), (const char *) p, (const char *) p + len); }
+	template <class T>
+	void	pod(const T& v)					{ raw(&v, sizeof(v)); }
+	void	str(const string& s)			{ pod((int) s.size()); raw(s.data(), s.size()); }
+	template <class T>
+	void	pods(const vector<T>& v)		{ pod((int) v.size()); if (!v.empty()) raw(&v[0], v.size() * sizeof(T)); }
+	void	pool(const ObjPointPool& p, int depth)
+	{
+		pod(p.count());
+		if (p.count())
+			raw(p.get(0), p.count() * depth * sizeof(float));
+	}
+};
+
+struct	obj8_bin_reader {
+	const char *	cur;
+	const char *	end;
+	bool			ok;
+	obj8_bin_reader(const char * b, const char * e) : cur(b), end(e), ok(true) { }
+
+	void	raw(void * p, size_t len)
+	{
+		if (!ok || (size_t) (end - cur) < len) { ok = false; return; }
+		memcpy(p, cur, len);
+		cur += len;
+	}
+	template <class T>
+	void	pod(T& v)						{ raw(&v, sizeof(v)); }
+	int		count(size_t elem_size)
+	{
+		int n = 0;
+		pod(n);
+		if (n < 0 || (size_t) (end - cur) < n * elem_size) { ok = false; return 0; }
+		return n;
+	}
+	void	str(string& s)					{ int n = count(1); s.assign(cur, n); cur += n; }
+	template <class T>
+	void	pods(vector<T>& v)				{ int n = count(sizeof(T)); v.resize(n); if (n) raw(&v[0], n * sizeof(T)); }
+	void	pool(ObjPointPool& p, int depth)
+	{
+		int n = count(depth * sizeof(float));
+		p.clear(depth);
+		if (n)
+		{
+			p.resize(n);
+			raw(p.get(0), n * depth * sizeof(float));
+			p.reindex();			// so accumulate() shares points with the loaded ones, as after a text read
+		}
+	}
+};
+
+void	XObj8WriteBinary(const XObj8& inObj, vector<char>& outBuf)
+{
+	obj8_bin_writer	w(outBuf);
+
+	w.pod(kXObj8BinaryVersion);
+	w.str(inObj.texture);
+	w.str(inObj.texture_normal_map);
+	w.str(inObj.texture_lit);
+	w.str(inObj.decal_lib);
+	w.str(inObj.texture_draped);
+	w.pod(inObj.use_metalness);
+	w.pod(inObj.glass_blending);
+	w.str(inObj.particle_system);
+	w.pods(inObj.regions);
+	w.pods(inObj.indices);
+	w.pool(inObj.geo_tri, 8);
+	w.pool(inObj.geo_lines, 6);
+	w.pool(inObj.geo_lights, 6);
+
+	w.pod((int) inObj.animation.size());
+	for (vector<XObjAnim8>::const_iterator a = inObj.animation.begin(); a != inObj.animation.end(); ++a)
+	{
+		w.pod(a->cmd);
+		w.str(a->dataref);
+		w.pod(a->axis);
+		w.pod(a->loop);
+		w.pods(a->keyframes);
+	}
+
+	w.pod((int) inObj.manips.size());
+	for (vector<XObjManip8>::const_iterator m = inObj.manips.begin(); m != inObj.manips.end(); ++m)
+	{
+		w.str(m->dataref1);
+		w.str(m->dataref2);
+		w.pod(m->centroid);
+		w.pod(m->axis);
+		w.pod(m->angle_min);
+		w.pod(m->angle_max);
+		w.pod(m->lift);
+		w.pod(m->v1_min);	w.pod(m->v1_max);
+		w.pod(m->v2_min);	w.pod(m->v2_max);
+		w.str(m->cursor);
+		w.str(m->tooltip);
+		w.pod(m->mouse_wheel_delta);
+		w.pods(m->rotation_key_frames);
+		w.pods(m->detents);
+	}
+
+	w.pod((int) inObj.emitters.size());
+	for (vector<XObjEmitter8>::const_iterator e = inObj.emitters.begin(); e != inObj.emitters.end(); ++e)
+	{
+		w.str(e->name);
+		w.str(e->dataref);
+		w.pod(e->x);	w.pod(e->y);	w.pod(e->z);
+		w.pod(e->psi);	w.pod(e->the);	w.pod(e->phi);
+		w.pod(e->v_min);	w.pod(e->v_max);
+	}
+
+	w.pod((int) inObj.lods.size());
+	for (vector<XObjLOD8>::const_iterator l = inObj.lods.begin(); l != inObj.lods.end(); ++l)
+	{
+		w.pod(l->lod_near);
+		w.pod(l->lod_far);
+		w.pod((int) l->cmds.size());
+		for (vector<XObjCmd8>::const_iterator c = l->cmds.begin(); c != l->cmds.end(); ++c)
+		{
+			w.pod(c->cmd);
+			w.pod(c->params);
+			w.str(c->name);
+			w.pod(c->idx_offset);
+			w.pod(c->idx_count);
+		}
+	}
+
+	w.pod(inObj.xyz_min);
+	w.pod(inObj.xyz_max);
+	w.pod(inObj.loadCenter_latlon);
+	w.pod(inObj.loadCenter_texSize);
+	w.pod(inObj.loadCenter_size);
+	w.pod(inObj.fixed_heading);
+	w.pod(inObj.viewpoint_height);
+	w.str(inObj.description);
+}
+
+bool	XObj8ReadBinary(const char * inBegin, const char * inEnd, XObj8& outObj)
+{
+	obj8_bin_reader r(inBegin, inEnd);
+	int vers = 0, n;
+
+	r.pod(vers);
+	if (!r.ok || vers != kXObj8BinaryVersion)
+		return false;
+
+	r.str(outObj.texture);
+	r.str(outObj.texture_normal_map);
+	r.str(outObj.texture_lit);
+	r.str(outObj.decal_lib);
+	r.str(outObj.texture_draped);
+	r.pod(outObj.use_metalness);
+	r.pod(outObj.glass_blending);
+	r.str(outObj.particle_system);
+	r.pods(outObj.regions);
+	r.pods(outObj.indices);
+	r.pool(outObj.geo_tri, 8);
+	r.pool(outObj.geo_lines, 6);
+	r.pool(outObj.geo_lights, 6);
+
+	n = r.count(1);
+	outObj.animation.resize(n);
+	for (vector<XObjAnim8>::iterator a = outObj.animation.begin(); r.ok && a != outObj.animation.end(); ++a)
+	{
+		r.pod(a->cmd);
+		r.str(a->dataref);
+		r.pod(a->axis);
+		r.pod(a->loop);
+		r.pods(a->keyframes);
+	}
+
+	n = r.count(1);
+	outObj.manips.resize(n);
+	for (vector<XObjManip8>::iterator m = outObj.manips.begin(); r.ok && m != outObj.manips.end(); ++m)
+	{
+		r.str(m->dataref1);
+		r.str(m->dataref2);
+		r.pod(m->centroid);
+		r.pod(m->axis);
+		r.pod(m->angle_min);
+		r.pod(m->angle_max);
+		r.pod(m->lift);
+		r.pod(m->v1_min);	r.pod(m->v1_max);
+		r.pod(m->v2_min);	r.pod(m->v2_max);
+		r.str(m->cursor);
+		r.str(m->tooltip);
+		r.pod(m->mouse_wheel_delta);
+		r.pods(m->rotation_key_frames);
+		r.pods(m->detents);
+	}
+
+	n = r.count(1);
+	outObj.emitters.resize(n);
+	for (vector<XObjEmitter8>::iterator e = outObj.emitters.begin(); r.ok && e != outObj.emitters.end(); ++e)
+	{
+		r.str(e->name);
+		r.str(e->dataref);
+		r.pod(e->x);	r.pod(e->y);	r.pod(e->z);
+		r.pod(e->psi);	r.pod(e->the);	r.pod(e->phi);
+		r.pod(e->v_min);	r.pod(e->v_max);
+	}
+
+	n = r.count(1);
+	outObj.lods.resize(n);
+	for (vector<XObjLOD8>::iterator l = outObj.lods.begin(); r.ok && l != outObj.lods.end(); ++l)
+	{
+		r.pod(l->lod_near);
+		r.pod(l->lod_far);
+		l->cmds.resize(r.count(1));
+		for (vector<XObjCmd8>::iterator c = l->cmds.begin(); r.ok && c != l->cmds.end(); ++c)
+		{
+			r.pod(c->cmd);
+			r.pod(c->params);
+			r.str(c->name);
+			r.pod(c->idx_offset);
+			r.pod(c->idx_count);
+		}
+	}
+
+	r.pod(outObj.xyz_min);
+	r.pod(outObj.xyz_max);
+	r.pod(outObj.loadCenter_latlon);
+	r.pod(outObj.loadCenter_texSize);
+	r.pod(outObj.loadCenter_size);
+	r.pod(outObj.fixed_heading);
+	r.pod(outObj.viewpoint_height);
+	r.str(outObj.description);
+
+	return r.ok && r.cur == r.end;
+}
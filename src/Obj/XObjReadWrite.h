@@ -30,4 +30,9 @@ bool	XObj8Read(const char * inFile, XObj8& outObj);
 // hasnt been updated since XP 10.00 - missing all newer OBJ commands !!!!
 bool	XObj8Write(const char * inFile, const XObj8& outObj, const char * comment = nullptr);
 
+// Binary image of a parsed XObj8 - native byte order, versioned, meant for on-disk caches of parsed objects.
+// ReadBinary returns false (leaving the obj partially filled) if the image is from another version or truncated.
+void	XObj8WriteBinary(const XObj8& inObj, vector<char>& outBuf);
+bool	XObj8ReadBinary(const char * inBegin, const char * inEnd, XObj8& outObj);
+
 #endif
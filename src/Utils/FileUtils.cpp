@@ -30,6 +30,7 @@
 #if LIN || APL
 #include <dirent.h>
 #include <sys/stat.h>
+#include <utime.h>
 #endif
 
 #include "zip.h"
@@ -37,6 +38,7 @@
 #if IBM
 #include "GUI_Unicode.h"
 #include <io.h>
+#include <sys/utime.h>
 
 char * mkdtemp(char *dirname)
 {
@@ -345,6 +347,65 @@ int FILE_rename_file(const char * old_name, const char * new_name)
 	return 0;
 }
 
+int FILE_replace_file(const char * old_name, const char * new_name)
+{
+#if IBM
+	if(!MoveFileExW(convert_str_to_utf16(old_name).c_str(), convert_str_to_utf16(new_name).c_str(),
+			MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) return GetLastError();
+#endif
+#if LIN || APL
+	if(rename(old_name,new_name)<0)	return errno;
+#endif
+	return 0;
+}
+
+int FILE_touch_file(const char * path)
+{
+#if IBM
+	if(_wutime(convert_str_to_utf16(path).c_str(), NULL) != 0) return errno;
+#endif
+#if LIN || APL
+	if(utime(path, NULL) != 0) return errno;
+#endif
+	return 0;
+}
+
+int FILE_copy_file(const char * src, const char * dst)
+{
+#if IBM
+	if(!CopyFileW(convert_str_to_utf16(src).c_str(), convert_str_to_utf16(dst).c_str(), FALSE)) return GetLastError();
+	return 0;
+#endif
+#if LIN || APL
+	FILE * in = fopen(src, "rb");
+	if(!in) return errno;
+	FILE * out = fopen(dst, "wb");
+	if(!out)
+	{
+		int err = errno;
+		fclose(in);
+		return err;
+	}
+	int err = 0;
+	char buf[65536];
+	size_t n;
+	while((n = fread(buf, 1, sizeof(buf), in)) > 0)
+		if(fwrite(buf, 1, n, out) != n)
+		{
+			err = errno ? errno : EIO;
+			break;
+		}
+	if(!err && ferror(in))
+		err = EIO;
+	fclose(in);
+	if(fclose(out) != 0 && !err)
+		err = errno;
+	if(err)
+		unlink(dst);
+	return err;
+#endif
+}
+
 int FILE_get_directory(const string& path, vector<string> * out_files, vector<string> * out_dirs)
 {
 #if IBM
@@ -107,6 +107,16 @@ int FILE_read_file_to_string(const string& path, string& content);
 // Returns 0 for success, else last_error
 int FILE_rename_file(const char * old_name, const char * new_name);
 
+// Like FILE_rename_file, but an existing new_name is replaced - in one step, so new_name is always either the old
+// or the new file.  Returns 0 for success, else last_error
+int FILE_replace_file(const char * old_name, const char * new_name);
+
+// Sets the file's modification time to now.  Returns 0 for success, else last_error
+int FILE_touch_file(const char * path);
+
+// Copies src over dst.  Returns 0 for success, else last_error
+int FILE_copy_file(const char * src, const char * dst);
+
 // Create in_dir in its parent directory
 // Returns 0 for success, else last_error
 int FILE_make_dir(const char * in_dir);
@@ -238,7 +238,7 @@ void	RTree2<T,N>::insert(I begin, I end)
 		root = NULL;
 	else {
 		vector<item_type>	container(begin,end);
-		root = insert_range(0, begin, end);
+		root = insert_range(0, container.begin(), container.end());
 	}
 }
 
@@ -24,6 +24,19 @@
 #include <vector>
 #include <string.h>
 
+#if defined(__x86_64__) || defined(_M_X64)
+	#define XCHUNKY_SIMD 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define XCHUNKY_AVX2
+	#else
+		#define XCHUNKY_AVX2 __attribute__((target("avx2")))
+	#endif
+#else
+	#define XCHUNKY_SIMD 0
+#endif
+
 
 using std::vector;
 
@@ -127,20 +140,24 @@ public:
 };
 
 
+// The encoders write either straight to a file or into a memory buffer, so atoms can be encoded off the writing thread.
+inline void	WriteToSink(FILE * file, const void * data, size_t len) { fwrite(data, len, 1, file); }
+inline void	WriteToSink(vector<uint8_t> * buf, const void * data, size_t len) { buf->insert(buf->end(), (const uint8_t *) data, (const uint8_t *) data + len); }
+
 #pragma mark class FlatEncoder
-template <class T>
+template <class T, class S>
 class	FlatEncoder {
 public:
 
-		FILE *		file;
+		S			file;
 
-	FlatEncoder(FILE * inFile) : file(inFile)
+	FlatEncoder(S inFile) : file(inFile)
 	{
 	}
 
 	void Accum(T value)
 	{
-		fwrite(&value, sizeof(value), 1, file);
+		WriteToSink(file, &value, sizeof(value));
 	}
 
 	void Done(void)
@@ -149,7 +166,7 @@ public:
 };
 
 #pragma mark class RLEEncoder
-template <class T>
+template <class T, class S>
 class	RLEEncoder {
 public:
 
@@ -157,13 +174,13 @@ public:
 	// having no data and neutral, having one item and neutral, or having
 	// two or more items and being in a heterogenous or homogenous run.
 
-		FILE *		file;
+		S			file;
 		vector<T>	run;
 		bool		is_run;
 		bool		is_individual;
 		int			run_length;
 
-	RLEEncoder(FILE * inFile)
+	RLEEncoder(S inFile)
 	{
 		file = inFile;
 		run_length = 0;
@@ -185,9 +202,9 @@ public:
 					// Run is max length - emit the run and go to neutral
 					// with this one item.
 					token = 0x80 | run_length;
-					fwrite(&token, sizeof(token), 1, file);
+					WriteToSink(file, &token, sizeof(token));
 					item = run[0];
-					fwrite(&item, sizeof(item), 1, file);
+					WriteToSink(file, &item, sizeof(item));
 					is_run = false;
 					run.clear();
 					run.push_back(value);
@@ -198,9 +215,9 @@ public:
 			} else {
 				// Emit the run, accum this one, but stay neutral
 				token = 0x80 | run_length;
-				fwrite(&token, sizeof(token), 1, file);
+				WriteToSink(file, &token, sizeof(token));
 				item = run[0];
-				fwrite(&item, sizeof(item), 1, file);
+				WriteToSink(file, &item, sizeof(item));
 				is_run = false;
 				run.clear();
 				run.push_back(value);
@@ -215,8 +232,8 @@ public:
 					// The run is too long.  Emit,
 					// go to neutral with this one item.
 					token = run.size();
-					fwrite(&token, sizeof(token), 1, file);
-					fwrite(&*run.begin(), sizeof(T), run.size(), file);
+					WriteToSink(file, &token, sizeof(token));
+					WriteToSink(file, &*run.begin(), sizeof(T) * run.size());
 					is_individual = false;
 					run.clear();
 					run.push_back(value);
@@ -243,8 +260,8 @@ public:
 
 				run.pop_back();
 				token = run.size();
-				fwrite(&token, sizeof(token), 1, file);
-				fwrite(&*run.begin(), sizeof(T), run.size(), file);
+				WriteToSink(file, &token, sizeof(token));
+				WriteToSink(file, &*run.begin(), sizeof(T) * run.size());
 				is_individual = false;
 				is_run = true;
 				run.clear();
@@ -282,20 +299,20 @@ public:
 		{
 			// dump the run
 			token = 0x80 | run_length;
-			fwrite(&token, sizeof(token), 1, file);
+			WriteToSink(file, &token, sizeof(token));
 			item = run[0];
-			fwrite(&item, sizeof(item), 1, file);
+			WriteToSink(file, &item, sizeof(item));
 
 		} else if (is_individual) {
 			// dump the run
 			token = run.size();
-			fwrite(&token, sizeof(token), 1, file);
-			fwrite(&*run.begin(), sizeof(T), run.size(), file);
+			WriteToSink(file, &token, sizeof(token));
+			WriteToSink(file, &*run.begin(), sizeof(T) * run.size());
 		} else if (!run.empty()) {
 			// make a one-item individual run
 			token = run.size();
-			fwrite(&token, sizeof(token), 1, file);
-			fwrite(&*run.begin(), sizeof(T), run.size(), file);
+			WriteToSink(file, &token, sizeof(token));
+			WriteToSink(file, &*run.begin(), sizeof(T) * run.size());
 		}
 	}
 
@@ -689,6 +706,252 @@ static F DecodeNumericPlaneInterleavedScaled(
 	return inPlaneCount;
 }
 
+#pragma mark SIMD point pool decoding
+
+/*
+	SIMD versions of DecodeNumericPlaneInterleavedScaled.  Each plane is first expanded into a flat array of
+	samples (a memcpy for the flat modes, the usual RLEDecoder for the RLE modes), then the differential
+	prefix-sum and the scale-to-double run as vector kernels.  The scale is done as ((double) v * sc) * reduce + of,
+	exactly like the scalar code (no FMA), so the results are bit-identical.  Byte swapping is a no-op on the
+	little-endian CPUs this runs on.
+
+	The scalar decoder stays the reference - SetPlanarNumericSIMD(xpna_SIMD_None) forces it.
+*/
+
+#if XCHUNKY_SIMD
+
+static int	DetectPlanarNumericSIMD(void)
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] >= 7)
+	{
+		__cpuid(info, 1);
+		bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		if (os_saves_ymm && (info[1] & (1 << 5)))
+			return xpna_SIMD_AVX2;
+	}
+	return xpna_SIMD_SSE2;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? xpna_SIMD_AVX2 : xpna_SIMD_SSE2;
+#endif
+}
+
+static const int	sSIMDSupported = DetectPlanarNumericSIMD();
+static int			sSIMDLevel = sSIMDSupported;
+
+// In-place running sum, wrapping in T just like the scalar 'last + val'.
+static void	PrefixSum_SSE2(uint16_t * d, int n)
+{
+	__m128i	carry = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i *) (d + i));
+		x = _mm_add_epi16(x, _mm_slli_si128(x, 2));
+		x = _mm_add_epi16(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi16(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi16(x, carry);
+		_mm_storeu_si128((__m128i *) (d + i), x);
+		carry = _mm_shufflehi_epi16(x, 0xFF);			// broadcast the last sum to all lanes
+		carry = _mm_unpackhi_epi64(carry, carry);
+	}
+	uint16_t last = i ? d[i-1] : 0;
+	for (; i < n; ++i)
+		d[i] = last = (uint16_t) (last + d[i]);
+}
+
+static void	PrefixSum_SSE2(uint32_t * d, int n)
+{
+	__m128i	carry = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i *) (d + i));
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi32(x, carry);
+		_mm_storeu_si128((__m128i *) (d + i), x);
+		carry = _mm_shuffle_epi32(x, 0xFF);
+	}
+	uint32_t last = i ? d[i-1] : 0;
+	for (; i < n; ++i)
+		d[i] = last = last + d[i];
+}
+
+// Scale n samples to doubles: ((double) v * sc) * reduce + of, or just (double) v if sc is 0.
+static inline __m128d	Scale_SSE2(__m128d v, double sc, double reduce, double of)
+{
+	return sc ? _mm_add_pd(_mm_mul_pd(_mm_mul_pd(v, _mm_set1_pd(sc)), _mm_set1_pd(reduce)), _mm_set1_pd(of)) : v;
+}
+
+static void	ScaleToDouble_SSE2(const uint16_t * src, int n, double * dst, double sc, double reduce, double of)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i v = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) (src + i)), _mm_setzero_si128());
+		_mm_storeu_pd(dst + i,     Scale_SSE2(_mm_cvtepi32_pd(v),                          sc, reduce, of));
+		_mm_storeu_pd(dst + i + 2, Scale_SSE2(_mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0xEE)), sc, reduce, of));
+	}
+	for (; i < n; ++i)
+		dst[i] = sc ? ((double) src[i]) * sc * reduce + of : src[i];
+}
+
+static inline __m128d	CvtLoU32ToDouble_SSE2(__m128i v)
+{
+	// cvtepi32_pd is signed - flip the sign bit and add it back as a double, which is exact.
+	return _mm_add_pd(_mm_cvtepi32_pd(_mm_xor_si128(v, _mm_set1_epi32(0x80000000))), _mm_set1_pd(2147483648.0));
+}
+
+static void	ScaleToDouble_SSE2(const uint32_t * src, int n, double * dst, double sc, double reduce, double of)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+		_mm_storeu_pd(dst + i,     Scale_SSE2(CvtLoU32ToDouble_SSE2(v),                          sc, reduce, of));
+		_mm_storeu_pd(dst + i + 2, Scale_SSE2(CvtLoU32ToDouble_SSE2(_mm_shuffle_epi32(v, 0xEE)), sc, reduce, of));
+	}
+	for (; i < n; ++i)
+		dst[i] = sc ? ((double) src[i]) * sc * reduce + of : src[i];
+}
+
+XCHUNKY_AVX2 static inline __m256d	Scale_AVX2(__m256d v, double sc, double reduce, double of)
+{
+	return sc ? _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(v, _mm256_set1_pd(sc)), _mm256_set1_pd(reduce)), _mm256_set1_pd(of)) : v;
+}
+
+XCHUNKY_AVX2 static void	ScaleToDouble_AVX2(const uint16_t * src, int n, double * dst, double sc, double reduce, double of)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (src + i)));
+		_mm256_storeu_pd(dst + i,     Scale_AVX2(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)),      sc, reduce, of));
+		_mm256_storeu_pd(dst + i + 4, Scale_AVX2(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), sc, reduce, of));
+	}
+	for (; i < n; ++i)
+		dst[i] = sc ? ((double) src[i]) * sc * reduce + of : src[i];
+}
+
+XCHUNKY_AVX2 static void	ScaleToDouble_AVX2(const uint32_t * src, int n, double * dst, double sc, double reduce, double of)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (src + i)), _mm_set1_epi32(0x80000000));
+		_mm256_storeu_pd(dst + i, Scale_AVX2(_mm256_add_pd(_mm256_cvtepi32_pd(v), _mm256_set1_pd(2147483648.0)), sc, reduce, of));
+	}
+	for (; i < n; ++i)
+		dst[i] = sc ? ((double) src[i]) * sc * reduce + of : src[i];
+}
+
+/*
+	Unlike the scalar decoder, which writes each plane with a stride of inPlaneCount doubles (and so walks the whole
+	output once per plane), all planes are expanded first.  Then blocks of vertices are scaled per plane into a small
+	cache-resident buffer and interleaved into the output in one sequential pass.
+*/
+template<class T>
+static int DecodeNumericPlaneInterleavedScaledSIMD(
+						int 					inPlaneCount,
+						int						inPlaneSize,
+						uint8_t		*			inAtomData,
+						uint8_t		*			inAtomDataEnd,
+						double *				ioPlane,
+						double *				ioScales,
+						double					inReduce,
+						double *				ioOffsets)
+{
+	const int	kBlock = 512;
+	vector<T>	samples((size_t) inPlaneCount * inPlaneSize);
+	vector<int>	decoded;				// planes with a known encoding - others are left alone, like the scalar code.
+	int			plane, planes_read, i;
+
+	for (planes_read = 0; planes_read < inPlaneCount; ++planes_read)
+	{
+		if (inAtomData >= inAtomDataEnd) break;
+		T * dst = samples.data() + (size_t) planes_read * inPlaneSize;
+
+		uint8_t	encodeMode = *inAtomData++;
+		if (encodeMode == xpna_Mode_Raw || encodeMode == xpna_Mode_Differenced)
+		{
+			memcpy(dst, inAtomData, inPlaneSize * sizeof(T));
+			inAtomData += inPlaneSize * sizeof(T);
+		}
+		else if (encodeMode == xpna_Mode_RLE || encodeMode == xpna_Mode_RLE_Differenced)
+		{
+			RLEDecoder<T>	decoder(inAtomData);
+			for (i = 0; i < inPlaneSize; ++i)
+				dst[i] = decoder.Fetch();
+			inAtomData = decoder.EndPos();
+		}
+		else
+			continue;
+
+		if (encodeMode == xpna_Mode_Differenced || encodeMode == xpna_Mode_RLE_Differenced)
+			PrefixSum_SSE2(dst, inPlaneSize);
+		decoded.push_back(planes_read);
+	}
+
+	vector<double>	block(decoded.size() * kBlock);
+	for (int base = 0; base < inPlaneSize; base += kBlock)
+	{
+		int n = inPlaneSize - base < kBlock ? inPlaneSize - base : kBlock;
+		for (int k = 0; k < decoded.size(); ++k)
+		{
+			plane = decoded[k];
+			const T * src = samples.data() + (size_t) plane * inPlaneSize + base;
+			if (sSIMDLevel >= xpna_SIMD_AVX2)
+				ScaleToDouble_AVX2(src, n, block.data() + k * kBlock, ioScales[plane], inReduce, ioOffsets[plane]);
+			else
+				ScaleToDouble_SSE2(src, n, block.data() + k * kBlock, ioScales[plane], inReduce, ioOffsets[plane]);
+		}
+		double * out = ioPlane + (size_t) base * inPlaneCount;
+		if (decoded.size() == inPlaneCount)
+		{
+			for (i = 0; i < n; ++i)
+			for (int k = 0; k < inPlaneCount; ++k)
+				*out++ = block[k * kBlock + i];
+		}
+		else
+		{
+			for (i = 0; i < n; ++i, out += inPlaneCount)
+			for (int k = 0; k < decoded.size(); ++k)
+				out[decoded[k]] = block[k * kBlock + i];
+		}
+	}
+	return planes_read;
+}
+
+int		SetPlanarNumericSIMD(int inMaxLevel)
+{
+	sSIMDLevel = inMaxLevel < sSIMDSupported ? inMaxLevel : sSIMDSupported;
+	return sSIMDLevel;
+}
+
+int		GetPlanarNumericSIMD(void)
+{
+	return sSIMDLevel;
+}
+
+#else
+
+int		SetPlanarNumericSIMD(int inMaxLevel)
+{
+	return xpna_SIMD_None;
+}
+
+int		GetPlanarNumericSIMD(void)
+{
+	return xpna_SIMD_None;
+}
+
+#endif
+
 int XAtomPlanerNumericTable::DecompressShortToDoubleInterleaved(
 					int		numberOfPlanes,
 					int		planeSize,
@@ -697,6 +960,15 @@ int XAtomPlanerNumericTable::DecompressShortToDoubleInterleaved(
 					double	inReduce,
 					double *ioOffsets)
 {
+#if XCHUNKY_SIMD
+	if (sSIMDLevel != xpna_SIMD_None)
+		return DecodeNumericPlaneInterleavedScaledSIMD<uint16_t>(numberOfPlanes, planeSize,
+							(uint8_t *) begin + sizeof(XAtomHeader_t) + sizeof(int) + sizeof(char), (uint8_t *) end,
+							ioPlaneBuffer,
+							ioScales,
+							inReduce,
+							ioOffsets);
+#endif
 	return DecodeNumericPlaneInterleavedScaled<uint16_t, double>(numberOfPlanes, planeSize,
 							(uint8_t *) begin + sizeof(XAtomHeader_t) + sizeof(int) + sizeof(char), (uint8_t *) end,
 							ioPlaneBuffer,
@@ -714,6 +986,15 @@ int XAtomPlanerNumericTable::DecompressIntToDoubleInterleaved(
 					double	inReduce,
 					double *ioOffsets)
 {
+#if XCHUNKY_SIMD
+	if (sSIMDLevel != xpna_SIMD_None)
+		return DecodeNumericPlaneInterleavedScaledSIMD<uint32_t>(numberOfPlanes, planeSize,
+							(uint8_t *) begin + sizeof(XAtomHeader_t) + sizeof(int) + sizeof(char), (uint8_t *) end,
+							ioPlaneBuffer,
+							ioScales,
+							inReduce,
+							ioOffsets);
+#endif
 	return DecodeNumericPlaneInterleavedScaled<unsigned int, double>(numberOfPlanes, planeSize,
 							(uint8_t *) begin + sizeof(XAtomHeader_t) + sizeof(int) + sizeof(char), (uint8_t *) end,
 							ioPlaneBuffer,
@@ -847,9 +1128,9 @@ StFileSizeDebugger::~StFileSizeDebugger()
 
 
 
-template <class T>
+template <class T, class S>
 void	WritePlanarNumericAtom(
-							FILE *	file,
+							S		file,
 							int		numberOfPlanes,
 							int		planeSize,
 							int		encodeMode,
@@ -860,16 +1141,16 @@ void	WritePlanarNumericAtom(
 
 	int	psize = SWAP32(planeSize);
 	uint8_t nplanes = numberOfPlanes;
-	fwrite(&psize, sizeof(psize), 1, file);
-	fwrite(&nplanes, sizeof(nplanes), 1, file);
+	WriteToSink(file, &psize, sizeof(psize));
+	WriteToSink(file, &nplanes, sizeof(nplanes));
 
 	for (int pln = 0; pln < numberOfPlanes; ++pln)
 	{
 		uint8_t encode = encodeMode;
-		fwrite(&encode, sizeof(encode), 1, file);
+		WriteToSink(file, &encode, sizeof(encode));
 		if (encodeMode == xpna_Mode_Raw)
 		{
-			FlatEncoder<T>	encoder(file);
+			FlatEncoder<T, S>	encoder(file);
 			for (int i = 0; i < planeSize; ++i)
 			{
 				value = SwapValueTyped(interleaved ?
@@ -881,7 +1162,7 @@ void	WritePlanarNumericAtom(
 		}
 		if (encodeMode == xpna_Mode_Differenced)
 		{
-			FlatEncoder<T>	encoder(file);
+			FlatEncoder<T, S>	encoder(file);
 			last = 0;
 			for (int i = 0; i < planeSize; ++i)
 			{
@@ -897,7 +1178,7 @@ void	WritePlanarNumericAtom(
 		}
 		if (encodeMode == xpna_Mode_RLE)
 		{
-			RLEEncoder<T>	encoder(file);
+			RLEEncoder<T, S>	encoder(file);
 			for (int i = 0; i < planeSize; ++i)
 			{
 				value = SwapValueTyped(interleaved ?
@@ -909,7 +1190,7 @@ void	WritePlanarNumericAtom(
 		}
 		if (encodeMode == xpna_Mode_RLE_Differenced)
 		{
-			RLEEncoder<T>	encoder(file);
+			RLEEncoder<T, S>	encoder(file);
 			last = 0;
 			for (int i = 0; i < planeSize; ++i)
 			{
@@ -937,6 +1218,17 @@ void	WritePlanarNumericAtomShort(
 	WritePlanarNumericAtom(file, numberOfPlanes, planeSize, encodeMode, interleaved, ioData);
 }
 
+void	EncodePlanarNumericAtomShort(
+							vector<uint8_t>&	outData,
+							int		numberOfPlanes,
+							int		planeSize,
+							int		encodeMode,
+							int		interleaved,
+							int16_t *	ioData)
+{
+	WritePlanarNumericAtom(&outData, numberOfPlanes, planeSize, encodeMode, interleaved, ioData);
+}
+
 void	WritePlanarNumericAtomInt(
 							FILE *	file,
 							int		numberOfPlanes,
@@ -56,6 +56,12 @@ enum {
 	xpna_Mode_RLE_Differenced = 3
 };
 
+enum {
+	xpna_SIMD_None = 0,
+	xpna_SIMD_SSE2 = 1,
+	xpna_SIMD_AVX2 = 2
+};
+
 
 /********************************************************************************
  * CHUNKY FILE READING UTILITIES
@@ -136,7 +142,10 @@ struct	XAtomPlanerNumericTable : public XAtom {
 	int		GetArraySize(void);
 	int		GetPlaneCount(void);
 
-	// doc this!!
+	/* These decode a point pool straight to interleaved doubles, applying
+	 * v * ioScales[plane] * inReduce + ioOffsets[plane] to every sample of
+	 * a plane with a non-zero scale.  On x86 they use SSE2/AVX2 kernels,
+	 * see SetPlanarNumericSIMD. */
 	int 	DecompressShortToDoubleInterleaved(
 					int		numberOfPlanes,
 					int		planeSize,
@@ -180,6 +189,16 @@ struct	XAtomPlanerNumericTable : public XAtom {
 
 };
 
+/*
+ * The ...ToDoubleInterleaved decoders pick the best SIMD level the CPU has
+ * at startup.  SetPlanarNumericSIMD caps that level and returns the level
+ * actually used; xpna_SIMD_None runs the original scalar decoder, which is
+ * the reference the SIMD kernels must match bit for bit.
+ *
+ */
+int		SetPlanarNumericSIMD(int inMaxLevel);
+int		GetPlanarNumericSIMD(void);
+
 /*
  * An atom of packed data...useful for reading by type
  * and dealing with endian swaps.
@@ -241,6 +260,15 @@ void	WritePlanarNumericAtomShort(
 							int			interleaved,
 							int16_t *	ioData);
 
+// Same encoding as WritePlanarNumericAtomShort, appended to a buffer instead of a file - safe to run on any thread.
+void	EncodePlanarNumericAtomShort(
+							vector<uint8_t>&	outData,
+							int			numberOfPlanes,
+							int			planeSize,
+							int			encodeMode,
+							int			interleaved,
+							int16_t *	ioData);
+
 void	WritePlanarNumericAtomInt(
 							FILE *		file,
 							int			numberOfPlanes,
@@ -160,6 +160,11 @@ void WED_Settings::ReceiveMessage(
 			gOrthoExport = ((GUI_Button *) inParam)->GetValue();
 			this->TakeFocus();
 	}
+	else if(inMsg == (intptr_t) &gParallelExport)
+	{
+			gParallelExport = ((GUI_Button *) inParam)->GetValue();
+			this->TakeFocus();
+	}
 	else if (inMsg == kMsg_Close)
 	{
 		this->TakeFocus();
@@ -202,6 +207,15 @@ WED_Settings::WED_Settings(GUI_Commander * cmdr) : GUI_Window("WED Preferences",
 	png_btn->SetValue(gOrthoExport);
 	png_btn->SetMsg((intptr_t) &gOrthoExport, (intptr_t) png_btn);
 
+	GUI_Button * par_btn = new GUI_Button("check_buttons.png",btn_Check,k_no, k_no, k_yes, k_yes);
+	par_btn->SetBounds(20,230,190,230+GUI_GetImageResourceHeight("check_buttons.png")/3);
+	par_btn->Show();
+	par_btn->SetDescriptor("Parallel DSF Export");
+	par_btn->SetParent(this);
+	par_btn->AddListener(this);
+	par_btn->SetValue(gParallelExport);
+	par_btn->SetMsg((intptr_t) &gParallelExport, (intptr_t) par_btn);
+
 	int field_height = gFontSize+gFontSize/2;
 
 	mCustom_box = new GUI_TextField(true, this);
@@ -27,6 +27,7 @@
 #include "WED_Persistent.h"
 #include "WED_UndoLayer.h"
 #include "WED_UndoMgr.h"
+#include "WED_Buffer.h"
 #include "AssertUtils.h"
 #include "WED_Errors.h"
 #include "WED_XMLWriter.h"
@@ -129,6 +130,35 @@ void			WED_Archive::SaveToXML(WED_XMLElement * parent)
 
 	mOpCount = 0;
 }
+
+void			WED_Archive::SaveToSnapshot(WED_Archive * dst)
+{
+	DebugAssert(dst->mObjects.empty());
+
+	// Same stream format the undo system uses.  Everything goes into one buffer and is read back
+	// in the same order, which is a lot cheaper than a buffer per object.
+	WED_Buffer						buf;
+	vector<WED_Persistent *>		src;
+	src.reserve(mObjects.size());
+	for (auto& ob : mObjects)
+		if(ob.second != NULL)
+		{
+			ob.second->WriteTo(&buf);
+			src.push_back(ob.second);
+		}
+
+	buf.ResetRead();
+	dst->SetUndo(UNDO_DISCARD);
+	for (auto ob : src)
+	{
+		WED_Persistent * copy = WED_Persistent::CreateByClass(ob->GetClass(), dst, ob->GetID());
+		DebugAssert(copy != NULL);
+		copy->ReadFrom(&buf);
+	}
+	dst->SetUndo(NULL);
+
+	mOpCount = 0;
+}
 #if WITHNWLINK
 void			WED_Archive::SetNWLinkAdapter(WED_NWLinkAdapter * inAdapter)
 {
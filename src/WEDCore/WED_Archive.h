@@ -77,6 +77,9 @@ public:
 
 	void			ClearAll(void);
 	void			SaveToXML(WED_XMLElement * parent);
+	// Copies every object into the empty archive dst and marks us saved, so dst can be written out
+	// (e.g. on another thread) while editing continues here.
+	void			SaveToSnapshot(WED_Archive * dst);
 #if WITHNWLINK
 	void			SetNWLinkAdapter(WED_NWLinkAdapter * inAdapter);
 #endif
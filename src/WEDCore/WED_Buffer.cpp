@@ -81,6 +81,12 @@ void	WED_Buffer::ReadBulk(char * inBuf, int inLength, bool inZip)
 	ReadInternal(inBuf, inLength);
 }
 
+// Spans are stored native-endian like everything else in the buffer, so they're just one big copy.
+void	WED_Buffer::ReadSpan(short * outBuf, int inCount)	{ if (inCount > 0) ReadInternal((char *) outBuf, inCount * sizeof(short));	}
+void	WED_Buffer::ReadSpan(int * outBuf, int inCount)		{ if (inCount > 0) ReadInternal((char *) outBuf, inCount * sizeof(int));	}
+void	WED_Buffer::ReadSpan(float * outBuf, int inCount)	{ if (inCount > 0) ReadInternal((char *) outBuf, inCount * sizeof(float));	}
+void	WED_Buffer::ReadSpan(double * outBuf, int inCount)	{ if (inCount > 0) ReadInternal((char *) outBuf, inCount * sizeof(double));	}
+
 void	WED_Buffer::WriteShort(short v)
 {
 	WriteInternal((const char *) &v, sizeof(v));
@@ -106,6 +112,11 @@ void	WED_Buffer::WriteBulk(const char * inBuf, int inLength, bool inZip)
 	WriteInternal(inBuf, inLength);
 }
 
+void	WED_Buffer::WriteSpan(const short * inBuf, int inCount)	{ if (inCount > 0) WriteInternal((const char *) inBuf, inCount * sizeof(short));	}
+void	WED_Buffer::WriteSpan(const int * inBuf, int inCount)	{ if (inCount > 0) WriteInternal((const char *) inBuf, inCount * sizeof(int));		}
+void	WED_Buffer::WriteSpan(const float * inBuf, int inCount)	{ if (inCount > 0) WriteInternal((const char *) inBuf, inCount * sizeof(float));	}
+void	WED_Buffer::WriteSpan(const double * inBuf, int inCount){ if (inCount > 0) WriteInternal((const char *) inBuf, inCount * sizeof(double));	}
+
 void	WED_Buffer::ReadInternal(char* p, unsigned long l)
 {
 	while (l > 0)
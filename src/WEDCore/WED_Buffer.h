@@ -52,7 +52,7 @@ using std::list;
 using std::vector;
 
 
-class	WED_Buffer : public IOReader, public IOWriter {
+class	WED_Buffer final : public IOReader, public IOWriter {
 public:
 
 					WED_Buffer();
@@ -66,6 +66,10 @@ public:
 	virtual	void	ReadFloat(float&);
 	virtual	void	ReadDouble(double&);
 	virtual	void	ReadBulk(char * inBuf, int inLength, bool inZip);
+	virtual	void	ReadSpan(short * outBuf, int inCount);
+	virtual	void	ReadSpan(int * outBuf, int inCount);
+	virtual	void	ReadSpan(float * outBuf, int inCount);
+	virtual	void	ReadSpan(double * outBuf, int inCount);
 
 	// IOWriter
 	virtual	void	WriteShort(short);
@@ -73,6 +77,10 @@ public:
 	virtual	void	WriteFloat(float);
 	virtual	void	WriteDouble(double);
 	virtual	void	WriteBulk(const char * inBuf, int inLength, bool inZip);
+	virtual	void	WriteSpan(const short * inBuf, int inCount);
+	virtual	void	WriteSpan(const int * inBuf, int inCount);
+	virtual	void	WriteSpan(const float * inBuf, int inCount);
+	virtual	void	WriteSpan(const double * inBuf, int inCount);
 
 			void	ResetRead(void);				// Resets reading to the beginning.
 			void *	AllocContiguous(int len);		// Allocates a chunk of memory that is not split across buffers.
@@ -65,6 +65,7 @@ int gModeratorMode;
 int gFontSize;
 string gCustomSlippyMap;
 int gOrthoExport;
+int gParallelExport;
 
 static set<WED_Document *> sDocuments;
 static map<string,string>	sGlobalPrefs;
@@ -81,7 +82,8 @@ WED_Document::WED_Document(
 	mOnDisk(false),
 	mPrefsChanged(false),
 	mUndo(&mArchive, this),
-	mArchive(this)
+	mArchive(this),
+	mSaveJob(NULL)
 {
 
 	mTexMgr = new WED_TexMgr(package);
@@ -148,6 +150,11 @@ WED_Document::WED_Document(
 
 WED_Document::~WED_Document()
 {
+	if(mSaveJob)
+	{
+		mSaveThread.join();
+		delete mSaveJob;
+	}
 	delete mTexMgr;
 	delete mResourceMgr;
 	delete mLibraryMgr;
@@ -199,154 +206,126 @@ WED_NWLinkAdapter *	WED_Document::GetNWLink(void)
 
 void	WED_Document::Save(void)
 {
-	BroadcastMessage(msg_DocWillSave, reinterpret_cast<uintptr_t>(static_cast<IDocPrefs *>(this)));
+	// One write at a time - and the previous one has to be through the rename dance before we start on the files again.
+	FinishSave();
 
-	enum {none,nobackup,both};
-	int stage = none;
+	BroadcastMessage(msg_DocWillSave, reinterpret_cast<uintptr_t>(static_cast<IDocPrefs *>(this)));
 
 	//Create the strings path.
 	//earth.wed.xml,
 	//earth.wed.bak.xml,
-	//earth.wed.bak.bak.xml, deleted before the user sees it.
-
-	//All or some of these are used through out
-
-	string xml = mFilePath;
-	xml += ".xml";
-
-	string bakXML = xml;
-	bakXML = bakXML.insert((bakXML.length()-4),".bak");
-
-	string tempBakBak = bakXML;
-	tempBakBak = tempBakBak.insert((bakXML.length()-4),".bak");
+	//earth.wed.tmp.xml, the new file until it is completely written.
 
 	auto t0 = std::chrono::high_resolution_clock::now();
 
-#if 0
-	bool earth_wed_xml = FILE_exists(xml.c_str());
-	bool earth_wed_bak_xml = FILE_exists(bakXML.c_str());
+	save_job_t * job = new save_job_t;
+	job->xml = mFilePath + ".xml";
+	job->bak = mFilePath + ".bak.xml";
+	job->tmp = mFilePath + ".tmp.xml";
+	job->done = false;
+
+	job->archive = new WED_Archive(this);
+	mArchive.SaveToSnapshot(job->archive);
+	job->prefs = mDocPrefs;
+	job->pref_items = mDocPrefsItems;
+	mPrefsChanged = false;
 
-	//If there is no earth.wed.xml file for any reason
-	if(earth_wed_xml == false)
-	{
-		stage = none;
-	}
-	//If there is no back up and there is an earth.wed.xml
-	else if(earth_wed_xml == true && earth_wed_bak_xml == false)
-	{
-		stage = nobackup;
-	}
-	//If there is a back up and an earth.wed.xml
-	else if(earth_wed_xml == true && earth_wed_bak_xml == true)
-	{
-		stage = both;
-	}
-	//This is the renaming switch
-	switch(stage)
-	{
-	case none:
-		break;
-	case nobackup:
-		//Rename the current earth.wed.xml to earth.wed.bak.xml
-		FILE_rename_file(xml.c_str(),bakXML.c_str());
-		break;
-	case both:
-		//next rename the current earth.wed.bak.xml to earth.wed.bak.bak.xml
-		FILE_rename_file(bakXML.c_str(),tempBakBak.c_str());
-
-		//Rename the current earth.wed.xml to earth.wed.bak.xml
-		FILE_rename_file(xml.c_str(),bakXML.c_str());
-		break;
-	}
-#else
-	rename(xml.c_str(), bakXML.c_str());
-#endif
 	auto t1 = std::chrono::high_resolution_clock::now();
 	chrono::duration<double> elapsed = t1 - t0;
-	LOG_MSG("\nrename b4 save %.3lf s\n", elapsed.count());
-	t0 = t1;
+	LOG_MSG("\nsnapshot b4 save %.3lf s\n", elapsed.count());
+
+	mSaveJob = job;
+	mSaveThread = thread(&WED_Document::SaveWorker, this, job);
+	Start(0.1);
+}
+
+void	WED_Document::SaveWorker(save_job_t * job)
+{
+	auto t0 = std::chrono::high_resolution_clock::now();
 
 	//Create an xml file by opening the file located on the hard drive (windows)
 	//open a file for writing creating/nukeing if neccessary
 
-	FILE * xml_file = fopen(xml.c_str(),"w");
+	FILE * xml_file = fopen(job->tmp.c_str(),"w");
 
 	if(xml_file == NULL)
+		job->error = "Can not open '" + job->tmp + "' for writing.";
+	else
 	{
-		string msg = "Can not open '" + xml + "' for writing.";
-		DoUserAlert(msg.c_str());
-		return;
-	}
+		WriteXML(xml_file, job->archive, job->prefs, job->pref_items);
 
-	int ferrorErr = ferror(xml_file);
-		//If everything else has worked
-	if(ferrorErr == 0)
-	{
-		WriteXML(xml_file);
+		int ferrorErr = ferror(xml_file);
+		int fcloseErr = fclose(xml_file);
+
+		if(ferrorErr != 0 || fcloseErr != 0)
+		{
+			FILE_delete_file(job->tmp.c_str(), false);
+			job->error = "Error while writing '" + job->tmp + "'.";
+		}
+		else
+		{
+			// The new file is complete.  The old one stays in place while we copy it to the backup, then the new one
+			// replaces it in one step - so whenever we get interrupted, earth.wed.xml is a complete save.
+			if(FILE_exists(job->xml.c_str()) && FILE_copy_file(job->xml.c_str(), job->bak.c_str()) != 0)
+				job->error = "Error creating backup '" + job->bak + "', the new save is in '" + job->tmp + "'.";
+			else if(FILE_replace_file(job->tmp.c_str(), job->xml.c_str()) != 0)
+				job->error = "Error renaming '" + job->tmp + "' to '" + job->xml + "'.";
+		}
 	}
 
-	int fcloseErr = fclose(xml_file);
+	// Tearing down a big snapshot takes a moment too, do that here rather than on the UI thread.
+	delete job->archive;
+	job->archive = NULL;
 
-	t1 = std::chrono::high_resolution_clock::now();
-	elapsed = t1 - t0;
+	auto t1 = std::chrono::high_resolution_clock::now();
+	chrono::duration<double> elapsed = t1 - t0;
 	LOG_MSG("xml write %.3lf s\n", elapsed.count());
-	t0 = t1;
 
-	if(ferrorErr != 0 || fcloseErr != 0)
-	{
-		string msg =  "Error while writing '" + xml + "'";
-#if 0
-		switch(stage)
-		{
-			case none:
-				FILE_delete_file(xml.c_str(), false);
-				break;
-			case nobackup:
-				//Delete's the bad save
-				FILE_delete_file(xml.c_str(), false);
-				//un-renames the old one
-				FILE_rename_file(bakXML.c_str(),xml.c_str());
-				msg += " or creating backup '" + bakXML;
-				break;
-			case both:
-				//delete incomplete file
-				FILE_delete_file(xml.c_str(), false);
+	lock_guard<mutex> lock(mSaveLock);
+	job->done = true;
+}
 
-				//un-rename earth.wed.bak.xml to earth.wed.xml
-				FILE_rename_file(bakXML.c_str(), xml.c_str());
+bool	WED_Document::FinishSave(void)
+{
+	if(mSaveJob == NULL)
+		return true;
 
-				//un-rename earth.wed.bak.bak.xml to earth.wed.bak.xml
-				FILE_rename_file(tempBakBak.c_str(), bakXML.c_str());
-				msg += " or renaming backups to '" + bakXML + "' or '" + tempBakBak;
-				break;
-		}
-#else
-		rename(bakXML.c_str(), xml.c_str());
-#endif
-		msg += "'.";
-		DoUserAlert(msg.c_str());
+	mSaveThread.join();
+	Stop();
+
+	save_job_t * job = mSaveJob;
+	mSaveJob = NULL;
+
+	bool ok = job->error.empty();
+	if(ok)
+	{
+		// This is the save-was-okay case.
+		mOnDisk = true;
 	}
 	else
 	{
-		// This is the save-was-okay case.
-		mOnDisk=true;
-		mPrefsChanged=false;
+		// The archive forgot it was dirty when we took the snapshot - make sure we still ask before closing.
+		mPrefsChanged = true;
+		DoUserAlert(job->error.c_str());
 	}
-#if 0
-	//if the second backup still exists after the error handling
-	if(FILE_exists(tempBakBak.c_str()) == true)
+	delete job;
+	return ok;
+}
+
+void	WED_Document::TimerFired(void)
+{
+	bool done;
 	{
-		//Delete it
-		FILE_delete_file(tempBakBak.c_str(), false);
+		lock_guard<mutex> lock(mSaveLock);
+		done = mSaveJob && mSaveJob->done;
 	}
-#endif
-	t1 = std::chrono::high_resolution_clock::now();
-	elapsed = t1 - t0;
-	LOG_MSG("delete aft save %.3lf s\n", elapsed.count());
+	if(done)
+		FinishSave();
 }
 
 void	WED_Document::Revert(void)
 {
+	FinishSave();
 	if(this->IsDirty())
 	{
 		string msg = "Are you sure you want to revert the document '" + mPackage + "' to the saved version on disk?";
@@ -358,7 +337,7 @@ void	WED_Document::Revert(void)
 
 	try {
 		mUndo.__StartCommand("Revert from Saved.", __FILE__, __LINE__);
-		bool xml_exists;
+		bool xml_exists, from_backup = false;
 
 		WED_XMLReader	reader;
 		reader.PushHandler(this);
@@ -368,7 +347,26 @@ void	WED_Document::Revert(void)
 		LOG_MSG("I/Doc reading XML from %s\n", fname.c_str());
 		string result = reader.ReadFile(fname.c_str(), &xml_exists);
 
-		if(xml_exists && !result.empty())
+		if(!xml_exists && FILE_exists((mFilePath + ".bak.xml").c_str()))
+		{
+			// Older WEDs moved earth.wed.xml out of the way while saving, a crash at the wrong moment left only the backup.
+			WED_XMLReader	reader_bak;
+			reader_bak.PushHandler(this);
+			mArchive.ClearAll();
+			fname = mFilePath + ".bak.xml";
+
+			LOG_MSG("I/Doc no XML, reading backup XML from %s\n", fname.c_str());
+			result = reader_bak.ReadFile(fname.c_str(), &xml_exists);
+			if(!result.empty())
+			{
+				LOG_MSG("E/Doc Error reading backup XML %s", result.c_str());
+				WED_ThrowPrintf("The XML file is missing and the backup XML resulted in error: %s", result.c_str());
+			}
+			DoUserAlert("The XML file of this scenery package is missing, probably from a save that got interrupted.\n"
+						"The backup has been opened instead - save to make it the XML file again.");
+			from_backup = true;
+		}
+		else if(xml_exists && !result.empty())
 		{
 			LOG_MSG("E/Doc Error reading XML %s",result.c_str());
 			string msg("An error '");
@@ -401,7 +399,7 @@ void	WED_Document::Revert(void)
 		if(xml_exists)
 		{
 			mOnDisk=true;
-			mPrefsChanged = false;
+			mPrefsChanged = from_backup;		// so closing asks to save it back to the XML file
 		}
 		else
 		{
@@ -467,12 +465,13 @@ bool	WED_Document::IsOnDisk(void)
 
 bool	WED_Document::TryClose(void)
 {
+	FinishSave();
 	if (IsDirty())
 	{
 		string msg = string("Save changes to scenery package ") + mPackage + string(" before closing?");
 
 		switch(DoSaveDiscardDialog("Save changes before closing...",msg.c_str())) {
-		case close_Save:	Save();	break;
+		case close_Save:	Save();	if (!FinishSave()) return false;	break;
 		case close_Discard:			break;
 		case close_Cancel:	return false;
 		}
@@ -664,6 +663,7 @@ void	WED_Document::ReadGlobalPrefs(void)
 	gFontSize = intlim(FontSize, 10, 18);
 	GUI_SetFontSizes(gFontSize);
 	gOrthoExport = atoi(GUI_GetPrefString("preferences","OrthoExport","1"));
+	gParallelExport = atoi(GUI_GetPrefString("preferences","ParallelExport","0"));
 }
 
 void	WED_Document::WriteGlobalPrefs(void)
@@ -674,6 +674,7 @@ void	WED_Document::WriteGlobalPrefs(void)
 	string FontSize(to_string(gFontSize));
 	GUI_SetPrefString("preferences","FontSize",FontSize.c_str());
 	GUI_SetPrefString("preferences","OrthoExport",gOrthoExport ? "1" : "0");
+	GUI_SetPrefString("preferences","ParallelExport",gParallelExport ? "1" : "0");
 
 	for (map<string,string>::iterator i = sGlobalPrefs.begin(); i != sGlobalPrefs.end(); ++i)
 		if(i->first != "doc/xml_compatibility")          // why NOT write that ? Cuz WED 2.0 ... 2.2 read that and if an PRE wed-2.0 document
@@ -774,7 +775,7 @@ void WED_Document::Panic(void)
 	FILE * xml_file = fopen(xml.c_str(),"w");
 	if(xml_file)
 	{
-		WriteXML(xml_file);
+		WriteXML(xml_file, &mArchive, mDocPrefs, mDocPrefsItems);
 		fclose(xml_file);
 	}
 }
@@ -799,27 +800,27 @@ bool		WED_Document::ReadPrefInternal(const char * in_key, unsigned type, string
 	return found;
 }
 
-void		WED_Document::WriteXML(FILE * xml_file)
+void		WED_Document::WriteXML(FILE * xml_file, WED_Archive * archive, const map<string,string>& doc_prefs, const map<string,set<int> >& doc_pref_items)
 {
 	//print to file the xml file passed in with the following encoding
 	fprintf(xml_file,"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
 	fprintf(xml_file,"<!-- written by WED " WED_VERSION_STRING " -->\n");
 	{
 		WED_XMLElement	top_level("doc",0,xml_file);
-		mArchive.SaveToXML(&top_level);
+		archive->SaveToXML(&top_level);
 		WED_XMLElement * pref;
 		WED_XMLElement * prefs = top_level.add_sub_element("prefs");
-		for(map<string,set<int> >::iterator pi = mDocPrefsItems.begin(); pi != mDocPrefsItems.end(); ++pi)
+		for(map<string,set<int> >::const_iterator pi = doc_pref_items.begin(); pi != doc_pref_items.end(); ++pi)
 		{
 			pref = prefs->add_sub_element("pref");
 			pref->add_attr_stl_str("name",pi->first);
-			for(set<int>::iterator i = pi->second.begin(); i != pi->second.end(); ++i)
+			for(set<int>::const_iterator i = pi->second.begin(); i != pi->second.end(); ++i)
 			{
 				WED_XMLElement *item = pref->add_sub_element("item");
 				item->add_attr_int("value",*i);
 			}
 		}
-		for(map<string,string>::iterator p = mDocPrefs.begin(); p != mDocPrefs.end(); ++p)
+		for(map<string,string>::const_iterator p = doc_prefs.begin(); p != doc_prefs.end(); ++p)
 		{
 			pref = prefs->add_sub_element("pref");
 			pref->add_attr_stl_str("name",p->first);
@@ -47,7 +47,10 @@ class	WED_NWLinkAdapter;
 #endif
 
 #include "GUI_Broadcaster.h"
+#include "GUI_Timer.h"
 #include "IResolver.h"
+#include <thread>
+#include <mutex>
 
 /*
 	WED_Document - THEORY OF OPERATION
@@ -62,10 +65,18 @@ class	WED_NWLinkAdapter;
 
 	Object with ID 1 is by definition "the document root" - that is, it is used as a starting point for all resolutions.
 
+	SAVING
+
+	Save copies the archive into a private snapshot archive (using the same object streams the undo system uses), which is
+	fast, and then writes the XML from that snapshot on a background thread while editing continues.  The new file is
+	written as earth.wed.tmp.xml and only once it is complete is the old earth.wed.xml moved to earth.wed.bak.xml and the
+	temp file moved into its place - so at any time there is at least one complete copy on disk.  The result is picked
+	up on the main thread by a timer; anything that needs the file on disk (revert, close, another save) waits for it.
+
 */
 
 
-class	WED_Document : public GUI_Broadcaster, public GUI_Destroyable, public virtual IResolver, public virtual ILibrarian, public IDocPrefs, public WED_XMLHandler, public WED_UndoFatalErrorHandler {
+class	WED_Document : public GUI_Broadcaster, public GUI_Destroyable, public virtual IResolver, public virtual ILibrarian, public IDocPrefs, public WED_XMLHandler, public WED_UndoFatalErrorHandler, public GUI_Timer {
 public:
 
 						WED_Document(
@@ -115,8 +126,9 @@ public:
 
 	bool				TryClose(void);
 
-	//Saves the file, returns true if successful, false if not.
+	//Saves the file.  The write finishes in the background, FinishSave waits for it and returns true if it worked.
 	void				Save(void);
+	bool				FinishSave(void);
 	void				Revert(void);
 	bool				IsDirty(void);
 	void				SetDirty();
@@ -124,10 +136,12 @@ public:
 
 	static	bool	TryCloseAll(void);
 
+	virtual	void		TimerFired(void);
+
 private:
 	bool				ReadPrefInternal(const char * in_key, unsigned type, string &out_value) const;
 
-	void				WriteXML(FILE * fi);
+	static	void		WriteXML(FILE * fi, WED_Archive * archive, const map<string,string>& doc_prefs, const map<string,set<int> >& doc_pref_items);
 
 	//Member Variables
 
@@ -152,6 +166,23 @@ private:
 	string						mDocPrefsActName;		// Temporary for tracking the current int-set on read-i.
 	map<string,string>			mDocPrefs;				// All string, int and double (non-set) prefs
 	map<string,set<int> >		mDocPrefsItems;			// The int-set prefs, separated out.
+
+	// Background save.  The writer thread owns the job from Save until it sets done (under mSaveLock),
+	// after that only the main thread touches it.
+	struct save_job_t {
+		WED_Archive *			archive;	// snapshot, deleted by the writer when it is done with it
+		map<string,string>		prefs;
+		map<string,set<int> >	pref_items;
+		string					xml, tmp, bak;
+		string					error;		// empty if the save worked
+		bool					done;
+	};
+
+			void		SaveWorker(save_job_t * job);
+
+	thread				mSaveThread;
+	mutex				mSaveLock;
+	save_job_t *		mSaveJob;
 };
 
 #endif
@@ -28,6 +28,8 @@
 #include "DSFLib.h"
 
 #include <string>
+#include <deque>
+#include <mutex>
 using std::string;
 
 #define ENUM_DOMAIN(D,H)		last_d = DOMAIN_Create(#D,H);
@@ -45,23 +47,29 @@ struct domain_Info {
 	int enum_end;		// Last enum + 1
 };
 
-static vector<enum_Info>				sEnums;				// For each enum N, string,
+// The library manager adds line and light types while a save may be reading the tables on its own thread,
+// so every access is under sEnumLock.  A deque, so the names handed out stay put when an enum gets added.
+static recursive_mutex					sEnumLock;
+static deque<enum_Info>					sEnums;				// For each enum N, string,
 static map<pair<int,string>, int>		sEnumsReverse;
 static map<int,domain_Info>				sDomains;
 
 bool				DOMAIN_Validate(int domain)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	return (domain >= 0 && domain < sEnums.size() && sEnums[domain].domain == -1);
 }
 
 const char *		DOMAIN_Name(int domain)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	if (!DOMAIN_Validate(domain)) return NULL;
 	return sEnums[domain].name.c_str();
 }
 
 const char *		DOMAIN_Desc(int domain)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	if (!DOMAIN_Validate(domain)) return NULL;
 	return sEnums[domain].desc.c_str();
 }
@@ -77,6 +85,7 @@ const char *		DOMAIN_Desc(int domain)
 
 int					DOMAIN_LookupDesc(const char * domain)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	string d(domain);
 	map<pair<int, string>, int>::iterator i = sEnumsReverse.find(pair<int,string>(-1,d));
 	if (i == sEnumsReverse.end())	return -1;
@@ -87,6 +96,7 @@ int					DOMAIN_LookupDesc(const char * domain)
 
 int					DOMAIN_Create(const char * domain, const char * desc)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	string d(domain);
 	map<pair<int,string>,int>::iterator i = sEnumsReverse.find(pair<int,string>(-1,d));
 	if (i != sEnumsReverse.end())
@@ -116,6 +126,7 @@ int					DOMAIN_Create(const char * domain, const char * desc)
 
 void				DOMAIN_Members(int domain, vector<int>& members)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	members.clear();
 	if (!DOMAIN_Validate(domain)) return;
 
@@ -128,6 +139,7 @@ void				DOMAIN_Members(int domain, vector<int>& members)
 
 void				DOMAIN_Members(int domain, set<int>& members)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	members.clear();
 	if (!DOMAIN_Validate(domain)) return;
 
@@ -140,6 +152,7 @@ void				DOMAIN_Members(int domain, set<int>& members)
 
 void				DOMAIN_Members(int domain, map<int, string>& members)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	members.clear();
 	if (!DOMAIN_Validate(domain)) return;
 
@@ -153,6 +166,7 @@ void				DOMAIN_Members(int domain, map<int, string>& members)
 
 int					ENUM_Create(int domain, const char * value, const char * desc, int export_value)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	if (!DOMAIN_Validate(domain))
 		AssertPrintf("Error: illegal domain %d registering %s\n",domain, value);
 	string v(value);
@@ -195,23 +209,27 @@ int					ENUM_Create(int domain, const char * value, const char * desc, int expor
 
 bool				ENUM_Validate(int value)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	return (value >= 0 && value < sEnums.size() && sEnums[value].domain != -1);
 }
 
 const char *		ENUM_Name(int value)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	if (!ENUM_Validate(value)) return NULL;
 	return sEnums[value].name.c_str();
 }
 
 int					ENUM_Export(int value)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	if (!ENUM_Validate(value)) return -1;
 	return sEnums[value].export_value;
 }
 
 int					ENUM_ExportSet(const set<int>& members)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	int r = 0;
 	for(set<int>::const_iterator m = members.begin(); m != members.end(); ++m)
 	{
@@ -232,6 +250,7 @@ int					ENUM_ExportSet(const set<int>& members)
 
 int					ENUM_LookupDesc(int domain, const char * value)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	string v(value);
 	map<pair<int,string>, int>::iterator i = sEnumsReverse.find(pair<int,string>(domain,v));
 	if (i == sEnumsReverse.end())	
@@ -247,18 +266,21 @@ int					ENUM_LookupDesc(int domain, const char * value)
 
 int					ENUM_Domain(int value)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	if (!ENUM_Validate(value)) return -1;
 	return sEnums[value].domain;
 }
 
 const char * ENUM_Desc(int value)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	if (!ENUM_Validate(value)) return NULL;
 	return sEnums[value].desc.c_str();
 }
 
 int					ENUM_Import(int domain, int export_value)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	if (!DOMAIN_Validate(domain)) return -1;
 
 	domain_Info * d = &sDomains[domain];
@@ -273,6 +295,7 @@ int					ENUM_Import(int domain, int export_value)
 
 void				ENUM_ImportSet(int domain, int export_value, set<int>& vals)
 {
+	lock_guard<recursive_mutex> lock(sEnumLock);
 	vals.clear();
 	if (!DOMAIN_Validate(domain)) return;
 
@@ -45,6 +45,22 @@ void	WED_FastBuffer::ReadBulk(char * inBuf, int inLength, bool inZip)
 {
 	mSource->ReadBulk(inBuf,inLength,inZip);
 }
+void	WED_FastBuffer::ReadSpan(short * outBuf, int inCount)
+{
+	mSource->ReadSpan(outBuf,inCount);
+}
+void	WED_FastBuffer::ReadSpan(int * outBuf, int inCount)
+{
+	mSource->ReadSpan(outBuf,inCount);
+}
+void	WED_FastBuffer::ReadSpan(float * outBuf, int inCount)
+{
+	mSource->ReadSpan(outBuf,inCount);
+}
+void	WED_FastBuffer::ReadSpan(double * outBuf, int inCount)
+{
+	mSource->ReadSpan(outBuf,inCount);
+}
 void	WED_FastBuffer::WriteShort(short x)
 {
 	mSource->WriteShort(x);
@@ -66,6 +82,23 @@ void	WED_FastBuffer::WriteBulk(const char * inBuf, int inLength, bool inZip)
 	mSource->WriteBulk(inBuf,inLength,inZip);
 }
 
+void	WED_FastBuffer::WriteSpan(const short * inBuf, int inCount)
+{
+	mSource->WriteSpan(inBuf,inCount);
+}
+void	WED_FastBuffer::WriteSpan(const int * inBuf, int inCount)
+{
+	mSource->WriteSpan(inBuf,inCount);
+}
+void	WED_FastBuffer::WriteSpan(const float * inBuf, int inCount)
+{
+	mSource->WriteSpan(inBuf,inCount);
+}
+void	WED_FastBuffer::WriteSpan(const double * inBuf, int inCount)
+{
+	mSource->WriteSpan(inBuf,inCount);
+}
+
 WED_FastBuffer::WED_FastBuffer(WED_Buffer * source)
 {
 	mSource = source;
@@ -47,7 +47,7 @@
 #include "IODefs.h"
 #include "WED_Buffer.h"
 
-class	WED_FastBuffer : public IOReader, public IOWriter {
+class	WED_FastBuffer final : public IOReader, public IOWriter {
 public:
 
 	virtual	void	ReadShort(short&);
@@ -55,12 +55,20 @@ public:
 	virtual	void	ReadFloat(float&);
 	virtual	void	ReadDouble(double&);
 	virtual	void	ReadBulk(char * inBuf, int inLength, bool inZip);
+	virtual	void	ReadSpan(short * outBuf, int inCount);
+	virtual	void	ReadSpan(int * outBuf, int inCount);
+	virtual	void	ReadSpan(float * outBuf, int inCount);
+	virtual	void	ReadSpan(double * outBuf, int inCount);
 
 	virtual	void	WriteShort(short);
 	virtual	void	WriteInt(int);
 	virtual	void	WriteFloat(float);
 	virtual	void	WriteDouble(double);
 	virtual	void	WriteBulk(const char * inBuf, int inLength, bool inZip);
+	virtual	void	WriteSpan(const short * inBuf, int inCount);
+	virtual	void	WriteSpan(const int * inBuf, int inCount);
+	virtual	void	WriteSpan(const float * inBuf, int inCount);
+	virtual	void	WriteSpan(const double * inBuf, int inCount);
 
 			void	ResetRead(void);
 
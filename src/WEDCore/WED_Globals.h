@@ -51,6 +51,8 @@ extern int gModeratorMode;
 extern int gFontSize;
 /* Switch format for orthophoto tiles export */
 extern int gOrthoExport;
+/* Export DSF tiles on all cores instead of one at a time */
+extern int gParallelExport;
 
 enum WED_Export_Target {
 		wet_xplane_900,		// X-Plane 9-compatible DSFs.
@@ -46,7 +46,8 @@ enum {
 	msg_SystemFolderChanged,
 	msg_SystemFolderUpdated,
 
-	msg_LibraryChanged
+	msg_LibraryChanged,
+	msg_ResourcesLoaded					// WED_ResourceMgr: background loads have been added to its cache
 
 #if WITHNWLINK
 	,msg_NetworkStatusInfo
@@ -32,6 +32,7 @@
 #include "MemFileUtils.h"
 #include "XObjReadWrite.h"
 #include "FileUtils.h"
+#include "PlatformUtils.h"
 #include "WED_PackageMgr.h"
 #include "CompGeomDefs2.h"
 #include "MathUtils.h"
@@ -40,6 +41,14 @@
 #include "DEMDefs.h"
 #include "WED_OrthoExport.h"
 
+#include <atomic>
+#include <algorithm>
+#if IBM
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 #if IBM
 #define DIR_CHAR '\\'
 #define DIR_STR "\\"
@@ -96,17 +105,29 @@ static void process_texture_path(const string& path_of_obj, string& path_of_tex)
 	path_of_tex = parent + ".bmp";
 }
 
-WED_ResourceMgr::WED_ResourceMgr(WED_LibraryMgr * in_library) : mLibrary(in_library)
+WED_ResourceMgr::WED_ResourceMgr(WED_LibraryMgr * in_library) : mLibrary(in_library),
+	mAsyncQuit(false), mAsyncSerial(0), mAsyncLoads(0)
 {
 }
 
 WED_ResourceMgr::~WED_ResourceMgr()
 {
+	AsyncStop();
 	Purge();
 }
 
 void	WED_ResourceMgr::Purge(void)
 {
+	{
+		lock_guard<mutex> lock(mAsyncLock);
+		for (auto& q : mAsyncQueue)
+			delete q.second;
+		mAsyncQueue.clear();
+	}
+	mAsyncPending.clear();			// so anything in flight gets thrown away when it arrives
+	mAsyncMissing.clear();
+	mAsyncWaiting.clear();
+
 	for(auto& i : mObj)
 		for(auto j : i.second)
 			delete j;
@@ -130,6 +151,20 @@ void	WED_ResourceMgr::Purge(void)
 
 void	WED_ResourceMgr::Purge(const string& vpath)
 {
+	auto p = mAsyncPending.find(vpath);
+	if (p != mAsyncPending.end())
+	{
+		lock_guard<mutex> lock(mAsyncLock);
+		auto q = mAsyncQueue.find(p->second);
+		if (q != mAsyncQueue.end())
+		{
+			delete q->second;
+			mAsyncQueue.erase(q);
+		}
+		mAsyncPending.erase(p);		// if a loader has it already, its result is dropped in TimerFired
+	}
+	mAsyncMissing.erase(vpath);
+	mAsyncWaiting.clear();			// a facade or .agp may have been waiting on what we just dropped
 	auto i = mObj.find(vpath);
 	if (i != mObj.end())
 	{
@@ -174,10 +209,196 @@ bool	WED_ResourceMgr::GetDem(const string& path, dem_info_t const*& info)
 }
 
 
+/* Parsed asset cache:
+   Parsing library OBJs from text is most of the time it takes to open a big airport, and it is the same few
+   thousand files every session. So each OBJ we parse is also dumped as an XObj8 binary image into the OS cache
+   folder, one file per asset, named by a hash of its absolute path. The entry header repeats the path plus the
+   source's mtime and size; an entry that doesn't match the file on disk any more is simply re-parsed and replaced.
+   An entry is read with a single MemFile_Open, i.e. one mmap.
+
+   The other asset types (.fac, .agp, .for, ...) are tiny text files whose cost is the OBJs they reference - and
+   those come through LoadObj and hit the cache as well.
+
+   The folder is capped at ASSET_CACHE_MAX_BYTES: once per session, before the first entry is used, the least
+   recently used entries are deleted until it is back under 3/4 of that, along with temp files that a crashed
+   writer left behind. An entry's mtime is its last use - a cache hit touches it - so what goes first is the
+   libraries no airport has loaded in a long time. Only .obj8 entries are counted and pruned; anything else
+   in the folder is left alone. */
+
+#define ASSET_CACHE_MAGIC	0x57414331		// 'WAC1'
+#define ASSET_CACHE_MAX_BYTES	(512LL << 20)
+
+struct asset_cache_hdr_t {
+	int					magic;
+	int					path_len;			// followed by the source path itself
+	long long			src_mtime;
+	long long			src_size;
+};
+
+static void asset_cache_prune(const string& dir)
+{
+	vector<string> files;
+	if (FILE_get_directory(dir, &files, nullptr) <= 0)
+		return;
+
+	struct entry_t { time_t mtime; long long size; string path; };
+	vector<entry_t> entries;
+	long long total = 0;
+	time_t now = time(nullptr);
+	for (auto& f : files)
+	{
+		struct stat meta;
+		string path = dir + DIR_STR + f;
+		if (FILE_get_file_meta_data(path, meta) != 0)
+			continue;
+		string ext = FILE_get_file_extension(f);
+		if (ext == "tmp")
+		{
+			if (now - meta.st_mtime > 24 * 60 * 60)		// another process could still be writing a recent one
+				FILE_delete_file(path.c_str(), false);
+			continue;
+		}
+		if (ext != "obj8")
+			continue;
+		entries.push_back({ meta.st_mtime, (long long) meta.st_size, path });
+		total += meta.st_size;
+	}
+	if (total <= ASSET_CACHE_MAX_BYTES)
+		return;
+
+	sort(entries.begin(), entries.end(), [](const entry_t& a, const entry_t& b) { return a.mtime < b.mtime; });
+	for (auto& e : entries)
+	{
+		if (total <= ASSET_CACHE_MAX_BYTES / 4 * 3)
+			break;
+		if (FILE_delete_file(e.path.c_str(), false) == 0)
+			total -= e.size;
+	}
+}
+
+static const string& asset_cache_dir(void)
+{
+	static string dir = [] {
+		string d = GetCacheFolder();
+		if (!d.empty())
+		{
+			d += DIR_STR "wed_asset_cache";
+			if (FILE_make_dir_exist(d.c_str()))
+				d.clear();
+			else
+				asset_cache_prune(d);
+		}
+		return d;
+	}();
+	return dir;
+}
+
+static string asset_cache_path(const string& abspath, const char * ext)
+{
+	if (asset_cache_dir().empty()) return string();
+	unsigned long long h = 14695981039346656037ULL;
+	for (auto c : abspath)
+		h = (h ^ (unsigned char) c) * 1099511628211ULL;
+	char name[32];
+	snprintf(name, sizeof(name), DIR_STR "%016llx%s", h, ext);
+	return asset_cache_dir() + name;
+}
+
+// Returns the payload of a valid entry for abspath in [out_begin, out_end), or nullptr if there is none.
+static MFMemFile * asset_cache_open(const string& cache_path, const string& abspath, const struct stat& src,
+									const char *& out_begin, const char *& out_end)
+{
+	MFMemFile * f = MemFile_Open(cache_path.c_str());
+	if (!f) return nullptr;
+
+	const char * p = MemFile_GetBegin(f);
+	const char * e = MemFile_GetEnd(f);
+	asset_cache_hdr_t hdr;
+	if ((size_t) (e - p) >= sizeof(hdr))
+	{
+		memcpy(&hdr, p, sizeof(hdr));
+		p += sizeof(hdr);
+		if (hdr.magic == ASSET_CACHE_MAGIC && hdr.src_mtime == (long long) src.st_mtime && hdr.src_size == (long long) src.st_size &&
+			hdr.path_len == (int) abspath.size() && e - p >= hdr.path_len && memcmp(p, abspath.data(), hdr.path_len) == 0)
+		{
+			out_begin = p + hdr.path_len;
+			out_end = e;
+			return f;
+		}
+	}
+	MemFile_Close(f);
+	return nullptr;
+}
+
+static void asset_cache_write(const string& cache_path, const string& abspath, const struct stat& src, const vector<char>& payload)
+{
+	asset_cache_hdr_t hdr;
+	hdr.magic = ASSET_CACHE_MAGIC;
+	hdr.path_len = abspath.size();
+	hdr.src_mtime = src.st_mtime;
+	hdr.src_size = src.st_size;
+
+	// Write aside and rename, so a reader never maps a half-written entry.  The temp name is unique to this
+	// process and write, as other WED instances or our own loader threads may be writing the same entry.
+	static atomic<unsigned> write_count(0);
+	char suffix[48];
+#if IBM
+	snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", (int) _getpid(), write_count++);
+#else
+	snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", (int) getpid(), write_count++);
+#endif
+	string tmp_path = cache_path + suffix;
+	FILE * fi = fopen(tmp_path.c_str(), "wb");
+	if (!fi) return;
+	bool ok = fwrite(&hdr, sizeof(hdr), 1, fi) == 1 &&
+			  fwrite(abspath.data(), 1, abspath.size(), fi) == abspath.size() &&
+			  (payload.empty() || fwrite(&payload[0], 1, payload.size(), fi) == payload.size());
+	ok = (fclose(fi) == 0) && ok;
+	if (ok)
+		ok = FILE_replace_file(tmp_path.c_str(), cache_path.c_str()) == 0;
+	if (!ok)
+		FILE_delete_file(tmp_path.c_str(), false);
+}
+
+static bool read_obj_cached(const string& abspath, XObj8& obj)
+{
+	struct stat src;
+	if (FILE_get_file_meta_data(abspath, src) != 0)
+		return XObj8Read(abspath.c_str(), obj);
+
+	string cache_path = asset_cache_path(abspath, ".obj8");
+	if (!cache_path.empty())
+	{
+		const char * b, * e;
+		if (MFMemFile * f = asset_cache_open(cache_path, abspath, src, b, e))
+		{
+			bool ok = XObj8ReadBinary(b, e, obj);
+			MemFile_Close(f);
+			if (ok)
+			{
+				FILE_touch_file(cache_path.c_str());	// mark it used, for asset_cache_prune
+				return true;
+			}
+			obj = XObj8();
+		}
+	}
+
+	if (!XObj8Read(abspath.c_str(), obj))
+		return false;
+
+	if (!cache_path.empty())
+	{
+		vector<char> payload;
+		XObj8WriteBinary(obj, payload);
+		asset_cache_write(cache_path, abspath, src, payload);
+	}
+	return true;
+}
+
 XObj8 * WED_ResourceMgr::LoadObj(const string& abspath)
 {
 	XObj8 * new_obj = new XObj8;
-	if(!XObj8Read(abspath.c_str(),*new_obj))
+	if(!read_obj_cached(abspath,*new_obj))
 	{
 		delete new_obj;
 		return nullptr;
@@ -227,6 +448,26 @@ bool	WED_ResourceMgr::GetObjRelative(const string& obj_path, const string& paren
 		}
 	}
 	/* Try if its a valid relative path */
+	string apath = RelativeObjPath(obj_path, parent_path);
+
+	auto i = mObj.find(apath);
+	if(i != mObj.end())
+	{
+		obj = i->second.front();
+		return true;
+	}
+
+//printf("GetObjRel trying via abspath '%s'\n", apath.c_str());
+	XObj8 * new_obj = LoadObj(apath);
+	if(!new_obj) return false;
+
+	mObj[apath].push_back(new_obj);  // store the thing under its absolute path name
+	obj = new_obj;
+	return true;
+}
+
+string	WED_ResourceMgr::RelativeObjPath(const string& obj_path, const string& parent_path)
+{
 	string apath = FILE_get_dir_name(mLibrary->GetResourcePath(parent_path)) + obj_path;
 
 	for (auto& a : apath)
@@ -236,21 +477,54 @@ bool	WED_ResourceMgr::GetObjRelative(const string& obj_path, const string& paren
 		if (a == '\\')
 #endif
 			a = DIR_CHAR;
+	return apath;
+}
+
+int		WED_ResourceMgr::GetObjRelativeAsync(const string& obj_path, const string& parent_path, XObj8 const *& obj)
+{
+	if(mLibrary->GetResourcePath(obj_path).size())
+	{
+		int r = GetObjAsync(obj_path, obj);
+		if(r != obj_Missing)
+			return r;
+	}
+	string apath = RelativeObjPath(obj_path, parent_path);
 
 	auto i = mObj.find(apath);
 	if(i != mObj.end())
 	{
 		obj = i->second.front();
-		return true;
+		return obj_Ready;
 	}
 
-//printf("GetObjRel trying via abspath '%s'\n", apath.c_str());
-	XObj8 * new_obj = LoadObj(apath);
-	if(!new_obj) return false;
+	int r = AsyncStatus(apath);
+	if(r < 0)
+	{
+		AsyncQueue(apath, 0, vector<string>(1, apath));
+		r = obj_Pending;
+	}
+	return r;
+}
 
-	mObj[apath].push_back(new_obj);  // store the thing under its absolute path name
-	obj = new_obj;
-	return true;
+// GetObjRelative or GetObjRelativeAsync, for the loaders of assets that reference OBJs.
+int		WED_ResourceMgr::LoadObjRelative(const string& obj_path, const string& parent_path, XObj8 const *& obj, bool async)
+{
+	if(async)
+		return GetObjRelativeAsync(obj_path, parent_path, obj);
+	return GetObjRelative(obj_path, parent_path, obj) ? obj_Ready : obj_Missing;
+}
+
+// True if an async load of vpath found OBJs still loading and none has finished since, so parsing it again
+// would find the same.
+bool	WED_ResourceMgr::AsyncWaiting(const string& vpath)
+{
+	auto w = mAsyncWaiting.find(vpath);
+	if(w == mAsyncWaiting.end())
+		return false;
+	if(w->second == mAsyncLoads)
+		return true;
+	mAsyncWaiting.erase(w);
+	return false;
 }
 
 bool	WED_ResourceMgr::GetObj(const string& vpath, XObj8 const *& obj, int variant)
@@ -295,6 +569,170 @@ bool	WED_ResourceMgr::GetObj(const string& vpath, XObj8 const *& obj, int varian
 	return true;
 }
 
+int		WED_ResourceMgr::GetObjAsync(const string& vpath, XObj8 const *& obj, int variant)
+{
+	if(toupper(vpath[vpath.size()-3]) != 'O') return obj_Missing;
+
+	auto i = mObj.find(vpath);
+	int first_needed = 0;
+	if(i != mObj.end())
+	{
+		if(variant < i->second.size())
+		{
+			obj = i->second[variant];
+			return obj_Ready;
+		}
+		else
+			first_needed = i->second.size();
+	}
+	int r = AsyncStatus(vpath);
+	if(r >= 0)
+		return r;
+
+	DebugAssert(variant < mLibrary->GetNumVariants(vpath));
+
+	vector<string> paths;
+	for (int v = first_needed; v <= variant; ++v)
+		paths.push_back(mLibrary->GetResourcePath(vpath,v));
+	AsyncQueue(vpath, first_needed, paths);
+	return obj_Pending;
+}
+
+// obj_Missing or obj_Pending if the loader already knows about key, -1 if it was never asked for it.
+int		WED_ResourceMgr::AsyncStatus(const string& key)
+{
+	if(mAsyncMissing.count(key))
+		return obj_Missing;
+
+	auto p = mAsyncPending.find(key);
+	if(p == mAsyncPending.end())
+		return -1;
+
+	// Still queued (not yet picked up by a loader)?  Then it was asked for again - move it to the front.
+	lock_guard<mutex> lock(mAsyncLock);
+	auto q = mAsyncQueue.find(p->second);
+	if(q != mAsyncQueue.end())
+	{
+		async_obj_t * job = q->second;
+		mAsyncQueue.erase(q);
+		p->second = job->serial = ++mAsyncSerial;
+		mAsyncQueue[p->second] = job;
+	}
+	return obj_Pending;
+}
+
+void	WED_ResourceMgr::AsyncQueue(const string& key, int first_variant, const vector<string>& paths)
+{
+	async_obj_t * job = new async_obj_t;
+	job->vpath = key;
+	job->first_variant = first_variant;
+	job->paths = paths;
+	job->serial = mAsyncPending[key] = ++mAsyncSerial;
+	{
+		lock_guard<mutex> lock(mAsyncLock);
+		mAsyncQueue[job->serial] = job;
+		if(mAsyncThreads.empty())
+		{
+			// Loading is mostly disk and parsing; a few threads are plenty and leave the UI thread a core.
+			int n = intlim(thread::hardware_concurrency() - 1, 1, 4);
+			for (int t = 0; t < n; ++t)
+				mAsyncThreads.push_back(thread(&WED_ResourceMgr::AsyncWorker, this));
+		}
+	}
+	mAsyncWake.notify_one();
+	Start(0.05);
+}
+
+void	WED_ResourceMgr::AsyncWorker(void)
+{
+	unique_lock<mutex> lock(mAsyncLock);
+	while(1)
+	{
+		mAsyncWake.wait(lock, [this] { return mAsyncQuit || !mAsyncQueue.empty(); });
+		if(mAsyncQuit)
+			return;
+		async_obj_t * job = mAsyncQueue.begin()->second;
+		mAsyncQueue.erase(mAsyncQueue.begin());
+		lock.unlock();
+
+		for (auto& p : job->paths)
+		{
+			XObj8 * o = p.empty() ? nullptr : LoadObj(p);
+			if(!o) break;
+			job->objs.push_back(o);
+		}
+
+		lock.lock();
+		mAsyncDone.push_back(job);
+	}
+}
+
+void	WED_ResourceMgr::AsyncStop(void)
+{
+	{
+		lock_guard<mutex> lock(mAsyncLock);
+		mAsyncQuit = true;
+	}
+	mAsyncWake.notify_all();
+	for (auto& t : mAsyncThreads)
+		t.join();
+	mAsyncThreads.clear();
+	Stop();
+
+	for (auto& q : mAsyncQueue)
+		delete q.second;
+	mAsyncQueue.clear();
+	for (auto j : mAsyncDone)
+	{
+		for (auto o : j->objs)
+			delete o;
+		delete j;
+	}
+	mAsyncDone.clear();
+}
+
+void	WED_ResourceMgr::TimerFired(void)
+{
+	vector<async_obj_t *> done;
+	{
+		lock_guard<mutex> lock(mAsyncLock);
+		done.swap(mAsyncDone);
+	}
+
+	bool arrived = false;
+	for (auto j : done)
+	{
+		auto p = mAsyncPending.find(j->vpath);
+		if(p != mAsyncPending.end() && p->second == j->serial)		// else it was purged while loading
+		{
+			mAsyncPending.erase(p);
+			arrived = true;									// a failed load changes what gets drawn, too
+			if(j->objs.size() < j->paths.size())
+				mAsyncMissing.insert(j->vpath);
+			if(!j->objs.empty())
+			{
+				auto& variants = mObj[j->vpath];
+				if(variants.size() == j->first_variant)		// else a synchronous GetObj got there first
+				{
+					variants.insert(variants.end(), j->objs.begin(), j->objs.end());
+					j->objs.clear();
+				}
+			}
+		}
+		for (auto o : j->objs)
+			delete o;
+		delete j;
+	}
+
+	if(mAsyncPending.empty())
+		Stop();
+	if(arrived)
+	{
+		++mAsyncLoads;
+		BroadcastMessage(msg_ResourcesLoaded, 0);
+	}
+}
+
 bool 	WED_ResourceMgr::SetPolUV(const string& path, Bbox2 box)
 {
 	auto i = mPol.find(path);
@@ -687,6 +1125,19 @@ void	WED_ResourceMgr::ReceiveMessage(
 }
 
 bool	WED_ResourceMgr::GetFac(const string& vpath, fac_info_t const *& info, int variant)
+{
+	return LoadFac(vpath, info, variant, false) == obj_Ready;
+}
+
+int		WED_ResourceMgr::GetFacAsync(const string& vpath, fac_info_t const *& info, int variant)
+{
+	return LoadFac(vpath, info, variant, true);
+}
+
+// The .fac itself is parsed right here - it is a small text file.  Its OBJs are what cost, so in async mode they
+// go through GetObjRelativeAsync, and if any is still loading the facade is thrown away again and we say pending.
+// It is parsed again once a background load has finished (see AsyncWaiting).
+int		WED_ResourceMgr::LoadFac(const string& vpath, fac_info_t const *& info, int variant, bool async)
 {
 	auto i = mFac.find(vpath);
 	int first_needed = 0;
@@ -695,11 +1146,14 @@ bool	WED_ResourceMgr::GetFac(const string& vpath, fac_info_t const *& info, int
 		if(variant < i->second.size())
 		{
 			info = &i->second[variant];
-			return true;
+			return obj_Ready;
 		}
 		else
 			first_needed = i->second.size();
 	}
+	if(async && AsyncWaiting(vpath))
+		return obj_Pending;
+	bool pending = false;
 
 	DebugAssert(variant < mLibrary->GetNumVariants(vpath));
 
@@ -708,7 +1162,7 @@ bool	WED_ResourceMgr::GetFac(const string& vpath, fac_info_t const *& info, int
 		string p = mLibrary->GetResourcePath(vpath, v);
 
 		MFMemFile * file = MemFile_Open(p.c_str());
-		if(!file) return false;
+		if(!file) return obj_Missing;
 
 		MFScanner	s;
 		MFS_init(&s, file);
@@ -718,7 +1172,7 @@ bool	WED_ResourceMgr::GetFac(const string& vpath, fac_info_t const *& info, int
 		{
 			LOG_MSG("E/RES unsupported version or header in %s\n", p.c_str());
 			MemFile_Close(file);
-			return false;
+			return obj_Missing;
 		}
 
 		mFac[vpath].push_back(fac_info_t());
@@ -1199,8 +1653,11 @@ bool	WED_ResourceMgr::GetFac(const string& vpath, fac_info_t const *& info, int
 			{                                             // We do at times load EVERY facade just to find out which are custom jetways
 				const XObj8 * o;
 				fac->xobjs.push_back(nullptr);
-				if(GetObjRelative(obj_nam, vpath, o))
+				int r = LoadObjRelative(obj_nam, vpath, o, async);
+				if(r == obj_Ready)
 					fac->xobjs.back() = o;
+				else if(r == obj_Pending)
+					pending = true;
 				else
 					LOG_MSG("E/Fac can not load object %s in %s\n", obj_nam.c_str(), p.c_str());
 
@@ -1215,7 +1672,10 @@ bool	WED_ResourceMgr::GetFac(const string& vpath, fac_info_t const *& info, int
 				else
 					for (auto& t : fac->tunnels)
 					{
-						if(!GetObjRelative(t.obj, vpath, t.o))
+						int r = LoadObjRelative(t.obj, vpath, t.o, async);
+						if(r == obj_Pending)
+							pending = true;
+						else if(r == obj_Missing)
 							LOG_MSG("E/Fac can not load jetway %s in %s\n", t.obj.c_str(), p.c_str());
 					}
 			}
@@ -1230,7 +1690,17 @@ bool	WED_ResourceMgr::GetFac(const string& vpath, fac_info_t const *& info, int
 		}
 		height_desc_for_facade(*fac, fac->h_range);
 	}
-	return true;
+	if(pending)
+	{
+		auto& variants = mFac[vpath];
+		variants.erase(variants.begin() + first_needed, variants.end());
+		if(variants.empty())
+			mFac.erase(vpath);
+		info = nullptr;
+		mAsyncWaiting[vpath] = mAsyncLoads;
+		return obj_Pending;
+	}
+	return obj_Ready;
 }
 
 inline void	do_rotate(int n, float& io_x, float& io_y)
@@ -1558,8 +2028,10 @@ bool	WED_ResourceMgr::GetFor(const string& path, for_info_t const *& info)
 	return true;
 }
 
-void WED_ResourceMgr::setup_tile(agp_t::tile_t * agp, int rotation, const string& path)
+// Returns false if, in async mode, an OBJ or facade of the tile is still loading.
+bool WED_ResourceMgr::setup_tile(agp_t::tile_t * agp, int rotation, const string& path, bool async)
 {
+	bool ready = true;
 	for(int n = 0; n < agp->tile.size(); n += 4)
 	{
 		agp->tile[n  ] -= agp->anchor_x;
@@ -1598,7 +2070,13 @@ void WED_ResourceMgr::setup_tile(agp_t::tile_t * agp, int rotation, const string
 	while(o != agp->objs.end())
 	{
 		const XObj8 * oo;
-		if(GetObjRelative(o->name, path, oo))
+		int r = LoadObjRelative(o->name, path, oo, async);
+		if(r == obj_Pending)
+		{
+			ready = false;
+			o++;
+		}
+		else if(r == obj_Ready)
 		{
 			o->obj = oo;
 			if (fabs(o->r-180.0) < 45.0)  // account for rotation, very roughly only
@@ -1644,7 +2122,13 @@ void WED_ResourceMgr::setup_tile(agp_t::tile_t * agp, int rotation, const string
 	while (f != agp->facs.end())
 	{
 		const fac_info_t * fac;
-		if(GetFac(f->name, fac))                // doesn't take rpaths, only vpaths
+		int r = LoadFac(f->name, fac, 0, async);	// doesn't take rpaths, only vpaths
+		if(r == obj_Pending)
+		{
+			ready = false;
+			f++;
+		}
+		else if(r == obj_Ready)
 		{
 			f->fac = fac;
 /*			for (auto& l : f->locs)
@@ -1664,20 +2148,35 @@ void WED_ResourceMgr::setup_tile(agp_t::tile_t * agp, int rotation, const string
 			LOG_MSG("E/Agp can not load facade %s in %s\n", f->name.c_str(), path.c_str());
 		}
 	}
+	return ready;
 }
 
 bool	WED_ResourceMgr::GetAGP(const string& path, agp_t const *& info)
+{
+	return LoadAGP(path, info, false) == obj_Ready;
+}
+
+int		WED_ResourceMgr::GetAGPAsync(const string& path, agp_t const *& info)
+{
+	return LoadAGP(path, info, true);
+}
+
+// Like LoadFac: in async mode the .agp is dropped again, and we say pending, while any OBJ or facade it
+// places is still loading.
+int		WED_ResourceMgr::LoadAGP(const string& path, agp_t const *& info, bool async)
 {
 	auto i = mAGP.find(path);
 	if(i != mAGP.end())
 	{
 		info = &i->second;
-		return true;
+		return obj_Ready;
 	}
+	if(async && AsyncWaiting(path))
+		return obj_Pending;
 
 	string p = mLibrary->GetResourcePath(path);
 	MFMemFile * file = MemFile_Open(p.c_str());
-	if(!file) return false;
+	if(!file) return obj_Missing;
 
 	MFScanner	s;
 	MFS_init(&s, file);
@@ -1693,10 +2192,11 @@ bool	WED_ResourceMgr::GetAGP(const string& path, agp_t const *& info)
 	{
 		LOG_MSG("E/RES unsupported version or header in %s\n", p.c_str());
 		MemFile_Close(file);
-		return false;
+		return obj_Missing;
 	}
 
 	agp_t * agp = &mAGP[path];
+	bool ready = true;
 	info = agp;
 
 	double tex_s = 1.0, tex_t = 1.0;		// these scale from pixels to UV coords
@@ -1769,7 +2269,7 @@ bool	WED_ResourceMgr::GetAGP(const string& path, agp_t const *& info)
 		}
 		else if(MFS_string_match(&s,"TILE",false))
 		{
-			if(ti) setup_tile(ti, rotation, path);
+			if(ti && !setup_tile(ti, rotation, path, async)) ready = false;
 			agp->tiles.push_back(agp_t::tile_t());
 			ti = &agp->tiles.back();
 			ti->id = last_id;
@@ -1984,10 +2484,18 @@ bool	WED_ResourceMgr::GetAGP(const string& path, agp_t const *& info)
 			MFS_string_eol(&s,NULL);
 	}
 	for(auto& t : agp->tiles)
-		setup_tile(&t, rotation, path);
+		if(!setup_tile(&t, rotation, path, async))
+			ready = false;
 
 	MemFile_Close(file);
-	return true;
+	if(!ready)
+	{
+		mAGP.erase(path);
+		info = nullptr;
+		mAsyncWaiting[path] = mAsyncLoads;
+		return obj_Pending;
+	}
+	return obj_Ready;
 }
 
 #if ROAD_EDITING
@@ -42,6 +42,16 @@
 	it's also definitely not very dangerous at this point in the code's development - that is, WED is not so big that this
 	represents a scalability issue.
 
+	BACKGROUND LOADING
+
+	The Get* calls load synchronously.  Draw code that would rather not stall can use GetObjAsync: it returns what we
+	have, or queues the object for a small pool of loader threads and says "pending".  GetFacAsync and GetAGPAsync do
+	the same for facades and .agps: their own text is parsed on the spot, but until every OBJ they use has arrived they
+	are not kept and say "pending" too.  Only the OBJ parsing happens on those threads - the library lookups happen at
+	request time and results are moved into the cache on the main thread, from a timer, which then broadcasts
+	msg_ResourcesLoaded so the map can redraw.  Purge drops any queued or
+	in-flight loads for what it purges, so a stale parse can never land after it.  The queue is newest-first, and
+	re-requesting a queued object moves it to the front, so what is on screen right now loads first.
 */
 
 #include "GUI_Listener.h"
@@ -50,7 +60,12 @@
 #include "XObjDefs.h"
 #include "DEMDefs.h"
 #include "CompGeomDefs2.h"
+#include "GUI_Timer.h"
 #include <list>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_set>
 
 class	WED_LibraryMgr;
 typedef struct DEMGeo dem_info_t;
@@ -261,9 +276,11 @@ class WED_JWFacades
 		string	find(WED_LibraryMgr* lmgr, WED_ResourceMgr* rmgr, const string& tunnel_vpath);
 };
 
-class WED_ResourceMgr : public GUI_Broadcaster, public GUI_Listener, public virtual IBase {
+class WED_ResourceMgr : public GUI_Broadcaster, public GUI_Listener, public GUI_Timer, public virtual IBase {
 public:
 
+	enum { obj_Ready, obj_Pending, obj_Missing };
+
 					 WED_ResourceMgr(WED_LibraryMgr * in_library);
 					~WED_ResourceMgr();
 
@@ -271,6 +288,7 @@ public:
 			void	Purge(const string& vpath);
 
 			bool	GetFac(const string& vpath, fac_info_t const *& info, int variant =0);
+			int		GetFacAsync(const string& vpath, fac_info_t const *& info, int variant = 0);	// obj_Ready, obj_Pending or obj_Missing
 			bool	GetPol(const string& path, pol_info_t const *& info);
 			bool 	SetPolUV(const string& path, Bbox2 box);
 			bool	GetLin(const string& path, lin_info_t const *& info);
@@ -280,8 +298,14 @@ public:
 
 			void	WritePol(const string& abspath, const pol_info_t& out_info); // side note: shouldn't this be in_info?
 			bool	GetObj(const string& path, XObj8 const *& obj, int variant = 0);
+			int		GetObjAsync(const string& path, XObj8 const *& obj, int variant = 0);	// obj_Ready, obj_Pending or obj_Missing
 			bool	GetObjRelative(const string& obj_path, const string& parent_path, XObj8 const *& obj);
+			int		GetObjRelativeAsync(const string& obj_path, const string& parent_path, XObj8 const *& obj);
+			// Goes up by one every time background loads finish (along with msg_ResourcesLoaded), so anything
+			// that made do with a guess while an OBJ was pending can tell when to look again.
+			int		GetLoadCount(void) const { return mAsyncLoads; }
 			bool	GetAGP(const string& path, agp_t const *& info);
+			int		GetAGPAsync(const string& path, agp_t const *& info);	// obj_Ready, obj_Pending or obj_Missing
 			bool	GetRoad(const string& path, const road_info_t *& out_info);
 			bool	GetDem(const string& path, dem_info_t const*& info);
 
@@ -289,12 +313,16 @@ public:
 							GUI_Broadcaster *		inSrc,
 							intptr_t				inMsg,
 							intptr_t				inParam);
+	virtual	void	TimerFired(void);
 
 			string	GetJetwayVpath(const string& tunnel_vpath);
 private:
 
-			XObj8 * LoadObj(const string& abspath);
-			void    setup_tile(agp_t::tile_t * agp, int rotation, const string& path);
+	static	XObj8 * LoadObj(const string& abspath);
+			int		LoadObjRelative(const string& obj_path, const string& parent_path, XObj8 const *& obj, bool async);
+			int		LoadFac(const string& vpath, fac_info_t const *& info, int variant, bool async);
+			int		LoadAGP(const string& path, agp_t const *& info, bool async);
+			bool    setup_tile(agp_t::tile_t * agp, int rotation, const string& path, bool async);
 
 	unordered_map<string,vector<fac_info_t> > mFac;
 	unordered_map<string,pol_info_t>		mPol;
@@ -309,6 +337,35 @@ private:
 #endif
 	WED_LibraryMgr *				mLibrary;
 	WED_JWFacades					mJetways;
+
+	// Background OBJ loading.  mAsyncQueue and mAsyncDone are shared with the loader threads under mAsyncLock,
+	// everything else is main-thread only.
+	struct async_obj_t {
+		string				vpath;			// or the absolute path of an OBJ that another asset references relative to itself
+		int					first_variant;	// paths[0] is this variant
+		vector<string>		paths;
+		vector<XObj8 *>		objs;			// filled by the loader, stops at the first failure
+		unsigned long long	serial;			// results are only taken if mAsyncPending still lists this serial for vpath
+	};
+
+			int		AsyncStatus(const string& key);
+			void	AsyncQueue(const string& key, int first_variant, const vector<string>& paths);
+			void	AsyncWorker(void);
+			void	AsyncStop(void);
+			bool	AsyncWaiting(const string& vpath);
+			string	RelativeObjPath(const string& obj_path, const string& parent_path);
+
+	mutex											mAsyncLock;
+	condition_variable								mAsyncWake;
+	map<unsigned long long, async_obj_t *, greater<unsigned long long> > mAsyncQueue;	// by request serial, newest first
+	vector<async_obj_t *>							mAsyncDone;
+	bool											mAsyncQuit;
+	vector<thread>									mAsyncThreads;
+	unordered_map<string, unsigned long long>		mAsyncPending;	// vpath -> serial it was queued under
+	unordered_set<string>							mAsyncMissing;	// failed background loads, so we don't retry every frame
+	unordered_map<string, int>						mAsyncWaiting;	// .fac/.agp whose OBJs were loading -> mAsyncLoads at the time
+	unsigned long long								mAsyncSerial;
+	int												mAsyncLoads;
 };
 
 #endif /* WED_ResourceMgr_H */
@@ -2175,8 +2175,40 @@ MFMemFile * ReadCIFP()
 }
 
 
+// All CIFP runway ends, by upper case ICAO.  Built once per validation run - scanning the whole CIFP file for
+// every airport made validating thousands of airports O(airports x CIFP size).
+typedef hash_map<string, vector<pair<int, Point3> > >	CIFP_index_t;		// icao -> (runway enum, (lon, lat, displacement))
+
+static void IndexCIFP(MFMemFile * mf, CIFP_index_t& idx)
+{
+	MFScanner	s;
+	MFS_init(&s, mf);
+	MFS_string_eol(&s,NULL);    // skip first line, so Tyler can put a comment/version in there
+
+	while(!MFS_done(&s))
+	{
+		string icao, rnam;
+		MFS_string(&s,&icao);
+		if(!icao.empty())
+		{
+			MFS_string(&s,&rnam);
+			double lat = MFS_double(&s);
+			double lon = MFS_double(&s);
+			double disp= MFS_double(&s);
+
+			int rwy_enum=ENUM_LookupDesc(ATCRunwayOneway,rnam.c_str());
+			if (rwy_enum != atc_rwy_None)
+			{
+				::transform(icao.begin(), icao.end(), icao.begin(), ::toupper);
+				idx[icao].push_back(make_pair(rwy_enum, Point3(lon,lat,disp)));
+			}
+		}
+		MFS_string_eol(&s,NULL);
+	}
+}
+
 static void ValidateCIFP(const vector<WED_Runway *>& runways, const vector<WED_Sealane *>& sealanes, const set<int>& legal_rwy_oneway,
-				MFMemFile * mf, validation_error_vector& msgs, WED_Airport* apt)
+				const CIFP_index_t * cifp, validation_error_vector& msgs, WED_Airport* apt)
 {
 		map<int,Point3> CIFP_rwys;
 		set<int> rwys_missing;
@@ -2194,31 +2226,16 @@ static void ValidateCIFP(const vector<WED_Runway *>& runways, const vector<WED_S
 		if (icao.empty())
 			apt->GetICAO(icao);
 
-		if (mf)
+		if (cifp)
 		{
-			MFScanner	s;
-			MFS_init(&s, mf);
-			MFS_string_eol(&s,NULL);    // skip first line, so Tyler can put a comment/version in there
-
-			while(!MFS_done(&s))        // build a list of all runways CIFP dats knows about at this airport
-			{
-				if(MFS_string_match_no_case(&s,icao.c_str(),false))
+			::transform(icao.begin(), icao.end(), icao.begin(), ::toupper);
+			auto apt_rwys = cifp->find(icao);
+			if(apt_rwys != cifp->end())
+				for(const auto& r : apt_rwys->second)        // build a list of all runways CIFP dats knows about at this airport
 				{
-					string rnam;
-					MFS_string(&s,&rnam);
-					double lat = MFS_double(&s);
-					double lon = MFS_double(&s);
-					double disp= MFS_double(&s);
-
-					int rwy_enum=ENUM_LookupDesc(ATCRunwayOneway,rnam.c_str());
-					if (rwy_enum != atc_rwy_None)
-					{
-						CIFP_rwys[rwy_enum]=Point3(lon,lat,disp);
-						rwys_missing.insert(rwy_enum);
-					}
+					CIFP_rwys[r.first] = r.second;
+					rwys_missing.insert(r.first);
 				}
-				MFS_string_eol(&s,NULL);
-			}
 		}
 		// first check: all runway present at current airport
 
@@ -2607,7 +2624,7 @@ for (auto o : objs)
 #pragma mark -
 //------------------------------------------------------------------------------------------------------------------------------------
 
-static void ValidateOneAirport(WED_Airport* apt, validation_error_vector& msgs, WED_LibraryMgr* lib_mgr, MFMemFile * mf)
+static void ValidateOneAirport(WED_Airport* apt, validation_error_vector& msgs, WED_LibraryMgr* lib_mgr, const CIFP_index_t * cifp)
 {
 	vector<WED_Runway *>			runways;
 	vector<WED_Helipad *>			helipads;
@@ -2981,8 +2998,8 @@ static void ValidateOneAirport(WED_Airport* apt, validation_error_vector& msgs,
 		if(!orthos_illegal.empty())
 			msgs.push_back(validation_error_t("Only Orthophotos with automatic subtexture selection can be exported to the Gateway. Please hide or remove selected Orthophotos.",
 						err_gateway_orthophoto_cannot_be_exported, orthos_illegal, apt));
-		if(mf)
-			ValidateCIFP(runways, sealanes, legal_rwy_oneway, mf, msgs, apt);
+		if(cifp)
+			ValidateCIFP(runways, sealanes, legal_rwy_oneway, cifp, msgs, apt);
 
 		if (!roads.empty())
 			ValidateRoads(roads, msgs, apt, apt_bounds);
@@ -3012,15 +3029,21 @@ validation_result_t	WED_ValidateApt(WED_Document * resolver, WED_MapPane * pane,
 	CollectRecursive(wrl, back_inserter(apts), WED_Airport::sClass);
 
 	// get data about runways from CIFP data
-	MFMemFile * mf = nullptr;
-	if(gExportTarget == wet_gateway)
-		mf = ReadCIFP();
+	CIFP_index_t	cifp;
+	bool			has_cifp = false;
+	if(gExportTarget == wet_gateway && !apts.empty())
+		if(MFMemFile * mf = ReadCIFP())
+		{
+			IndexCIFP(mf, cifp);
+			MemFile_Close(mf);
+			has_cifp = true;
+		}
 
 #if 0 // DEV
 	auto t0 = std::chrono::high_resolution_clock::now();
 #endif
 	for(auto a : apts)
-		ValidateOneAirport(a, msgs, lib_mgr, mf);
+		ValidateOneAirport(a, msgs, lib_mgr, has_cifp ? &cifp : nullptr);
 
 	vector<WED_RoadEdge*> off_airport_roads;
 
@@ -3065,7 +3088,6 @@ validation_result_t	WED_ValidateApt(WED_Document * resolver, WED_MapPane * pane,
 	char c[50]; snprintf(c, 50, "Validation time was %.3lf s.", elapsed.count());
 	msgs.push_back(validation_error_t(c, warn_airport_impossible_size, wrl, nullptr));
 #endif
-	if (mf) MemFile_Close(mf);
 
 	string logfile(gPackageMgr->ComputePath(lib_mgr->GetLocalPackage(), "validation_report.txt"));
 	FILE * fi = fopen(logfile.c_str(), "w");
@@ -95,7 +95,7 @@ void	WED_Entity::CacheInval(int flags)
 		{
 			WED_Entity * e = dynamic_cast<WED_Entity *>(p);
 			if (e)
-				e->CacheInval(new_invals);
+				e->ChildCacheInval(this, new_invals);
 		}
 		set<WED_Thing *>	viewers;
 		GetAllViewers(viewers);
@@ -108,10 +108,16 @@ void	WED_Entity::CacheInval(int flags)
 	}
 }
 
+void	WED_Entity::ChildCacheInval(WED_Entity * child, int flags)
+{
+	CacheInval(flags);
+}
+
 int	WED_Entity::CacheBuild(int flags) const
 {
 	int needed_flags = flags & ~cache_valid_;
-	cache_valid_ |= needed_flags;
+	if (needed_flags)						// never write to a valid cache - the DSF export reads warm entities from several threads
+		cache_valid_ |= needed_flags;
 	return needed_flags;
 }
 
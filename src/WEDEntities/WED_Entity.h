@@ -122,6 +122,7 @@ protected:
 
 			void	CacheInval(int flags);				// Invalidate the cache.
 			int		CacheBuild(int flags) const;		// Set cache to valid.  Returns true if cache needed rebuilding
+	virtual	void	ChildCacheInval(WED_Entity * child, int flags);	// A child passes its invalidation up.  Default is a plain CacheInval.
 
 	virtual	void	AddChild(int id, int n);
 	virtual	void	RemoveChild(int id);
@@ -853,7 +853,7 @@ void draw_facade(ITexMgr * tman, WED_ResourceMgr * rman, const string& vpath, co
 					if(!s.base_obj.empty())
 					{
 						const XObj8 * oo;
-						if(rman->GetObjRelative(s.base_obj, vpath, oo))
+						if(rman->GetObjRelativeAsync(s.base_obj, vpath, oo) == WED_ResourceMgr::obj_Ready)
 						{
 							draw_obj_at_xyz(tman, oo,
 								scpOrig.x(), 0.0, scpOrig.y(), facRot + s.base_xzr[2], g);
@@ -862,7 +862,7 @@ void draw_facade(ITexMgr * tman, WED_ResourceMgr * rman, const string& vpath, co
 					if(!s.towr_obj.empty())
 					{
 						const XObj8 * oo;
-						if(rman->GetObjRelative(s.towr_obj, vpath, oo))
+						if(rman->GetObjRelativeAsync(s.towr_obj, vpath, oo) == WED_ResourceMgr::obj_Ready)
 						{
 							draw_obj_at_xyz(tman, oo,
 								scpOrig.x(), scpAGL, scpOrig.y(), facRot + s.towr_xzr[2], g);
@@ -23,9 +23,11 @@
 
 #include "WED_GISComposite.h"
 
+#define INDEX_MIN_ENTITIES	64		// below this a plain walk over all entities is just as fast
+
 TRIVIAL_COPY(WED_GISComposite, WED_Entity)
 
-WED_GISComposite::WED_GISComposite(WED_Archive * a, int i) : WED_Entity(a,i)
+WED_GISComposite::WED_GISComposite(WED_Archive * a, int i) : WED_Entity(a,i), mIndexValid(false)
 {
 }
 
@@ -182,6 +184,11 @@ void	WED_GISComposite::RebuildCache(int flags) const
 {
 	if(flags & cache_Topological)
 	{
+		// Any change of a child invalidates our topology as well, so only drop the index if the entities really changed.
+		vector<IGISEntity *> old_entities;
+		if(mIndexValid)
+			old_entities.swap(mEntities);
+
 		mEntities.clear();
 		int n = CountChildren();
 		mHasUV = (n > 0);
@@ -196,6 +203,8 @@ void	WED_GISComposite::RebuildCache(int flags) const
 				mEntities.push_back(ent);
 			}
 		}
+		if(mIndexValid && mEntities != old_entities)
+			mIndexValid = false;
 	}
 
 	if(flags & cache_Spatial)
@@ -221,3 +230,71 @@ void	WED_GISComposite::RebuildCache(int flags) const
 		}
 	}		
 }
+
+bool	WED_GISComposite::GetEntitiesNear(const Bbox2& bounds, vector<int>& out_idx) const
+{
+	RebuildCache(CacheBuild(cache_Topological));
+	int n = mEntities.size();
+	if (n < INDEX_MIN_ENTITIES)
+		return false;
+
+	if (!mIndexValid || mIndexDirty.size() > (size_t) max(32, n / 16))
+		RebuildIndex();
+
+	out_idx.clear();
+	mIndex.query_value(bounds, back_inserter(out_idx));
+	if (!mIndexDirty.empty())
+	{
+		// We don't know where these are now - so they are always near. The duplicates are their old index entries.
+		out_idx.insert(out_idx.end(), mIndexDirty.begin(), mIndexDirty.end());
+		sort(out_idx.begin(), out_idx.end());
+		out_idx.erase(unique(out_idx.begin(), out_idx.end()), out_idx.end());
+	}
+	else
+		sort(out_idx.begin(), out_idx.end());
+	return true;
+}
+
+void	WED_GISComposite::RebuildIndex(void) const
+{
+	int n = mEntities.size();
+	vector<pair<Bbox2, int> > items;
+	items.reserve(n);
+	mIndexSlot.clear();
+	mIndexDirty.clear();
+	mIndexIsDirty.assign(n, 0);
+
+	for (int i = 0; i < n; ++i)
+	{
+		Bbox2 b;
+		mEntities[i]->GetBounds(gis_Geo, b);		// also re-arms the child's cache, so its next change is reported to us
+		b.expand(GLOBAL_WED_ART_ASSET_FUDGE_FACTOR);
+		items.push_back(make_pair(b, i));
+
+		if (WED_Entity * e = dynamic_cast<WED_Entity *>(mEntities[i]))
+			mIndexSlot[e] = i;
+		else
+		{
+			mIndexIsDirty[i] = 1;					// can't hear about its changes, so never trust its index entry
+			mIndexDirty.push_back(i);
+		}
+	}
+	mIndex.insert(items.begin(), items.end());
+	mIndexValid = true;
+}
+
+void	WED_GISComposite::ChildCacheInval(WED_Entity * child, int flags)
+{
+	if (mIndexValid && (flags & cache_Spatial))
+	{
+		auto i = mIndexSlot.find(child);
+		if (i == mIndexSlot.end())
+			mIndexValid = false;
+		else if (!mIndexIsDirty[i->second])
+		{
+			mIndexIsDirty[i->second] = 1;
+			mIndexDirty.push_back(i->second);
+		}
+	}
+	WED_Entity::ChildCacheInval(child, flags);
+}
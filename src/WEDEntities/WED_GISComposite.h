@@ -26,6 +26,7 @@
 
 #include "WED_Entity.h"
 #include "IGIS.h"
+#include "RTree2.h"
 
 class	WED_GISComposite : public WED_Entity, public virtual IGISComposite {
 
@@ -49,15 +50,33 @@ public:
 	virtual	int				GetNumEntities(void ) const;
 	virtual	IGISEntity *	GetNthEntity  (int n) const;
 
+	// Spatial index over our entities, for the map's drawing and hit testing.  Returns false if we are too small to have
+	// one - then the caller should simply look at all entities.  Otherwise out_idx are the ascending indices of all entities
+	// that may overlap bounds, i.e. those whose bounds grown by GLOBAL_WED_ART_ASSET_FUDGE_FACTOR do, same as Cull() assumes.
+			bool			GetEntitiesNear(const Bbox2& bounds, vector<int>& out_idx) const;
+
+protected:
+
+	virtual	void			ChildCacheInval(WED_Entity * child, int flags);
+
 private:
 
 			void			RebuildCache(int flags) const;
+			void			RebuildIndex(void) const;
 
 	mutable	Bbox2					mCacheBounds;
 	mutable	Bbox2					mCacheBoundsUV;
 	mutable	bool					mHasUV;
 	mutable	vector<IGISEntity *>	mEntities;
 
+	// The index is kept across edits: an entity whose bounds change is only flagged and then always reported as near,
+	// until enough have piled up to make a rebuild worth it.  A change to the list of entities drops the index.
+	mutable	RTree2<int, 16>			mIndex;
+	mutable	bool					mIndexValid;
+	mutable	unordered_map<const WED_Entity *, int>	mIndexSlot;		// entity -> its index in mEntities
+	mutable	vector<int>				mIndexDirty;
+	mutable	vector<char>			mIndexIsDirty;
+
 };
 
 #endif
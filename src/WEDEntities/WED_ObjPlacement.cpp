@@ -39,7 +39,8 @@ WED_ObjPlacement::WED_ObjPlacement(WED_Archive * a, int i) :
 	msl    (this,PROP_Name("Elevation",     XML_Name("obj_placement","msl")), 0, 5, 3),
 	resource  (this,PROP_Name("Resource",  XML_Name("obj_placement","resource")),""),
 	show_level(this,PROP_Name("Show with", XML_Name("obj_placement","show_level")), ShowLevel, show_Level1),
-	visibleWithinDeg(-1.0)
+	visibleWithinDeg(-1.0),
+	visibleGuessedAt(-1)
 {
 }
 
@@ -66,6 +67,7 @@ void		WED_ObjPlacement::SetResource(const string& r)
 {
 	resource = r;
 	visibleWithinDeg = -1.0; // force re-evaluation when object is changed
+	visibleGuessedAt = -1;
 }
 
 void		WED_ObjPlacement::SetHeading(double h)
@@ -143,12 +145,18 @@ double 	WED_ObjPlacement::GetVisibleDeg(void) const
 {
 	// caching the objects dimension here for off-display culling in the map view. Its disregarding object rotation
 	// and any lattitude dependency in the conversion, so the value will be choosen sufficiently pessimistic.
+	// This runs for every object on every map redraw, so it must never wait for an OBJ to be parsed. While the OBJ
+	// is loading in the background we go with the rule of thumb, and look again once the resource manager says
+	// more OBJs have arrived (that is when it sends msg_ResourcesLoaded and the map redraws).
 #if WED
-	if(visibleWithinDeg < 0.0)                            // so we only do this once for each object, ever
+	if(visibleWithinDeg < 0.0 || visibleGuessedAt >= 0)   // once per object - unless we had to guess
 	{
+		WED_ResourceMgr * rmgr = WED_GetResourceMgr(GetArchive()->GetResolver());
+		if(visibleWithinDeg >= 0.0 && (!rmgr || rmgr->GetLoadCount() == visibleGuessedAt))
+			return visibleWithinDeg;                      // nothing new arrived yet
 		visibleWithinDeg = GLOBAL_WED_ART_ASSET_FUDGE_FACTOR;           // the old, brain-dead visibility rule of thumb
 		visibleWithinMeters = 10.0;                       // just a wild guess
-		WED_ResourceMgr * rmgr = WED_GetResourceMgr(GetArchive()->GetResolver());
+		visibleGuessedAt = -1;
 		if(rmgr)
 		{
 			const XObj8 * o;
@@ -158,7 +166,8 @@ double 	WED_ObjPlacement::GetVisibleDeg(void) const
 			double mtr_to_lon = MTR_TO_DEG_LAT / cos(my_loc.y() * DEG_TO_RAD);
 
 //			int n = GetNumVariants(resource.value);   // no need to cycle through these - only the first variant is used for preview
-			if (rmgr->GetObj(resource.value, o))
+			int obj_state = rmgr->GetObjAsync(resource.value, o);
+			if (obj_state == WED_ResourceMgr::obj_Ready)
 			{
 				visibleWithinDeg = pythag(max(fabs(o->xyz_max[0]), fabs(o->xyz_min[0])), max(fabs(o->xyz_max[2]), fabs(o->xyz_min[2]))) * 1.2 * mtr_to_lon;
 				visibleWithinMeters = pythag(
@@ -166,6 +175,8 @@ double 	WED_ObjPlacement::GetVisibleDeg(void) const
 					max(fabs(o->xyz_max[1]), fabs(o->xyz_min[1])),
 					max(fabs(o->xyz_max[2]), fabs(o->xyz_min[2])));
 			}
+			else if (obj_state == WED_ResourceMgr::obj_Pending)
+				visibleGuessedAt = rmgr->GetLoadCount();
 			else if(rmgr->GetAGP(resource.value,agp))
 			{
 				auto ti = agp->tiles.front();
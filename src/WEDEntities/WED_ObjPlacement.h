@@ -71,6 +71,7 @@ private:
 
 	mutable float				visibleWithinDeg;     // for culling in the map_view
 	mutable float				visibleWithinMeters;
+	mutable int					visibleGuessedAt;     // resource manager load count when the OBJ was still loading, -1 once we know its size
 };
 
 
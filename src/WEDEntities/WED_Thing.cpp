@@ -84,8 +84,8 @@ bool 			WED_Thing::ReadFrom(IOReader * reader)
 	// Children
 	reader->ReadInt(ct);
 	child_id.resize(ct);
-	for (int n = 0; n < ct; ++n)
-		reader->ReadInt(child_id[n]);
+	if (ct > 0)
+		reader->ReadSpan(&child_id[0], ct);
 
 	// Viewers
 	viewer_id.clear();
@@ -100,8 +100,8 @@ bool 			WED_Thing::ReadFrom(IOReader * reader)
 	// Sources
 	reader->ReadInt(ct);
 	source_id.resize(ct);
-	for(int n = 0; n < ct; ++n)
-		reader->ReadInt(source_id[n]);
+	if (ct > 0)
+		reader->ReadSpan(&source_id[0], ct);
 
 	ReadPropsFrom(reader);
 	return false;
@@ -113,8 +113,8 @@ void 			WED_Thing::WriteTo(IOWriter * writer)
 
 	// Children
 	writer->WriteInt(child_id.size());
-	for (int n = 0; n < child_id.size(); ++n)
-		writer->WriteInt(child_id[n]);
+	if (!child_id.empty())
+		writer->WriteSpan(&child_id[0], child_id.size());
 
 	// Viewers
 	writer->WriteInt(viewer_id.size());
@@ -123,8 +123,8 @@ void 			WED_Thing::WriteTo(IOWriter * writer)
 
 	//Sources
 	writer->WriteInt(source_id.size());
-	for(int n = 0; n < source_id.size(); ++n)
-		writer->WriteInt(source_id[n]);
+	if (!source_id.empty())
+		writer->WriteSpan(&source_id[0], source_id.size());
 
 	WritePropsTo(writer);
 }
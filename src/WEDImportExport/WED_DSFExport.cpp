@@ -57,6 +57,9 @@
 #include "DSF2Text.h"
 #include "zip.h"
 #include <stdarg.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 //#include "WED_ToolUtils.h"
 //#include "WED_Validate.h"
@@ -477,7 +480,8 @@ void dsf_road_grid_helper::export_to_dsf(
 // some big item goes across buckets and we lose precision.
 #define DSF_DIVISIONS 32
 
-static bool g_dropped_pts = false;
+// Per thread, so parallel tile exports each track their own dropped bezier points - DSF_Export collects them.
+static thread_local bool g_dropped_pts = false;
 
 struct	DSF_ResourceTable {
 	DSF_ResourceTable() { for(int i = 0; i < 7; ++i) show_level_obj[i] = show_level_pol[i] = -1; cur_filter = -1;}
@@ -1109,10 +1113,91 @@ void DSF_AccumPolygonWithHoles(
 }
 
 
+/************************************************************************************************************************************************
+ * TILE INDEX
+ ************************************************************************************************************************************************/
+
+// Without an index, every tile walks the whole document and culls by bounds - N tiles x M entities bounds tests. The index is built in
+// one pass over the groups and airports: for every tile it lists, per container, only the children that overlap that tile, in the
+// original order. So the DSFs come out the same, but a tile only visits its own entities.
+
+typedef	hash_map<WED_Thing *, vector<WED_Thing *> >	DSF_tile_children_t;
+
+class	DSF_TileIndex {
+public:
+	DSF_TileIndex(WED_Thing * base, int west, int south, int east, int north);
+
+	const DSF_tile_children_t *	tile(int x, int y) const;		// nullptr if not indexed - walk all children
+
+	static const vector<WED_Thing *> *	children(const DSF_tile_children_t * tile, WED_Thing * what);
+
+private:
+	void	add_children(WED_Thing * what);
+
+	int		mWest, mSouth, mEast, mNorth;
+	vector<DSF_tile_children_t>		mTiles;
+};
+
+DSF_TileIndex::DSF_TileIndex(WED_Thing * base, int west, int south, int east, int north) :
+	mWest(west), mSouth(south), mEast(east), mNorth(north)
+{
+	mTiles.resize(max(0, (east - west) * (north - south)));
+	add_children(base);
+}
+
+void DSF_TileIndex::add_children(WED_Thing * what)
+{
+	sClass_t c = what->GetClass();
+	if(c != WED_Airport::sClass && c != WED_Group::sClass)		// the exporters only ever recurse into these
+		return;
+
+	int nn = what->CountChildren();
+	for(int n = 0; n < nn; ++n)
+	{
+		WED_Thing * child = what->GetNthChild(n);
+		IGISEntity * ent = dynamic_cast<IGISEntity *>(child);
+		if(ent)
+		{
+			Bbox2	bounds;
+			ent->GetBounds(gis_Geo, bounds);
+			if(bounds.is_null())
+				continue;
+			// Bbox2::overlap is inclusive, so an entity ending on a tile edge belongs to both tiles - exactly what the cull does.
+			int x1 = max(mWest, (int) floor(bounds.xmin()) - 1), x2 = min(mEast - 1,  (int) floor(bounds.xmax()));
+			int y1 = max(mSouth,(int) floor(bounds.ymin()) - 1), y2 = min(mNorth - 1, (int) floor(bounds.ymax()));
+			for(int y = y1; y <= y2; ++y)
+				for(int x = x1; x <= x2; ++x)
+					if(bounds.overlap(Bbox2(x, y, x + 1, y + 1)))
+						mTiles[(y - mSouth) * (mEast - mWest) + x - mWest][what].push_back(child);
+		}
+		else
+			for(auto& t : mTiles)			// no bounds, no culling
+				t[what].push_back(child);
+
+		add_children(child);
+	}
+}
+
+const DSF_tile_children_t * DSF_TileIndex::tile(int x, int y) const
+{
+	if(x < mWest || x >= mEast || y < mSouth || y >= mNorth)
+		return nullptr;
+	return &mTiles[(y - mSouth) * (mEast - mWest) + x - mWest];
+}
+
+const vector<WED_Thing *> * DSF_TileIndex::children(const DSF_tile_children_t * tile, WED_Thing * what)
+{
+	static const vector<WED_Thing *> none;
+	if(!tile)
+		return nullptr;
+	auto k = tile->find(what);
+	return k != tile->end() ? &k->second : &none;
+}
+
 // 1 = got at least 1 min/max height entity
 // 0 = got entities, none affected by height
 // -1 = cull
-static int	DSF_HeightRangeRecursive(WED_Thing * what, double& out_msl_min, double& out_msl_max, const Bbox2& bounds)
+static int	DSF_HeightRangeRecursive(WED_Thing * what, double& out_msl_min, double& out_msl_max, const Bbox2& bounds, const DSF_tile_children_t * tile_children)
 {
 	IGISEntity * ent;
 	if((ent = dynamic_cast<IGISEntity *>(what)) != NULL)
@@ -1147,11 +1232,12 @@ static int	DSF_HeightRangeRecursive(WED_Thing * what, double& out_msl_min, doubl
 
 	if(c == WED_Airport::sClass || c == WED_Group::sClass)
 	{
-		int nn = what->CountChildren();
+		auto kids = DSF_TileIndex::children(tile_children, what);
+		int nn = kids ? kids->size() : what->CountChildren();
 		for(int n = 0; n < nn; ++n)
 		{
 			double msl_min, msl_max;
-			int child_cull = DSF_HeightRangeRecursive(what->GetNthChild(n),msl_min,msl_max, bounds);
+			int child_cull = DSF_HeightRangeRecursive(kids ? (*kids)[n] : what->GetNthChild(n),msl_min,msl_max, bounds, tile_children);
 			if (child_cull == 1)
 			{
 				any_inside = 1;
@@ -1208,7 +1294,8 @@ static int	DSF_ExportTileRecursive(
 						void *						writer,
 						set<WED_Thing *>&			problem_children,
 						int							show_level,
-						DSF_export_info_t *			export_info )
+						DSF_export_info_t *			export_info,
+						const DSF_tile_children_t *	tile_children = nullptr )	// if set, only visit what the tile index lists
 {
 	WED_Entity * ent = static_cast<WED_Entity *>(what);
 	if (!ent || ent->GetHidden())
@@ -2062,10 +2149,11 @@ static int	DSF_ExportTileRecursive(
 
 	if(apt || c == WED_Group::sClass)  // only recurse if there is actually a possibility of more DSF content in there
 	{
-		int cc = what->CountChildren();
+		auto kids = DSF_TileIndex::children(tile_children, what);
+		int cc = kids ? kids->size() : what->CountChildren();
 		for (int c = 0; c < cc; ++c)
 		{
-			int result = DSF_ExportTileRecursive(what->GetNthChild(c), resolver, pkg, cull_bounds, safe_bounds, io_table, cbs, writer, problem_children, show_level, export_info);
+			int result = DSF_ExportTileRecursive(kids ? (*kids)[c] : what->GetNthChild(c), resolver, pkg, cull_bounds, safe_bounds, io_table, cbs, writer, problem_children, show_level, export_info, tile_children);
 			if (result == -1)
 			{
 				real_thingies = -1; //Abort!
@@ -2087,7 +2175,15 @@ static int	DSF_ExportTileRecursive(
 	return real_thingies;
 }
 
-int DSF_ExportTile(WED_Thing * base, IResolver * resolver, const string& pkg, int x, int y, set <WED_Thing *>& problem_children, DSF_export_info_t * export_info)
+// DSF path relative to "Earth nav data", as remembered in the export info
+static string DSF_TilePath(int x, int y)
+{
+	char buffer[32];
+	snprintf(buffer, 32, "%+03d%+04d" DIR_STR "%+03d%+04d.dsf", latlon_bucket(y), latlon_bucket(x), y, x);
+	return buffer;
+}
+
+int DSF_ExportTile(WED_Thing * base, IResolver * resolver, const string& pkg, int x, int y, set <WED_Thing *>& problem_children, DSF_export_info_t * export_info, const DSF_TileIndex * index)
 {
 	void *			writer;
 	DSFCallbacks_t	cbs;
@@ -2096,7 +2192,9 @@ int DSF_ExportTile(WED_Thing * base, IResolver * resolver, const string& pkg, in
 	double msl_min, msl_max;
 	Bbox2	cull(x,y,x+1,y+1);
 
-	int cull_code = DSF_HeightRangeRecursive(base,msl_min,msl_max, cull);    // also finds if tile has anything goint into it
+	const DSF_tile_children_t * tile_children = index ? index->tile(x, y) : nullptr;
+
+	int cull_code = DSF_HeightRangeRecursive(base,msl_min,msl_max, cull, tile_children);    // also finds if tile has anything goint into it
 
 	if(cull_code < 0)
 		return 0;
@@ -2132,7 +2230,7 @@ int DSF_ExportTile(WED_Thing * base, IResolver * resolver, const string& pkg, in
 	int entities = 0;
 	for (int show_level = 6; show_level >= 1; --show_level)
 	{
-		int result = DSF_ExportTileRecursive(base, resolver, pkg, cull_bounds, safe_bounds, rsrc, &cbs, writer, problem_children, show_level, export_info);
+		int result = DSF_ExportTileRecursive(base, resolver, pkg, cull_bounds, safe_bounds, rsrc, &cbs, writer, problem_children, show_level, export_info, tile_children);
 		if (result == -1)
 		{
 			DSFDestroyWriter(writer);
@@ -2146,13 +2244,16 @@ int DSF_ExportTile(WED_Thing * base, IResolver * resolver, const string& pkg, in
 	if(entities)	// empty DSF?  Don't write a empty file, makes a mess!
 	{
 		snprintf(buffer, 255, "%sEarth nav data" DIR_STR "%+03d%+04d",	pkg.c_str(), latlon_bucket(y), latlon_bucket(x)	);
-		FILE_make_dir_exist(buffer);
+		{
+			static mutex dir_mutex;                  // tiles exported in parallel may share the same 10x10 degree directory
+			lock_guard<mutex> lock(dir_mutex);
+			FILE_make_dir_exist(buffer);
+		}
 
 		snprintf(buffer, 255, "%sEarth nav data" DIR_STR "%+03d%+04d" DIR_STR "%+03d%+04d.dsf", pkg.c_str(), latlon_bucket(y), latlon_bucket(x), y, x);
 		DSFWriteToFile(buffer, writer);
 
-		snprintf(buffer, 255, "%+03d%+04d" DIR_STR "%+03d%+04d.dsf", latlon_bucket(y), latlon_bucket(x), y, x);
-		export_info->mark_written(buffer);
+		export_info->mark_written(DSF_TilePath(x, y));
 	}
 
 	/*
@@ -2161,7 +2262,7 @@ int DSF_ExportTile(WED_Thing * base, IResolver * resolver, const string& pkg, in
 	{
 		if(entities > 0)
 		{
-			int cull_code = DSF_HeightRangeRecursive(base,msl_min,msl_max, cull);
+			int cull_code = DSF_HeightRangeRecursive(base,msl_min,msl_max, cull, tile_children);
 		}
 		Assert(entities == 0);
 	}
@@ -2171,7 +2272,135 @@ int DSF_ExportTile(WED_Thing * base, IResolver * resolver, const string& pkg, in
 	return entities;
 }
 
-int DSF_Export(WED_Thing * base, IResolver * resolver, const string& package, set<WED_Thing *>& problem_children)
+/************************************************************************************************************************************************
+ * PARALLEL TILE EXPORT
+ ************************************************************************************************************************************************/
+
+// Tiles are independent DSF files - each gets its own writer and resource table, so they can be built on several threads and the
+// files come out exactly as the serial export writes them. What has to be taken care of:
+// - the WED entities fill their bounds/point caches and facade infos lazily on first read. All of these get touched once on the main
+//   thread before any worker starts, so the workers only ever read.
+// - new orthophotos and terrain objects get converted during export, which edits the document and may alert the user. Tiles touching
+//   any of those are exported on the main thread up front, all others go to the workers afterwards.
+// - problem children, dropped bezier points and the list of written DSFs are collected per thread and merged in tile order at the end.
+
+struct DSF_tile_job_t {
+	int		x;
+	int		y;
+	bool	main_thread;	// has content that can only be exported on the main thread
+	int		result;			// DSF_ExportTile result, 0 if never exported
+};
+
+static void	DSF_PrepareParallelRecursive(WED_Thing * what, vector<Bbox2>& main_thread_bounds)
+{
+	if(IGISEntity * ent = dynamic_cast<IGISEntity *>(what))
+	{
+		Bbox2	bounds;
+		ent->GetBounds(gis_Geo, bounds);
+		ent->HasLayer(gis_UV);
+		if(IGISPointSequence * seq = dynamic_cast<IGISPointSequence *>(what))
+			seq->GetNumPoints();
+
+		sClass_t c = what->GetClass();
+		if(c == WED_FacadePlacement::sClass)
+			static_cast<WED_FacadePlacement *>(what)->GetTopoMode();   // loads the facade info into the resource manager
+		else if(c == WED_TerPlacement::sClass
+#if WED
+			 || (c == WED_DrapedOrthophoto::sClass && static_cast<WED_DrapedOrthophoto *>(what)->IsNew())
+#endif
+#if ROAD_EDITING
+			 || c == WED_RoadEdge::sClass
+#endif
+			)
+			main_thread_bounds.push_back(bounds);
+	}
+
+	int nn = what->CountChildren();
+	for(int n = 0; n < nn; ++n)
+		DSF_PrepareParallelRecursive(what->GetNthChild(n), main_thread_bounds);
+}
+
+static void	DSF_ExportTilesParallel(WED_Thing * base, IResolver * resolver, const string& package, const DSF_TileIndex& index, vector<DSF_tile_job_t>& jobs,
+									int num_threads, set<WED_Thing *>& problem_children, DSF_export_info_t& export_info)
+{
+	vector<Bbox2>	main_thread_bounds;
+	DSF_PrepareParallelRecursive(base, main_thread_bounds);
+
+	for(auto& j : jobs)
+	{
+		Bbox2 tile(j.x, j.y, j.x + 1, j.y + 1);
+		for(const auto& b : main_thread_bounds)
+			if(b.overlap(tile))
+			{
+				j.main_thread = true;
+				break;
+			}
+	}
+
+	vector<set<WED_Thing *> >	thread_problems(num_threads);
+	bool	aborted = false;
+
+	{
+		DSF_export_info_t	info;				// private orthophoto cache, the document's export info only gets the results merged
+		info.DockingJetways = export_info.DockingJetways;
+
+		for(auto& j : jobs)
+			if(j.main_thread && !aborted)
+			{
+				j.result = DSF_ExportTile(base, resolver, package, j.x, j.y, thread_problems[0], &info, &index);
+				aborted = j.result < 0;
+			}
+
+		if(info.resourcesAdded)					// leave the library rescan to the export info that outlives us
+		{
+			export_info.resourcesAdded = true;
+			info.resourcesAdded = false;
+		}
+	}
+
+	// Converting orthophotos undoes the UV rescaling when done, invalidating caches all the way up - so warm them again.
+	main_thread_bounds.clear();
+	DSF_PrepareParallelRecursive(base, main_thread_bounds);
+
+	atomic<int>		next_job(0);
+	atomic<bool>	worker_aborted(aborted);
+	atomic<bool>	dropped_pts(false);
+
+	auto worker = [&](int w)
+	{
+		DSF_export_info_t	info;
+		info.DockingJetways = export_info.DockingJetways;
+
+		int n;
+		while(!worker_aborted && (n = next_job++) < (int) jobs.size())
+			if(!jobs[n].main_thread)
+			{
+				jobs[n].result = DSF_ExportTile(base, resolver, package, jobs[n].x, jobs[n].y, thread_problems[w], &info, &index);
+				if(jobs[n].result < 0)
+					worker_aborted = true;
+			}
+		if(g_dropped_pts)
+			dropped_pts = true;
+	};
+
+	vector<thread>	workers;
+	for(int w = 1; w < num_threads; ++w)
+		workers.push_back(thread(worker, w));
+	worker(0);
+
+	for(auto& t : workers)
+		t.join();
+
+	if(dropped_pts)
+		g_dropped_pts = true;
+	for(const auto& p : thread_problems)
+		problem_children.insert(p.begin(), p.end());
+	for(const auto& j : jobs)
+		if(j.result > 0)
+			export_info.mark_written(DSF_TilePath(j.x, j.y));
+}
+
+int DSF_Export(WED_Thing * base, IResolver * resolver, const string& package, set<WED_Thing *>& problem_children, int num_threads)
 {
 #if DEV
 	StElapsedTime	etime("Export time");
@@ -2192,20 +2421,40 @@ int DSF_Export(WED_Thing * base, IResolver * resolver, const string& package, se
 
 	int DSF_export_tile_res = 0;
 
-	DSF_export_info_t DSF_export_info(resolver);   // We kept the last loaded orthoimage open, so it does not have to be loaded repeatedly. This gates parallel DSF exports.
+	DSF_export_info_t DSF_export_info(resolver);   // We kept the last loaded orthoimage open, so it does not have to be loaded repeatedly.
 	DSF_export_info.DockingJetways = gExportTarget >= wet_xplane_1200;
 
-	for (int y = tile_south; y < tile_north; ++y)
+	DSF_TileIndex	index(base, tile_west, tile_south, tile_east, tile_north);
+
+	if(num_threads <= 0)
+		num_threads = thread::hardware_concurrency();
+	num_threads = min(num_threads, (tile_east - tile_west) * (tile_north - tile_south));
+
+	if(num_threads > 1)
 	{
+		vector<DSF_tile_job_t>	jobs;
+		for (int y = tile_south; y < tile_north; ++y)
+			for (int x = tile_west; x < tile_east; ++x)
+			{
+				DSF_tile_job_t j = { x, y, false, 0 };
+				jobs.push_back(j);
+			}
+		DSF_ExportTilesParallel(base, resolver, package, index, jobs, num_threads, problem_children, DSF_export_info);
+	}
+	else
+	{
+		for (int y = tile_south; y < tile_north; ++y)
+		{
 #if TYLER_MODE
-		printf("Exporting DSF's at lattitude %d\n", y);
+			printf("Exporting DSF's at lattitude %d\n", y);
 #endif
-		for (int x = tile_west; x < tile_east; ++x)
-		{
-			DSF_export_tile_res = DSF_ExportTile(base, resolver, package, x, y, problem_children, &DSF_export_info);
+			for (int x = tile_west; x < tile_east; ++x)
+			{
+				DSF_export_tile_res = DSF_ExportTile(base, resolver, package, x, y, problem_children, &DSF_export_info, &index);
+				if (DSF_export_tile_res == -1) break;
+			}
 			if (DSF_export_tile_res == -1) break;
 		}
-		if (DSF_export_tile_res == -1) break;
 	}
 	if (g_dropped_pts)
 	{
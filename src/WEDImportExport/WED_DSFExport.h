@@ -28,10 +28,12 @@ class	IResolver;
 class	WED_Thing;
 class	WED_Airport;
 class	DSF_export_info_t;
+class	DSF_TileIndex;
 
 // You will need the IResolver in case you're handling a orthophoto
-int DSF_Export(WED_Thing * base, IResolver * resolver, const string& in_package, set<WED_Thing *>& problem_items);
-int DSF_ExportTile(WED_Thing * base, IResolver * resolver, const string& pkg, int x, int y, set <WED_Thing *>& problem_children, DSF_export_info_t * export_info = nullptr);
+// Tiles are exported on num_threads threads, 1 = serial, 0 = one per core. The DSFs are identical either way.
+int DSF_Export(WED_Thing * base, IResolver * resolver, const string& in_package, set<WED_Thing *>& problem_items, int num_threads = 1);
+int DSF_ExportTile(WED_Thing * base, IResolver * resolver, const string& pkg, int x, int y, set <WED_Thing *>& problem_children, DSF_export_info_t * export_info = nullptr, const DSF_TileIndex * index = nullptr);
 
 // 
 int DSF_ExportAirportOverlay(IResolver * resolver, WED_Airport  * who, const string& package, set<WED_Thing *>& problem_children);
@@ -1163,6 +1163,7 @@ public:
 
 		LOG_MSG("I/DSF Importing binary DSF from %s\n",file_name);
 		int res = DSFReadFile(file_name, malloc, free, &cb, NULL, this);
+		DSFReleaseDecoderCache();
 
 		return res;
 	}
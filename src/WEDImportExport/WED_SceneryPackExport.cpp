@@ -47,6 +47,7 @@
 #include "WED_Menus.h"
 #include "WED_UIDefs.h"
 #include "WED_Validate.h"
+#include "WED_Globals.h"
 
 #include <iostream>
 
@@ -197,7 +198,7 @@ static void OsmExport(WED_Thing* root, const string& file)
 void	WED_ExportPackToPath(WED_Thing * root, IResolver * resolver, const string& in_path, set<WED_Thing *>& problem_children)
 {
 	StElapsedTime etime("Export Scenery");
-	int result = DSF_Export(root, resolver, in_path, problem_children);
+	int result = DSF_Export(root, resolver, in_path, problem_children, gParallelExport ? 0 : 1);
 	if (result == -1)
 		return;
 
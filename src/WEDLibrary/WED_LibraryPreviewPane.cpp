@@ -98,6 +98,9 @@ WED_LibraryPreviewPane::WED_LibraryPreviewPane(GUI_Commander * cmdr, WED_Resourc
 		mInfoButton->AddListener(this);
 		mInfoButton->Hide();
 
+		// Facade previews pick up their OBJs from the background loader, redraw once they arrive.
+		mResMgr->AddListener(this);
+
 		mMSAA = 1;
 		GLint tmp;
 		glGetIntegerv(GL_SAMPLES, &tmp);
@@ -141,6 +144,8 @@ void		WED_LibraryPreviewPane::ReceiveMessage(GUI_Broadcaster * inSrc, intptr_t i
 			sprintf(s,"%d/%d",mVariant + 1, mNumVariants);
 		mInfoButton->SetDescriptor(s);
 	}
+	else if(inMsg == msg_ResourcesLoaded)
+		Refresh();
 }
 
 void WED_LibraryPreviewPane::SetResource(const string& r, int res_type, int variants)
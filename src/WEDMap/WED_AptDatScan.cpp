@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026, Laminar Research.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "WED_AptDatScan.h"
+#include "MemFileUtils.h"
+#include "MathUtils.h"
+
+#include <functional>
+#include <thread>
+
+/* apt.dat scanning:
+   The global apt.dat is some 300+ MBytes of text, of which we only need the airport headers and the few row types
+   that locate an airport. So the memory mapped file is cut into chunks at airport header lines and each chunk is
+   scanned on its own thread. The chunks are appended in file order, so a later duplicate of an ICAO still wins. */
+
+#define APT_CHUNK_MIN_SIZE	(4 << 20)	// smaller files aren't worth the threads
+
+static bool is_apt_header(const char * p, const char * end)
+{
+	while (p < end && (*p == ' ' || *p == '\t')) p++;
+	int rowcode = 0;
+	const char * digits = p;
+	while (p < end && *p >= '0' && *p <= '9' && p - digits < 3)
+		rowcode = rowcode * 10 + *p++ - '0';
+	if (p == digits || (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n'))
+		return false;
+	return rowcode == 1 || rowcode == 16 || rowcode == 17 || rowcode == 99;
+}
+
+// Returns the start of the first airport header line at or after the line following p.
+static const char * next_apt_header(const char * p, const char * end)
+{
+	while (p < end)
+	{
+		while (p < end && *p != '\n' && *p != '\r') p++;
+		while (p < end && (*p == '\n' || *p == '\r')) p++;
+		if (p < end && is_apt_header(p, end))
+			return p;
+	}
+	return end;
+}
+
+// Scans one chunk. All but the last chunk end right before another airport header, so the airport open at the
+// end of such a chunk is complete. In the last chunk, like always, only the 99 row closes the final airport.
+static void parse_apt_chunk(const char * begin, const char * end, bool last_chunk, vector<apt_dat_entry_t>& out)
+{
+	MFScanner	s;
+	MFS_init(&s, begin, end);
+
+	int apt_type = 0;
+	Bbox2 apt_bounds;
+	apt_dat_entry_t n;
+
+	while(!MFS_done(&s))
+	{
+		int rowcode = MFS_int(&s);
+		if (rowcode == 1 || rowcode == 16 || rowcode == 17 || rowcode == 99)
+		{
+			if(apt_type)
+			{
+				n.lonlat = apt_bounds.centroid();
+				out.push_back(n);
+			}
+			apt_type = rowcode;
+			apt_bounds = Bbox2();
+			n.type = 10000 + rowcode;
+			n.has_atc = 0;
+			MFS_int(&s);	// skip elevation
+			MFS_int(&s);
+			MFS_int(&s);
+
+			MFS_string(&s,&n.icao);
+			MFS_string_eol(&s,&n.name);
+		}
+		else if(apt_type)
+		{
+			if((rowcode >=  111 && rowcode <=  116) ||
+				rowcode == 1201 || rowcode == 1300  ||
+				(rowcode >=   18 && rowcode <=   21))
+			{
+				double lat = MFS_double(&s);
+				double lon = MFS_double(&s);
+				apt_bounds += Point2(lon,lat);
+			}
+			else if (rowcode == 100) // runways
+			{
+				MFS_double(&s);  // width
+				MFS_double(&s); MFS_double(&s); MFS_double(&s);
+				MFS_double(&s); MFS_double(&s); MFS_double(&s);
+				MFS_string(&s, NULL);
+				double lat = MFS_double(&s);
+				double lon = MFS_double(&s);
+				MFS_double(&s); MFS_double(&s); MFS_double(&s);
+				MFS_double(&s); MFS_double(&s); MFS_double(&s);
+				apt_bounds += Point2(lon,lat);
+				MFS_string(&s, NULL);
+				lat = MFS_double(&s);
+				lon = MFS_double(&s);
+				apt_bounds += Point2(lon,lat);
+			}
+			else if (rowcode == 101) // sealanes
+			{
+				MFS_double(&s);
+				MFS_double(&s);
+				MFS_string(&s, NULL);
+				double lat = MFS_double(&s);
+				double lon = MFS_double(&s);
+				apt_bounds += Point2(lon,lat);
+				MFS_string(&s, NULL);
+				lat = MFS_double(&s);
+				lon = MFS_double(&s);
+				apt_bounds += Point2(lon,lat);
+			}
+			else if (rowcode == 102) // helipads
+			{
+				MFS_string(&s, NULL);
+				double lat = MFS_double(&s);
+				double lon = MFS_double(&s);
+				apt_bounds += Point2(lon,lat);
+			}
+			else if (rowcode == 54 || rowcode == 1054) // ATC frequency
+			{
+				n.has_atc = 1;
+			}
+		}
+		MFS_string_eol(&s,NULL);
+	}
+	if(apt_type && !last_chunk)
+	{
+		n.lonlat = apt_bounds.centroid();
+		out.push_back(n);
+	}
+}
+
+bool WED_ScanAptDat(MFMemFile * str, vector<apt_dat_entry_t>& out, int num_chunks)
+{
+	MFScanner	s;
+	MFS_init(&s, str);
+	int versions[] = { 1000, 1021, 1050, 1100, 1130, 1200, 0 };
+
+	if(!MFS_xplane_header(&s,versions,NULL,NULL))
+		return false;
+
+	const char * body = s.cur;
+	const char * end = s.end;
+
+	if(num_chunks <= 0)
+	{
+		num_chunks = intlim(thread::hardware_concurrency(), 1, 8);
+		num_chunks = min<ptrdiff_t>(num_chunks, (end - body) / APT_CHUNK_MIN_SIZE + 1);
+	}
+
+	vector<const char *> cuts(1, body);
+	for(int i = 1; i < num_chunks; ++i)
+	{
+		const char * p = next_apt_header(body + (end - body) / num_chunks * i, end);
+		if(p > cuts.back() && p < end)
+			cuts.push_back(p);
+	}
+	cuts.push_back(end);
+
+	vector<vector<apt_dat_entry_t> > found(cuts.size() - 1);
+	vector<thread> workers;
+	for(int i = 1; i < found.size(); ++i)
+		workers.push_back(thread(parse_apt_chunk, cuts[i], cuts[i+1], i == found.size() - 1, ref(found[i])));
+	parse_apt_chunk(cuts[0], cuts[1], found.size() == 1, found[0]);
+	for(auto& w : workers)
+		w.join();
+
+	for(auto& chunk : found)
+		out.insert(out.end(), chunk.begin(), chunk.end());
+	return true;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2026, Laminar Research.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WED_AptDatScan_h
+#define WED_AptDatScan_h
+
+// The apt.dat scanning of the navaid layer, kept apart from the GL and GUI so it can be exercised on its own.
+
+#include "CompGeomDefs2.h"
+
+struct MFMemFile;
+
+struct apt_dat_entry_t {
+	int		type;		// 10000 + header row code: 1 airport, 16 seaplane base, 17 heliport
+	Point2	lonlat;		// center of all runways, taxiways, pavement etc.
+	int		has_atc;	// 1 if there is a tower frequency
+	string	icao;
+	string	name;
+};
+
+// Returns every airport of an apt.dat in file order, duplicate ICAO's included. The file is cut into num_chunks
+// pieces at airport headers that are scanned on their own threads; 0 picks the count from the file size and the
+// number of cores. Returns false if the file has no known apt.dat header. Does not close the file.
+bool	WED_ScanAptDat(MFMemFile * str, vector<apt_dat_entry_t>& out, int num_chunks = 0);
+
+#endif /* WED_AptDatScan_h */
@@ -26,6 +26,7 @@
 #include "WED_MapZoomerNew.h"
 #include "WED_ToolUtils.h"
 #include "WED_Entity.h"
+#include "WED_GISComposite.h"
 #include "WED_Colors.h"
 #include "XESConstants.h"
 #include "GUI_GraphState.h"
@@ -612,6 +613,24 @@ void WED_HandleToolBase::ProcessSelectionRecursive(
 	if(seq  &&  seq->GetGISClass() == gis_Composite) seq = NULL;
 	if(poly && poly->GetGISClass() != gis_Polygon)  poly = NULL;
 
+	// Big composites have a spatial index - only visit what can be within reach, which is what the speedup above would let through.
+	auto ProcessEntities = [&](IGISComposite * com)
+	{
+		vector<int> near;
+		Bbox2 reach(pt_sel ? Bbox2(psel) : bounds);
+		reach.expand(icon_dist_h, icon_dist_v);
+		WED_GISComposite * gc = dynamic_cast<WED_GISComposite *>(com);
+		if (gc && gc->GetEntitiesNear(reach, near))
+			for (auto n : near)
+				ProcessSelectionRecursive(com->GetNthEntity(n),bounds,pt_sel, icon_dist_h, icon_dist_v, result);
+		else
+		{
+			int count = com->GetNumEntities();
+			for (int n = 0; n < count; ++n)
+				ProcessSelectionRecursive(com->GetNthEntity(n),bounds,pt_sel, icon_dist_h, icon_dist_v, result);
+		}
+	};
+
 	switch(choice) {
 	case ent_Atomic:
 //		if(entity->IntersectsBox(gis_Geo,bounds))                 result.insert(entity);   // includes the inner area of BoundingBoxes aka Exclusions
@@ -623,9 +642,7 @@ void WED_HandleToolBase::ProcessSelectionRecursive(
 
 		if (com)
 		{
-			int count = com->GetNumEntities();
-			for (int n = 0; n < count; ++n)
-				ProcessSelectionRecursive(com->GetNthEntity(n),bounds,pt_sel, icon_dist_h, icon_dist_v, result);
+			ProcessEntities(com);
 		}
 		else if (seq)
 		{
@@ -646,9 +663,7 @@ void WED_HandleToolBase::ProcessSelectionRecursive(
 			result.insert(entity);
 		else if (com)
 		{
-			int count = com->GetNumEntities();
-			for (int n = 0; n < count; ++n)
-				ProcessSelectionRecursive(com->GetNthEntity(n),bounds,pt_sel, icon_dist_h, icon_dist_v, result);
+			ProcessEntities(com);
 		}
 		else if (seq)
 		{
@@ -34,6 +34,7 @@
 #include "WED_Menus.h"
 #include "XESConstants.h"
 #include "IGIS.h"
+#include "WED_GISComposite.h"
 #include "ISelection.h"
 #include "IResolver.h"
 #include "GISUtils.h"
@@ -388,9 +389,17 @@ void		WED_Map::DrawVisFor(WED_MapLayer * layer, int current, const Bbox2& bounds
 
 		if(max(span.dx, span.dy) > TOO_SMALL_TO_GO_IN || (p1 == p2) || depth == 0)		// Why p1 == p2?  If the composite contains ONLY ONE POINT it is zero-size.  We'd LOD out.  But if
 		{																				// it contains one thing then we might as well ALWAYS draw it - it's relatively cheap!
-			int t = c->GetNumEntities();												// Depth == 0 means we draw ALL top level objects -- good for airports.
-			for (int n = t-1; n >= 0; --n)
-				DrawVisFor(layer, current, bounds, c->GetNthEntity(n), g, sel, depth+1);
+			vector<int> near;															// Depth == 0 means we draw ALL top level objects -- good for airports.
+			WED_GISComposite * gc = dynamic_cast<WED_GISComposite *>(c);
+			if (gc && gc->GetEntitiesNear(bounds, near))								// big composites: only what their index says could be on screen
+				for (auto n = near.rbegin(); n != near.rend(); ++n)
+					DrawVisFor(layer, current, bounds, c->GetNthEntity(*n), g, sel, depth+1);
+			else
+			{
+				int t = c->GetNumEntities();
+				for (int n = t-1; n >= 0; --n)
+					DrawVisFor(layer, current, bounds, c->GetNthEntity(n), g, sel, depth+1);
+			}
 		}
 	}
 }
@@ -413,9 +422,17 @@ void		WED_Map::DrawStrFor(WED_MapLayer * layer, int current, const Bbox2& bounds
 
 		if(PixelSize(on_screen) > TOO_SMALL_TO_GO_IN || on_screen.is_point() || depth == 0)
 		{
-			int t = c->GetNumEntities();
-			for (int n = t-1; n >= 0; --n)
-				DrawStrFor(layer, current, bounds, c->GetNthEntity(n), what_locked, g, sel, depth+1);
+			vector<int> near;
+			WED_GISComposite * gc = dynamic_cast<WED_GISComposite *>(c);
+			if (gc && gc->GetEntitiesNear(bounds, near))
+				for (auto n = near.rbegin(); n != near.rend(); ++n)
+					DrawStrFor(layer, current, bounds, c->GetNthEntity(*n), what_locked, g, sel, depth+1);
+			else
+			{
+				int t = c->GetNumEntities();
+				for (int n = t-1; n >= 0; --n)
+					DrawStrFor(layer, current, bounds, c->GetNthEntity(n), what_locked, g, sel, depth+1);
+			}
 		}
 	}
 }
@@ -522,7 +539,7 @@ void		WED_Map::ReceiveMessage(
 							intptr_t				inMsg,
 							intptr_t				inParam)
 {
-	if(inMsg == msg_ArchiveChanged)	Refresh();
+	if(inMsg == msg_ArchiveChanged || inMsg == msg_ResourcesLoaded)	Refresh();
 }
 
 IGISEntity *	WED_Map::GetGISBase()
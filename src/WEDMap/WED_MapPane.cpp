@@ -57,6 +57,7 @@
 #include "WED_GroupCommands.h"
 #include "WED_LibraryListAdapter.h"
 #include "WED_LibraryMgr.h"
+#include "WED_ResourceMgr.h"
 #include "IDocPrefs.h"
 #include "WED_Orthophoto.h"
 #if WITHNWLINK
@@ -313,6 +314,9 @@ WED_MapPane::WED_MapPane(GUI_Commander * cmdr, double map_bounds[4], IResolver *
 
 	archive->AddListener(mMap);
 
+	// Same deal for objects the resource manager loads in the background while we draw.
+	WED_GetResourceMgr(resolver)->AddListener(mMap);
+
 	// This is a band-aid.  We don't restore the current tab in the tab hierarchy (as of WED 1.5) so we don't get a tab changed message.  Instead we just
 	// are always in the selection tab.  So mostly that means the defaults for things like filters are fine, but for the ATC layer it needs to be off!
 	mATCLayer->ToggleVisible();
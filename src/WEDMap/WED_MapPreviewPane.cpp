@@ -32,6 +32,7 @@
 #include "MathUtils.h"
 #include "WED_Colors.h"
 #include "WED_Document.h"
+#include "WED_GISComposite.h"
 #include "WED_FacadePreview.h"
 #include "WED_Menus.h"
 #include "WED_Messages.h"
@@ -97,9 +98,17 @@ static void DrawVisFor(WED_MapLayer * layer, const Bbox2& bounds, const WED_MapZ
 			Point2 p2 = zoomer.LLToPixel(bboxLL.p2);
 			if (zoomer.PixelSize(bboxLL) > TOO_SMALL_TO_GO_IN || (p1 == p2) || depth == 0)	// Why p1 == p2?  If the composite contains ONLY ONE POINT it is zero-size.  We'd LOD out.  But if
 			{																				// it contains one thing then we might as well ALWAYS draw it - it's relatively cheap!
-				int t = c->GetNumEntities();												// Depth == 0 means we draw ALL top level objects -- good for airports.
-				for (int n = t - 1; n >= 0; --n)
-					DrawVisFor(layer, bounds, zoomer, c->GetNthEntity(n), g, depth + 1, stats);
+				vector<int> near;															// Depth == 0 means we draw ALL top level objects -- good for airports.
+				WED_GISComposite * gc = dynamic_cast<WED_GISComposite *>(c);
+				if (gc && gc->GetEntitiesNear(bounds, near))
+					for (auto n = near.rbegin(); n != near.rend(); ++n)
+						DrawVisFor(layer, bounds, zoomer, c->GetNthEntity(*n), g, depth + 1, stats);
+				else
+				{
+					int t = c->GetNumEntities();
+					for (int n = t - 1; n >= 0; --n)
+						DrawVisFor(layer, bounds, zoomer, c->GetNthEntity(n), g, depth + 1, stats);
+				}
 			}
 			else
 			{
@@ -22,6 +22,7 @@
  */
 
 #include "WED_NavaidLayer.h"
+#include "WED_AptDatScan.h"
 #include "GUI_Pane.h"
 
 #include "GUI_DrawUtils.h"
@@ -35,6 +36,7 @@
 #include "MemFileUtils.h"
 #include "PlatformUtils.h"
 #include "GISUtils.h"
+#include "FileUtils.h"
 
 #if APL
 	#include <OpenGL/gl.h>
@@ -130,93 +132,163 @@ static void get_airports(map<string, navaid_t>& tAirports)
 
 static void parse_apt_dat(MFMemFile * str, map<string, navaid_t>& tAirports, const string& source)
 {
-	MFScanner	s;
-	MFS_init(&s, str);
-	int versions[] = { 1000, 1021, 1050, 1100, 1130, 1200, 0 };
-		
-	if(MFS_xplane_header(&s,versions,NULL,NULL))
+	vector<apt_dat_entry_t> found;
+	if(WED_ScanAptDat(str, found))
 	{
-		int apt_type = 0;
-		Bbox2 apt_bounds;
 		navaid_t n;
+		n.freq = 0;
+		n.rwy = source;
+		for(auto& a : found)
+		{
+			n.type = a.type;
+			n.lonlat = a.lonlat;
+			n.heading = a.has_atc;  // going to store ATC tower frequency presence here.
+			n.icao = a.icao;
+			n.name = a.name;
+			tAirports[n.icao] = n;
+		}
+	}
+	MemFile_Close(str);
+}
 
-		while(!MFS_done(&s))
+/* Navaid index:
+   Once parsed, the complete navaid and airport list is kept as a binary dump in the OS cache folder. It is keyed by the
+   path, size and mtime of every file LoadNavaids may read - including the alternates that don't exist - so installing
+   an X-Plane update or a new Global Airports pack invalidates it. Later launches then skip the text parsing altogether. */
+
+#define NAVAID_INDEX_MAGIC	0x574E4931		// 'WNI1'
+
+struct navaid_index_hdr_t {
+	int					magic;
+	int					key_len;			// followed by the key itself
+	int					count;
+};
+
+static string navaid_index_path(void)
+{
+	string d = GetCacheFolder();
+	if (d.empty()) return d;
+	d += DIR_STR "wed_navaid_cache";		// not wed_asset_cache - that folder is pruned by size
+	if (FILE_make_dir_exist(d.c_str())) return string();
+	return d + DIR_STR "navaids.idx";
+}
+
+static string navaid_index_key(const vector<string>& sources)
+{
+	string key;
+	for (auto& p : sources)
+	{
+		struct stat meta;
+		char info[64];
+		if (FILE_get_file_meta_data(p, meta) == 0)
+			snprintf(info, sizeof(info), "\n%lld %lld\n", (long long) meta.st_size, (long long) meta.st_mtime);
+		else
+			snprintf(info, sizeof(info), "\n-\n");
+		key += p;
+		key += info;
+	}
+	return key;
+}
+
+struct navaid_index_writer {
+	vector<char>&	out;
+	void put(const void * p, size_t n) { out.insert(out.end(), (const char *) p, (const char *) p + n); }
+	template <class T> void pod(const T& v) { put(&v, sizeof(v)); }
+	void str(const string& s) { int n = s.size(); pod(n); put(s.data(), n); }
+};
+
+struct navaid_index_reader {
+	const char *	p;
+	const char *	end;
+	bool			ok;
+	void get(void * d, size_t n) { if (end - p < (ptrdiff_t) n) { ok = false; memset(d, 0, n); return; } memcpy(d, p, n); p += n; }
+	template <class T> void pod(T& v) { get(&v, sizeof(v)); }
+	void str(string& s) { int n; pod(n); if (!ok || n < 0 || end - p < n) { ok = false; return; } s.assign(p, n); p += n; }
+};
+
+static bool read_navaid_index(const string& path, const string& key, vector<navaid_t>& out)
+{
+	MFMemFile * f = MemFile_Open(path.c_str());
+	if (!f) return false;
+
+	navaid_index_reader r = { MemFile_GetBegin(f), MemFile_GetEnd(f), true };
+	navaid_index_hdr_t hdr;
+	r.pod(hdr);
+	if (r.ok && hdr.magic == NAVAID_INDEX_MAGIC && hdr.key_len == (int) key.size() && hdr.count >= 0 &&
+		r.end - r.p >= hdr.key_len && memcmp(r.p, key.data(), hdr.key_len) == 0)
+	{
+		r.p += hdr.key_len;
+		out.resize(hdr.count);
+		for (auto& n : out)
 		{
-			int rowcode = MFS_int(&s);
-			if (rowcode == 1 || rowcode == 16 || rowcode == 17 || rowcode == 99)   // look only for accept only ILS component overrides
+			double lon, lat;
+			int num_shapes;
+			r.pod(n.type); r.pod(lon); r.pod(lat); r.pod(n.heading); r.pod(n.freq);
+			n.lonlat = Point2(lon, lat);
+			r.str(n.name); r.str(n.icao); r.str(n.rwy);
+			r.pod(num_shapes);
+			if (!r.ok || num_shapes < 0) { r.ok = false; break; }
+			n.shape.resize(num_shapes);
+			for (auto& poly : n.shape)
 			{
-				if(apt_type)
+				int num_pts;
+				r.pod(num_pts);
+				if (!r.ok || num_pts < 0 || (r.end - r.p) / (2 * sizeof(double)) < (size_t) num_pts) { r.ok = false; break; }
+				poly.reserve(num_pts);
+				for (int i = 0; i < num_pts; ++i)
 				{
-					n.lonlat = apt_bounds.centroid();
-					tAirports[n.icao]= n;
+					r.pod(lon); r.pod(lat);
+					poly.push_back(Point2(lon, lat));
 				}
-				apt_type = rowcode;
-				apt_bounds = Bbox2();
-				n.type = 10000 + rowcode;
-				n.heading = 0;  // going to store ATC tower frequency presence here.
-				MFS_int(&s);	// skip elevation
-				MFS_int(&s);
-				MFS_int(&s);
-
-				MFS_string(&s,&n.icao);
-				MFS_string_eol(&s,&n.name);
-				n.rwy = source;
 			}
-			else if(apt_type)
+			if (!r.ok) break;
+		}
+		if (r.ok && r.p == r.end)
+		{
+			MemFile_Close(f);
+			return true;
+		}
+	}
+	MemFile_Close(f);
+	out.clear();
+	return false;
+}
+
+static void write_navaid_index(const string& path, const string& key, vector<navaid_t>::const_iterator b, vector<navaid_t>::const_iterator e)
+{
+	vector<char> buf;
+	navaid_index_writer w = { buf };
+	navaid_index_hdr_t hdr = { NAVAID_INDEX_MAGIC, (int) key.size(), (int) (e - b) };
+	w.pod(hdr);
+	w.put(key.data(), key.size());
+	for (; b != e; ++b)
+	{
+		w.pod(b->type); w.pod(b->lonlat.x()); w.pod(b->lonlat.y()); w.pod(b->heading); w.pod(b->freq);
+		w.str(b->name); w.str(b->icao); w.str(b->rwy);
+		w.pod((int) b->shape.size());
+		for (auto& poly : b->shape)
+		{
+			w.pod((int) poly.size());
+			for (auto& pt : poly)
 			{
-				if((rowcode >=  111 && rowcode <=  116) ||
-					rowcode == 1201 || rowcode == 1300  ||
-					(rowcode >=   18 && rowcode <=   21))
-				{
-					double lat = MFS_double(&s);
-					double lon = MFS_double(&s);
-					apt_bounds += Point2(lon,lat);
-				}
-				else if (rowcode == 100) // runways
-				{
-					MFS_double(&s);  // width
-					MFS_double(&s); MFS_double(&s); MFS_double(&s);
-					MFS_double(&s); MFS_double(&s); MFS_double(&s);
-					MFS_string(&s, NULL);
-					double lat = MFS_double(&s);
-					double lon = MFS_double(&s);
-					MFS_double(&s); MFS_double(&s); MFS_double(&s);
-					MFS_double(&s); MFS_double(&s); MFS_double(&s);
-					apt_bounds += Point2(lon,lat);
-					MFS_string(&s, NULL);
-					lat = MFS_double(&s);
-					lon = MFS_double(&s);
-					apt_bounds += Point2(lon,lat);
-				}
-				else if (rowcode == 101) // sealanes
-				{
-					MFS_double(&s);
-					MFS_double(&s);
-					MFS_string(&s, NULL);
-					double lat = MFS_double(&s);
-					double lon = MFS_double(&s);
-					apt_bounds += Point2(lon,lat);
-					MFS_string(&s, NULL);
-					lat = MFS_double(&s);
-					lon = MFS_double(&s);
-					apt_bounds += Point2(lon,lat);
-				}
-				else if (rowcode == 102) // helipads
-				{
-					MFS_string(&s, NULL);
-					double lat = MFS_double(&s);
-					double lon = MFS_double(&s);
-					apt_bounds += Point2(lon,lat);
-				}
-				else if (rowcode == 54 || rowcode == 1054) // ATC frequency
-				{
-					n.heading = 1;  // ATC tower frequency presence
-				}
+				w.pod(pt.x()); w.pod(pt.y());
 			}
-			MFS_string_eol(&s,NULL);
 		}
-	MemFile_Close(str);
 	}
+
+	// Write aside and rename, so a reader never maps a half-written index.
+	string tmp_path = path + ".tmp";
+	FILE * fi = fopen(tmp_path.c_str(), "wb");
+	if (!fi) return;
+	bool ok = fwrite(&buf[0], 1, buf.size(), fi) == buf.size();
+	ok = (fclose(fi) == 0) && ok;
+	if (ok)
+	{
+		FILE_delete_file(path.c_str(), false);
+		ok = FILE_rename_file(tmp_path.c_str(), path.c_str()) == 0;
+	}
+	if (!ok)
+		FILE_delete_file(tmp_path.c_str(), false);
 }
 
 void WED_NavaidLayer::parse_nav_dat(MFMemFile * str, bool merge)
@@ -490,7 +562,34 @@ void WED_NavaidLayer::LoadNavaids(void)
 	// deliberately ignoring any Custom Data/earth_424.dat or Custom Data/earth_nav.dat files that a user may have ... to avoid confusion
 	string defaultNavaids  = resourcePath + DIR_STR "Resources" DIR_STR "default data" DIR_STR "earth_nav.dat";
 	string globalNavaids = DIR_STR "Global Airports" DIR_STR "Earth nav data" DIR_STR "earth_nav.dat";
-	
+	string defaultATC = resourcePath + DIR_STR "Resources" DIR_STR "default scenery" DIR_STR "default atc dat" DIR_STR "Earth nav data" DIR_STR "atc.dat";
+	// on the linux and OSX platforms this path was different before XP11.30 for some unknown reasons. So try that, too.
+	string olderATC   = resourcePath + DIR_STR "Resources" DIR_STR "default scenery" DIR_STR "default atc" DIR_STR "Earth nav data" DIR_STR "atc.dat";
+	// in XP12 the file again changed to a different location
+	string xp12ATC    = resourcePath + DIR_STR "Resources" DIR_STR "default scenery" DIR_STR "1200 atc data" DIR_STR "Earth nav data" DIR_STR "atc.dat";
+	string defaultApts = resourcePath + DIR_STR "Resources" DIR_STR "default scenery" DIR_STR "default apt dat" DIR_STR "Earth nav data" DIR_STR "apt.dat";
+	string globalApts  = DIR_STR "Global Airports" DIR_STR "Earth nav data" DIR_STR "apt.dat";
+
+	string index_path = navaid_index_path();
+	string index_key;
+	if (!index_path.empty())
+	{
+		index_key = navaid_index_key({ defaultNavaids,
+			resourcePath + DIR_STR "Global Scenery" + globalNavaids, resourcePath + DIR_STR "Custom Scenery" + globalNavaids,
+			defaultATC, olderATC, xp12ATC,
+#if SHOW_APTS_FROM_APTDAT
+			defaultApts, resourcePath + DIR_STR "Global Scenery" + globalApts, resourcePath + DIR_STR "Custom Scenery" + globalApts
+#endif
+			});
+		vector<navaid_t> indexed;
+		if (read_navaid_index(index_path, index_key, indexed))
+		{
+			for (auto& n : indexed)
+				mNavaids.insert(n);
+			return;
+		}
+	}
+
 	MFMemFile * str = MemFile_Open(defaultNavaids.c_str());
 	if(str) parse_nav_dat(str, false);
 
@@ -499,20 +598,11 @@ void WED_NavaidLayer::LoadNavaids(void)
 		str = MemFile_Open((resourcePath + DIR_STR "Custom Scenery" + globalNavaids).c_str());
 	if(str)	parse_nav_dat(str, true);
 	
-	string defaultATC = resourcePath + DIR_STR "Resources" DIR_STR "default scenery" DIR_STR "default atc dat" DIR_STR "Earth nav data" DIR_STR "atc.dat";
 	str = MemFile_Open(defaultATC.c_str());
-	// on the linux and OSX platforms this path was different before XP11.30 for some unknown reasons. So try that, too.
 	if(!str)
-	{
-		defaultATC = resourcePath + DIR_STR "Resources" DIR_STR "default scenery" DIR_STR "default atc" DIR_STR "Earth nav data" DIR_STR "atc.dat";
-		str = MemFile_Open(defaultATC.c_str());
-	}
-	// in XP12 the file again changed to a different location
+		str = MemFile_Open(olderATC.c_str());
 	if (!str)
-	{
-		defaultATC = resourcePath + DIR_STR "Resources" DIR_STR "default scenery" DIR_STR "1200 atc data" DIR_STR "Earth nav data" DIR_STR "atc.dat";
-		str = MemFile_Open(defaultATC.c_str());
-	}
+		str = MemFile_Open(xp12ATC.c_str());
 	if(str)	parse_atc_dat(str);
 
 //	str = MemFile_Open(seattleATC.c_str());  // don't take local local ATC data any more
@@ -520,8 +610,6 @@ void WED_NavaidLayer::LoadNavaids(void)
 	
 #if SHOW_APTS_FROM_APTDAT
 	map<string,navaid_t> tAirports;
-	string defaultApts = resourcePath + DIR_STR "Resources" DIR_STR "default scenery" DIR_STR "default apt dat" DIR_STR "Earth nav data" DIR_STR "apt.dat";
-	string globalApts  = DIR_STR "Global Airports" DIR_STR "Earth nav data" DIR_STR "apt.dat";
 
 	str = MemFile_Open(defaultApts.c_str());
 	if(str) parse_apt_dat(str, tAirports, "");
@@ -557,6 +645,9 @@ void WED_NavaidLayer::LoadNavaids(void)
 
 #endif
 
+	if (!index_path.empty())
+		write_navaid_index(index_path, index_key, mNavaids.cbegin(), mNavaids.cend());
+
 // Todo: speedup drawing by sorting mNavaids into longitude buckets, so the preview function only have to go through a smalller part of the overall list.
 //       although for now Navaid map drawing is under 1 msec on a 3.6 GHz CPU at all times == good enough
 }
@@ -1009,7 +1009,7 @@ struct	preview_string : WED_PreviewItem {
 		if(ps && sinfo->objs.size())
 		{
 			const XObj8 * o;
-			if(rmgr->GetObjRelative(sinfo->objs.front(),vpath,o))
+			if(rmgr->GetObjRelativeAsync(sinfo->objs.front(),vpath,o) == WED_ResourceMgr::obj_Ready)
 			{
 				float real_radius=pythag(
 						o->xyz_max[0]- o->xyz_min[0],
@@ -1190,7 +1190,7 @@ struct	preview_airportlights : WED_PreviewItem {
 					}
 				}
 				const XObj8 * obj;
-				if(rmgr->GetObjRelative(sinfo->objs.front(), vpath, obj))
+				if(rmgr->GetObjRelativeAsync(sinfo->objs.front(), vpath, obj) == WED_ResourceMgr::obj_Ready)
 					draw_string_preview(pts, d0, ds, *sinfo, zoomer, g, tman, obj);
 			}
 			else
@@ -1234,7 +1234,7 @@ struct	preview_facade : public preview_polygon {
 			fac->GetResource(vpath);
 			const fac_info_t * info;
 
-			if (rmgr->GetFac(vpath, info))
+			if (rmgr->GetFacAsync(vpath, info) == WED_ResourceMgr::obj_Ready)	// else the map is refreshed when its OBJs arrive
 			for(int i = 0; i < n; ++i)
 			{
 				static Bezier2		b;
@@ -1393,7 +1393,7 @@ struct	preview_facade : public preview_polygon {
 			zoomer->Scalef(ppm,ppm,ppm);
 			zoomer->Rotatef(90, 1,0,0);
 
-			if(rmgr->GetFac(vpath, info))
+			if(rmgr->GetFacAsync(vpath, info) == WED_ResourceMgr::obj_Ready)
 				draw_facade(tman, rmgr, vpath, *info, pts, choices, fac->GetHeight(), g, true, 0.7 * zoomer->PixelSize(bb_geo, 1.0), preview_level);
 			zoomer->PopMatrix();
 		}
@@ -1536,13 +1536,17 @@ struct	preview_object : public WED_PreviewItem {
 
 		float agl = obj->HasCustomMSL() > 1 ? obj->GetCustomMSL() : 0.0;
 
-		if (rmgr->GetObj(vpath, o))
+		int obj_state = rmgr->GetObjAsync(vpath, o);
+		int agp_state = obj_state == WED_ResourceMgr::obj_Missing ? rmgr->GetAGPAsync(vpath, agp) : WED_ResourceMgr::obj_Missing;
+		if (obj_state == WED_ResourceMgr::obj_Ready)
 		{
 			draw_obj_at_ll(tman, o, loc, agl, obj->GetHeading() + zoomer->GetRotation(loc), g, zoomer);
 //			draw_obj_at_ll(tman, o, loc, agl, obj->GetHeading(), g, zoomer);
 		}
-		else if (rmgr->GetAGP(vpath, agp))
+		else if (agp_state == WED_ResourceMgr::obj_Ready)
 			draw_agp_at_ll(tman, agp, loc, agl, obj->GetHeading() + zoomer->GetRotation(loc), g, zoomer, preview_level);
+		else if (obj_state == WED_ResourceMgr::obj_Pending || agp_state == WED_ResourceMgr::obj_Pending)
+			;	// still loading - the map gets refreshed when it arrives
 		else
 		{
 			loc = zoomer->LLToPixel(loc);
@@ -1646,7 +1650,7 @@ struct	preview_windsock : public WED_PreviewItem {
 		ws->GetLocation(gis_Geo,loc);
 		const XObj8 * o = NULL;
 
-		if(rmgr->GetObj("lib/airport/landscape/windsock.obj",o))
+		if(rmgr->GetObjAsync("lib/airport/landscape/windsock.obj",o) == WED_ResourceMgr::obj_Ready)
 		{
 			g->SetState(false,1,false,false,true,true,true);
 			glColor3f(1,1,1);
@@ -1679,7 +1683,7 @@ struct	preview_beacon : public WED_PreviewItem {
 			default /*beacon_Airport*/ : vpath = "lib/airport/beacons/beacon_airport_big.obj";
 		}
 
-		if(rmgr->GetObj(vpath, o))
+		if(rmgr->GetObjAsync(vpath, o) == WED_ResourceMgr::obj_Ready)
 		{
 			g->SetState(false,1,false,false,true,true,true);
 			glColor3f(1,1,1);
@@ -1719,7 +1723,8 @@ struct	preview_truck : public WED_PreviewItem {
 			}
 
 		const XObj8 * o1 = NULL, * o2 = NULL;
-		if(!vpath1.empty() && rmgr->GetObj(vpath1,o1))
+		int obj_state = vpath1.empty() ? WED_ResourceMgr::obj_Missing : rmgr->GetObjAsync(vpath1,o1);
+		if(obj_state == WED_ResourceMgr::obj_Ready)
 		{
 			g->SetState(false,1,false,true,true,true,true);
 			glColor3f(1,1,1);
@@ -1730,8 +1735,7 @@ struct	preview_truck : public WED_PreviewItem {
 
 			if(trk->GetTruckType() == atc_ServiceTruck_Baggage_Train)
 			{
-				rmgr->GetObj(vpath2,o2);
-				if(o2)
+				if(rmgr->GetObjAsync(vpath2,o2) == WED_ResourceMgr::obj_Ready)
 				{
 					double gap = 3.899;
 					Vector2 dirv(sin(trk_heading * DEG_TO_RAD),
@@ -1748,8 +1752,7 @@ struct	preview_truck : public WED_PreviewItem {
 			}
 			if(trk->GetTruckType() == atc_ServiceTruck_Ground_Power_Unit)
 			{
-				rmgr->GetObj(vpath2,o2);
-				if(o2)
+				if(rmgr->GetObjAsync(vpath2,o2) == WED_ResourceMgr::obj_Ready)
 				{
 					double gap = 4.247;
 					Vector2 dirv(sin(trk_heading * DEG_TO_RAD),
@@ -1761,7 +1764,7 @@ struct	preview_truck : public WED_PreviewItem {
 				}
 			}
 		}
-		else
+		else if(obj_state == WED_ResourceMgr::obj_Missing)	// pending ones show up once loaded
 		{
 			Point2 l;
 			trk->GetLocation(gis_Geo,l);
@@ -1798,7 +1801,7 @@ struct	preview_light : public WED_PreviewItem {
 		}
 
 		const XObj8 * o = NULL;
-		if(!vpath.empty() && rmgr->GetObj(vpath,o))
+		if(!vpath.empty() && rmgr->GetObjAsync(vpath,o) == WED_ResourceMgr::obj_Ready)
 		{
 			g->SetState(false,1,false,true,true,true,true);
 			glColor3f(1,1,1);
@@ -63,6 +63,11 @@
 
 #define PREDEFINED_MAPS 2
 
+#define TEXTURE_BUDGET     (256 << 20)   // bytes of tile textures kept around, beyond what is on screen
+
+#define MAX_DOWNLOADS      6     // tile requests in flight at any time
+#define MAX_DOWNLOADS_OSM  2     // the OSM tile servers are volunteer run, be extra nice to them
+
 static const char * attributions[PREDEFINED_MAPS] = {
 "© OpenStreetMap Contributors",
 // ToDo: use shorter specific ESRI attribution by downloading https://static.arcgis.com/attribution/World_Imagery
@@ -173,23 +178,110 @@ static void get_tile_range_for_box(const double bounds[4], int z, int tiles[4])
 }
 
 
+static bool is_ESRI_blank(const string& path, const ImageInfo& info)
+{
+	bool same_grey = false;           // ESRI sends a mostly solid grey image with embedded error text if image isn't available
+
+	if(path.find("arcgisonline.com") != string::npos)
+		if (info.channels == 3 && info.width > 6 && info.height > 6)
+		{
+			int line_stride = info.channels * (info.width + info.pad);
+
+			auto pixel = info.data + 2 * line_stride + 6;  // 3rd row, 3rd pixel
+			auto color = *pixel;
+			same_grey = true;
+
+			for (int x = info.width - 4; x > 0; x--)
+				if (color != *(pixel++) || color != *(pixel++) || color != *(pixel++))
+				{
+					same_grey = false;
+					break;
+				}
+
+			pixel = info.data + (info.height - 3) * line_stride + 6; // 3rd last row, 3rd pixel
+			for (int x = info.width - 4; x > 0; x--)
+				if (color != *(pixel++) || color != *(pixel++) || color != *(pixel++))
+				{
+					same_grey = false;
+					break;
+				}
+		}
+
+	return same_grey;
+}
+
+static int decode_tile(const string& path, int map_mode, ImageInfo& info)
+{
+	info.data = NULL;
+	int r = CreateBitmapFromPNG(path.c_str(), &info, false, 0);
+	if(r != 0)
+		r = CreateBitmapFromJPEG(path.c_str(), &info);
+	if (r != 0)
+	{
+		LOG_MSG("E/Sli bad png or JPG in %s\n", path.c_str());
+		return 2;
+	}
+	if (info.channels == 3)                                                        // apply to color changes
+		for (int x = 0; x < info.height * (info.width + info.pad) * info.channels; x += info.channels)
+		{
+			double BRIGHTNESS = -20;
+			double SATURATION = 1.0;
+			if (map_mode == 1) { BRIGHTNESS = -140.0; SATURATION = 0.4; }
+
+			int val = 0.3 * info.data[x] + 0.6 * info.data[x + 1] + 0.1 * info.data[x + 2];  // deliberately not HSV weighing - want red's brighter
+			for (int c = 0; c < info.channels; ++c)
+				info.data[x + c] = intlim((1.0 - SATURATION) * val + SATURATION * info.data[x + c] + BRIGHTNESS, 0, 255);
+		}
+	if (is_ESRI_blank(path, info))
+	{
+		DestroyBitmap(&info);
+		info.data = NULL;
+		return 1;
+	}
+	return 0;
+}
+
+// Tiles come through gFileCache, which downloads each on its own curl thread and keeps them on disk.
+class cache_tile_source : public WED_TileSource {
+public:
+	virtual	int		fetch(const string& url, const string& folder, string& out_file)
+	{
+		WED_file_cache_response res = gFileCache.request_file(WED_file_cache_request(cache_domain_osm_tile, folder, url));
+		if (res.out_status == cache_status_available)
+		{
+			out_file = res.out_path;
+			return tile_Ready;
+		}
+		if (res.out_status == cache_status_error)
+		{
+			int code = res.out_error_type;
+			LOG_MSG("E/Sli cache error %s: %d\n%s\n", url.c_str(), code, res.out_error_human.c_str());
+			return tile_Failed;
+		}
+		return res.out_status == cache_status_downloading ? tile_Transferring : tile_Waiting;
+	}
+	virtual	int		decode(const string& file, int map_mode, ImageInfo& info)	{ return decode_tile(file, map_mode, info); }
+	virtual	void	release(ImageInfo& info)									{ DestroyBitmap(&info); }
+};
+
 WED_SlippyMap::WED_SlippyMap(GUI_Pane * h, WED_MapZoomerNew * zoomer, IResolver * resolver)
 	: WED_MapLayer(h, zoomer, resolver),
-	m_cache_request(NULL),
+	m_loader(new cache_tile_source),
+	m_cache(TEXTURE_BUDGET),
 	mMapMode(0)
 {
 }
 
 WED_SlippyMap::~WED_SlippyMap()
 {
-	delete m_cache_request;
-	m_cache_request = NULL;
 }
 
 void	WED_SlippyMap::DrawVisualization(bool inCurrent, GUI_GraphState * g)
 {
 	if (mMapMode ==0) return;
-	finish_loading_tile();
+	m_cache.begin_frame();
+	m_loader.poll();
+	finish_decodes();
 
 	double map_bounds[4];
 
@@ -205,6 +297,15 @@ void	WED_SlippyMap::DrawVisualization(bool inCurrent, GUI_GraphState * g)
 	int min_zoom = flt_abs(map_bounds[1]) > 60.0 ? MIN_ZOOM-1 : MIN_ZOOM; // get those ant/artic designers a bit more visibility
 	if(z_max < min_zoom) return;
 
+	struct tile_want_t {
+		double		priority;
+		string		path;
+		string		url;
+		string		folder;
+	};
+	vector<tile_want_t> missing;
+	set<string> visible;
+
 	int want = 0, got = 0, bad = 0;
 	for(int z = max(min_zoom,z_max-1); z <= z_max; ++z)      // Display only the next lower zoom level
 	{                                                        // avoids having to load up to 4x14 extra tiles at ZL16
@@ -262,12 +363,13 @@ void	WED_SlippyMap::DrawVisualization(bool inCurrent, GUI_GraphState * g)
 
 			//The potential place the tile could appear on disk, were it to be downloaded or have been downloaded
 			string potential_path = gFileCache.url_to_cache_path(WED_file_cache_request(cache_domain_osm_tile, folder_prefix , url));
+			visible.insert(potential_path);
 
-			if (m_cache.count(potential_path))
+			int id;
+			if (m_cache.lookup(potential_path, id))
 			{
 				++got;
 
-				int id = m_cache[potential_path];
 				if(id != 0)
 				{
 					g->SetState(0, 1, 0, 0, 0, 0, 0);
@@ -291,14 +393,34 @@ void	WED_SlippyMap::DrawVisualization(bool inCurrent, GUI_GraphState * g)
 					++bad;
 				}
 			}
-			else if(m_cache_request == NULL)
+			else if(!m_loader.is_loading(potential_path))
 			{
-				m_cache_request = new WED_file_cache_request(cache_domain_osm_tile, folder_prefix, url);
+				// The coarser level goes first, it covers the view with a quarter of the tiles. Then from the center out.
+				double dx = x - 0.5 * (tiles[0] + tiles[2]);
+				double dy = y - 0.5 * (tiles[1] + tiles[3]);
+				tile_want_t w = { (z - z_max + 1) * 1.0e6 + dx * dx + dy * dy, potential_path, url, folder_prefix };
+				missing.push_back(w);
 			}
 		}
 	}
 
-	if (m_cache_request)
+	m_loader.set_visible(visible);
+
+	vector<int> evicted;
+	m_cache.evict(evicted);
+	for (auto id : evicted)
+	{
+		GLuint tex_id = id;
+		glDeleteTextures(1, &tex_id);
+	}
+
+	sort(missing.begin(), missing.end(), [](const tile_want_t& a, const tile_want_t& b) { return a.priority < b.priority; });
+	size_t max_downloads = mMapMode == 1 ? MAX_DOWNLOADS_OSM : MAX_DOWNLOADS;
+	for(auto& m : missing)
+		if(!m_loader.load(m.path, m.url, m.folder, mMapMode, max_downloads))
+			break;
+
+	if (m_loader.busy())
 	{
 		this->Start(0.05);
 	}
@@ -314,6 +436,14 @@ void	WED_SlippyMap::DrawVisualization(bool inCurrent, GUI_GraphState * g)
 	GetHost()->GetBounds(bnds);
 	GLfloat white[4] = { 1, 1, 1, 1 };
 	GUI_FontDraw(g, font_UI_Basic, white, bnds[0] + 10, bnds[1] + 40, str);
+#if DEV && SHOW_DEBUG_INFO
+	{
+		char msg[100];
+		snprintf(msg, sizeof(msg), "%d tex %d MB, %d hits %d misses %d evicted", (int) m_cache.size(), (int) (m_cache.bytes() >> 20),
+				m_cache.hits(), m_cache.misses(), m_cache.evictions());
+		GUI_FontDraw(g, font_UI_Basic, white, bnds[0] + 10, bnds[1] + 55, msg);
+	}
+#endif
 
 	if(mMapMode <= PREDEFINED_MAPS)
 	{
@@ -336,101 +466,32 @@ void	WED_SlippyMap::GetCaps(bool& draw_ent_v, bool& draw_ent_s, bool& cares_abou
 	draw_ent_v = draw_ent_s = cares_about_sel = wants_clicks = 0;
 }
 
-static bool is_ESRI_blank(const string& path, const ImageInfo& info)
+void	WED_SlippyMap::finish_decodes()
 {
-	bool same_grey = false;           // ESRI sends a mostly solid grey image with embedded error text if image isn't available
+	vector<WED_TileLoader::tile_t *> done;
+	m_loader.get_done(done);
 
-	if(path.find("arcgisonline.com") != string::npos)
-		if (info.channels == 3 && info.width > 6 && info.height > 6)
-		{
-			int line_stride = info.channels * (info.width + info.pad);
-
-			auto pixel = info.data + 2 * line_stride + 6;  // 3rd row, 3rd pixel
-			auto color = *pixel;
-			same_grey = true;
-
-			for (int x = info.width - 4; x > 0; x--)
-				if (color != *(pixel++) || color != *(pixel++) || color != *(pixel++))
-				{
-					same_grey = false;
-					break;
-				}
-
-			pixel = info.data + (info.height - 3) * line_stride + 6; // 3rd last row, 3rd pixel
-			for (int x = info.width - 4; x > 0; x--)
-				if (color != *(pixel++) || color != *(pixel++) || color != *(pixel++))
-				{
-					same_grey = false;
-					break;
-				}
-		}
-
-	return same_grey;
-}
-
-void	WED_SlippyMap::finish_loading_tile()
-{
-	if (m_cache_request != NULL)
+	for (auto j : done)
 	{
-		WED_file_cache_response res = gFileCache.request_file(*m_cache_request);
-		if (res.out_status == cache_status_available)
+		if (j->status == 0)
 		{
-			struct ImageInfo info;
-			int r = CreateBitmapFromPNG(res.out_path.c_str(), &info, false, 0);
-			if(r != 0)
-				r = CreateBitmapFromJPEG(res.out_path.c_str(), &info);
-			if (r == 0)
+			GLuint tex_id;
+			int w, h;
+			glGenTextures(1, &tex_id);
+			if (LoadTextureFromImage(j->info, tex_id, tex_Linear, &w, &h, NULL, NULL))
 			{
-				if (info.channels == 3)                                                        // apply to color changes
-					for (int x = 0; x < info.height * (info.width + info.pad) * info.channels; x += info.channels)
-					{
-						double BRIGHTNESS = -20;
-						double SATURATION = 1.0;
-						if (mMapMode == 1) { BRIGHTNESS = -140.0; SATURATION = 0.4; }
-
-						int val = 0.3 * info.data[x] + 0.6 * info.data[x + 1] + 0.1 * info.data[x + 2];  // deliberately not HSV weighing - want red's brighter
-						for (int c = 0; c < info.channels; ++c)
-							info.data[x + c] = intlim((1.0 - SATURATION) * val + SATURATION * info.data[x + c] + BRIGHTNESS, 0, 255);
-					}
-				if (is_ESRI_blank(res.out_path, info))
-				{
-					m_cache[res.out_path] = 0;
-				}
-				else
-				{
-					GLuint tex_id;
-					glGenTextures(1, &tex_id);
-					if (LoadTextureFromImage(info, tex_id, tex_Linear, NULL, NULL, NULL, NULL))
-					{
-						m_cache[res.out_path] = tex_id;
-					}
-					else
-					{
-						LOG_MSG("E/Sli bad png or JPG in %s\n", res.out_path.c_str());
-						m_cache[res.out_path] = 0;
-					}
-				}
+				m_cache.insert(j->path, tex_id, (size_t) w * h * 4);		// drivers keep RGB as RGBA
 			}
 			else
 			{
-				LOG_MSG("E/Sli bad png or JPG in %s\n", res.out_path.c_str());
-				m_cache[res.out_path] = 0;
+				LOG_MSG("E/Sli bad png or JPG in %s\n", j->file.c_str());
+				glDeleteTextures(1, &tex_id);
+				m_cache.insert(j->path, 0, 0);
 			}
-			DestroyBitmap(&info);
-			delete m_cache_request;
-			m_cache_request = NULL;
-		}
-		else if (res.out_status == cache_status_error)
-		{
-			int code = res.out_error_type;
-
-			LOG_MSG("E/Sli cache error %s: %d\n%s\n", res.out_path.c_str(), code, res.out_error_human.c_str());
-
-			m_cache[res.out_path] = 0;
-
-			delete m_cache_request;
-			m_cache_request = NULL;
 		}
+		else
+			m_cache.insert(j->path, 0, 0);
+		m_loader.release(j);
 	}
 }
 
@@ -25,10 +25,9 @@
 #ifndef WED_SlippyMap_h
 #define WED_SlippyMap_h
 
-class	WED_file_cache_request;
-
 #include "GUI_Timer.h"
 #include "WED_MapLayer.h"
+#include "WED_SlippyTiles.h"
 
 enum yCoord_t { yNone, yNormal, yYahoo, yOSGeo };
 
@@ -46,13 +45,16 @@ public:
 
 private:
 
-			void	finish_loading_tile();
+			void	finish_decodes();
 			int 	get_zl_for_map(double in_ppm, double lattitude);
 
-	WED_file_cache_request* m_cache_request;
+	// Tile loading: gFileCache runs every download on its own curl thread, the loader keeps up to a handful of
+	// them in flight and decodes and color adjusts the finished files on its own threads, so the UI thread only
+	// uploads textures.
+	WED_TileLoader					m_loader;
 
 	//The texture cache, where they key is the tile texture path on disk and the value is the texture id
-	map<string,int>	m_cache;
+	WED_TileLRU		m_cache;
 
 			int		mMapMode;
 			string	url_printf_fmt;
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2026, Laminar Research.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "WED_SlippyTiles.h"
+
+WED_TileLRU::WED_TileLRU(size_t budget_bytes) :
+	m_budget(budget_bytes), m_bytes(0), m_frame(0), m_hits(0), m_misses(0), m_evictions(0)
+{
+}
+
+void	WED_TileLRU::begin_frame()
+{
+	++m_frame;
+}
+
+bool	WED_TileLRU::lookup(const string& key, int& out_id)
+{
+	auto i = m_index.find(key);
+	if (i == m_index.end())
+		return false;
+	m_lru.splice(m_lru.begin(), m_lru, i->second);
+	i->second->frame = m_frame;
+	out_id = i->second->id;
+	++m_hits;
+	return true;
+}
+
+void	WED_TileLRU::insert(const string& key, int id, size_t bytes)
+{
+	auto i = m_index.find(key);
+	if (i != m_index.end())
+	{
+		m_bytes -= i->second->bytes;
+		m_lru.erase(i->second);
+	}
+	entry_t e = { key, id, bytes, m_frame };
+	m_lru.push_front(e);
+	m_index[key] = m_lru.begin();
+	m_bytes += bytes;
+	++m_misses;
+}
+
+void	WED_TileLRU::evict(vector<int>& out_ids)
+{
+	while (m_bytes > m_budget && !m_lru.empty() && m_lru.back().frame != m_frame)
+	{
+		entry_t& e = m_lru.back();
+		if (e.id) out_ids.push_back(e.id);
+		m_bytes -= e.bytes;
+		m_index.erase(e.key);
+		m_lru.pop_back();
+		++m_evictions;
+	}
+}
+
+WED_TileLoader::WED_TileLoader(WED_TileSource * source) :
+	m_source(source), m_decode_quit(false)
+{
+}
+
+WED_TileLoader::~WED_TileLoader()
+{
+	decode_stop();
+	delete m_source;
+}
+
+bool	WED_TileLoader::load(const string& path, const string& url, const string& folder, int map_mode, size_t max_downloads)
+{
+	if(m_downloads.size() >= max_downloads)
+		return false;
+	download_t d = { url, folder, map_mode };
+	auto i = m_downloads.insert(make_pair(path, d)).first;
+	if(poll_one(i))			// tiles already on disk come right back and free their slot
+		m_downloads.erase(i);
+	return true;
+}
+
+bool	WED_TileLoader::is_loading(const string& path) const
+{
+	return m_downloads.count(path) || m_decoding.count(path);
+}
+
+void	WED_TileLoader::set_visible(set<string>& visible)
+{
+	m_visible.swap(visible);
+
+	// Tiles that scrolled off before a decoder got to them aren't worth decoding any more.
+	lock_guard<mutex> lock(m_decode_lock);
+	for(auto j = m_decode_queue.begin(); j != m_decode_queue.end(); )
+		if(m_visible.count((*j)->path))
+			++j;
+		else
+		{
+			m_decoding.erase((*j)->path);
+			delete *j;
+			j = m_decode_queue.erase(j);
+		}
+}
+
+void	WED_TileLoader::poll()
+{
+	for(auto d = m_downloads.begin(); d != m_downloads.end(); )
+		if(poll_one(d))
+			d = m_downloads.erase(d);
+		else
+			++d;
+}
+
+bool	WED_TileLoader::poll_one(map<string, download_t>::iterator d)
+{
+	string file;
+	int status = m_source->fetch(d->second.url, d->second.folder, file);
+
+	if(status == WED_TileSource::tile_Transferring)
+		return false;		// left to finish even when its tile scrolled off, it lands in the disk cache for next time
+	if(status == WED_TileSource::tile_Waiting)
+		return !m_visible.count(d->first);
+
+	if(status == WED_TileSource::tile_Ready && !m_visible.count(d->first))
+		return true;
+
+	tile_t * t = new tile_t;
+	t->path = d->first;
+	t->file = file;
+	t->map_mode = d->second.map_mode;
+	t->info.data = NULL;
+	t->status = 2;
+	m_decoding.insert(d->first);
+
+	lock_guard<mutex> lock(m_decode_lock);
+	if(status == WED_TileSource::tile_Failed)
+	{
+		m_decode_done.push_back(t);
+		return true;
+	}
+	m_decode_queue.push_back(t);
+	if(m_decode_threads.empty())
+	{
+		int n = min(max((int) thread::hardware_concurrency() - 1, 1), 4);
+		for (int i = 0; i < n; ++i)
+			m_decode_threads.push_back(thread(&WED_TileLoader::decode_worker, this));
+	}
+	m_decode_wake.notify_one();
+	return true;
+}
+
+void	WED_TileLoader::get_done(vector<tile_t *>& out_tiles)
+{
+	{
+		lock_guard<mutex> lock(m_decode_lock);
+		out_tiles.swap(m_decode_done);
+		m_decode_done.clear();
+	}
+	for (auto t : out_tiles)
+		m_decoding.erase(t->path);
+}
+
+void	WED_TileLoader::release(tile_t * tile)
+{
+	if (tile->status == 0)
+		m_source->release(tile->info);
+	delete tile;
+}
+
+void	WED_TileLoader::decode_worker()
+{
+	unique_lock<mutex> lock(m_decode_lock);
+	while(1)
+	{
+		m_decode_wake.wait(lock, [this] { return m_decode_quit || !m_decode_queue.empty(); });
+		if(m_decode_quit)
+			return;
+		tile_t * t = m_decode_queue.front();
+		m_decode_queue.pop_front();
+		lock.unlock();
+
+		t->status = m_source->decode(t->file, t->map_mode, t->info);
+
+		lock.lock();
+		m_decode_done.push_back(t);
+	}
+}
+
+void	WED_TileLoader::decode_stop()
+{
+	{
+		lock_guard<mutex> lock(m_decode_lock);
+		m_decode_quit = true;
+	}
+	m_decode_wake.notify_all();
+	for (auto& t : m_decode_threads)
+		t.join();
+	m_decode_threads.clear();
+
+	for (auto t : m_decode_queue)
+		delete t;
+	m_decode_queue.clear();
+	for (auto t : m_decode_done)
+		release(t);
+	m_decode_done.clear();
+	m_decoding.clear();
+	m_downloads.clear();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026, Laminar Research.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WED_SlippyTiles_h
+#define WED_SlippyTiles_h
+
+// The parts of the slippy map that know nothing about GL or the GUI, so they can be exercised on their own.
+
+#include "BitmapUtils.h"
+#include <list>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Byte budgeted LRU of tile textures.  It only keeps the books - the ids it evicts are handed back to the caller
+// to delete, so it knows nothing about GL.  Every tile looked up or inserted since the last begin_frame() is pinned,
+// i.e. what is on screen never gets evicted, even if that alone is over budget.
+class	WED_TileLRU {
+public:
+					 WED_TileLRU(size_t budget_bytes);
+
+			void	begin_frame();
+			bool	lookup(const string& key, int& out_id);					// a hit, also pins the tile
+			void	insert(const string& key, int id, size_t bytes);		// a miss that got loaded, pinned as well
+			void	evict(vector<int>& out_ids);							// down to budget, out_ids are the non-zero ids dropped
+
+			size_t	size() const { return m_index.size(); }
+			size_t	bytes() const { return m_bytes; }
+			int		hits() const { return m_hits; }
+			int		misses() const { return m_misses; }
+			int		evictions() const { return m_evictions; }
+
+private:
+	struct entry_t {
+		string		key;
+		int			id;
+		size_t		bytes;
+		int			frame;		// last frame it was used in
+	};
+
+	list<entry_t>								m_lru;		// most recently used first
+	unordered_map<string, list<entry_t>::iterator>	m_index;
+	size_t		m_budget;
+	size_t		m_bytes;
+	int			m_frame;
+	int			m_hits;
+	int			m_misses;
+	int			m_evictions;
+};
+
+// Where the tiles come from.  fetch() is called from the UI thread only, decode() and release() from the
+// decoder threads as well, so those must not touch any state of the source.
+class	WED_TileSource {
+public:
+	enum { tile_Waiting, tile_Transferring, tile_Ready, tile_Failed };
+
+	virtual			~WED_TileSource() { }
+
+	// Polled until it says tile_Ready (with the file to decode) or tile_Failed.  A tile that is merely waiting is
+	// dropped by the loader once it is no longer visible, one that is transferring is always left to finish.
+	virtual	int		fetch(const string& url, const string& folder, string& out_file)=0;
+	// 0 = decoded into info, 1 = decoded but nothing to show (e.g. a "no imagery" tile), 2 = not decodable
+	virtual	int		decode(const string& file, int map_mode, ImageInfo& info)=0;
+	virtual	void	release(ImageInfo& info)=0;
+};
+
+// Keeps up to max_downloads tiles in flight with the source and decodes what arrives on a few threads of its own,
+// so the UI thread only has to upload the textures.  All calls are UI thread only.
+class	WED_TileLoader {
+public:
+	struct tile_t {
+		string		path;			// what the tile was asked for by
+		string		file;			// the file to decode, as the source reported it
+		int			map_mode;
+		ImageInfo	info;
+		int			status;			// as from WED_TileSource::decode, a tile that failed to load comes back as 2
+	};
+
+					 WED_TileLoader(WED_TileSource * source);	// takes ownership of the source
+					~WED_TileLoader();
+
+			bool	load(const string& path, const string& url, const string& folder, int map_mode, size_t max_downloads);	// false if all slots are taken
+			bool	is_loading(const string& path) const;
+			void	set_visible(set<string>& visible);		// swapped in, undecoded tiles that are not in it are dropped
+			void	poll();									// hands finished downloads to the decoders
+			void	get_done(vector<tile_t *>& out_tiles);
+			void	release(tile_t * tile);					// once done with a tile from get_done
+			bool	busy() const { return !m_downloads.empty() || !m_decoding.empty(); }
+			size_t	downloads() const { return m_downloads.size(); }
+
+private:
+	struct download_t {
+		string		url;
+		string		folder;
+		int			map_mode;
+	};
+
+			bool	poll_one(map<string, download_t>::iterator d);		// true if the download is over
+			void	decode_worker();
+			void	decode_stop();
+
+	WED_TileSource *				m_source;
+	map<string, download_t>			m_downloads;	// by tile path
+	set<string>						m_decoding;		// tile paths handed to the decoders and not yet collected
+	set<string>						m_visible;		// tile paths the last draw wanted
+
+	// m_decode_queue and m_decode_done are shared with m_decode_threads under m_decode_lock.
+	mutex							m_decode_lock;
+	condition_variable				m_decode_wake;
+	list<tile_t *>					m_decode_queue;
+	vector<tile_t *>				m_decode_done;
+	bool							m_decode_quit;
+	vector<thread>					m_decode_threads;
+};
+
+#endif /* WED_SlippyTiles_h */
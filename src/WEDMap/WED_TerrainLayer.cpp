@@ -214,18 +214,20 @@ void WED_TerrainLayer::LoadTerrain(Bbox2& bounds)
 					AddObjectWithMode, BeginSegment, AddSegmentShapePoint, EndSegment,
 					BeginPolygon, BeginPolygonWinding, AddPolygonPoint,EndPolygonWinding, EndPolygon, AddRasterData, SetFilter_ };
 
+	DSFKeepDecoderCache(true);
 	for (const auto& v : vpaths)
 	{
 		if (mTerrains.find(v) != mTerrains.end()) continue;
 		terrain_t& tile = mTerrains[v];
 		tile.current_color = 0;                      // initially abuse this for keeping track of terrain_def indices
-		if (DSFReadFile(v.c_str(), malloc, free, &cb, NULL, &tile) == dsf_ErrOK)
+		if (DSFReadFileMapped(v.c_str(), &cb, NULL, &tile) == dsf_ErrOK)
 		{
 			int lon, lat;
 			if(sscanf(v.substr(v.length() - 11, 7).c_str(), "%d%d", &lat, &lon) == 2)
 				tile.bounds = { {(double) lon, (double) lat}, {(double) lon + 1, (double) lat + 1} };
 		}
 	}
+	DSFKeepDecoderCache(false);
 }
 
 void		WED_TerrainLayer::DrawVisualization		(bool inCurrent, GUI_GraphState * g)
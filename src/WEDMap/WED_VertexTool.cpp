@@ -36,6 +36,7 @@
 #include "WED_ExclusionPoly.h"
 #include "WED_Taxiway.h"
 #include "WED_PolygonPlacement.h"
+#include "WED_GISComposite.h"
 #include "WED_DrapedOrthophoto.h"
 #include "WED_RoadEdge.h"
 #include "WED_Runway.h"
@@ -1349,9 +1350,17 @@ void		WED_VertexTool::AddEntityRecursive(IGISEntity * e, const Bbox2& vis_area )
 
 		if ((cmp = SAFE_CAST(IGISComposite, e)) != NULL)
 		{
-			c = cmp->GetNumEntities();
-			for (n = 0; n < c; ++n)
-				AddEntityRecursive(cmp->GetNthEntity(n),vis_area);
+			vector<int> near;
+			WED_GISComposite * gc = dynamic_cast<WED_GISComposite *>(cmp);
+			if (gc && gc->GetEntitiesNear(vis_area, near))
+				for (auto i : near)
+					AddEntityRecursive(cmp->GetNthEntity(i),vis_area);
+			else
+			{
+				c = cmp->GetNumEntities();
+				for (n = 0; n < c; ++n)
+					AddEntityRecursive(cmp->GetNthEntity(n),vis_area);
+			}
 		}
 		break;
 	}
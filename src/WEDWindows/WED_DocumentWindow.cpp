@@ -448,6 +448,9 @@ int	WED_DocumentWindow::HandleCommand(int command)
 	// wed_EdgePavement,
 	// wed_MowGrass,
 	case wed_AlignApt:	WED_AlignAirports(mDocument);	return 1;
+#if DEV
+	case wed_BenchSpatialIndex:	WED_BenchSpatialIndex(mDocument);	return 1;
+#endif
 	case wed_CreateApt:	WED_DoMakeNewAirport(mDocument); return 1;
 	case wed_EditApt:	WED_DoSetCurrentAirport(mDocument); return 1;
 	case gui_Close:		mDocument->TryClose();	return 1;
@@ -585,6 +588,9 @@ int	WED_DocumentWindow::CanHandleCommand(int command, string& ioName, int& ioChe
 	case wed_AgePavement:	 return 1;
 	case wed_EdgePavement:   return 0;    //  still Todo !!!!
 	case wed_MowGrass:       return 1;
+#if DEV
+	case wed_BenchSpatialIndex:	return 1;
+#endif
 
 
 	case wed_CreateApt:	return WED_CanMakeNewAirport(mDocument);
@@ -88,6 +88,9 @@
 #include "WED_UIDefs.h"
 
 #include <sstream>
+#if DEV
+#include <chrono>
+#endif
 
 #define DOUBLE_PT_DIST (1.0 * MTR_TO_DEG_LAT)
 
@@ -6174,3 +6177,88 @@ void WED_MowGrass(IResolver* resolver)
 	else
 		wrl->AbortOperation();
 }
+
+#if DEV
+// Times the viewport queries the map makes against a big synthetic group - once through its spatial index, once
+// walking and culling every entity, like composites without an index are.  The group is built inside an operation
+// that gets aborted at the end, so the document is left as it was.
+void WED_BenchSpatialIndex(IResolver * resolver)
+{
+	const int		N_ENTITIES = 100000;
+	const int		N_VIEWS    = 2000;
+	const int		N_MOVED    = 1000;
+	const double	AREA       = 0.2;		// degrees, a big airport
+	const double	VIEW       = 0.005;		// degrees, a close up map view
+
+	WED_Thing * wrl = WED_GetWorld(resolver);
+	wrl->StartOperation("Benchmark Spatial Index");
+
+	WED_Group * grp = WED_Group::CreateTyped(wrl->GetArchive());
+	grp->SetName("Spatial Index Benchmark");
+	grp->SetParent(wrl, wrl->CountChildren());
+
+	srand(1);
+	vector<WED_Windsock *> socks;
+	for (int i = 0; i < N_ENTITIES; ++i)
+	{
+		WED_Windsock * s = WED_Windsock::CreateTyped(wrl->GetArchive());
+		s->SetLocation(gis_Geo, Point2(AREA * rand() / RAND_MAX, AREA * rand() / RAND_MAX));
+		s->SetParent(grp, i);
+		socks.push_back(s);
+	}
+
+	vector<Bbox2> views;
+	for (int i = 0; i < N_VIEWS; ++i)
+	{
+		Point2 p((AREA - VIEW) * rand() / RAND_MAX, (AREA - VIEW) * rand() / RAND_MAX);
+		views.push_back(Bbox2(p, p + Vector2(VIEW, VIEW)));
+	}
+
+	auto walk = [&](double& secs) {
+		auto t0 = chrono::high_resolution_clock::now();
+		long long hits = 0;
+		for (auto& v : views)
+			for (int n = 0; n < grp->GetNumEntities(); ++n)
+				hits += grp->GetNthEntity(n)->Cull(v);
+		secs = chrono::duration<double>(chrono::high_resolution_clock::now() - t0).count();
+		return hits;
+	};
+	auto query = [&](double& secs) {
+		auto t0 = chrono::high_resolution_clock::now();
+		long long hits = 0;
+		vector<int> near;
+		for (auto& v : views)
+			if (grp->GetEntitiesNear(v, near))
+				for (auto n : near)
+					hits += grp->GetNthEntity(n)->Cull(v);
+		secs = chrono::duration<double>(chrono::high_resolution_clock::now() - t0).count();
+		return hits;
+	};
+
+	double t_build, t_walk, t_query, t_dirty;
+	{
+		auto t0 = chrono::high_resolution_clock::now();
+		vector<int> near;
+		grp->GetEntitiesNear(views.front(), near);		// builds the index
+		t_build = chrono::duration<double>(chrono::high_resolution_clock::now() - t0).count();
+	}
+	long long h_walk  = walk(t_walk);
+	long long h_query = query(t_query);
+
+	for (int i = 0; i < N_MOVED; ++i)				// these are only flagged, the index is kept
+		socks[i * (N_ENTITIES / N_MOVED)]->SetLocation(gis_Geo, Point2(AREA * rand() / RAND_MAX, AREA * rand() / RAND_MAX));
+	long long h_dirty = query(t_dirty);
+	long long h_check = walk(t_walk);
+
+	wrl->AbortOperation();
+
+	char msg[512];
+	snprintf(msg, sizeof(msg), "%d entities, %d views of %.3lf deg\n\n"
+		"Index build: %.1lf ms\nWalk all: %.1lf ms (%lld hits)\nIndexed: %.1lf ms (%lld hits)\n"
+		"Indexed, %d moved: %.1lf ms (%lld hits, walk says %lld)\n",
+		N_ENTITIES, N_VIEWS, VIEW, t_build * 1000.0, t_walk * 1000.0, h_walk, t_query * 1000.0, h_query,
+		N_MOVED, t_dirty * 1000.0, h_dirty, h_check);
+	LOG_MSG("I/Bench %s", msg);
+	DoUserAlert(msg);
+}
+#endif
@@ -169,6 +169,9 @@ bool	WED_DoMowGrass(WED_Airport* apt, int statistics[4] = nullptr);
 
 void WED_AgePavement(IResolver* mDocument);
 void WED_AlignAirports(IResolver * resolver);
+#if DEV
+void WED_BenchSpatialIndex(IResolver * resolver);
+#endif
 
 void WED_AddChildrenRecursive(set<WED_Thing*>& who);
 void WED_RecursiveDelete(set<WED_Thing *>& who);
@@ -265,6 +265,10 @@ static const GUI_MenuItem_t kHelpMenu[] = {
 {	"&X-Plane Scenery Homepage",	0,	0,										0,	wed_HelpScenery },
 {	"&OpenStreetMap Bug Fixing",	0,	0,										0,	wed_OSMFixTheMap },
 {	"&Esri Imagery Permitted Uses",	0,	0,										0,	wed_ESRIUses },
+#if DEV
+{	"-",							0,	0,										0,	0				},
+{	"Benchmark Spatial Index",		0,	0,										0,	wed_BenchSpatialIndex },
+#endif
 #if IBM || LIN
 {	"-",							0,		0,									0,	0				},
 {	"&About WED",					0,		0,									0,	gui_About		},
@@ -194,7 +194,8 @@ enum {
 	wed_HelpManual,
 	wed_HelpScenery,
 	wed_OSMFixTheMap,
-	wed_ESRIUses
+	wed_ESRIUses,
+	wed_BenchSpatialIndex	// DEV builds only
 };
 
 class	GUI_Application;
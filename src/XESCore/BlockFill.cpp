@@ -71,12 +71,19 @@
 // selected for zoning was grossly inappropriate AND the facade was made of tiny fragments.
 #define SMALL_CUT 0.1
 
-int num_block_processed = 0;
-int num_blocks_with_split = 0;
-int num_forest_split = 0;
-int num_line_integ = 0;
+thread_local int num_block_processed = 0;
+thread_local int num_blocks_with_split = 0;
+thread_local int num_forest_split = 0;
+thread_local int num_line_integ = 0;
 
 #include <stdarg.h>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+// CDT::locate walks with the triangulation's own random generator - serialize it when blocks run on several threads.
+static mutex	sMeshLocateLock;
 
 typedef UTL_interval<double>	time_region;
 
@@ -3105,6 +3112,14 @@ static void	init_polygon_features(const GISPolygonFeatureVector& feats,
 
 
 
+// The mesh is shared by all of the block-filling threads, so midpoints and centroids are built from private copies of
+// its points.  The new lazy nodes then never hold or refine a shared number.  The copies carry the same exact values
+// (and so the same intervals), so the results don't depend on whether the mesh points were made exact beforehand.
+static Point_2	private_point(const Point_2& p)
+{
+	return Point_2(NT(p.x().exact()), NT(p.y().exact()));
+}
+
 static void	init_mesh(CDT& mesh, CoordTranslator2& translator, vector<Block_2::X_monotone_curve_2>& curves, int cat_table[cat_DIM],float max_slope, int need_lu)
 {
 	Point_2 start = Point_2(
@@ -3113,7 +3128,11 @@ static void	init_mesh(CDT& mesh, CoordTranslator2& translator, vector<Block_2::X
 
 	int n;
 	CDT::Locate_type lt;
-	CDT::Face_handle root = mesh.locate(start, lt, n);
+	CDT::Face_handle root;
+	{
+		lock_guard<mutex>	lock(sMeshLocateLock);
+		root = mesh.locate(start, lt, n);
+	}
 
 	DebugAssert(lt != CDT::OUTSIDE_AFFINE_HULL);
 	DebugAssert(lt != CDT::OUTSIDE_CONVEX_HULL);
@@ -3148,10 +3167,13 @@ static void	init_mesh(CDT& mesh, CoordTranslator2& translator, vector<Block_2::X
 //			Point_2	p0 = ben2cgal(translator.Forward(cgal2ben(f->vertex(0)->point())));
 //			Point_2	p1 = ben2cgal(translator.Forward(cgal2ben(f->vertex(0)->point())));
 //			Point_2	p2 = ben2cgal(translator.Forward(cgal2ben(f->vertex(0)->point())));
-			BPoint_2	p01 = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::midpoint(f->vertex(0)->point(),f->vertex(1)->point()))));
-			BPoint_2	p12 = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::midpoint(f->vertex(1)->point(),f->vertex(2)->point()))));
-			BPoint_2	p20 = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::midpoint(f->vertex(2)->point(),f->vertex(0)->point()))));
-			BPoint_2 p012 = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::centroid(mesh.triangle(f)))));
+			Point_2		v0 = private_point(f->vertex(0)->point());
+			Point_2		v1 = private_point(f->vertex(1)->point());
+			Point_2		v2 = private_point(f->vertex(2)->point());
+			BPoint_2	p01 = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::midpoint(v0,v1))));
+			BPoint_2	p12 = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::midpoint(v1,v2))));
+			BPoint_2	p20 = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::midpoint(v2,v0))));
+			BPoint_2 p012 = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::centroid(v0,v1,v2))));
 			
 //			if(p01 == p12 ||
 //			   p01 == p20 ||
@@ -3208,7 +3230,7 @@ static void	init_mesh(CDT& mesh, CoordTranslator2& translator, vector<Block_2::X
 			{
 				BPoint_2	pl = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(f->vertex(CDT::cw (n))->point())));
 				BPoint_2	pr = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(f->vertex(CDT::ccw(n))->point())));
-				BPoint_2	pm = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::midpoint(f->vertex(CDT::cw (n))->point(),f->vertex(CDT::ccw(n))->point()))));
+				BPoint_2	pm = ben2cgal<BPoint_2>(translator.Forward(cgal2ben(CGAL::midpoint(private_point(f->vertex(CDT::cw (n))->point()),private_point(f->vertex(CDT::ccw(n))->point())))));
 
 				if(l == r && L == R)
 				{
@@ -4305,3 +4327,203 @@ bool process_block(Pmwx::Face_handle f, CDT& mesh, const DEMGeo& ag_ok_approx_de
 //	printf("Face had %d vertices.\n", total);
 	return ret;
 }
+
+template <class P>
+static void make_point_exact(const P& p)
+{
+	p.x().exact();
+	p.y().exact();
+}
+
+static void make_curves_exact(const Pmwx& map)
+{
+	for(Pmwx::Edge_const_iterator e = map.edges_begin(); e != map.edges_end(); ++e)
+	{
+		make_point_exact(e->curve().source());
+		make_point_exact(e->curve().target());
+		e->curve().line().a().exact();			// the segment caches its supporting line, built lazily from the end points
+		e->curve().line().b().exact();
+		e->curve().line().c().exact();
+	}
+}
+
+// Lazy numbers cache their exact value the first time a filtered predicate or to_double needs it, and that
+// cache write is not thread-safe.  Pay for it up front on every number the workers share - the points and the
+// cached supporting lines of both maps, and the mesh points.  After this the shared numbers are only ever read.
+static void make_shared_geometry_exact(const Pmwx& map, const CDT& mesh, const Pmwx& forest_map)
+{
+	for(Pmwx::Vertex_const_iterator v = map.vertices_begin(); v != map.vertices_end(); ++v)
+		make_point_exact(v->point());
+	for(Pmwx::Vertex_const_iterator v = forest_map.vertices_begin(); v != forest_map.vertices_end(); ++v)
+		make_point_exact(v->point());
+	make_curves_exact(map);
+	make_curves_exact(forest_map);
+	for(CDT::Finite_vertices_iterator v = mesh.finite_vertices_begin(); v != mesh.finite_vertices_end(); ++v)
+		make_point_exact(v->point());
+}
+
+struct block_counts_t {
+	int processed, with_split, forest_split, line_integ;
+};
+
+void	process_blocks(
+					Pmwx&								map,
+					const vector<Pmwx::Face_handle>&	faces,
+					CDT&								mesh,
+					const DEMGeo&						ag_ok_approx_dem,
+					const DEMGeo&						forest_dem,
+					ForestIndex&						forest_index,
+					const Pmwx&							forest_map,
+					ProgressFunc						prog,
+					int									num_threads)
+{
+	int t = faces.size();
+	int step = t / 100;
+	if(step < 1) step = 1;
+
+#if DEV && OPENGL_MAP
+	num_threads = 1;		// failed blocks are dropped into gFaceSelection for debugging.
+#endif
+#if !BLOCKFILL_THREADS
+	num_threads = 1;		// not yet built and checked against a real CGAL - see BlockFill.h
+#endif
+#if !defined(CGAL_HAS_THREADS)
+	num_threads = 1;		// lazy number handles are ref counted without atomics - a worker could free a shared rep.
+#endif
+	if(num_threads <= 0)
+		num_threads = thread::hardware_concurrency();
+	num_threads = intlim(num_threads, 1, intmax2(t, 1));
+
+	if(num_threads == 1)
+	{
+		for(int n = 0; n < t; ++n)
+		{
+			PROGRESS_CHECK(prog, 0, 1, "Creating 3-d.", n, t, step);
+			SeedFacadeRules(n);
+			process_block(faces[n], mesh, ag_ok_approx_dem, forest_dem, forest_index);
+		}
+		return;
+	}
+
+	make_shared_geometry_exact(map, mesh, forest_map);
+
+	vector<block_counts_t>	counts(num_threads);
+	atomic<int>				next_face(0);
+	atomic<bool>			failed(false);
+	exception_ptr			error;
+	mutex					error_lock;
+
+	auto worker = [&](int w) {
+		block_counts_t before = { num_block_processed, num_blocks_with_split, num_forest_split, num_line_integ };
+		int next_report = 0;
+		int n;
+		while(!failed && (n = next_face++) < t)
+		{
+			if(w == 0 && n >= next_report)			// only the calling thread may talk to the progress func
+			{
+				PROGRESS_SHOW(prog, 0, 1, "Creating 3-d.", n, t);
+				next_report = n + step;
+			}
+			try
+			{
+				SeedFacadeRules(n);
+				process_block(faces[n], mesh, ag_ok_approx_dem, forest_dem, forest_index);
+			}
+			catch(...)
+			{
+				lock_guard<mutex>	lock(error_lock);
+				if(!error)
+					error = current_exception();
+				failed = true;
+			}
+		}
+		block_counts_t& c(counts[w]);
+		c.processed = num_block_processed - before.processed;
+		c.with_split = num_blocks_with_split - before.with_split;
+		c.forest_split = num_forest_split - before.forest_split;
+		c.line_integ = num_line_integ - before.line_integ;
+	};
+
+	vector<thread>	workers;
+	for(int w = 1; w < num_threads; ++w)
+		workers.push_back(thread(worker, w));
+	worker(0);
+	for(auto& w : workers)
+		w.join();
+
+	for(int w = 1; w < num_threads; ++w)
+	{
+		num_block_processed += counts[w].processed;
+		num_blocks_with_split += counts[w].with_split;
+		num_forest_split += counts[w].forest_split;
+		num_line_integ += counts[w].line_integ;
+	}
+
+	if(error)
+		rethrow_exception(error);
+}
+
+static bool same_poly_objs(const GISPolyObjPlacementVector& a, const GISPolyObjPlacementVector& b)
+{
+	if(a.size() != b.size())
+		return false;
+	for(int i = 0; i < a.size(); ++i)
+	{
+		if(a[i].mRepType != b[i].mRepType || a[i].mParam != b[i].mParam || a[i].mDerived != b[i].mDerived ||
+			a[i].mShape.size() != b[i].mShape.size())
+			return false;
+		for(int s = 0; s < a[i].mShape.size(); ++s)
+			if(!(a[i].mShape[s] == b[i].mShape[s]))
+				return false;
+	}
+	return true;
+}
+
+bool	check_process_blocks(
+					Pmwx&								map,
+					const vector<Pmwx::Face_handle>&	faces,
+					CDT&								mesh,
+					const DEMGeo&						ag_ok_approx_dem,
+					const DEMGeo&						forest_dem,
+					ForestIndex&						forest_index,
+					const Pmwx&							forest_map,
+					ProgressFunc						prog,
+					int									num_threads)
+{
+#if !BLOCKFILL_THREADS || !defined(CGAL_HAS_THREADS)
+	printf("This build fills blocks serially only, both runs are serial.\n");
+#endif
+	int t = faces.size();
+	vector<GISPolyObjPlacementVector>	before(t), serial(t);
+	for(int n = 0; n < t; ++n)
+		before[n] = faces[n]->data().mPolyObjs;
+
+	block_counts_t	counts = { num_block_processed, num_blocks_with_split, num_forest_split, num_line_integ };
+	process_blocks(map, faces, mesh, ag_ok_approx_dem, forest_dem, forest_index, forest_map, prog, 1);
+	num_block_processed = counts.processed;			// count the blocks once, not once per run
+	num_blocks_with_split = counts.with_split;
+	num_forest_split = counts.forest_split;
+	num_line_integ = counts.line_integ;
+
+	for(int n = 0; n < t; ++n)
+	{
+		serial[n].swap(faces[n]->data().mPolyObjs);
+		faces[n]->data().mPolyObjs = before[n];
+	}
+	process_blocks(map, faces, mesh, ag_ok_approx_dem, forest_dem, forest_index, forest_map, prog, num_threads);
+
+	int bad = 0;
+	for(int n = 0; n < t; ++n)
+	if(!same_poly_objs(serial[n], faces[n]->data().mPolyObjs))
+	{
+		if(bad < 10)
+			printf("Block %d: %d polygon objects serially, %d in parallel, they differ.\n", n,
+				(int) serial[n].size() - (int) before[n].size(), (int) faces[n]->data().mPolyObjs.size() - (int) before[n].size());
+		++bad;
+	}
+	if(bad)
+		printf("%d of %d blocks differ between 1 and %d threads.\n", bad, t, num_threads);
+	else
+		printf("All %d blocks are the same on 1 and %d threads.\n", t, num_threads);
+	return bad == 0;
+}
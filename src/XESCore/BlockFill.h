@@ -62,7 +62,45 @@ bool	process_block(
 					const DEMGeo&			forest_dem,
 					ForestIndex&			forest_index);
 
+// The parallel block fill is off until it has been built against the CGAL we ship with and been shown safe:
+// -instobjs <threads> check under TSan on a dense tile, with identical serial and parallel results.  With it off,
+// process_blocks ignores num_threads.
+#ifndef BLOCKFILL_THREADS
+#define BLOCKFILL_THREADS 0
+#endif
 
+// Runs process_block over faces on num_threads threads (0 = one per core, 1 = serial).  Each face only ever writes
+// its own polygon objects and every block seeds the facade picker from its index in faces, so the results are the
+// same for any thread count.  The parallel path needs BLOCKFILL_THREADS and a CGAL with thread-safe handle ref
+// counts (CGAL_HAS_THREADS) - without them the blocks are filled serially.  It first makes every point and edge of
+// map, mesh and forest_map exact, so no worker ever refines a shared lazy number; anything a worker constructs from
+// them is its own.  An exception from any block is rethrown here once all the workers have stopped.
+void	process_blocks(
+					Pmwx&								map,
+					const vector<Pmwx::Face_handle>&	faces,
+					CDT&								mesh,
+					const DEMGeo&						ag_ok_approx_dem,
+					const DEMGeo&						forest_dem,
+					ForestIndex&						forest_index,
+					const Pmwx&							forest_map,
+					ProgressFunc						prog,
+					int									num_threads);
+
+
+
+// Fills the blocks serially and then on num_threads threads, starting from the same polygon objects both times,
+// and compares the results.  The faces keep the parallel results.  Returns false and says which blocks differ
+// if any do.
+bool	check_process_blocks(
+					Pmwx&								map,
+					const vector<Pmwx::Face_handle>&	faces,
+					CDT&								mesh,
+					const DEMGeo&						ag_ok_approx_dem,
+					const DEMGeo&						forest_dem,
+					ForestIndex&						forest_index,
+					const Pmwx&							forest_map,
+					ProgressFunc						prog,
+					int									num_threads);
 
 
 bool block_pts_from_ccb(
@@ -75,8 +113,9 @@ bool block_pts_from_ccb(
 float WidthForSegment(const pair<int,bool>& seg_type);
 
 
-extern int num_block_processed;
-extern int num_blocks_with_split;
-extern int num_forest_split;
-extern int num_line_integ;
+// Per thread - process_blocks adds the workers' counts into the calling thread's when it is done.
+extern thread_local int num_block_processed;
+extern thread_local int num_blocks_with_split;
+extern thread_local int num_forest_split;
+extern thread_local int num_line_integ;
 #endif /* BlockFill_H */
@@ -25,6 +25,83 @@
 #include "MathUtils.h"
 #include <list>
 
+#if LIN || APL
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define DEM_SCRATCH_BLOCK	(1024*1024)
+
+static string	sScratchDir;
+static size_t	sScratchMin = 0;
+
+void	DEMGeo_SetScratchStore(const char * dir, size_t min_bytes)
+{
+	sScratchDir = dir ? dir : "";
+	sScratchMin = min_bytes;
+}
+
+// Returns NULL if there is no scratch store, the DEM is too small for it, or we can't get the space.
+// Fresh mappings are zero-filled.
+static float *	scratch_alloc(size_t bytes, size_t& mapped)
+{
+#if LIN || APL
+	if (sScratchDir.empty() || bytes == 0 || bytes < sScratchMin)
+		return NULL;
+	size_t len = (bytes + DEM_SCRATCH_BLOCK - 1) / DEM_SCRATCH_BLOCK * DEM_SCRATCH_BLOCK;
+
+	string	path(sScratchDir + "/dem_scratch_XXXXXX");
+	vector<char>	buf(path.begin(), path.end());
+	buf.push_back(0);
+	int fd = mkstemp(&*buf.begin());
+	if (fd == -1)
+		return NULL;
+	unlink(&*buf.begin());		// The mapping keeps it alive - the space comes back when we unmap, even if we crash.
+
+#if LIN
+	// Reserve the disk now - a sparse file that runs out of disk later is a SIGBUS on some random write.
+	int ok = posix_fallocate(fd, 0, len) == 0;
+#else
+	int ok = ftruncate(fd, len) == 0;
+#endif
+	void * mem = ok ? mmap(NULL, len, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+	close(fd);
+	if (mem == MAP_FAILED)
+		return NULL;
+	mapped = len;
+	return (float *) mem;
+#else
+	return NULL;
+#endif
+}
+
+bool	DEMGeo::alloc_data(bool zero)
+{
+	size_t bytes = (size_t) mWidth * (size_t) mHeight * sizeof(float);
+	mMapped = 0;
+	mData = scratch_alloc(bytes, mMapped);
+	if (mData)
+		return true;
+	mData = (float *) malloc(bytes);
+	if (mData && zero)
+		memset(mData, 0, bytes);
+	return mData != NULL;
+}
+
+void	DEMGeo::free_data(void)
+{
+#if LIN || APL
+	if (mMapped)
+		munmap(mData, mMapped);
+	else
+#endif
+	if (mData)
+		free(mData);
+	mData = NULL;
+	mMapped = 0;
+}
+
 #define HIST_MAX	10
 
 struct	HistoHelper {
@@ -99,7 +176,8 @@ DEMGeo::DEMGeo() :
 	mWidth(0),
 	mHeight(0),
 	mPost(1),
-	mData(0)
+	mData(0),
+	mMapped(0)
 {
 }
 
@@ -110,43 +188,33 @@ DEMGeo::DEMGeo(const DEMGeo& x) :
 	mNorth(x.mNorth),
 	mWidth(x.mWidth),
 	mPost(x.mPost),
-	mHeight(x.mHeight)
+	mHeight(x.mHeight),
+	mData(0),
+	mMapped(0)
 {
-	if (mWidth == 0 || mHeight == 0)
+	if (mWidth != 0 && mHeight != 0)
 	{
-		mData = 0;
-	} else {
-		mData = (float *) malloc(mWidth * mHeight * sizeof(float));
-		if (mData == NULL)
+		if (!alloc_data(x.mData == NULL))
 			mWidth = mHeight = 0;
-		else {
-			if (x.mData)
-				memcpy(mData, x.mData, mWidth * mHeight * sizeof(float));
-			else
-				memset(mData, 0, mWidth * mHeight * sizeof(float));
-		}
+		else if (x.mData)
+			memcpy(mData, x.mData, (size_t) mWidth * (size_t) mHeight * sizeof(float));
 	}
 }
 
 DEMGeo::DEMGeo(int width, int height) :
 	mSouth(0.0), mNorth(0.0), mEast(0.0), mWest(0.0),
-	mWidth(width), mHeight(height), mPost(1)
+	mWidth(width), mHeight(height), mPost(1), mData(0), mMapped(0)
 {
-	if (mWidth == 0 || mHeight == 0)
+	if (mWidth != 0 && mHeight != 0)
 	{
-		mData = 0;
-	} else {
-		mData = (float *) malloc(mWidth * mHeight * sizeof(float));
-		if (mData == NULL)
+		if (!alloc_data(true))
 			mWidth = mHeight = 0;
-		else
-			memset(mData, 0, mWidth * mHeight * sizeof(float));
 	}
 }
 
 DEMGeo::~DEMGeo()
 {
-	if (mData) free(mData);
+	free_data();
 }
 
 DEMGeo& DEMGeo::operator=(float v)
@@ -224,10 +292,10 @@ DEMGeo& DEMGeo::operator=(const DEMGeo& x)
 
 	if (x.mWidth != mWidth || x.mHeight != mHeight || mData == NULL)
 	{
-		if (mData)	free(mData);
+		free_data();
 		mWidth = x.mWidth;
 		mHeight = x.mHeight;
-		mData = (float *) malloc(mWidth * mHeight * sizeof(float));
+		alloc_data(false);
 	}
 
 	mSouth = x.mSouth;
@@ -240,9 +308,9 @@ DEMGeo& DEMGeo::operator=(const DEMGeo& x)
 		mWidth = mHeight = 0;
 	else {
 		if (x.mData)
-			memcpy(mData, x.mData, mWidth * mHeight * sizeof(float));
+			memcpy(mData, x.mData, (size_t) mWidth * (size_t) mHeight * sizeof(float));
 		else
-			memset(mData, 0, mWidth * mHeight * sizeof(float));
+			memset(mData, 0, (size_t) mWidth * (size_t) mHeight * sizeof(float));
 	}
 	return *this;
 }
@@ -258,10 +326,10 @@ void DEMGeo::clear_from(const DEMGeo& x, float v)
 	
 	if (x.mWidth != mWidth || x.mHeight != mHeight || mData == NULL)
 	{
-		if (mData)	free(mData);
+		free_data();
 		mWidth = x.mWidth;
 		mHeight = x.mHeight;
-		mData = (float *) malloc(mWidth * mHeight * sizeof(float));
+		alloc_data(false);
 	}
 
 	mSouth = x.mSouth;
@@ -285,10 +353,10 @@ void DEMGeo::clear_from(const DEMGeo& x)
 	
 	if (x.mWidth != mWidth || x.mHeight != mHeight || mData == NULL)
 	{
-		if (mData)	free(mData);
+		free_data();
 		mWidth = x.mWidth;
 		mHeight = x.mHeight;
-		mData = (float *) malloc(mWidth * mHeight * sizeof(float));
+		alloc_data(false);
 	}
 
 	mSouth = x.mSouth;
@@ -415,19 +483,14 @@ void DEMGeo::derez_nearest(void)
 void	DEMGeo::resize(int width, int height)
 {
 	if (width == mWidth && height == mHeight) return;
-	if (mData) free(mData);
+	free_data();
 
 	mWidth = width; mHeight = height;
 
-	if (mWidth == 0 || mHeight == 0)
+	if (mWidth != 0 && mHeight != 0)
 	{
-		mData = 0;
-	} else {
-		mData = (float *) malloc((size_t) mWidth * (size_t) mHeight * sizeof(float));
-		if (mData == NULL)
+		if (!alloc_data(true))
 			mWidth = mHeight = 0;
-		else
-			memset(mData, 0, (size_t) mWidth * (size_t) mHeight * sizeof(float));
 	}
 }
 
@@ -481,6 +544,7 @@ void	DEMGeo::swap(DEMGeo& rhs)
 	std::swap(mWidth, rhs.mWidth);
 	std::swap(mHeight, rhs.mHeight);
 	std::swap(mData, rhs.mData);
+	std::swap(mMapped, rhs.mMapped);
 	std::swap(mPost, rhs.mPost);
 }
 
@@ -501,12 +565,14 @@ void	DEMGeo::calc_normal(DEMGeo& outX, DEMGeo& outY, DEMGeo& outZ, ProgressFunc
 	float	h, hl, ht, hb, hr;
 	float	ld, rd, bd, td;
 
+	// Row-major so that we walk the source and both outputs sequentially - column order touches a new
+	// page for every pixel, which is awful for big DEMs and hopeless for scratch-backed ones.
 	if (inProg) inProg(0, 1, "Calculating Slope", 0.0);
-	for (int x = 0; x < mWidth; ++x)
 	for (int y = 0; y < mHeight;++y)
+	for (int x = 0; x < mWidth; ++x)
 	{
-		if (y == 0 && (x % 50) == 0)
-			if (inProg) inProg(0, 1, "Calculating Slope", (double) x / (double) mWidth);
+		if (x == 0 && (y % 50) == 0)
+			if (inProg) inProg(0, 1, "Calculating Slope", (double) y / (double) mHeight);
 
 		h = get(x,y);
 		if (h == DEM_NO_DATA)
@@ -587,12 +653,14 @@ void	DEMGeo::calc_slope(DEMGeo& outSlope, DEMGeo& outHeading, ProgressFunc inPro
 	float	h, hl, ht, hb, hr;
 	float	ld, rd, bd, td;
 
+	// Row-major so that we walk the source and both outputs sequentially - column order touches a new
+	// page for every pixel, which is awful for big DEMs and hopeless for scratch-backed ones.
 	if (inProg) inProg(0, 1, "Calculating Slope", 0.0);
-	for (int x = 0; x < mWidth; ++x)
 	for (int y = 0; y < mHeight;++y)
+	for (int x = 0; x < mWidth; ++x)
 	{
-		if (y == 0 && (x % 50) == 0)
-			if (inProg) inProg(0, 1, "Calculating Slope", (double) x / (double) mWidth);
+		if (x == 0 && (y % 50) == 0)
+			if (inProg) inProg(0, 1, "Calculating Slope", (double) y / (double) mHeight);
 
 		h = get(x,y);
 		if (h == DEM_NO_DATA)
@@ -878,20 +946,22 @@ float	DEMGeo::local_minmax(int x1, int y1, int x2, int y2,
 void	DEMGeo::filter_self(int dim, float * k)
 {
 	DEMGeo	temp(*this);
-	for (int x = 0; x < temp.mWidth; ++x)
 	for (int y = 0; y < temp.mHeight;++y)
 	{
-		(*this)(x,y) = temp.kernelN(x,y,dim,k);
+		float * row = mData + y * mWidth;
+		for (int x = 0; x < temp.mWidth; ++x)
+			row[x] = temp.kernelN(x,y,dim,k);
 	}
 }
 
 void	DEMGeo::filter_self_normalize(int dim, float * k)
 {
 	DEMGeo	temp(*this);
-	for (int x = 0; x < temp.mWidth; ++x)
 	for (int y = 0; y < temp.mHeight;++y)
 	{
-		(*this)(x,y) = temp.kernelN_Normalize(x,y,dim,k);
+		float * row = mData + y * mWidth;
+		for (int x = 0; x < temp.mWidth; ++x)
+			row[x] = temp.kernelN_Normalize(x,y,dim,k);
 	}
 }
 
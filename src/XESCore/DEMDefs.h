@@ -148,6 +148,9 @@ struct	DEMGeo {
 	// An array of width*height data points in floating point format.
 	// The first sample is the southwest corner, we then proceed east.
 	float *	mData;
+	
+	// Bytes of mData that live in a mapped scratch file, or 0 if mData is on the heap.  See DEMGeo_SetScratchStore.
+	size_t	mMapped;
 
 	inline	float	pixel_offset() const { return mPost ? 0.0 : 0.5; }	// distance from the coordinate defining a pixel to its sampling center.
 	inline	int		pixel_area() const { return mWidth * mHeight; }
@@ -232,6 +235,9 @@ struct	DEMGeo {
 	void	subset(DEMGeo& newDEM, int x1, int y1, int x2, int y2) const;					// INCLUSIVE for post, EXCLUSIVE for area.
 	void	swap(DEMGeo& otherDEM);															// Swap all params, good for avoiding mem copies
 
+	bool	alloc_data(bool zero);							// Allocate mWidth x mHeight samples (mData must be free) - false if out of memory
+	void	free_data(void);
+
 	/****************************************************************************
 	 * FILTER FUNCTIONS AND SPECIALIZED PIXEL ACCESS
 	 ****************************************************************************/	
@@ -339,6 +345,18 @@ struct	DEMGeo {
 	
 };
 
+/*************************************************************************************
+ * SCRATCH BACKING STORE
+ *************************************************************************************/
+
+// A high-rez landuse run can have several DEMs in a DEMGeoMap that don't fit in RAM together.
+// When a scratch dir is set, any DEM of at least min_bytes is allocated in an (unlinked) memory
+// mapped file in that dir, in whole 1 MB blocks, so the OS can page it to disk instead of swapping
+// or failing.  The DEM stays one contiguous array, so iterators, addresses and every algorithm work
+// unchanged - but loops should run row-major (y outer, x inner) to stay block-local.
+// Pass NULL to go back to the heap.  Only implemented for Mac/Linux; Windows always uses the heap.
+void	DEMGeo_SetScratchStore(const char * dir, size_t min_bytes);
+
 /*************************************************************************************
  * DEM MASK
  *************************************************************************************/
@@ -40,6 +40,8 @@
 #include <xtiffio.h>
 #include <geotiff.h>
 #include <geovalues.h>
+#include <atomic>
+#include <thread>
 const double one_256 = 1.0 / 256.0;
 
 static	double	ReadReal48(const unsigned char * p)
@@ -60,7 +62,7 @@ static	double	ReadReal48(const unsigned char * p)
 	return sign_negative ? ( -m * exponent) : (m * exponent);
 }
 
-void	WriteDEM(DEMGeo& inMap, IOWriter * inWriter)
+void	WriteDEM(const DEMGeo& inMap, IOWriter * inWriter)
 {
 	inWriter->WriteInt(inMap.mWidth);
 	inWriter->WriteInt(inMap.mHeight);
@@ -69,9 +71,8 @@ void	WriteDEM(DEMGeo& inMap, IOWriter * inWriter)
 	inWriter->WriteDouble(inMap.mEast);
 	inWriter->WriteDouble(inMap.mNorth);
 
-	EndianSwapArray(platform_Native, platform_LittleEndian, inMap.mWidth *inMap.mHeight, sizeof(float), inMap.mData);
-	inWriter->WriteBulk((const char *) inMap.mData, inMap.mWidth * inMap.mHeight * sizeof(float), false);
-	EndianSwapArray(platform_LittleEndian, platform_Native, inMap.mWidth *inMap.mHeight, sizeof(float), inMap.mData);
+	if (inMap.mData)
+		inWriter->WriteSpan(inMap.mData, inMap.mWidth * inMap.mHeight);
 }
 
 void	ReadDEM (		DEMGeo& inMap, IOReader * inReader)
@@ -88,10 +89,7 @@ void	ReadDEM (		DEMGeo& inMap, IOReader * inReader)
 	inReader->ReadDouble(inMap.mNorth);
 
 	if (inMap.mData)
-	{
-		inReader->ReadBulk((char *) inMap.mData, inMap.mWidth * inMap.mHeight * sizeof(float), false);
-		EndianSwapArray(platform_LittleEndian, platform_Native, inMap.mWidth * inMap.mHeight, sizeof(float), inMap.mData);
-	}
+		inReader->ReadSpan(inMap.mData, inMap.mWidth * inMap.mHeight);
 }
 
 void	RemapEnumDEM(	DEMGeo& ioMap, const TokenConversionMap& inMap)
@@ -731,11 +729,13 @@ static	void	IgnoreTiffErrs(const char *, const char* fmt, va_list args)
 }
 
 struct	StTiffMemFile {
-	StTiffMemFile(const char * fname) { file = MemFile_Open(fname); offset = 0; }
-	~StTiffMemFile() { if (file) MemFile_Close(file); }
+	StTiffMemFile(const char * fname) { file = MemFile_Open(fname); offset = 0; owned = true; }
+	StTiffMemFile(MFMemFile * shared) { file = shared; offset = 0; owned = false; }	// another read position on an already open file
+	~StTiffMemFile() { if (file && owned) MemFile_Close(file); }
 
 	MFMemFile *		file;
 	int				offset;
+	bool			owned;
 };
 
 static tsize_t	MemTIFFReadWriteProc(thandle_t handle, tdata_t data, tsize_t len)
@@ -823,17 +823,181 @@ void copy_tile(
 				int y,
 				int dx,			// tile size
 				int dy,
+				int stride,		// samples per row in v - edge tiles are padded out to the full tile width
 				DEMGeo& dem)
 {
 	for (int cy = 0; cy < dy; ++cy)
-	for (int cx = 0; cx < dx; ++cx)
 	{
-		int dem_x = x + cx;
+		const T * r = v + cy * stride;
 		int dem_y = dem.mHeight - (y + cy) - 1;
-		float e = *v;
-		dem(dem_x,dem_y) = e;
-		++v;
+		for (int cx = 0; cx < dx; ++cx)
+		{
+			float e = r[cx];
+			dem(x + cx,dem_y) = e;
+		}
+	}
+}
+
+/*
+	Parallel GeoTiff decoding -
+	For big compressed rasters, the LZW/deflate decode dominates the import.  Strips and tiles are compressed
+	independently, so each worker opens its own TIFF handle (with its own seek offset) on the one memory file and
+	decodes whole chunks straight into their rows/columns of the DEM.  Chunks never overlap, so no locking is needed.
+	We only go parallel for single-sample rasters in a pixel format we know - everything else takes the old serial path.
+*/
+
+struct	tiff_layout_t {
+	uint32		w, h;
+	uint16		format;
+	uint16		depth;
+	bool		tiled;
+	uint32		cw, ch;		// chunk size - tile size, or width x rows per strip
+	uint32		across;		// chunks per row of chunks
+	int			count;		// total chunks
+};
+
+static bool tiff_format_supported(int format, int d)
+{
+	switch(format) {
+	case SAMPLEFORMAT_UINT:
+	case SAMPLEFORMAT_INT:		return d == 8 || d == 16 || d == 32;
+	case SAMPLEFORMAT_IEEEFP:	return d == 32 || d == 64;
+	default:					return false;
+	}
+}
+
+// Decode chunk number 'chunk' into its place in the DEM.  buf must hold a whole strip or tile.
+static bool	read_tiff_chunk(TIFF * tif, tdata_t buf, int chunk, const tiff_layout_t& l, DEMGeo& dem)
+{
+	tsize_t got = l.tiled ? TIFFReadEncodedTile(tif, chunk, buf, -1) : TIFFReadEncodedStrip(tif, chunk, buf, -1);
+	if (got == -1)
+		return false;
+
+	int x = (chunk % l.across) * l.cw;
+	int y = (chunk / l.across) * l.ch;
+	int ux = min(l.cw, l.w - x);
+	int uy = min(l.ch, l.h - y);
+	int stride = l.cw;
+
+	switch(l.format) {
+	case SAMPLEFORMAT_UINT:
+		switch(l.depth) {
+		case 8:		copy_tile<unsigned char>((const unsigned char *) buf, x,y,ux,uy,stride, dem);	break;
+		case 16:	copy_tile<unsigned short>((const unsigned short *) buf, x,y,ux,uy,stride, dem);	break;
+		case 32:	copy_tile<unsigned int>((const unsigned int *) buf, x,y,ux,uy,stride, dem);	break;
+		default:	return false;
+		}
+		break;
+	case SAMPLEFORMAT_INT:
+		switch(l.depth) {
+		case 8:		copy_tile<char>((const char *) buf, x,y,ux,uy,stride, dem);	break;
+		case 16:	copy_tile<short>((const short *) buf, x,y,ux,uy,stride, dem);	break;
+		case 32:	copy_tile<int>((const int *) buf, x,y,ux,uy,stride, dem);	break;
+		default:	return false;
+		}
+		break;
+	case SAMPLEFORMAT_IEEEFP:
+		switch(l.depth) {
+		case 32:	copy_tile<float>((const float *) buf, x,y,ux,uy,stride, dem);	break;
+		case 64:	copy_tile<double>((const double *) buf, x,y,ux,uy,stride, dem);	break;
+		default:	return false;
+		}
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+// Returns 1 if the whole image was read, 0 on a read error, -1 if the layout isn't one we can do in parallel
+// (and the caller should fall back to the serial reader).
+static int	ExtractGeoTiffParallel(TIFF * tif, MFMemFile * mem, const char * inFileName, DEMGeo& dem, int num_threads)
+{
+	tiff_layout_t	l;
+	uint16			cc, planar;
+	l.w = dem.mWidth;
+	l.h = dem.mHeight;
+	TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &cc);
+	TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planar);
+	TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &l.depth);
+	TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLEFORMAT, &l.format);
+	if (cc != 1 || !tiff_format_supported(l.format, l.depth))
+		return -1;
+
+	l.tiled = TIFFIsTiled(tif);
+	tsize_t	chunk_bytes;
+	if (l.tiled)
+	{
+		TIFFGetField(tif, TIFFTAG_TILEWIDTH, &l.cw);
+		TIFFGetField(tif, TIFFTAG_TILELENGTH, &l.ch);
+		l.count = TIFFNumberOfTiles(tif);
+		chunk_bytes = TIFFTileSize(tif);
+	}
+	else
+	{
+		l.cw = l.w;
+		TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &l.ch);
+		l.ch = min(l.ch, l.h);
+		l.count = TIFFNumberOfStrips(tif);
+		chunk_bytes = TIFFStripSize(tif);
+	}
+	if (l.cw == 0 || l.ch == 0)
+		return -1;
+	l.across = (l.w + l.cw - 1) / l.cw;
+	if (l.count != (int) (l.across * ((l.h + l.ch - 1) / l.ch)))
+		return -1;
+
+	if (num_threads <= 0)
+		num_threads = thread::hardware_concurrency();
+	num_threads = min(num_threads, l.count);
+	if (num_threads < 2)
+		return -1;
+
+	atomic<int>		next_chunk(0);
+	atomic<bool>	ok(true);
+
+	auto worker = [&](TIFF * t) {
+		tdata_t buf = _TIFFmalloc(chunk_bytes);
+		if (buf == NULL) { ok = false; return; }
+		int c;
+		while (ok && (c = next_chunk++) < l.count)
+			if (!read_tiff_chunk(t, buf, c, l, dem))
+			{
+				printf("Tiff error in read of %s %d.\n", l.tiled ? "tile" : "strip", c);
+				ok = false;
+			}
+		_TIFFfree(buf);
+	};
+
+	// The calling thread reuses the handle it already has, the rest each get their own.
+	vector<StTiffMemFile *>	views;
+	vector<TIFF *>			handles;
+	for (int n = 1; n < num_threads; ++n)
+	{
+		StTiffMemFile * v = new StTiffMemFile(mem);
+		TIFF * t = TIFFClientOpen(inFileName, "r", v,
+			MemTIFFReadWriteProc, MemTIFFReadWriteProc,
+			MemTIFFSeekProc, MemTIFFCloseProc,
+			MemTIFFSizeProc,
+			MemTIFFMapFileProc, MemTIFFUnmapFileProc);
+		if (t == NULL) { delete v; break; }
+		views.push_back(v);
+		handles.push_back(t);
 	}
+
+	vector<thread>	workers;
+	for (auto t : handles)
+		workers.push_back(thread(worker, t));
+	worker(tif);
+	for (auto& t : workers)
+		t.join();
+
+	for (auto t : handles)
+		TIFFClose(t);
+	for (auto v : views)
+		delete v;
+
+	return ok ? 1 : 0;
 }
 
 /*
@@ -860,7 +1024,7 @@ void copy_tile(
 	In other words, the CGIAR SRTM files have essentially been shifted to the northeast by 1.5 arc-seconds.
 
 */
-bool	ExtractGeoTiff(DEMGeo& inMap, const char * inFileName, int post_style, int no_geo_needed)
+bool	ExtractGeoTiff(DEMGeo& inMap, const char * inFileName, int post_style, int no_geo_needed, int num_threads)
 {
 	int result = -1;
 	double	corners[8];
@@ -924,6 +1088,18 @@ bool	ExtractGeoTiff(DEMGeo& inMap, const char * inFileName, int post_style, int
 	printf("Image is: %dx%d, samples: %d, depth: %d, format: %d\n", w, h, cc, d, format);
 
 	inMap.resize(w,h);
+
+	if (num_threads != 1)
+	{
+		int par = ExtractGeoTiffParallel(tif, tiffMem.file, inFileName, inMap, num_threads);
+		if (par != -1)
+		{
+			TIFFClose(tif);
+			TIFFSetWarningHandler(warnH);
+			TIFFSetErrorHandler(errH);
+			return par == 1;
+		}
+	}
 	
 	if(TIFFIsTiled(tif))
 	{
@@ -944,13 +1120,13 @@ bool	ExtractGeoTiff(DEMGeo& inMap, const char * inFileName, int post_style, int
 			case SAMPLEFORMAT_UINT:
 				switch(d) {
 				case 8:
-					copy_tile<unsigned char>((const unsigned char *) buf, x,y,ux,uy, inMap);
+					copy_tile<unsigned char>((const unsigned char *) buf, x,y,ux,uy,tw, inMap);
 					break;
 				case 16:
-					copy_tile<unsigned short>((const unsigned short *) buf, x,y,ux,uy, inMap);
+					copy_tile<unsigned short>((const unsigned short *) buf, x,y,ux,uy,tw, inMap);
 					break;
 				case 32:
-					copy_tile<unsigned int>((const unsigned int *) buf, x,y,ux,uy, inMap);
+					copy_tile<unsigned int>((const unsigned int *) buf, x,y,ux,uy,tw, inMap);
 					break;
 				default:
 					printf("TIFF error: unsupported unsigned int sample depth: %d\n", d);
@@ -960,13 +1136,13 @@ bool	ExtractGeoTiff(DEMGeo& inMap, const char * inFileName, int post_style, int
 			case SAMPLEFORMAT_INT:
 				switch(d) {
 				case 8:
-					copy_tile<char>((const char *) buf, x,y,ux,uy, inMap);
+					copy_tile<char>((const char *) buf, x,y,ux,uy,tw, inMap);
 					break;
 				case 16:
-					copy_tile<short>((const short *) buf, x,y,ux,uy, inMap);
+					copy_tile<short>((const short *) buf, x,y,ux,uy,tw, inMap);
 					break;
 				case 32:
-					copy_tile<int>((const int *) buf, x,y,ux,uy, inMap);
+					copy_tile<int>((const int *) buf, x,y,ux,uy,tw, inMap);
 					break;
 				default:
 					printf("TIFF error: unsupported signed int sample depth: %d\n", d);
@@ -976,10 +1152,10 @@ bool	ExtractGeoTiff(DEMGeo& inMap, const char * inFileName, int post_style, int
 			case SAMPLEFORMAT_IEEEFP:
 				switch(d) {
 				case 32:
-					copy_tile<float>((const float *) buf, x,y,ux,uy, inMap);
+					copy_tile<float>((const float *) buf, x,y,ux,uy,tw, inMap);
 					break;
 				case 64:
-					copy_tile<double>((const double *) buf, x,y,ux,uy, inMap);
+					copy_tile<double>((const double *) buf, x,y,ux,uy,tw, inMap);
 					break;
 				default:
 					printf("TIFF error: unsupported floating point sample depth: %d\n", d);
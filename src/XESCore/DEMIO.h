@@ -55,7 +55,9 @@ struct	DEMSpec {
 
 // These DEM IO Routines write the 'DEM format' that is part of an XES file.
 // They do NOT write the atom container that holds the DEMs, just the contents.
-void	WriteDEM(		DEMGeo& inMap, IOWriter * inWriter);
+// Samples go through Write/ReadSpan, so they take the byte order of the reader/writer
+// (little endian for XES).
+void	WriteDEM(const	DEMGeo& inMap, IOWriter * inWriter);
 void	ReadDEM (		DEMGeo& inMap, IOReader * inReader);
 
 // Translate the values of the DEM as enums.  Useful when loading an enum-based
@@ -83,7 +85,9 @@ bool	ExtractIDAFile(DEMGeo& inMap, const char * inFileName);
 bool	ExtractUSGSNaturalFile(DEMGeo& inMap, const char * inFileName);
 
 // GeoTiff - must be geographic projected for us to use.  Origin is NW corner.
-bool	ExtractGeoTiff(DEMGeo& inMap, const char * inFileName, int post_style, int no_geo_needed);
+// Strips/tiles are decoded on num_threads threads, 1 = serial, 0 = one per core.  Serial unless asked, since
+// tools that already run one job per core (e.g. MeshTool --batch) would otherwise oversubscribe the machine.
+bool	ExtractGeoTiff(DEMGeo& inMap, const char * inFileName, int post_style, int no_geo_needed, int num_threads = 1);
 bool	WriteGeoTiff(DEMGeo& inMap, const char * inFileName);
 
 // DTED - contains its own geo info
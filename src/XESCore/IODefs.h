@@ -32,6 +32,13 @@ public:
 	virtual	void	ReadDouble(double&)=0;
 	virtual	void	ReadBulk(char * inBuf, int inLength, bool inZip)=0;
 
+	// Arrays of scalars, with the same byte order as the single-value calls.  The defaults just loop;
+	// readers that can copy (and endian-swap) a whole run at once override all four.
+	virtual	void	ReadSpan(short * outBuf, int inCount)	{ while(inCount-- > 0) ReadShort(*outBuf++);	}
+	virtual	void	ReadSpan(int * outBuf, int inCount)		{ while(inCount-- > 0) ReadInt(*outBuf++);		}
+	virtual	void	ReadSpan(float * outBuf, int inCount)	{ while(inCount-- > 0) ReadFloat(*outBuf++);	}
+	virtual	void	ReadSpan(double * outBuf, int inCount)	{ while(inCount-- > 0) ReadDouble(*outBuf++);	}
+
 };
 
 class	IOWriter {
@@ -43,6 +50,11 @@ public:
 	virtual	void	WriteDouble(double)=0;
 	virtual	void	WriteBulk(const char * inBuf, int inLength, bool inZip)=0;
 
+	virtual	void	WriteSpan(const short * inBuf, int inCount)		{ while(inCount-- > 0) WriteShort(*inBuf++);	}
+	virtual	void	WriteSpan(const int * inBuf, int inCount)		{ while(inCount-- > 0) WriteInt(*inBuf++);		}
+	virtual	void	WriteSpan(const float * inBuf, int inCount)		{ while(inCount-- > 0) WriteFloat(*inBuf++);	}
+	virtual	void	WriteSpan(const double * inBuf, int inCount)	{ while(inCount-- > 0) WriteDouble(*inBuf++);	}
+
 };
 
 #endif
@@ -33,10 +33,20 @@
 // Ratio of operations to an update of the progress bar.
 #define	PROGRESS_RATIO	5000
 
-const int kMainMapID = 'MAP2';
+const int kMainMapID = 'MAP2';		// Every coordinate as an exact rational (MP_Float limbs)
+const int kCompactMapID = 'MAP3';	// Same layout, but points that are exactly two doubles are stored as such
+
+// Point tags in a compact map.
+const short	kPointDouble = 0;
+const short	kPointExact = 1;
+
+// The map is only ever written to a file and read back from memory, so the serializers below take the concrete
+// (final, inline) buffered types instead of IOWriter/IOReader - no virtual call per scalar or per limb.
+typedef	WriterBuffer	MapWriter;
+typedef	MemFileReader	MapReader;
 
 template <class	T, class F>
-void WriteVector(IOWriter& writer, const T& v, F func)
+void WriteVector(MapWriter& writer, const T& v, F func)
 {
 	writer.WriteInt(v.size());
 	for (typename T::const_iterator i = v.begin(); i != v.end(); ++i)
@@ -46,7 +56,7 @@ void WriteVector(IOWriter& writer, const T& v, F func)
 }
 
 template <class T, class F>
-void ReadVector(IOReader& reader, T& v, F func, const TokenConversionMap& c)
+void ReadVector(MapReader& reader, T& v, F func, const TokenConversionMap& c)
 {
 	int counter;
 	v.clear();
@@ -59,7 +69,7 @@ void ReadVector(IOReader& reader, T& v, F func, const TokenConversionMap& c)
 	}
 }
 
-void WriteNetworkSegment(IOWriter& inWriter, const GISNetworkSegment_t& i)
+void WriteNetworkSegment(MapWriter& inWriter, const GISNetworkSegment_t& i)
 {
 	inWriter.WriteInt(i.mFeatType);
 	inWriter.WriteInt(i.mRepType);
@@ -67,7 +77,7 @@ void WriteNetworkSegment(IOWriter& inWriter, const GISNetworkSegment_t& i)
 	inWriter.WriteDouble(i.mTargetHeight);
 }
 
-void ReadNetworkSegment(IOReader& inReader, GISNetworkSegment_t& seg, const TokenConversionMap& c)
+void ReadNetworkSegment(MapReader& inReader, GISNetworkSegment_t& seg, const TokenConversionMap& c)
 {
 	inReader.ReadInt(seg.mFeatType);
 	inReader.ReadInt(seg.mRepType);
@@ -77,7 +87,7 @@ void ReadNetworkSegment(IOReader& inReader, GISNetworkSegment_t& seg, const Toke
 	inReader.ReadDouble(seg.mTargetHeight);
 }
 
-void WriteParamMap				(IOWriter& inWriter, const GISParamMap& m)
+void WriteParamMap				(MapWriter& inWriter, const GISParamMap& m)
 {
 	inWriter.WriteInt(m.size());
 	for (GISParamMap::const_iterator i = m.begin(); i != m.end(); ++i)
@@ -88,7 +98,7 @@ void WriteParamMap				(IOWriter& inWriter, const GISParamMap& m)
 	}
 }
 
-void ReadParamMap				(IOReader& inReader, GISParamMap& m, const TokenConversionMap& c)
+void ReadParamMap				(MapReader& inReader, GISParamMap& m, const TokenConversionMap& c)
 {
 	int counter;
 	m.clear();
@@ -105,7 +115,7 @@ void ReadParamMap				(IOReader& inReader, GISParamMap& m, const TokenConversionM
 	}
 }
 
-void	WriteObjPlacement(IOWriter& inWriter, const GISObjPlacement_t& i)
+void	WriteObjPlacement(MapWriter& inWriter, const GISObjPlacement_t& i)
 {
 	inWriter.WriteInt(i.mRepType);
 	inWriter.WriteDouble(CGAL::to_double(i.mLocation.x()));
@@ -114,7 +124,7 @@ void	WriteObjPlacement(IOWriter& inWriter, const GISObjPlacement_t& i)
 	inWriter.WriteInt(i.mDerived ? 1 : 0);
 }
 
-void ReadObjPlacement(IOReader& inReader, GISObjPlacement_t& p, const TokenConversionMap& c)
+void ReadObjPlacement(MapReader& inReader, GISObjPlacement_t& p, const TokenConversionMap& c)
 {
 	double	x,y;
 	inReader.ReadInt(p.mRepType);
@@ -128,7 +138,7 @@ void ReadObjPlacement(IOReader& inReader, GISObjPlacement_t& p, const TokenConve
 	p.mDerived = (derived != 0);
 }
 
-void WritePolyObjPlacement(IOWriter& inWriter, const GISPolyObjPlacement_t& i)
+void WritePolyObjPlacement(MapWriter& inWriter, const GISPolyObjPlacement_t& i)
 {
 	inWriter.WriteInt(i.mRepType);
 	inWriter.WriteInt(i.mShape.size());	
@@ -147,7 +157,7 @@ void WritePolyObjPlacement(IOWriter& inWriter, const GISPolyObjPlacement_t& i)
 	inWriter.WriteInt(i.mDerived ? 1 : 0);
 }
 
-void ReadPolyObjPlacement(IOReader& inReader, GISPolyObjPlacement_t& obj, const TokenConversionMap& c)
+void ReadPolyObjPlacement(MapReader& inReader, GISPolyObjPlacement_t& obj, const TokenConversionMap& c)
 {
 	inReader.ReadInt(obj.mRepType);
 	obj.mRepType = c[obj.mRepType];
@@ -176,7 +186,7 @@ void ReadPolyObjPlacement(IOReader& inReader, GISPolyObjPlacement_t& obj, const
 	obj.mDerived = (derived != 0);
 }
 
-void WritePointFeature(IOWriter& inWriter, const GISPointFeature_t& i)
+void WritePointFeature(MapWriter& inWriter, const GISPointFeature_t& i)
 {
 	inWriter.WriteInt(i.mFeatType);
 	WriteParamMap(inWriter, i.mParams);
@@ -184,7 +194,7 @@ void WritePointFeature(IOWriter& inWriter, const GISPointFeature_t& i)
 	inWriter.WriteDouble(CGAL::to_double(i.mLocation.y()));
 }
 
-void ReadPointFeature(IOReader& inReader, GISPointFeature_t& feature, const TokenConversionMap& c)
+void ReadPointFeature(MapReader& inReader, GISPointFeature_t& feature, const TokenConversionMap& c)
 {
 	inReader.ReadInt(feature.mFeatType);
 	feature.mFeatType = c[feature.mFeatType];
@@ -196,7 +206,7 @@ void ReadPointFeature(IOReader& inReader, GISPointFeature_t& feature, const Toke
 	feature.mInstantiated = false;
 }
 
-void WritePolygonFeature(IOWriter& inWriter, const GISPolygonFeature_t& i)
+void WritePolygonFeature(MapWriter& inWriter, const GISPolygonFeature_t& i)
 {
 	inWriter.WriteInt(i.mFeatType);
 	WriteParamMap(inWriter, i.mParams);
@@ -209,7 +219,7 @@ void WritePolygonFeature(IOWriter& inWriter, const GISPolygonFeature_t& i)
 	}
 }
 
-void ReadPolygonFeature(IOReader& inReader, GISPolygonFeature_t& obj, const TokenConversionMap& c)
+void ReadPolygonFeature(MapReader& inReader, GISPolygonFeature_t& obj, const TokenConversionMap& c)
 {
 	inReader.ReadInt(obj.mFeatType);
 	obj.mFeatType = c[obj.mFeatType];
@@ -226,13 +236,13 @@ void ReadPolygonFeature(IOReader& inReader, GISPolygonFeature_t& obj, const Toke
 	}
 }
 
-void WriteAreaFeature(IOWriter& inWriter, const GISAreaFeature_t& i)
+void WriteAreaFeature(MapWriter& inWriter, const GISAreaFeature_t& i)
 {
 	inWriter.WriteInt(i.mFeatType);
 	WriteParamMap(inWriter, i.mParams);
 }
 
-void ReadAreaFeature(IOReader& inReader, GISAreaFeature_t& obj, const TokenConversionMap& c)
+void ReadAreaFeature(MapReader& inReader, GISAreaFeature_t& obj, const TokenConversionMap& c)
 {
 	inReader.ReadInt(obj.mFeatType);
 	obj.mFeatType = c[obj.mFeatType];
@@ -257,7 +267,7 @@ void hex_print(const NT& c)
 	printf("\n");
 }
 */
-void WriteCoordinate(IOWriter& inWriter, const NT& c)
+void WriteCoordinate(MapWriter& inWriter, const NT& c)
 {
 #if !USE_GMP
 	NT::ET e = c.exact();
@@ -269,17 +279,17 @@ void WriteCoordinate(IOWriter& inWriter, const NT& c)
 	
 	inWriter.WriteDouble(num.exp);
 	inWriter.WriteInt(num.v.size());
-	for(int n = 0; n < num.v.size(); ++n)
-		inWriter.WriteShort(num.v[n]);
+	if(!num.v.empty())
+		inWriter.WriteSpan(&num.v[0], num.v.size());
 
 	inWriter.WriteDouble(den.exp);
 	inWriter.WriteInt(den.v.size());
-	for(int n = 0; n < den.v.size(); ++n)
-		inWriter.WriteShort(den.v[n]);
+	if(!den.v.empty())
+		inWriter.WriteSpan(&den.v[0], den.v.size());
 #endif		
 }
 
-void ReadCoordinate(IOReader& inReader, NT& c)
+void ReadCoordinate(MapReader& inReader, NT& c)
 {
 #if !USE_GMP
 	int n;
@@ -289,33 +299,27 @@ void ReadCoordinate(IOReader& inReader, NT& c)
 	
 	inReader.ReadDouble(et.num.exp);
 	inReader.ReadInt(n);
-	et.num.v.clear();
-	while(n--)
-	{
-		et.num.v.push_back(short());
-		inReader.ReadShort(et.num.v.back());
-	}
+	et.num.v.assign(n, 0);
+	if(n > 0)
+		inReader.ReadSpan(&et.num.v[0], n);
 
 	inReader.ReadDouble(et.den.exp);
 	inReader.ReadInt(n);
-	et.den.v.clear();
-	while(n--)
-	{
-		et.den.v.push_back(short());
-		inReader.ReadShort(et.den.v.back());
-	}
+	et.den.v.assign(n, 0);
+	if(n > 0)
+		inReader.ReadSpan(&et.den.v[0], n);
 	
 	c = et;
 #endif	
 }
 
-void WritePoint(IOWriter& inWriter, const Point_2& p)
+void WritePoint(MapWriter& inWriter, const Point_2& p)
 {
 	WriteCoordinate(inWriter,p.x());
 	WriteCoordinate(inWriter,p.y());
 }
 
-void ReadPoint(IOReader& inReader, Point_2& p)
+void ReadPoint(MapReader& inReader, Point_2& p)
 {
 	NT	x, y;
 	ReadCoordinate(inReader,x);
@@ -323,6 +327,41 @@ void ReadPoint(IOReader& inReader, Point_2& p)
 	p = Point_2(x,y);
 }
 
+// Almost all of our points came from doubles (shapefiles, DEM posts, apt.dat) and never went through an
+// intersection, so they round-trip through to_double losslessly; only the rest pay for the limb encoding.
+void WritePointCompact(MapWriter& inWriter, const Point_2& p, int& ioExactCount)
+{
+	double	x = CGAL::to_double(p.x());
+	double	y = CGAL::to_double(p.y());
+	if (NT(x) == p.x() && NT(y) == p.y())
+	{
+		inWriter.WriteShort(kPointDouble);
+		inWriter.WriteDouble(x);
+		inWriter.WriteDouble(y);
+	}
+	else
+	{
+		inWriter.WriteShort(kPointExact);
+		WritePoint(inWriter, p);
+		++ioExactCount;
+	}
+}
+
+void ReadPointCompact(MapReader& inReader, Point_2& p)
+{
+	short	tag;
+	inReader.ReadShort(tag);
+	if (tag == kPointDouble)
+	{
+		double	x, y;
+		inReader.ReadDouble(x);
+		inReader.ReadDouble(y);
+		p = Point_2(x,y);
+	}
+	else
+		ReadPoint(inReader, p);
+}
+
 
 #pragma mark -
 
@@ -347,11 +386,25 @@ public:
 	typedef Arrangement_2::Halfedge_const_handle  Halfedge_const_handle;
 	typedef Arrangement_2::Face_const_handle      Face_const_handle;
 
-	IOReader *					reader;
-	IOWriter *					writer;
+	MapReader *					reader;
+	MapWriter *					writer;
 	const TokenConversionMap * 	token_map;
-	PmwxFmt(IOReader * r, const TokenConversionMap * t) : reader(r), writer(NULL), token_map(t) { }
-	PmwxFmt(IOWriter * w) : reader(NULL), writer(w), token_map(NULL) { }
+	bool						compact;		// Points are tagged double-or-exact (MAP3) rather than always exact (MAP2)
+	int							exact_points;	// Points written with the exact encoding
+	PmwxFmt(MapReader * r, const TokenConversionMap * t, bool c) : reader(r), writer(NULL), token_map(t), compact(c), exact_points(0) { }
+	PmwxFmt(MapWriter * w, bool c) : reader(NULL), writer(w), token_map(NULL), compact(c), exact_points(0) { }
+
+	void put_point(const Point_2& p)
+	{
+		if (compact)	WritePointCompact(*writer, p, exact_points);
+		else			{ WritePoint(*writer, p); ++exact_points; }
+	}
+
+	void get_point(Point_2& p)
+	{
+		if (compact)	ReadPointCompact(*reader, p);
+		else			ReadPoint(*reader, p);
+	}
 
 	void write_size (const char *label, Size size)
 	{
@@ -384,7 +437,7 @@ public:
 
 	virtual void write_point (const Point_2& p)
 	{
-		WritePoint(*writer, p);
+		put_point(p);
 	}
 
 	virtual void write_vertex_data (Vertex_const_handle  v)
@@ -404,8 +457,8 @@ public:
 
 	virtual void write_x_monotone_curve (const X_monotone_curve_2& cv)
 	{
-		WritePoint(*writer, cv.source());
-		WritePoint(*writer, cv.target());
+		put_point(cv.source());
+		put_point(cv.target());
 		writer->WriteInt(cv.data().size());
 		for(EdgeKey_container::const_iterator e = cv.data().begin(); e != cv.data().end(); ++e)
 			writer->WriteInt(*e);
@@ -476,7 +529,7 @@ public:
 
 	virtual void read_point (Point_2& p) 
 	{
-		ReadPoint(*reader,p);
+		get_point(p);
 	}
 
 	virtual void read_vertex_data (Vertex_handle v)
@@ -512,8 +565,8 @@ public:
 		Point_2 s, t;
 		int n, v;
 		EdgeKey_container d;
-		ReadPoint(*reader,s);
-		ReadPoint(*reader,t);
+		get_point(s);
+		get_point(t);
 		reader->ReadInt(n);
 		while(n--)
 		{
@@ -577,7 +630,7 @@ private:
 
 #pragma mark -
 
-void	WriteMap(FILE * fi, const Pmwx& inMap, ProgressFunc inProgress, int atomID)
+void	WriteMap(FILE * fi, const Pmwx& inMap, ProgressFunc inProgress, int atomID, int * outExactPoints)
 {
 	StAtomWriter	mapAtom(fi, atomID);
 
@@ -587,14 +640,17 @@ void	WriteMap(FILE * fi, const Pmwx& inMap, ProgressFunc inProgress, int atomID)
 	int	ctr = 0;
 
 	{
-		StAtomWriter 	mainMap(fi, kMainMapID);
-		FileWriter		writer(fi);
+		StAtomWriter 	mainMap(fi, kCompactMapID);
+		FileWriter		file_writer(fi);
+		MapWriter		writer(&file_writer);
 
-		PmwxFmt	write_formatter(&writer);
+		PmwxFmt	write_formatter(&writer, true);
 		
 		CGAL::Arrangement_2_writer<Pmwx>	arr_writer(inMap);
 		
 		arr_writer(write_formatter);
+		if (outExactPoints)
+			*outExactPoints = write_formatter.exact_points;
 	}
 
 	if (inProgress) inProgress(0, 1, "Writing", 1.0);
@@ -609,11 +665,12 @@ void	ReadMap(XAtomContainer& container, Pmwx& inMap, ProgressFunc inProgress, in
 	if (!container.GetNthAtomOfID(atomID, 0, meAtom)) return;
 	meAtom.GetContents(meContainer);
 
-	if (!meContainer.GetNthAtomOfID(kMainMapID, 0, mapAtom)) return;
+	bool compact = meContainer.GetNthAtomOfID(kCompactMapID, 0, mapAtom);
+	if (!compact && !meContainer.GetNthAtomOfID(kMainMapID, 0, mapAtom)) return;
 	mapAtom.GetContents(mapContainer);
 	MemFileReader	readMainMap(mapContainer.begin, mapContainer.end);
 	
-	PmwxFmt	read_formatter(&readMainMap, &c);
+	PmwxFmt	read_formatter(&readMainMap, &c, compact);
 		
 	CGAL::Arrangement_2_reader<Pmwx>	arr_reader(inMap);
 		
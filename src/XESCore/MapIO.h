@@ -50,11 +50,17 @@
 	  for each hole
 	     int number of half edges on each hole
 	     for each inner halfedge, write index
+
+	Points are written in one of two atoms.  MAP2 stores every coordinate as an exact rational: a double exponent,
+	then a count and the 16-bit limbs, for the numerator and then the denominator.  MAP3 (what we write now)
+	prefixes each point with a short tag: 0 means two doubles follow, 1 means the point did not survive conversion
+	to double and the MAP2 encoding follows.  ReadMap takes either.
  */
 
  struct	XAtomContainer;
 
-void	WriteMap(FILE * fi, const 	Pmwx& inMap, ProgressFunc inProgress, int atomID);
+// If outExactPoints is passed, it receives the number of points that needed the exact (limb) encoding.
+void	WriteMap(FILE * fi, const 	Pmwx& inMap, ProgressFunc inProgress, int atomID, int * outExactPoints = NULL);
 void	ReadMap(XAtomContainer& container, Pmwx& inMap, ProgressFunc inProgress, int atomID, const TokenConversionMap& c);
 
 #endif
@@ -30,134 +30,301 @@
 const int kMeshControlID = 'mesh';
 const int kMeshData1ID = 'dat1';
 
-void WriteMesh(FILE * fi, CDT& mesh, int inAtomID, ProgressFunc func)
+/*
+	PACKED MESH FORMAT
+
+	Older XES files store the mesh as 'mesh' + 'dat1' atoms, written one scalar at a time; ReadMesh still reads those.
+	We now write 'msh2' + 'dat2' instead: the same information, but laid out as flat arrays so both sides can move
+	them with one span each, and numbered with hash tables instead of std::map, so a save is linear in mesh size.
+
+	msh2:	int version, int vertex count (n), int face count (m), int dimension (d)
+			int[m * verts per face]		face vertex indices (vertex 0 is the infinite vertex)
+			int[m * (d+1)]				face neighbor indices
+			int[m]						constraint bits, bit j = edge j is constrained
+	dat2:	double[n * 4]				x, y, height, wave height
+			float[n * 3]				vertex normals
+			int[n]						border blend count per vertex, then int[total] terrain + float[total] level
+			int[m * 3]					feature, terrain, flag
+			float[m * 3]				face normals
+			int[m]						terrain border count per face, then int[total] terrain
+
+	The version is bumped if the layout changes; a reader that sees a newer version than it knows skips the mesh.
+*/
+const int kMeshPackedID = 'msh2';
+const int kMeshPackedDataID = 'dat2';
+const int kMeshPackedVersion = 1;
+
+template <class T>
+inline void	write_array(IOWriter& w, const vector<T>& v)
 {
-	StAtomWriter	meshAtom(fi, inAtomID);
-
-	// These maps assign numbers to all entities in the mesh.
-	map<TDS::Vertex_handle, int>	V;
-	map<TDS::Face_handle, int>		F;
-	TDS::Face_iterator				ib;
-	TDS::Vertex_iterator			vit;
+	if (!v.empty())
+		w.WriteSpan(&v[0], v.size());
+}
 
-	int 							vnum = 0;
-	int								fnum = 0;
+template <class T>
+inline void	read_array(IOReader& r, vector<T>& v, int n)
+{
+	v.resize(n);
+	if (n > 0)
+		r.ReadSpan(&v[0], n);
+}
 
-	int j;
+void WriteMesh(FILE * fi, CDT& mesh, int inAtomID, ProgressFunc func)
+{
+	StAtomWriter	meshAtom(fi, inAtomID);
 
-	int ctr = 0;
-	int tot = mesh.tds().number_of_vertices() * 2 + mesh.tds().number_of_full_dim_faces() * 4;
-	int step = tot / 150;
+	TDS&			tds(mesh.tds());
+	int				nv = tds.number_of_vertices();
 
 	PROGRESS_START(func, 0, 1, "Writing terrain mesh...")
 
+	// Number every vertex and face.  The infinite vertex must be vertex 0 - the reader relies on it.
+	hash_map<const TDS::Vertex *, int>	V;
+	hash_map<const TDS::Face *, int>	F;
+	vector<TDS::Vertex_handle>			VT;
+	vector<TDS::Face_handle>			FT;
+
+	V.reserve(nv);
+	VT.reserve(nv);
+	V[&*mesh.infinite_vertex()] = 0;
+	VT.push_back(mesh.infinite_vertex());
+	for (TDS::Vertex_iterator vit = tds.vertices_begin(); vit != tds.vertices_end(); ++vit)
+	if (!(&*vit == &*mesh.infinite_vertex()))
 	{
-		// TDS CONTROL ATOM
-		// This atom contains the basic mesh structure.
-
-		StAtomWriter 	mainAtom(fi, kMeshControlID);
-		FileWriter		writer1(fi);
+		V[&*vit] = VT.size();
+		VT.push_back(vit);
+	}
 
-		// HEADER - number of vertices, number of full DIM faces,
-		// dimension of mesh.
+	for (TDS::Face_iterator ib = tds.face_iterator_base_begin(); ib != tds.face_iterator_base_end(); ++ib)
+	{
+		F[&*ib] = FT.size();
+		FT.push_back(ib);
+	}
 
-		writer1.WriteInt(mesh.tds().number_of_vertices());
-		writer1.WriteInt(mesh.tds().number_of_full_dim_faces());
-		writer1.WriteInt(mesh.tds().dimension());
+	int nf = FT.size();
+	int fv = (mesh.dimension() == -1 ? 1 : mesh.dimension() + 1);
+	int fn = tds.dimension() + 1;
 
-		// Write out vertices
-		V[mesh.infinite_vertex()] = vnum++;
+	PROGRESS_SHOW(func, 0, 1, "Writing terrain mesh...", 1, 4)
 
-		for (vit = mesh.tds().vertices_begin(); vit != mesh.tds().vertices_end(); ++vit, ++ctr)
-		if (!(&*vit == &*mesh.infinite_vertex()))
+	{
+		vector<int>	face_verts(nf * fv), face_nbrs(nf * fn), face_cons(nf);
+		for (int f = 0; f < nf; ++f)
 		{
-			PROGRESS_CHECK(func, 0, 1, "Writing terrain mesh...", ctr, tot, step)
-			V[vit] = vnum++;
+			for (int j = 0; j < fv; ++j)
+				face_verts[f * fv + j] = V[&*FT[f]->vertex(j)];
+			for (int j = 0; j < fn; ++j)
+			{
+				TDS::Face_handle n = FT[f]->neighbor(j);
+				face_nbrs[f * fn + j] = n == TDS::Face_handle() ? 0 : F[&*n];
+			}
+			int bits = 0;
+			for (int j = 0; j < 3; ++j)
+			if (FT[f]->is_constrained(j))
+				bits |= (1 << j);
+			face_cons[f] = bits;
 		}
 
-		// Write out faces
-		int dim = (mesh.dimension() == -1 ? 1 :  mesh.dimension() + 1);
-		for(ib = mesh.tds().face_iterator_base_begin(); ib != mesh.tds().face_iterator_base_end(); ++ib, ++ctr)
+		StAtomWriter 	mainAtom(fi, kMeshPackedID);
+		FileWriter		file_writer(fi);
+		WriterBuffer	writer(&file_writer);
+
+		writer.WriteInt(kMeshPackedVersion);
+		writer.WriteInt(nv);
+		writer.WriteInt(nf);
+		writer.WriteInt(tds.dimension());
+		write_array(writer, face_verts);
+		write_array(writer, face_nbrs);
+		write_array(writer, face_cons);
+	}
+
+	PROGRESS_SHOW(func, 0, 1, "Writing terrain mesh...", 2, 4)
+
+	{
+		StAtomWriter	data1(fi, kMeshPackedDataID);
+		FileWriter		file_writer(fi);
+		WriterBuffer	writer(&file_writer);
+
 		{
-			PROGRESS_CHECK(func, 0, 1, "Writing terrain mesh...", ctr, tot, step)
-			F[ib] = fnum++;
-			for(int j = 0; j < dim ; ++j)
+			vector<double>	pos(nv * 4);
+			vector<float>	nrm(nv * 3), blend_lev;
+			vector<int>		blend_count(nv), blend_type;
+			for (int v = 0; v < nv; ++v)
 			{
-				writer1.WriteInt(V[ib->vertex(j)]);
+				const MeshVertexInfo& i(VT[v]->info());
+				pos[v * 4    ] = CGAL::to_double(VT[v]->point().x());
+				pos[v * 4 + 1] = CGAL::to_double(VT[v]->point().y());
+				pos[v * 4 + 2] = i.height;
+				pos[v * 4 + 3] = i.wave_height;
+				nrm[v * 3    ] = i.normal[0];
+				nrm[v * 3 + 1] = i.normal[1];
+				nrm[v * 3 + 2] = i.normal[2];
+				blend_count[v] = i.border_blend.size();
+				for (hash_map<int,float>::const_iterator bb = i.border_blend.begin(); bb != i.border_blend.end(); ++bb)
+				{
+					blend_type.push_back(bb->first);
+					blend_lev.push_back(bb->second);
+				}
 			}
+			write_array(writer, pos);
+			write_array(writer, nrm);
+			write_array(writer, blend_count);
+			write_array(writer, blend_type);
+			write_array(writer, blend_lev);
 		}
 
-		// Write out neighbors
-		for(ib = mesh.tds().face_iterator_base_begin(); ib != mesh.tds().face_iterator_base_end(); ++ib, ++ctr)
-		{
-			PROGRESS_CHECK(func, 0, 1, "Writing terrain mesh...", ctr, tot, step)
-			for(j = 0; j < mesh.tds().dimension()+1; ++j)
-				writer1.WriteInt(F[ib->neighbor(j)]);
-		}
+		PROGRESS_SHOW(func, 0, 1, "Writing terrain mesh...", 3, 4)
 
-		// Write out constraints
-		for(ib = mesh.tds().face_iterator_base_begin(); ib != mesh.tds().face_iterator_base_end(); ++ib, ++ctr)
 		{
-			PROGRESS_CHECK(func, 0, 1, "Writing terrain mesh...", ctr, tot, step)
-			for (j = 0; j < 3; ++j)
-				writer1.WriteInt(ib->is_constrained(j) ? 1 : 0);
+			vector<int>		ints(nf * 3), border_count(nf), border;
+			vector<float>	nrm(nf * 3);
+			for (int f = 0; f < nf; ++f)
+			{
+				const MeshFaceInfo& i(FT[f]->info());
+				ints[f * 3    ] = i.feature;
+				ints[f * 3 + 1] = i.terrain;
+				ints[f * 3 + 2] = i.flag;
+				nrm[f * 3    ] = i.normal[0];
+				nrm[f * 3 + 1] = i.normal[1];
+				nrm[f * 3 + 2] = i.normal[2];
+				border_count[f] = i.terrain_border.size();
+				border.insert(border.end(), i.terrain_border.begin(), i.terrain_border.end());
+			}
+			write_array(writer, ints);
+			write_array(writer, nrm);
+			write_array(writer, border_count);
+			write_array(writer, border);
 		}
 	}
+	PROGRESS_DONE(func, 0, 1, "Writing terrain mesh...")
+}
+
+static void ReadMeshPacked(XAtomContainer& ctrlContainer, XAtomContainer& dataContainer, CDT& mesh, const TokenConversionMap& conv, ProgressFunc func)
+{
+	MemFileReader	readCtrl(ctrlContainer.begin, ctrlContainer.end);
+	MemFileReader	readData(dataContainer.begin, dataContainer.end);
+
+	int vers, n, m, d;
+	readCtrl.ReadInt(vers);
+	if (vers > kMeshPackedVersion)
+		return;
+	readCtrl.ReadInt(n);
+	readCtrl.ReadInt(m);
+	readCtrl.ReadInt(d);
+
+	if (n == 0) return;
+
+	PROGRESS_START(func, 0, 1, "Reading mesh...")
+
+	TDS& tds(mesh.tds());
+	tds.set_dimension(d);
+
+	std::vector<TDS::Vertex_handle > V(n);
+	std::vector<TDS::Face_handle> 	F(m);
 
-	// Reverse the vertex and face tables...
-	vector<TDS::Vertex_handle>	VT(vnum);
-	vector<TDS::Face_handle>	FT(fnum);
-	for (map<TDS::Vertex_handle, int>::iterator viter = V.begin(); viter != V.end(); ++viter)
-		VT[viter->second] = viter->first;
-	for (map<TDS::Face_handle, int>::iterator fiter = F.begin(); fiter != F.end(); ++fiter)
-		FT[fiter->second] = fiter->first;
+	for (int i = 0; i < n; ++i)
+		V[i] = tds.create_vertex();
+	for (int i = 0; i < m; ++i)
+		F[i] = tds.create_face();
 
+	int fv = (tds.dimension() == -1 ? 1 : tds.dimension() + 1);
+	int fn = tds.dimension() + 1;
 
 	{
-		StAtomWriter	data1(fi, kMeshData1ID);
-		FileWriter		writer2(fi);
+		vector<int>	face_verts, face_nbrs, face_cons;
+		read_array(readCtrl, face_verts, m * fv);
+		read_array(readCtrl, face_nbrs, m * fn);
+		read_array(readCtrl, face_cons, m);
 
-		// Write out per-vertex info.
-		for (j = 0; j < vnum; ++j, ++ctr)
+		for (int i = 0; i < m; ++i)
 		{
-			PROGRESS_CHECK(func, 0, 1, "Writing terrain mesh...", ctr, tot, step)
-
-			writer2.WriteDouble(CGAL::to_double(VT[j]->point().x()));
-			writer2.WriteDouble(CGAL::to_double(VT[j]->point().y()));
-			writer2.WriteDouble(VT[j]->info().height);
-			writer2.WriteDouble(VT[j]->info().wave_height);
-			writer2.WriteFloat(VT[j]->info().normal[0]);
-			writer2.WriteFloat(VT[j]->info().normal[1]);
-			writer2.WriteFloat(VT[j]->info().normal[2]);
-
-			writer2.WriteInt(VT[j]->info().border_blend.size());
-			for (hash_map<int,float>::iterator bb = VT[j]->info().border_blend.begin();
-				bb != VT[j]->info().border_blend.end(); ++bb)
+			for (int j = 0; j < fv; ++j)
 			{
-				writer2.WriteInt(bb->first);
-				writer2.WriteFloat(bb->second);
+				TDS::Vertex_handle v = V[face_verts[i * fv + j]];
+				F[i]->set_vertex(j, v);
+				v->set_face(F[i]);
 			}
+			for (int j = 0; j < fn; ++j)
+				F[i]->set_neighbor(j, F[face_nbrs[i * fn + j]]);
+			for (int j = 0; j < 3; ++j)
+				F[i]->set_constraint(j, (face_cons[i] & (1 << j)) != 0);
+		}
+	}
+
+	PROGRESS_SHOW(func, 0, 1, "Reading mesh...", 1, 3)
+
+	{
+		vector<double>	pos;
+		vector<float>	nrm, blend_lev;
+		vector<int>		blend_count, blend_type;
+		read_array(readData, pos, n * 4);
+		read_array(readData, nrm, n * 3);
+		read_array(readData, blend_count, n);
+		int total = 0;
+		for (int i = 0; i < n; ++i)
+			total += blend_count[i];
+		read_array(readData, blend_type, total);
+		read_array(readData, blend_lev, total);
+
+		int b = 0;
+		for (int i = 0; i < n; ++i)
+		{
+			MeshVertexInfo	vi;
+			vi.height = pos[i * 4 + 2];
+			vi.wave_height = pos[i * 4 + 3];
+			vi.normal[0] = nrm[i * 3    ];
+			vi.normal[1] = nrm[i * 3 + 1];
+			vi.normal[2] = nrm[i * 3 + 2];
+			for (int k = 0; k < blend_count[i]; ++k, ++b)
+				vi.border_blend[conv[blend_type[b]]] = blend_lev[b];
+
+			V[i]->set_point(CDT::Point(pos[i * 4], pos[i * 4 + 1]));
+			V[i]->info() = vi;
 		}
-		// Write out per-face info.
-		for (j = 0; j < fnum; ++j, ++ctr)
+	}
+
+	PROGRESS_SHOW(func, 0, 1, "Reading mesh...", 2, 3)
+
+	{
+		vector<int>		ints, border_count, border;
+		vector<float>	nrm;
+		read_array(readData, ints, m * 3);
+		read_array(readData, nrm, m * 3);
+		read_array(readData, border_count, m);
+		int total = 0;
+		for (int i = 0; i < m; ++i)
+			total += border_count[i];
+		read_array(readData, border, total);
+
+		int b = 0;
+		for (int i = 0; i < m; ++i)
 		{
-			PROGRESS_CHECK(func, 0, 1, "Writing terrain mesh...", ctr, tot, step)
-
-			writer2.WriteInt(FT[j]->info().feature);
-			writer2.WriteInt(FT[j]->info().terrain);
-			writer2.WriteInt(FT[j]->info().flag);
-			writer2.WriteFloat(FT[j]->info().normal[0]);
-			writer2.WriteFloat(FT[j]->info().normal[1]);
-			writer2.WriteFloat(FT[j]->info().normal[2]);
-			writer2.WriteInt(FT[j]->info().terrain_border.size());
-			for (set<int>::iterator tb = FT[j]->info().terrain_border.begin();
-				tb != FT[j]->info().terrain_border.end(); ++tb)
+			MeshFaceInfo	fi;
+			fi.feature = ints[i * 3    ];
+			fi.terrain = ints[i * 3 + 1];
+			fi.flag    = ints[i * 3 + 2];
+			fi.normal[0] = nrm[i * 3    ];
+			fi.normal[1] = nrm[i * 3 + 1];
+			fi.normal[2] = nrm[i * 3 + 2];
+
+			// Faces on the infinite vertex never had real enums written - same as the old format.
+			if (F[i]->vertex(0) != V[0] &&
+				F[i]->vertex(1) != V[0] &&
+				F[i]->vertex(2) != V[0])
 			{
-				writer2.WriteInt(*tb);
+				fi.feature = conv[fi.feature];
+				fi.terrain = conv[fi.terrain];
 			}
+
+			for (int k = 0; k < border_count[i]; ++k, ++b)
+				fi.terrain_border.insert(conv[border[b]]);
+
+			F[i]->info() = fi;
 		}
 	}
-	PROGRESS_DONE(func, 0, 1, "Writing terrain mesh...")
+
+	mesh.set_infinite_vertex(V[0]);
+	PROGRESS_DONE(func, 0, 1, "Reading mesh...")
 }
 
 void ReadMesh(XAtomContainer& container, CDT& mesh, int atomID, const TokenConversionMap& conv, ProgressFunc func)
@@ -168,6 +335,18 @@ void ReadMesh(XAtomContainer& container, CDT& mesh, int atomID, const TokenConve
 	if (!container.GetNthAtomOfID(atomID, 0, meAtom)) return;
 	meAtom.GetContents(meContainer);
 
+	if (meContainer.GetNthAtomOfID(kMeshPackedID, 0, ctrlAtom))
+	{
+		if (!meContainer.GetNthAtomOfID(kMeshPackedDataID, 0, data1Atom)) return;
+		ctrlAtom.GetContents(ctrlContainer);
+		data1Atom.GetContents(data1Container);
+
+		if (mesh.tds().number_of_vertices() != 0)    { mesh.tds().clear(); mesh.cache_reset(); }
+		ReadMeshPacked(ctrlContainer, data1Container, mesh, conv, func);
+		return;
+	}
+
+	// Older XES files: one scalar at a time, vertex/face/neighbor data interleaved.
 	if (!meContainer.GetNthAtomOfID(kMeshControlID, 0, ctrlAtom)) return;
 	ctrlAtom.GetContents(ctrlContainer);
 
@@ -83,61 +83,6 @@ void	FileReader::ReadBulk(char * inBuf, int inLength, bool inZip)
 		throw "fread error";
 }
 
-MemFileReader::MemFileReader(const char * inStart, const char * inEnd, PlatformType platform)
-{
-	mPtr = inStart;
-	mEnd = inEnd;
-	mPlatform = platform;
-}
-
-MemFileReader::~MemFileReader()
-{
-}
-
-void	MemFileReader::ReadShort(short& x)
-{
-	if (mPtr >= mEnd)	return;
-	x = *((short *) mPtr);
-	mPtr += sizeof(short);
-	EndianSwapBuffer(mPlatform, platform_Native, kSwapTwo, &x);
-}
-
-void	MemFileReader::ReadInt(int& x)
-{
-	if (mPtr >= mEnd)	return;
-	x = *((int *) mPtr);
-	mPtr += sizeof(int);
-	EndianSwapBuffer(mPlatform, platform_Native, kSwapFour, &x);
-}
-
-void	MemFileReader::ReadFloat(float& x)
-{
-	if (mPtr >= mEnd)	return;
-	x = *((float *) mPtr);
-	mPtr += sizeof(float);
-	EndianSwapBuffer(mPlatform, platform_Native, kSwapFour, &x);
-}
-
-void	MemFileReader::ReadDouble(double& x)
-{
-	if (mPtr >= mEnd)	return;
-	x = *((double *) mPtr);
-	mPtr += sizeof(double);
-	EndianSwapBuffer(mPlatform, platform_Native, kSwapEight, &x);
-}
-
-void	MemFileReader::ReadBulk(char * inBuf, int inLength, bool inZip)
-{
-	if (mPtr >= mEnd) return;
-	memcpy(inBuf, mPtr, inLength);
-	mPtr += inLength;
-}
-
-
-
-
-
-
 FileWriter::FileWriter(const char * inFileName, PlatformType platform)
 {
 	mFile = fopen(inFileName, "wb");
@@ -187,6 +132,33 @@ void	FileWriter::WriteBulk(const char * inBuf, int inLength, bool inZip)
 	fwrite(inBuf, inLength, 1, mFile);
 }
 
+// Spans go out in one fwrite when no swap is needed, otherwise in stack-sized swapped runs.
+template <class T>
+static void	fwrite_span(FILE * fi, PlatformType platform, const T * p, int n)
+{
+	if (platform == platform_Native || platform == GetNativePlatformType())
+	{
+		if (n > 0)
+			fwrite(p, sizeof(T), n, fi);
+		return;
+	}
+	T	buf[4096 / sizeof(T)];
+	while (n > 0)
+	{
+		int chunk = n > (int) (sizeof(buf) / sizeof(T)) ? (int) (sizeof(buf) / sizeof(T)) : n;
+		memcpy(buf, p, chunk * sizeof(T));
+		EndianSwapArray(platform_Native, platform, chunk, sizeof(T), buf);
+		fwrite(buf, sizeof(T), chunk, fi);
+		p += chunk;
+		n -= chunk;
+	}
+}
+
+void	FileWriter::WriteSpan(const short * inBuf, int inCount)		{ fwrite_span(mFile, mPlatform, inBuf, inCount); }
+void	FileWriter::WriteSpan(const int * inBuf, int inCount)		{ fwrite_span(mFile, mPlatform, inBuf, inCount); }
+void	FileWriter::WriteSpan(const float * inBuf, int inCount)		{ fwrite_span(mFile, mPlatform, inBuf, inCount); }
+void	FileWriter::WriteSpan(const double * inBuf, int inCount)	{ fwrite_span(mFile, mPlatform, inBuf, inCount); }
+
 ZipFileWriter::ZipFileWriter(const char * inFileName, const char * inEntryName, PlatformType platform)
 {
 	mFile = zipOpen(inFileName, 0);
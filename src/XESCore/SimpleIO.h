@@ -27,6 +27,7 @@
 #include <zlib.h>
 #include "zip.h"
 #include "EndianUtils.h"
+#include <string.h>
 
 const char	kSwapTwo[] = { 2, 0 };
 const char	kSwapFour[] = { 4, 0 };
@@ -54,23 +55,60 @@ private:
 
 };
 
-class	MemFileReader : public IOReader {
+// MemFileReader is final and inline so that code holding a MemFileReader (rather than an IOReader) gets its reads
+// inlined - the XES map, mesh and DEM loaders read millions of scalars through it.
+class	MemFileReader final : public IOReader {
 public:
 
-					MemFileReader(const char * inStart, const char * inEnd, PlatformType platform = platform_LittleEndian);
-	virtual			~MemFileReader();
+					MemFileReader(const char * inStart, const char * inEnd, PlatformType platform = platform_LittleEndian) :
+						mPtr(inStart), mEnd(inEnd), mPlatform(platform), mSwap(platform != platform_Native && platform != GetNativePlatformType()) { }
+	virtual			~MemFileReader() { }
 
-	virtual	void	ReadShort(short&);
-	virtual	void	ReadInt(int&);
-	virtual	void	ReadFloat(float&);
-	virtual	void	ReadDouble(double&);
-	virtual	void	ReadBulk(char * inBuf, int inLength, bool inZip);
+	virtual	void	ReadShort(short& x)		{ ReadOne(x, kSwapTwo);		}
+	virtual	void	ReadInt(int& x)			{ ReadOne(x, kSwapFour);	}
+	virtual	void	ReadFloat(float& x)		{ ReadOne(x, kSwapFour);	}
+	virtual	void	ReadDouble(double& x)	{ ReadOne(x, kSwapEight);	}
+	virtual	void	ReadBulk(char * inBuf, int inLength, bool inZip)
+	{
+		if (mPtr >= mEnd) return;
+		memcpy(inBuf, mPtr, inLength);
+		mPtr += inLength;
+	}
+
+	virtual	void	ReadSpan(short * outBuf, int inCount)	{ ReadMany(outBuf, inCount); }
+	virtual	void	ReadSpan(int * outBuf, int inCount)		{ ReadMany(outBuf, inCount); }
+	virtual	void	ReadSpan(float * outBuf, int inCount)	{ ReadMany(outBuf, inCount); }
+	virtual	void	ReadSpan(double * outBuf, int inCount)	{ ReadMany(outBuf, inCount); }
 
 private:
 
+	template <class T>
+	inline void		ReadOne(T& x, const char * fmt)
+	{
+		if (mPtr >= mEnd)	return;
+		memcpy(&x, mPtr, sizeof(T));
+		mPtr += sizeof(T);
+		if (mSwap)
+			EndianSwapBuffer(mPlatform, platform_Native, fmt, &x);
+	}
+
+	// A span that runs off the end of the buffer reads only the whole values that are there.
+	template <class T>
+	inline void		ReadMany(T * x, int n)
+	{
+		int avail = mPtr < mEnd ? (mEnd - mPtr) / sizeof(T) : 0;
+		if (n > avail) n = avail;
+		if (n <= 0) return;
+		memcpy(x, mPtr, n * sizeof(T));
+		mPtr += n * sizeof(T);
+		if (mSwap)
+			EndianSwapArray(mPlatform, platform_Native, n, sizeof(T), x);
+	}
+
 	const char *	mPtr;
 	const char *	mEnd;
 	PlatformType	mPlatform;
+	bool			mSwap;
 
 };
 
@@ -87,6 +125,11 @@ public:
 	virtual	void	WriteDouble(double);
 	virtual	void	WriteBulk(const char * inBuf, int inLength, bool inZip);
 
+	virtual	void	WriteSpan(const short * inBuf, int inCount);
+	virtual	void	WriteSpan(const int * inBuf, int inCount);
+	virtual	void	WriteSpan(const float * inBuf, int inCount);
+	virtual	void	WriteSpan(const double * inBuf, int inCount);
+
 private:
 
 	FILE *			mFile;
@@ -114,9 +157,13 @@ private:
 
 };
 
+// WriterBuffer batches small writes into one big WriteBulk on the writer underneath it.  Like MemFileReader it
+// is final and inline, so serializers that are handed a WriterBuffer directly pay no virtual call per scalar; it
+// is also a full IOWriter and can be passed to code that only takes one.  The buffer is flushed on destruction,
+// so scope the WriterBuffer inside whatever owns the file (e.g. an StAtomWriter).
 #define WRITER_BUFFER_SIZE 65536
 #define WRITER_BUFFER_PAD 1024
-class	WriterBuffer {
+class	WriterBuffer final : public IOWriter {
 
 	char			mBuffer[WRITER_BUFFER_SIZE + WRITER_BUFFER_PAD];
 	int				mPos;
@@ -131,65 +178,68 @@ class	WriterBuffer {
 		mPos = 0;
 	}
 
-public:
-
-	WriterBuffer(IOWriter * inWriter, PlatformType platform = platform_LittleEndian)
-	{
-		mWriter = inWriter;
-		mPos = 0;
-		mPlatform = platform;
-		mSwap = (platform != platform_Native && platform != GetNativePlatformType());
-	}
-
-	~WriterBuffer()
-	{
-		Flush();
-	}
-
-	inline void	WriteShort(short x)
+	template <class T>
+	inline void	WriteOne(T x, const char * fmt)
 	{
 		if (mSwap)
-			EndianSwapBuffer(platform_Native, mPlatform, kSwapTwo, &x);
-		*((short *) (mBuffer + mPos)) = x;
+			EndianSwapBuffer(platform_Native, mPlatform, fmt, &x);
+		memcpy(mBuffer + mPos, &x, sizeof(x));
 		mPos += sizeof(x);
 		if (mPos > WRITER_BUFFER_SIZE)
 			Flush();
 	}
 
-	inline void	WriteInt(int x)
+	// Spans are copied in as big a run as fits and swapped in place in the buffer; a big span that needs
+	// no swap goes straight through to the writer.
+	template <class T>
+	inline void	WriteMany(const T * x, int n)
 	{
-		if (mSwap)
-			EndianSwapBuffer(platform_Native, mPlatform, kSwapFour, &x);
-		*((int *) (mBuffer + mPos)) = x;
-		mPos += sizeof(x);
-		if (mPos > WRITER_BUFFER_SIZE)
+		if (!mSwap && n * (int) sizeof(T) > WRITER_BUFFER_PAD)
+		{
 			Flush();
+			mWriter->WriteBulk((const char *) x, n * sizeof(T), false);
+			return;
+		}
+		while (n > 0)
+		{
+			int chunk = (WRITER_BUFFER_SIZE + WRITER_BUFFER_PAD - mPos) / sizeof(T);
+			if (chunk > n) chunk = n;
+			memcpy(mBuffer + mPos, x, chunk * sizeof(T));
+			if (mSwap)
+				EndianSwapArray(platform_Native, mPlatform, chunk, sizeof(T), mBuffer + mPos);
+			mPos += chunk * sizeof(T);
+			x += chunk;
+			n -= chunk;
+			if (mPos > WRITER_BUFFER_SIZE)
+				Flush();
+		}
 	}
 
-	inline void	WriteFloat(float x)
+public:
+
+	WriterBuffer(IOWriter * inWriter, PlatformType platform = platform_LittleEndian)
 	{
-		if (mSwap)
-			EndianSwapBuffer(platform_Native, mPlatform, kSwapFour, &x);
-		*((float *) (mBuffer + mPos)) = x;
-		mPos += sizeof(x);
-		if (mPos > WRITER_BUFFER_SIZE)
-			Flush();
+		mWriter = inWriter;
+		mPos = 0;
+		mPlatform = platform;
+		mSwap = (platform != platform_Native && platform != GetNativePlatformType());
 	}
 
-	inline void	WriteDouble(double x)
+	virtual ~WriterBuffer()
 	{
-		if (mSwap)
-			EndianSwapBuffer(platform_Native, mPlatform, kSwapEight, &x);
-		*((double *) (mBuffer + mPos)) = x;
-		mPos += sizeof(x);
-		if (mPos > WRITER_BUFFER_SIZE)
-			Flush();
+		Flush();
 	}
 
-	inline void	WriteBulk(const char * inBuf, int inLength, bool inZip)
+	virtual	void	WriteShort(short x)		{ WriteOne(x, kSwapTwo);	}
+	virtual	void	WriteInt(int x)			{ WriteOne(x, kSwapFour);	}
+	virtual	void	WriteFloat(float x)		{ WriteOne(x, kSwapFour);	}
+	virtual	void	WriteDouble(double x)	{ WriteOne(x, kSwapEight);	}
+
+	virtual	void	WriteBulk(const char * inBuf, int inLength, bool inZip)
 	{
 		if (inLength > WRITER_BUFFER_PAD)
 		{
+			Flush();
 			mWriter->WriteBulk(inBuf, inLength, inZip);
 		} else {
 			memcpy(mBuffer + mPos, inBuf, inLength);
@@ -198,6 +248,11 @@ public:
 		}
 	}
 
+	virtual	void	WriteSpan(const short * inBuf, int inCount)		{ WriteMany(inBuf, inCount); }
+	virtual	void	WriteSpan(const int * inBuf, int inCount)		{ WriteMany(inBuf, inCount); }
+	virtual	void	WriteSpan(const float * inBuf, int inCount)		{ WriteMany(inBuf, inCount); }
+	virtual	void	WriteSpan(const double * inBuf, int inCount)	{ WriteMany(inBuf, inCount); }
+
 };
 
 #endif
@@ -49,7 +49,8 @@ void	WriteXESFile(
 					  CDT&		inMesh,
 				DEMGeoMap&		inDEM,
 				const AptVector& inApts,
-				ProgressFunc	inFunc);
+				ProgressFunc	inFunc,
+				int *			outExactPoints = NULL);	// Optional: map points that needed exact (non-double) storage
 
 void	ReadXESFile(
 				MFMemFile *		inFile,
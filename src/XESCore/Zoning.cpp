@@ -44,6 +44,7 @@
 #include "BlockFill.h"
 #include "BlockAlgs.h"
 #include "MathUtils.h"
+#include <random>
 
 // NOTE: all that this does is propegate parks, forestparks, cemetaries and golf courses to the feature type if
 // it isn't assigned.
@@ -2019,6 +2020,13 @@ PointRule_t * GetPointRuleForFeature(int zoning, const GISPointFeature_t& f)
 	return NULL;
 }
 
+static thread_local minstd_rand	sFacadeRandom;
+
+void	SeedFacadeRules(unsigned int seed)
+{
+	sFacadeRandom.seed(seed);
+}
+
 FacadeSpelling_t * GetFacadeRule(int zoning, int variant, double front_wall_len, double height, double depth_one_fac)
 {
 	vector<FacadeSpelling_t *>	possible;
@@ -2061,7 +2069,7 @@ FacadeSpelling_t * GetFacadeRule(int zoning, int variant, double front_wall_len,
 	}
 	if(!possible.empty())
 	{
-		return possible[rand() % possible.size()];
+		return possible[sFacadeRandom() % possible.size()];
 	}
 
 	#if DEV
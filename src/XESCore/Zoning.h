@@ -267,4 +267,8 @@ PointRule_t * GetPointRuleForFeature(int zoning, const GISPointFeature_t& f);
 
 FacadeSpelling_t * GetFacadeRule(int zoning, int variant, double front_wall_len, double height, double depth_one_fac);
 
+// GetFacadeRule picks at random among equally good facades, from a per-thread generator.  Block fill reseeds it for each
+// block so that the pick depends only on the block - not on which thread filled it or what got filled before.
+void	SeedFacadeRules(unsigned int seed);
+
 #endif /* ZONING_H */
@@ -386,7 +386,9 @@ static int DoSave(const vector<const char *>& args)
 	{
 		if (gVerbose) printf("Saving file %s\n", args[0]);
 		check_map_sanity();
-		WriteXESFile(args[0], gMap, gTriangulationHi, gDem, gApts, gProgress);
+		int exact_pts = 0;
+		WriteXESFile(args[0], gMap, gTriangulationHi, gDem, gApts, gProgress, &exact_pts);
+		if (gVerbose) printf("  %d map points needed exact (non-double) storage.\n", exact_pts);
 		return 0;
 	} else {
 		printf("Not writing file %s - no DEMs and no land!\n", args[0]);
@@ -399,10 +401,87 @@ static int DoSaveForce(const vector<const char *>& args)
 {
 	if (gVerbose) printf("Saving file %s (always)\n", args[0]);
 	check_map_sanity();
-	WriteXESFile(args[0], gMap, gTriangulationHi, gDem, gApts, gProgress);
+	int exact_pts = 0;
+	WriteXESFile(args[0], gMap, gTriangulationHi, gDem, gApts, gProgress, &exact_pts);
+	if (gVerbose) printf("  %d map points needed exact (non-double) storage.\n", exact_pts);
 	return 0;
 }
 
+static bool same_file_bytes(const char * a, const char * b)
+{
+	MFMemFile * fa = MemFile_Open(a);
+	MFMemFile * fb = MemFile_Open(b);
+	bool same = fa && fb &&
+		(MemFile_GetEnd(fa) - MemFile_GetBegin(fa)) == (MemFile_GetEnd(fb) - MemFile_GetBegin(fb)) &&
+		memcmp(MemFile_GetBegin(fa), MemFile_GetBegin(fb), MemFile_GetEnd(fa) - MemFile_GetBegin(fa)) == 0;
+	if (fa) MemFile_Close(fa);
+	if (fb) MemFile_Close(fb);
+	return same;
+}
+
+#define DoBenchXES_HELP \
+"USAGE: -bench_xes <passes> <file> [<file>...]\n"\
+"Reads each XES file and writes it back out passes times, and prints the time\n"\
+"and MB/s for each direction.  The copy is then read and written once more;\n"\
+"fails unless the two copies are byte for byte the same.  Also says whether\n"\
+"the copy matches the original.  The loaded map, mesh and DEMs are not touched.\n"
+static int DoBenchXES(const vector<const char *>& args)
+{
+	int passes = max(atoi(args[0]), 1);
+	int err = 0;
+	for (int f = 1; f < args.size(); ++f)
+	{
+		string	copy[2] = { string(args[f]) + ".bench1", string(args[f]) + ".bench2" };
+		double	read_us = 0.0, write_us = 0.0, bytes = 0.0;
+
+		// Pass 0..passes-1 time original -> copy[0]; the last, untimed, run is copy[0] -> copy[1].
+		for (int n = 0; n <= passes; ++n)
+		{
+			const char * src = n < passes ? args[f] : copy[0].c_str();
+			const char * dst = n < passes ? copy[0].c_str() : copy[1].c_str();
+			MFMemFile * fi = MemFile_Open(src);
+			if (fi == NULL)
+			{
+				fprintf(stderr, "Could not load file %s.\n", src);
+				return 1;
+			}
+			bytes = MemFile_GetEnd(fi) - MemFile_GetBegin(fi);
+
+			Pmwx		map;
+			CDT			mesh;
+			DEMGeoMap	dems;
+			AptVector	apts;
+
+			unsigned long long t0 = query_hpc();
+			ReadXESFile(fi, &map, &mesh, &dems, &apts, NULL);
+			unsigned long long t1 = query_hpc();
+			MemFile_Close(fi);
+			WriteXESFile(dst, map, mesh, dems, apts, NULL);
+			unsigned long long t2 = query_hpc();
+			if (n < passes)
+			{
+				read_us += hpc_to_microseconds(t1 - t0);
+				write_us += hpc_to_microseconds(t2 - t1);
+			}
+		}
+
+		bool stable = same_file_bytes(copy[0].c_str(), copy[1].c_str());
+		bool as_input = same_file_bytes(args[f], copy[0].c_str());
+		if (!stable) err = 1;
+
+		double mb = bytes / (1024.0 * 1024.0);
+		printf("BENCH %s: %.1lf MB, read %.2lf ms (%.1lf MB/s), write %.2lf ms (%.1lf MB/s), round trip %s, %s the input\n",
+			args[f], mb,
+			read_us / passes / 1000.0, mb * passes / (read_us / 1000000.0),
+			write_us / passes / 1000.0, mb * passes / (write_us / 1000000.0),
+			stable ? "stable" : "UNSTABLE", as_input ? "same bytes as" : "differs from");
+
+		FILE_delete_file(copy[0].c_str(), false);
+		FILE_delete_file(copy[1].c_str(), false);
+	}
+	return err;
+}
+
 
 static int DoIfEmpty(const vector<const char *>& args)
 {
@@ -3057,6 +3136,7 @@ static	GISTool_RegCmd_t		sCoreCmds[] = {
 { "-load", 			1, 1, DoLoad, 			"Load an XES file.", "" },
 { "-save", 			1, 1, DoSave, 			"Save an XES file.", "" },
 { "-force_save", 	1, 1, DoSaveForce,		"Save an XES file, even if empty.", "" },
+{ "-bench_xes",		2, -1, DoBenchXES,		"Time XES reads and writes, check the round trip.", DoBenchXES_HELP },
 { "-ifempty",		1, 2, DoIfEmpty,		"Skip the next N commands unless the map or a layer is empty.", "" },
 { "-cropsave", 		1, 1, DoCropSave, 		"Save only extent as an XES file.", "" },
 { "-overlay", 		1, 1, DoOverlay, 		"Superimpose/replace a second vector map.", "" },
@@ -31,6 +31,7 @@
 #include "PlatformUtils.h"
 #include "FileUtils.h"
 #include "MemFileUtils.h"
+#include <thread>
 
 #if OPENGL_MAP
 #include "RF_Notify.h"
@@ -102,7 +103,7 @@ static int DoRasterImport(const vector<const char *>& args)
 	}
 	else if(strcmp(args[1],"tiff") == 0)
 	{
-		if(!ExtractGeoTiff(*dem, args[2], mode, strstr(args[0],"l") != NULL))
+		if(!ExtractGeoTiff(*dem, args[2], mode, strstr(args[0],"l") != NULL, 0))
 		{
 			if(strstr(args[0],"i")) return 0;
 			fprintf(stderr,"Unable to read GeoTiff file %s\n", args[2]);
@@ -807,6 +808,47 @@ static int DoGeoTiffImport(const vector<const char *>& args)
 }
 */
 
+#define DoBenchGeoTiff_HELP \
+"USAGE: -bench_geotiff <threads> <passes> <file> [<file>...]\n"\
+"Reads each GeoTiff passes times serially and passes times on <threads>\n"\
+"threads (0 = one per core), alternating the two, and prints the time per\n"\
+"read.  Fails if the two reads of a file give different samples.\n"
+static int DoBenchGeoTiff(const vector<const char *>& args)
+{
+	int threads = atoi(args[0]);
+	int passes = max(atoi(args[1]), 1);
+	int err = 0;
+	for (int f = 2; f < args.size(); ++f)
+	{
+		double	usec[2] = { 0.0, 0.0 };
+		DEMGeo	dem[2];
+		for (int n = 0; n < passes; ++n)
+		for (int par = 0; par < 2; ++par)
+		{
+			unsigned long long t0 = query_hpc();
+			bool ok = ExtractGeoTiff(dem[par], args[f], dem_want_Post, 1, par ? threads : 1);
+			usec[par] += hpc_to_microseconds(query_hpc() - t0);
+			if (!ok)
+			{
+				fprintf(stderr, "Unable to read GeoTiff file %s\n", args[f]);
+				return 1;
+			}
+		}
+
+		bool same = dem[0].mWidth == dem[1].mWidth && dem[0].mHeight == dem[1].mHeight &&
+			dem[0].mWest == dem[1].mWest && dem[0].mSouth == dem[1].mSouth &&
+			dem[0].mEast == dem[1].mEast && dem[0].mNorth == dem[1].mNorth &&
+			memcmp(dem[0].mData, dem[1].mData, sizeof(float) * dem[0].mWidth * dem[0].mHeight) == 0;
+		if (!same) err = 1;
+
+		printf("BENCH %s: %dx%d, serial %.2lf ms, %d threads %.2lf ms, speedup %.2lf, %s\n", args[f],
+			dem[0].mWidth, dem[0].mHeight, usec[0] / passes / 1000.0,
+			threads ? threads : (int) thread::hardware_concurrency(), usec[1] / passes / 1000.0, usec[0] / usec[1],
+			same ? "identical" : "DIFFERENT");
+	}
+	return err;
+}
+
 static int DoGLCCImport(const vector<const char *>& args)
 {
 	DEMGeo&	dem = gDem[dem_LandUse];
@@ -1027,6 +1069,22 @@ static int DoSaveNormals(const vector<const char *>& args)
 	return 0;
 }
 
+#define DoRasterScratch_HELP \
+"USAGE: -raster_scratch dir [min_mb]\n"\
+"Raster layers of at least min_mb megabytes (default 64) created after this\n"\
+"are kept in memory-mapped scratch files in dir, so the OS can page them\n"\
+"to disk.  Use this when the raster layers of a big run exceed RAM.\n"\
+"Pass - as the dir to go back to keeping rasters in memory.\n"
+static int DoRasterScratch(const vector<const char *>& args)
+{
+	size_t min_mb = args.size() > 1 ? atoi(args[1]) : 64;
+	if (strcmp(args[0], "-") == 0)
+		DEMGeo_SetScratchStore(NULL, 0);
+	else
+		DEMGeo_SetScratchStore(args[0], min_mb * 1024 * 1024);
+	return 0;
+}
+
 static	GISTool_RegCmd_t		sDemCmds[] = {
 { "-hgt", 			1, 1, DoHGTImport, 			"Import 16-bit BE raw HGT DEM.", "" },
 { "-hgtzip", 		1, 1, DoHGTExport, 			"Export 16-bit BE raw HGT DEM.", "" },
@@ -1041,8 +1099,10 @@ static	GISTool_RegCmd_t		sDemCmds[] = {
 { "-markoverlay",	0, 0, DoRemember,			"Remember the current elevation as overlay.", "" },
 { "-readmask",		1, 1, DoMaskRemember,		"Remember the current elevation as overlay.", "" },
 { "-raster_import",	4, 7, DoRasterImport,		"Import one raster DEM file.", DoRasterImport_HELP },
+{ "-bench_geotiff",	3, -1, DoBenchGeoTiff,		"Time serial against parallel GeoTiff reads.", DoBenchGeoTiff_HELP },
 { "-raster_export", 4, 5, DoRasterExport,		"Export one raster DEM file.", DoRasterExport_HELP }, 
 { "-raster_init",	4, 5, DoRasterInit,			"Create new empty raster layer.", DoRasterInit_HELP }, 
+{ "-raster_scratch",	1, 2, DoRasterScratch,		"Page big raster layers from scratch files.", DoRasterScratch_HELP },
 { "-raster_scale",	2, 2, DoRasterScale,		"Resize a raster layer.", DoRasterScale_HELP },
 { "-raster_resample",4, 4, DoRasterResample,	"Resample raster layer.", DoRasterResample_HELP }, 
 { "-raster_resample_median",4, 4, DoRasterResampleMedian,	"Resample raster layer with median.", DoRasterResampleMedian_HELP },
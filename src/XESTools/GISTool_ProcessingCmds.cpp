@@ -345,8 +345,18 @@ static int DoRemoveDupeObjs(const vector<const char *>& args)
 	return 0;
 }
 
+#define DoInstantiateObjs_HELP \
+"USAGE: -instobjs [threads] [check]\n"\
+"Fill the zoned blocks with autogen and forests.  Blocks are filled on\n"\
+"the given number of threads - 0 for one per core, default 1.  The\n"\
+"output is the same for any thread count.  With 'check' the blocks are\n"\
+"filled serially first and the command fails unless the threaded fill\n"\
+"gives the same polygon objects.  The threaded fill needs a build with\n"\
+"BLOCKFILL_THREADS, see BlockFill.h.\n"
 static int DoInstantiateObjs(const vector<const char *>& args)
 {
+	int num_threads = args.empty() ? 1 : atoi(args[0]);
+	bool check = args.size() > 1 && strcmp(args[1], "check") == 0;
 
 	Pmwx	forest_stands;
 
@@ -424,10 +434,6 @@ static int DoInstantiateObjs(const vector<const char *>& args)
 	
 	PROGRESS_START(gProgress, 0, 2, "Creating 3-d.")
 	trim_map(gMap);
-	int idx = 0;
-	int t = gMap.number_of_faces();
-	int step = t / 100;
-	if(step < 1) step = 1;
 
 	#if OPENGL_MAP
 		bool no_sel = gFaceSelection.empty();
@@ -452,23 +458,20 @@ static int DoInstantiateObjs(const vector<const char *>& args)
 	// want it all? slow?  to test?  ok...
 	//ag_ok=1;
 
-	for(Pmwx::Face_handle f = gMap.faces_begin(); f != gMap.faces_end(); ++f, ++idx)
+	vector<Pmwx::Face_handle>	blocks;
+	for(Pmwx::Face_handle f = gMap.faces_begin(); f != gMap.faces_end(); ++f)
 	if(!f->is_unbounded())
 	if(!f->data().IsWater())
 	#if OPENGL_MAP
 	if(gFaceSelection.count(f) || no_sel)
 	#endif
-	{
-//		unsigned long long before, after;
-//		Microseconds((UnsignedWide *)&before);
-		PROGRESS_CHECK(gProgress, 0, 1, "Creating 3-d.", idx, t, step);
-		process_block(f,gTriangulationHi, ag_ok, forests, forest_index);
-//		Microseconds((UnsignedWide *)&after);
-//		double elapsed = (double) (after - before) / 1000000.0;
-//		by_zone[f->data().GetZoning()] += elapsed;
-//		int ns = count_circulator(f->outer_ccb());
-//		by_sides[ns] += elapsed;
-	}
+		blocks.push_back(f);
+
+	bool same = true;
+	if(check)
+		same = check_process_blocks(gMap, blocks, gTriangulationHi, ag_ok, forests, forest_index, forest_stands, gProgress, num_threads);
+	else
+		process_blocks(gMap, blocks, gTriangulationHi, ag_ok, forests, forest_index, forest_stands, gProgress, num_threads);
 
 	printf("Blocks: %d.  Split: %d. Forests: %d.  Parts: %d\n",  num_block_processed, num_blocks_with_split, num_forest_split, num_line_integ);
 	
@@ -517,7 +520,7 @@ static int DoInstantiateObjs(const vector<const char *>& args)
 //		InstantiateGTPolygonAll(insets, gDem, gTriangulationHi, gProgress);
 //	}
 //	DumpPlacementCounts();
-	return 0;
+	return same ? 0 : 1;
 
 }
 
@@ -609,7 +612,7 @@ static	GISTool_RegCmd_t		sProcessCmds[] = {
 //{ "-hydrobridge",	0, 0, DoBridgeRebuild,	"Rebuild bridgse after hydro.",		  "" },
 { "-derivedems", 	1, 1, DoDeriveDEMs, 	"Derive DEM data.", 				  "" },
 { "-removedupes", 	0, 0, DoRemoveDupeObjs, "Remove duplicate objects.", 		  "" },
-{ "-instobjs", 		0, 0, DoInstantiateObjs, "Instantiate Objects.", 			  "" },
+{ "-instobjs", 		0, 2, DoInstantiateObjs, "Instantiate Objects.", 			  DoInstantiateObjs_HELP },
 { "-buildroads", 	0, 0, DoBuildRoads, 	"Pick Road Types.", 	  			"" },
 { "-assignterrain", 1, 1, DoAssignLandUse, 	"Assign Terrain to Mesh.", 	 		 "" },
 { "-exportdsf", 	2, 2, DoBuildDSF, 		"Build DSF file.", 					  "" },
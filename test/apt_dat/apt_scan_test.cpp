@@ -0,0 +1,294 @@
+/*
+ * Checks the chunked, threaded apt.dat scan of the navaid layer against the serial parser it replaced and
+ * times both.  Every chunk count must give the same airports in the same order, and the map the navaid layer
+ * builds from them (a later duplicate ICAO wins) must match the serial parser's exactly.
+ *
+ * Usage:  apt_scan_test --make <file> <airports> [crlf] [no99]	writes a synthetic apt.dat
+ *         apt_scan_test <passes> <apt.dat> [...]				checks and times the given files
+ */
+
+#include "WED_AptDatScan.h"
+#include "MemFileUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+static double now_ms(void)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static unsigned int rng_state = 12345;
+static int rnd(int n)
+{
+	rng_state = rng_state * 1103515245 + 12345;
+	return (rng_state >> 8) % n;
+}
+
+/* A synthetic apt.dat: airports, seaplane bases and heliports with the rows the scan looks at - runways, sealanes,
+   helipads, pavement nodes, taxi nodes, ramp starts, beacons, windsocks, signs, light fixtures, tower frequencies -
+   and a share of the rows it skips (flows, routes, edges, metadata) that start with the same digits. Every 97th
+   airport repeats an earlier ICAO, some have nothing to locate them, some rows are indented or preceded by blank
+   lines. The average airport is a bit over 2 kB, like the global apt.dat. */
+static bool make_apt_dat(const char * path, int airports, bool crlf, bool no99)
+{
+	FILE * fi = fopen(path, crlf ? "wb" : "w");
+	if (!fi) return false;
+	const char * eol = crlf ? "\r\n" : "\n";
+	fprintf(fi, "I%s1100 Generated by apt_scan_test. This is synthetic data.%s%s", eol, eol, eol);
+
+	for (int a = 0; a < airports; ++a)
+	{
+		static const int headers[] = { 1, 1, 1, 1, 1, 1, 16, 17, 17 };
+		int		hdr = headers[rnd(9)];
+		double	lat = -60.0 + rnd(1400000) * 0.0001;
+		double	lon = -180.0 + rnd(3600000) * 0.0001;
+		char	icao[16];
+		if (a > 100 && a % 97 == 0)
+			snprintf(icao, sizeof(icao), "X%05d", rnd(a));
+		else
+			snprintf(icao, sizeof(icao), "X%05d", a);
+
+		if (rnd(10) == 0) fputs(eol, fi);
+		fprintf(fi, "%s%d %5d 0 0 %s Synthetic %s number %d%s", rnd(20) ? "" : " ", hdr, rnd(9000), icao, hdr == 17 ? "Heliport" : "Field", a, eol);
+		fprintf(fi, "1302 city Testville%s1302 country Nowhere%s", eol, eol);
+		if (rnd(50) == 0)
+			continue;													// nothing that locates it
+
+		if (hdr == 1)
+		for (int r = rnd(3) + 1; r > 0; --r)
+		{
+			double h = rnd(180) * 0.01745;
+			fprintf(fi, "100 %.2lf 1 0 0.25 1 3 0 %02d %.8lf %.8lf 0 0 2 0 0 1 %02dR %.8lf %.8lf 0 0 2 0 0 1%s", 30.0 + rnd(30), r, lat + sin(h) * 0.01, lon + cos(h) * 0.01, r + 18, lat - sin(h) * 0.01, lon - cos(h) * 0.01, eol);
+		}
+		if (hdr == 16)
+			fprintf(fi, "101 50.00 0 05 %.8lf %.8lf 23 %.8lf %.8lf%s", lat + 0.01, lon - 0.005, lat - 0.01, lon + 0.005, eol);
+		if (hdr != 16 && rnd(3) == 0)
+			fprintf(fi, "102 H%d %.8lf %.8lf 0.00 15.00 15.00 1 0 0 0.25 0%s", rnd(9), lat + rnd(100) * 0.0001, lon - rnd(100) * 0.0001, eol);
+
+		for (int p = rnd(4); p > 0; --p)
+		{
+			fprintf(fi, "110 1 0.25 %.2lf Taxiway %d%s", rnd(360) * 1.0, p, eol);
+			for (int v = rnd(20) + 4; v > 0; --v)
+			{
+				int code = 111 + rnd(6);
+				double y = lat + (rnd(2000) - 1000) * 0.00001, x = lon + (rnd(2000) - 1000) * 0.00001;
+				if (code == 112 || code == 114 || code == 116)
+					fprintf(fi, "%d %.8lf %.8lf %.8lf %.8lf%s%s", code, y, x, y + 0.00001, x + 0.00001, code == 116 ? "" : " 3 102", eol);
+				else
+					fprintf(fi, "%d %.8lf %.8lf%s%s", code, y, x, code == 115 ? "" : " 51", eol);
+			}
+		}
+		fprintf(fi, "1200%s", eol);
+		for (int v = rnd(30); v > 0; --v)
+			fprintf(fi, "1201 %.8lf %.8lf both %d%s", lat + (rnd(2000) - 1000) * 0.00001, lon + (rnd(2000) - 1000) * 0.00001, v, eol);
+		for (int e = rnd(30); e > 0; --e)
+			fprintf(fi, "1202 %d %d twoway taxiway%s", e, e + 1, eol);
+		for (int s = rnd(8); s > 0; --s)
+			fprintf(fi, "1300 %.8lf %.8lf %.2lf gate jets Gate %d%s", lat + rnd(100) * 0.00001, lon + rnd(100) * 0.00001, rnd(360) * 1.0, s, eol);
+		if (rnd(2)) fprintf(fi, "18 %.8lf %.8lf 1 BCN%s", lat + 0.002, lon, eol);
+		if (rnd(2)) fprintf(fi, "   19 %.8lf %.8lf 1 WS%s", lat, lon + 0.002, eol);
+		if (rnd(3) == 0) fprintf(fi, "20 %.8lf %.8lf %.2lf 0 2 {@Y}A1%s", lat - 0.001, lon, rnd(360) * 1.0, eol);
+		if (rnd(3) == 0) fprintf(fi, "21 %.8lf %.8lf 2 %.2lf 3.00 %02d PAPI%s", lat, lon - 0.001, rnd(360) * 1.0, rnd(36) + 1, eol);
+		if (rnd(4) == 0) fprintf(fi, "14 %.8lf %.8lf 100 0 Tower%s", lat, lon, eol);
+		if (rnd(3) == 0) fprintf(fi, "1050 %d ATIS%s", 118000 + rnd(1000) * 5, eol);
+		int twr = rnd(4);
+		if (twr == 1) fprintf(fi, "54 %d TWR%s", 11800 + rnd(100) * 5, eol);
+		if (twr == 2) fprintf(fi, "1054 %d TWR%s", 118000 + rnd(1000) * 5, eol);
+		if (rnd(5) == 0) fprintf(fi, "1000 Flow %d%s1001 %s 270 010 5%s1100 %02d 11920 arrivals 180 355 Rule%s1101 %02d left%s", a, eol, icao, eol, rnd(36) + 1, eol, rnd(36) + 1, eol);
+	}
+	if (!no99)
+		fprintf(fi, "99%s", eol);
+	return fclose(fi) == 0;
+}
+
+// The serial parser as it was before the scan was cut into chunks, to compare against.
+static bool reference_parse(MFMemFile * str, map<string, apt_dat_entry_t>& tAirports)
+{
+	MFScanner	s;
+	MFS_init(&s, str);
+	int versions[] = { 1000, 1021, 1050, 1100, 1130, 1200, 0 };
+
+	if (!MFS_xplane_header(&s, versions, NULL, NULL))
+		return false;
+
+	int apt_type = 0;
+	Bbox2 apt_bounds;
+	apt_dat_entry_t n;
+
+	while (!MFS_done(&s))
+	{
+		int rowcode = MFS_int(&s);
+		if (rowcode == 1 || rowcode == 16 || rowcode == 17 || rowcode == 99)
+		{
+			if (apt_type)
+			{
+				n.lonlat = apt_bounds.centroid();
+				tAirports[n.icao] = n;
+			}
+			apt_type = rowcode;
+			apt_bounds = Bbox2();
+			n.type = 10000 + rowcode;
+			n.has_atc = 0;
+			MFS_int(&s);
+			MFS_int(&s);
+			MFS_int(&s);
+			MFS_string(&s, &n.icao);
+			MFS_string_eol(&s, &n.name);
+		}
+		else if (apt_type)
+		{
+			if ((rowcode >= 111 && rowcode <= 116) || rowcode == 1201 || rowcode == 1300 || (rowcode >= 18 && rowcode <= 21))
+			{
+				double lat = MFS_double(&s);
+				double lon = MFS_double(&s);
+				apt_bounds += Point2(lon, lat);
+			}
+			else if (rowcode == 100)
+			{
+				for (int i = 0; i < 7; ++i) MFS_double(&s);
+				MFS_string(&s, NULL);
+				double lat = MFS_double(&s);
+				double lon = MFS_double(&s);
+				for (int i = 0; i < 6; ++i) MFS_double(&s);
+				apt_bounds += Point2(lon, lat);
+				MFS_string(&s, NULL);
+				lat = MFS_double(&s);
+				lon = MFS_double(&s);
+				apt_bounds += Point2(lon, lat);
+			}
+			else if (rowcode == 101)
+			{
+				MFS_double(&s);
+				MFS_double(&s);
+				MFS_string(&s, NULL);
+				double lat = MFS_double(&s);
+				double lon = MFS_double(&s);
+				apt_bounds += Point2(lon, lat);
+				MFS_string(&s, NULL);
+				lat = MFS_double(&s);
+				lon = MFS_double(&s);
+				apt_bounds += Point2(lon, lat);
+			}
+			else if (rowcode == 102)
+			{
+				MFS_string(&s, NULL);
+				double lat = MFS_double(&s);
+				double lon = MFS_double(&s);
+				apt_bounds += Point2(lon, lat);
+			}
+			else if (rowcode == 54 || rowcode == 1054)
+				n.has_atc = 1;
+		}
+		MFS_string_eol(&s, NULL);
+	}
+	return true;
+}
+
+// Bitwise, so that the centers of airports with nothing to locate them compare too.
+static bool same_entry(const apt_dat_entry_t& a, const apt_dat_entry_t& b)
+{
+	return a.type == b.type && a.has_atc == b.has_atc && a.icao == b.icao && a.name == b.name &&
+		memcmp(&a.lonlat, &b.lonlat, sizeof(Point2)) == 0;
+}
+
+static bool check_file(const char * path, int passes)
+{
+	MFMemFile * fi = MemFile_Open(path);
+	if (!fi)
+	{
+		printf("FAILED: could not open %s\n", path);
+		return false;
+	}
+	double mb = (MemFile_GetEnd(fi) - MemFile_GetBegin(fi)) / 1048576.0;
+
+	map<string, apt_dat_entry_t> ref;
+	double ref_ms = 1e30;
+	for (int p = 0; p < passes; ++p)
+	{
+		ref.clear();
+		double t0 = now_ms();
+		if (!reference_parse(fi, ref))
+		{
+			printf("FAILED: %s has no apt.dat header\n", path);
+			MemFile_Close(fi);
+			return false;
+		}
+		ref_ms = min(ref_ms, now_ms() - t0);
+	}
+
+	bool ok = true;
+	vector<apt_dat_entry_t> serial;
+	static const int chunk_counts[] = { 1, 2, 3, 8, 64, 0 };
+	for (int c : chunk_counts)
+	{
+		vector<apt_dat_entry_t> found;
+		double ms = 1e30;
+		for (int p = 0; p < passes; ++p)
+		{
+			found.clear();
+			double t0 = now_ms();
+			WED_ScanAptDat(fi, found, c);
+			ms = min(ms, now_ms() - t0);
+		}
+
+		if (c == 1)
+			serial = found;
+		else if (found.size() != serial.size() || !equal(found.begin(), found.end(), serial.begin(), same_entry))
+		{
+			printf("CHECK %s: %d chunks give a different airport list than 1 chunk\n", path, c);
+			ok = false;
+		}
+
+		map<string, apt_dat_entry_t> merged;
+		for (auto& n : found)
+			merged[n.icao] = n;
+		if (merged.size() != ref.size() || !equal(merged.begin(), merged.end(), ref.begin(),
+				[](const pair<const string, apt_dat_entry_t>& a, const pair<const string, apt_dat_entry_t>& b) { return a.first == b.first && same_entry(a.second, b.second); }))
+		{
+			printf("CHECK %s: %d chunks give %d airports, the serial parser %d, or they differ\n", path, c, (int) merged.size(), (int) ref.size());
+			ok = false;
+		}
+
+		if (c == 1 || c == 8 || c == 0)
+			printf("BENCH %s, %.1lf MB, %d airports: %s %.1lf ms, %.1lf MB/s, serial parser %.1lf ms\n", path, mb, (int) ref.size(),
+				c ? (c == 1 ? "1 chunk " : "8 chunks") : "default ", ms, mb * 1000.0 / ms, ref_ms);
+	}
+	MemFile_Close(fi);
+	return ok;
+}
+
+int main(int argc, char * argv[])
+{
+	if (argc >= 4 && strcmp(argv[1], "--make") == 0)
+	{
+		bool crlf = false, no99 = false;
+		for (int i = 4; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "crlf") == 0) crlf = true;
+			if (strcmp(argv[i], "no99") == 0) no99 = true;
+		}
+		if (!make_apt_dat(argv[2], atoi(argv[3]), crlf, no99))
+		{
+			printf("FAILED: could not write %s\n", argv[2]);
+			return 1;
+		}
+		return 0;
+	}
+	if (argc < 3 || atoi(argv[1]) < 1)
+	{
+		printf("Usage: %s --make <file> <airports> [crlf] [no99]\n       %s <passes> <apt.dat> [...]\n", argv[0], argv[0]);
+		return 1;
+	}
+
+	printf("BENCH %u hardware threads\n", thread::hardware_concurrency());
+	bool ok = true;
+	for (int i = 2; i < argc; ++i)
+		ok = check_file(argv[i], atoi(argv[1])) && ok;
+	return ok ? 0 : 1;
+}
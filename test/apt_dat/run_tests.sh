@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Builds the apt.dat scan test against src/WEDMap/WED_AptDatScan.cpp, writes synthetic apt.dat files and checks
+# the chunked scan against the serial parser on them.  Any files after the compiler, e.g. the global apt.dat,
+# are checked and timed as well.
+#
+# Usage:  run_tests.sh [c++ compiler] [apt.dat ...]
+
+CXX=${1:-g++}
+CC=${CC:-cc}
+[ $# -gt 0 ] && shift
+HERE=$(cd "$(dirname "$0")" && pwd)
+TOP=$(cd "$HERE/../.." && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+DEFS="-DLIN=1 -DIBM=0 -DAPL=0 -include $TOP/src/Obj/XDefs.h -I$TOP/src/WEDMap -I$TOP/src/Utils"
+FLAGS="-std=c++14 -O2 -g -Wno-deprecated-declarations -pthread $DEFS"
+UTILS="$TOP/src/Utils/MemFileUtils.cpp $TOP/src/Utils/FileUtils.cpp $TOP/src/Utils/AssertUtils.cpp $TMP/unzip.o -lz"
+
+$CC -O2 $DEFS -c -o "$TMP/unzip.o" "$TOP/src/Utils/unzip.c" || { echo "FAILED: could not build unzip.c"; exit 1; }
+$CXX $FLAGS -o "$TMP/apt_scan_test" "$HERE/apt_scan_test.cpp" "$TOP/src/WEDMap/WED_AptDatScan.cpp" $UTILS || { echo "FAILED: could not build apt_scan_test"; exit 1; }
+
+# The big one is about the size of the global apt.dat from a few years back; the small ones have odd line ends
+# and no closing 99 row, and still get cut into up to 64 chunks.
+"$TMP/apt_scan_test" --make "$TMP/apt.dat" 40000 || exit 1
+"$TMP/apt_scan_test" --make "$TMP/apt_crlf.dat" 500 crlf || exit 1
+"$TMP/apt_scan_test" --make "$TMP/apt_no99.dat" 300 no99 || exit 1
+"$TMP/apt_scan_test" --make "$TMP/apt_one.dat" 1 || exit 1
+
+"$TMP/apt_scan_test" 3 "$TMP/apt.dat" "$TMP/apt_crlf.dat" "$TMP/apt_no99.dat" "$TMP/apt_one.dat" "$@" || { echo "FAILED: apt_scan_test"; exit 1; }
+echo "PASSED"
@@ -0,0 +1,59 @@
+#!/bin/sh
+#
+# Checks that the SSE2/AVX2 point pool decoders in XChunkyFileUtils give bit for bit
+# the same coordinates as the scalar decoder, on the DSF in this directory and on a
+# large synthetic DSF with terrain, object, polygon and (32 bit) network pools.
+#
+# Usage:  check_simd.sh [path to DSFTool]
+
+DSFTOOL=${1:-build/Linux/release/DSFTool}
+HERE=$(cd "$(dirname "$0")" && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+awk 'BEGIN {
+	srand(1);
+	print "I\n800\nDSF2TEXT\n";
+	print "PROPERTY sim/west 12\nPROPERTY sim/east 13\nPROPERTY sim/north 48\nPROPERTY sim/south 47";
+	print "PROPERTY sim/planet earth\nPROPERTY sim/overlay 1";
+	print "TERRAIN_DEF terrain_Water\nOBJECT_DEF lib/a.obj\nOBJECT_DEF lib/b.obj";
+	print "POLYGON_DEF lib/a.fac\nNETWORK_DEF lib/g10/roads.net";
+
+	for (d = 5; d <= 7; d += 2)
+	{
+		printf "BEGIN_PATCH 0 0.0 -1.0 1 %d\nBEGIN_PRIMITIVE 0\n", d;
+		for (i = 0; i < 60000; ++i)
+		{
+			printf "PATCH_VERTEX %.9f %.9f %.6f", 12 + rand(), 47 + rand(), 300 + 2700 * rand();
+			for (p = 3; p < d; ++p)
+				printf " %.6f", p < 5 ? 2 * rand() - 1 : rand();		# normal, then UV
+			printf "\n";
+		}
+		print "END_PRIMITIVE\nEND_PATCH";
+	}
+	for (i = 0; i < 50000; ++i)
+	{
+		printf "OBJECT %d %.9f %.9f %.6f\n", i % 2, 12 + rand(), 47 + rand(), 360 * rand();
+		printf "OBJECT_MSL %d %.9f %.9f %.6f %.6f\n", i % 2, 12 + rand(), 47 + rand(), 300 + 2700 * rand(), 360 * rand();
+	}
+	for (i = 0; i < 5000; ++i)
+	{
+		x = 12.01 + 0.98 * rand(); y = 47.01 + 0.98 * rand();
+		print "BEGIN_POLYGON 0 10 2\nBEGIN_WINDING";
+		for (j = 0; j < 5; ++j)
+			printf "POLYGON_POINT %.9f %.9f\n", x + 0.002 * rand() - 0.001, y + 0.002 * rand() - 0.001;
+		print "END_WINDING\nEND_POLYGON";
+	}
+	for (i = 0; i < 5000; ++i)
+	{
+		x = 12.01 + 0.98 * rand(); y = 47.01 + 0.98 * rand();
+		printf "BEGIN_SEGMENT 0 1 %d %.9f %.9f %.6f\n", 2 * i + 1, x, y, 10 * rand();
+		printf "SHAPE_POINT %.9f %.9f %.6f\n", x + 0.001 * rand(), y + 0.001 * rand(), 10 * rand();
+		printf "END_SEGMENT %d %.9f %.9f %.6f\n", 2 * i + 2, x + 0.002 * rand(), y + 0.002 * rand(), 10 * rand();
+	}
+}' > "$TMP/synthetic.txt"
+
+"$DSFTOOL" --text2dsf "$TMP/synthetic.txt" "$TMP/synthetic.dsf" > /dev/null || { echo "FAILED: could not build the synthetic DSF"; exit 1; }
+
+"$DSFTOOL" --check_simd "$HERE/+47+012.dsf" --check_simd "$TMP/synthetic.dsf" || { echo "FAILED"; exit 1; }
+echo "PASSED"
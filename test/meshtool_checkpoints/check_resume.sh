@@ -0,0 +1,82 @@
+#!/bin/sh
+#
+# Builds one tile four ways and fails unless all four DSFs are byte for byte the same:
+#
+#   full		from scratch, writing both checkpoints
+#   temp2	resumed from temp2.xes (terrain assigned)
+#   temp1	resumed from temp1.xes (mesh built)
+#   old		with temp1.xes.links removed - MeshTool must refuse the checkpoint and start over
+#
+# Any CHECKPOINTS line in your script is replaced.  Paths in the script (shape files etc.) must be absolute,
+# since MeshTool runs in a scratch directory so the checkpoints don't land in yours.
+#
+# Usage:  check_resume.sh <MeshTool> <script> <xes> <dem> <dir_base> [DSFTool, to diff the DSFs as text on failure]
+
+if [ $# -lt 5 ]; then
+	echo "Usage: $0 <MeshTool> <script> <xes> <dem> <dir_base> [DSFTool]"
+	exit 1
+fi
+
+abspath() { echo "$(cd "$(dirname "$1")" && pwd)/$(basename "$1")"; }
+
+MESHTOOL=$(abspath "$1")
+SCRIPT=$(abspath "$2")
+XES=$(abspath "$3")
+DEM=$(abspath "$4")
+DIR_BASE=$(abspath "$5")/
+DSFTOOL=$6
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# run <name> <CHECKPOINTS options>
+run() {
+	{ echo "CHECKPOINTS $2"; grep -v '^CHECKPOINTS' "$SCRIPT"; } > "$TMP/$1.txt"
+	( cd "$TMP" && "$MESHTOOL" "$TMP/$1.txt" "$XES" "$DEM" "$DIR_BASE" "$TMP/$1.dsf" ) > "$TMP/$1.log" 2>&1
+	if [ $? -ne 0 ]; then
+		tail -20 "$TMP/$1.log"
+		echo "FAILED: MeshTool failed on the $1 run"
+		exit 1
+	fi
+}
+
+# expect <name> <pattern> - the log must say which checkpoint (if any) the run used.
+expect() {
+	if ! grep -q "$2" "$TMP/$1.log"; then
+		echo "FAILED: the $1 run did not print '$2'"
+		exit 1
+	fi
+}
+
+run full "mesh terrain"
+
+run temp2 "resume"
+expect temp2 "Resuming from checkpoint temp2.xes"
+
+rm -f "$TMP/temp2.xes" "$TMP/temp2.xes.links"
+run temp1 "resume"
+expect temp1 "Resuming from checkpoint temp1.xes"
+
+rm -f "$TMP/temp1.xes.links"
+run old "resume"
+expect old "Ignoring checkpoint temp1.xes"
+
+RESULT=0
+for r in temp2 temp1 old; do
+	if cmp -s "$TMP/full.dsf" "$TMP/$r.dsf"; then
+		echo "$r: identical"
+	else
+		echo "$r: DIFFERENT"
+		if [ -n "$DSFTOOL" ]; then
+			"$DSFTOOL" --dsf2text "$TMP/full.dsf" "$TMP/full.dsf.txt" > /dev/null
+			"$DSFTOOL" --dsf2text "$TMP/$r.dsf" "$TMP/$r.dsf.txt" > /dev/null
+			diff "$TMP/full.dsf.txt" "$TMP/$r.dsf.txt" | head -20
+		fi
+		RESULT=1
+	fi
+done
+
+if [ $RESULT -ne 0 ]; then
+	echo "FAILED"
+	exit 1
+fi
+echo "PASSED"
@@ -0,0 +1,19 @@
+#!/bin/sh
+#
+# Builds and runs the headless slippy map tests against the sources in src/WEDMap.
+#
+# Usage:  run_tests.sh [c++ compiler]
+
+CXX=${1:-g++}
+HERE=$(cd "$(dirname "$0")" && pwd)
+TOP=$(cd "$HERE/../.." && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+FLAGS="-std=c++14 -O1 -g -DLIN=1 -DIBM=0 -DAPL=0 -include $TOP/src/Obj/XDefs.h -I$TOP/src/WEDMap -I$TOP/src/Utils -pthread"
+
+for t in tile_lru_test tile_loader_test; do
+	$CXX $FLAGS -o "$TMP/$t" "$HERE/$t.cpp" "$TOP/src/WEDMap/WED_SlippyTiles.cpp" || { echo "FAILED: could not build $t"; exit 1; }
+	"$TMP/$t" || { echo "FAILED: $t"; exit 1; }
+done
+echo "PASSED"
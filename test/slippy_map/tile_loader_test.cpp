@@ -0,0 +1,235 @@
+/*
+ * Headless test of WED_TileLoader, with tiles served from a local directory instead of the web.
+ *
+ * It writes a small grid of PPM tiles (and leaves one out), then loads them the way WED_SlippyMap does - one
+ * "frame" at a time, up to MAX_DOWNLOADS in flight - and checks that every tile comes back exactly once with the
+ * right pixels, that the missing tile comes back as failed, that the download limit is kept, that tiles which
+ * scrolled off are not decoded, and that shutting down with work in flight releases every decoded image.
+ */
+
+#include "WED_SlippyTiles.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#define GRID			5		// tiles per side
+#define TILE_SIZE		16
+#define MAX_DOWNLOADS	3
+#define SLOW_POLLS		2		// polls a tile stays "transferring"
+
+static int failures = 0;
+
+#define CHECK(x) do { if(!(x)) { printf("FAILED line %d: %s\n", __LINE__, #x); ++failures; } } while(0)
+
+static unsigned char pixel(int x, int y, int c) { return (unsigned char) (x * 40 + y * 7 + c * 3); }
+
+class dir_tile_source : public WED_TileSource {
+public:
+	dir_tile_source() : max_in_flight(0), decodes(0), images(0) { }
+
+	virtual	int		fetch(const string& url, const string& folder, string& out_file)
+	{
+		int& n = polls[url];
+		if(n++ < SLOW_POLLS)
+		{
+			in_flight.insert(url);
+			max_in_flight = max(max_in_flight, in_flight.size());
+			return tile_Transferring;
+		}
+		in_flight.erase(url);
+		polls.erase(url);
+		ifstream f(url.c_str());
+		if(!f)
+			return tile_Failed;
+		out_file = url;
+		return tile_Ready;
+	}
+
+	virtual	int		decode(const string& file, int map_mode, ImageInfo& info)
+	{
+		++decodes;
+		ifstream f(file.c_str(), ios::binary);
+		string magic;
+		int w, h, maxval;
+		f >> magic >> w >> h >> maxval;
+		f.get();
+		if(!f || magic != "P6")
+			return 2;
+		info.width = w;
+		info.height = h;
+		info.pad = 0;
+		info.channels = 3;
+		info.data = (unsigned char *) malloc(w * h * 3);
+		f.read((char *) info.data, w * h * 3);
+		++images;
+		return 0;
+	}
+
+	virtual	void	release(ImageInfo& info)
+	{
+		free(info.data);
+		--images;
+	}
+
+	map<string, int>	polls;
+	set<string>			in_flight;
+	size_t				max_in_flight;
+	atomic<int>			decodes;
+	atomic<int>			images;
+};
+
+static string tile_path(const string& dir, int x, int y)
+{
+	ostringstream s;
+	s << dir << "/" << x << "_" << y << ".ppm";
+	return s.str();
+}
+
+static void write_tile(const string& path, int x, int y)
+{
+	ofstream f(path.c_str(), ios::binary);
+	f << "P6\n" << TILE_SIZE << " " << TILE_SIZE << "\n255\n";
+	for (int i = 0; i < TILE_SIZE * TILE_SIZE; ++i)
+		for (int c = 0; c < 3; ++c)
+			f.put(pixel(x, y, c));
+}
+
+static void wait_a_bit()
+{
+	this_thread::sleep_for(chrono::milliseconds(1));
+}
+
+int main(int argc, char ** argv)
+{
+	char tmpl[] = "/tmp/wed_tiles_XXXXXX";
+	if(!mkdtemp(tmpl))
+	{
+		printf("FAILED: no temp dir\n");
+		return 1;
+	}
+	string dir(tmpl);
+
+	vector<string> all;
+	for (int y = 0; y < GRID; ++y)
+	for (int x = 0; x < GRID; ++x)
+	{
+		string p = tile_path(dir, x, y);
+		all.push_back(p);
+		if(x != 2 || y != 3)			// this one the server "doesn't have"
+			write_tile(p, x, y);
+	}
+
+	// 1. Load everything, frame by frame, the way the map does.
+	{
+		dir_tile_source * src = new dir_tile_source;
+		WED_TileLoader loader(src);
+		map<string, int> got;
+
+		for (int frame = 0; frame < 10000 && got.size() < all.size(); ++frame)
+		{
+			loader.poll();
+			vector<WED_TileLoader::tile_t *> done;
+			loader.get_done(done);
+			for (auto t : done)
+			{
+				++got[t->path];
+				if(t->path == tile_path(dir, 2, 3))
+					CHECK(t->status == 2);
+				else
+				{
+					CHECK(t->status == 0);
+					int x, y;
+					sscanf(t->path.c_str() + dir.size() + 1, "%d_%d", &x, &y);
+					if(t->status == 0)
+					{
+						CHECK(t->info.width == TILE_SIZE && t->info.height == TILE_SIZE && t->info.channels == 3);
+						bool same = true;
+						for (int i = 0; i < TILE_SIZE * TILE_SIZE * 3; ++i)
+							if(t->info.data[i] != pixel(x, y, i % 3))
+								same = false;
+						CHECK(same);
+					}
+				}
+				loader.release(t);
+			}
+
+			set<string> visible(all.begin(), all.end());
+			loader.set_visible(visible);
+			for (auto& p : all)
+				if(!got.count(p) && !loader.is_loading(p))
+				{
+					if(!loader.load(p, p, "", 0, MAX_DOWNLOADS))
+						break;
+					CHECK(loader.downloads() <= MAX_DOWNLOADS);
+				}
+			wait_a_bit();
+		}
+
+		CHECK(got.size() == all.size());
+		for (auto& g : got)
+			CHECK(g.second == 1);
+		CHECK(src->max_in_flight <= MAX_DOWNLOADS);
+		CHECK(src->max_in_flight > 1);					// it did overlap downloads
+		CHECK(src->decodes == (int) all.size() - 1);
+		CHECK(src->images == 0);
+		CHECK(!loader.busy());
+	}
+
+	// 2. A tile that scrolled off before its download finished is neither decoded nor reported.
+	{
+		dir_tile_source * src = new dir_tile_source;
+		WED_TileLoader loader(src);
+		set<string> visible;
+		visible.insert(all[0]);
+		loader.set_visible(visible);
+		CHECK(loader.load(all[0], all[0], "", 0, MAX_DOWNLOADS));
+		CHECK(loader.is_loading(all[0]));
+
+		visible.clear();
+		loader.set_visible(visible);
+		for (int i = 0; i < 2 * SLOW_POLLS; ++i)
+			loader.poll();
+		CHECK(!loader.busy());
+
+		for (int i = 0; i < 20; ++i) wait_a_bit();
+		vector<WED_TileLoader::tile_t *> done;
+		loader.get_done(done);
+		CHECK(done.empty());
+		CHECK(src->decodes == 0);
+	}
+
+	// 3. Going away with downloads and decodes in flight leaks no images.
+	{
+		struct counting_source : public dir_tile_source {			// the loader deletes its source, so report on the way out
+			counting_source(atomic<int> * out) : out_images(out) { }
+			virtual ~counting_source() { *out_images = (int) images; }
+			atomic<int> *	out_images;
+		};
+		atomic<int> images_at_exit(-1);
+		{
+			WED_TileLoader loader(new counting_source(&images_at_exit));
+			set<string> visible(all.begin(), all.end());
+			loader.set_visible(visible);
+			for (int round = 0; round <= SLOW_POLLS; ++round)
+			{
+				for (auto& p : all)
+					if(!loader.is_loading(p))
+						loader.load(p, p, "", 0, all.size());
+				loader.poll();
+			}
+			for (int i = 0; i < 5; ++i) wait_a_bit();
+			CHECK(loader.busy());
+		}
+		CHECK(images_at_exit == 0);
+	}
+
+	for (auto& p : all)
+		remove(p.c_str());
+	rmdir(dir.c_str());
+
+	if(failures)
+		return 1;
+	printf("tile_loader_test PASSED\n");
+	return 0;
+}
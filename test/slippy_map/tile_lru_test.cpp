@@ -0,0 +1,80 @@
+/*
+ * Test of WED_TileLRU: least recently used tiles go first, tiles used in the current frame are never evicted
+ * even when they alone are over budget, and failed tiles (id 0) take up a slot but are never handed back.
+ */
+
+#include "WED_SlippyTiles.h"
+
+static int failures = 0;
+
+#define CHECK(x) do { if(!(x)) { printf("FAILED line %d: %s\n", __LINE__, #x); ++failures; } } while(0)
+
+int main(int argc, char ** argv)
+{
+	WED_TileLRU c(300);
+	vector<int> ev;
+	int id;
+
+	// Everything on screen is pinned, even 400 bytes against a 300 byte budget.
+	c.begin_frame();
+	c.insert("a", 1, 100);
+	c.insert("b", 2, 100);
+	c.insert("c", 3, 100);
+	c.insert("d", 4, 100);
+	c.evict(ev);
+	CHECK(ev.empty());
+	CHECK(c.bytes() == 400);
+	CHECK(c.size() == 4);
+
+	// Next frame only "a" is used, so the least recently used of the others goes - just enough to fit the budget.
+	c.begin_frame();
+	CHECK(c.lookup("a", id) && id == 1);
+	c.evict(ev);
+	CHECK(ev.size() == 1 && ev[0] == 2);
+	CHECK(c.bytes() == 300);
+	CHECK(!c.lookup("b", id));
+
+	// A new tile pushes out the oldest one not used in this frame.
+	c.begin_frame();
+	c.insert("e", 5, 100);
+	ev.clear();
+	c.evict(ev);
+	CHECK(ev.size() == 1 && ev[0] == 3);
+	CHECK(c.size() == 3);
+	CHECK(c.bytes() == 300);
+
+	// Failed tiles cost nothing and are dropped without an id, re-inserting a tile replaces its size.
+	c.begin_frame();
+	c.insert("bad", 0, 0);
+	c.insert("e", 5, 250);
+	CHECK(c.bytes() == 450);
+	ev.clear();
+	c.evict(ev);
+	CHECK(ev.size() == 2 && ev[0] == 4 && ev[1] == 1);	// "d" is older than "a"
+	CHECK(c.bytes() == 250);
+
+	// The failed tile is the oldest now, it goes first but has no texture to hand back.
+	c.begin_frame();
+	c.insert("big", 6, 100);
+	ev.clear();
+	c.evict(ev);
+	CHECK(ev.size() == 1 && ev[0] == 5);
+	CHECK(!c.lookup("bad", id));
+	CHECK(c.lookup("big", id) && id == 6);
+
+	c.begin_frame();
+	c.insert("x", 7, 300);
+	ev.clear();
+	c.evict(ev);
+	CHECK(ev.size() == 1 && ev[0] == 6);
+	CHECK(c.size() == 1);
+
+	CHECK(c.hits() == 2);
+	CHECK(c.misses() == 9);
+	CHECK(c.evictions() == 7);
+
+	if(failures)
+		return 1;
+	printf("tile_lru_test PASSED\n");
+	return 0;
+}
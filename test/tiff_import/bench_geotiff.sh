@@ -0,0 +1,38 @@
+#!/bin/sh
+#
+# Times the serial against the parallel GeoTiff reader in ExtractGeoTiff, on the images in
+# this directory and on a synthetic 3601x3601 SRTM-like DEM, and fails unless both readers
+# give the same samples.  The images here are RGB, which the parallel reader leaves to the
+# serial one - they check that fallback.  The synthetic DEM is single band and deflate
+# compressed in strips, the layout the parallel reader is for.
+#
+# Usage:  bench_geotiff.sh [path to RenderFarm (GISTool)] [threads, 0 = one per core] [passes]
+
+GISTOOL=${1:-build/Linux/release/RenderFarm}
+THREADS=${2:-0}
+PASSES=${3:-3}
+HERE=$(cd "$(dirname "$0")" && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+python3 - "$TMP/N47E012.hgt" <<'PY'
+import math, struct, sys
+n = 3601
+wave = [800 * math.sin(x / 300.0) for x in range(n)]
+with open(sys.argv[1], "wb") as f:
+	for y in range(n):
+		c = math.cos(y / 450.0)
+		row = [int(1200 + wave[x] * c) + (x * 7919 + y * 104729) % 41 - 20 for x in range(n)]
+		f.write(struct.pack(">%dh" % n, *row))
+PY
+
+"$GISTOOL" -hgt "$TMP/N47E012.hgt" -raster_export x tiff "$TMP/srtm_like.tif" dem_Elevation > /dev/null || exit 1
+
+"$GISTOOL" -bench_geotiff "$THREADS" "$PASSES" "$TMP/srtm_like.tif" "$HERE"/*.tif > "$TMP/out.txt"
+RESULT=$?
+grep '^BENCH' "$TMP/out.txt"
+if [ $RESULT -ne 0 ]; then
+	echo "FAILED"
+	exit 1
+fi
+echo "PASSED"
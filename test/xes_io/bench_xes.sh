@@ -0,0 +1,36 @@
+#!/bin/sh
+#
+# Times XES reads and writes with GISTool -bench_xes and fails unless writing a file, reading it back and writing
+# it again gives the same bytes.  With no files it builds one: a 3601x3601 synthetic DEM, which exercises the
+# DEM spans only.  Pass real files too - a MeshTool checkpoint (temp1.xes / temp2.xes) has a map and a mesh.
+#
+# Usage:  bench_xes.sh [path to RenderFarm (GISTool)] [passes] [file.xes ...]
+
+GISTOOL=${1:-build/Linux/release/RenderFarm}
+PASSES=${2:-3}
+[ $# -gt 0 ] && shift
+[ $# -gt 0 ] && shift
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+python3 - "$TMP/N47E012.hgt" <<'PY'
+import math, struct, sys
+n = 3601
+wave = [800 * math.sin(x / 300.0) for x in range(n)]
+with open(sys.argv[1], "wb") as f:
+	for y in range(n):
+		c = math.cos(y / 450.0)
+		row = [int(1200 + wave[x] * c) + (x * 7919 + y * 104729) % 41 - 20 for x in range(n)]
+		f.write(struct.pack(">%dh" % n, *row))
+PY
+
+"$GISTOOL" -hgt "$TMP/N47E012.hgt" -force_save "$TMP/dem_only.xes" > /dev/null || exit 1
+
+"$GISTOOL" -bench_xes "$PASSES" "$TMP/dem_only.xes" "$@" > "$TMP/out.txt"
+RESULT=$?
+grep '^BENCH' "$TMP/out.txt"
+if [ $RESULT -ne 0 ]; then
+	echo "FAILED"
+	exit 1
+fi
+echo "PASSED"
@@ -0,0 +1,219 @@
+/*
+ * Times XObjBuilder::AccumTri and Obj8_Optimize on synthetic grid objects and reports the peak memory of
+ * each.  The std::map point index ObjPointPool used before is kept here as a reference: the pool must hand
+ * out the same indices, and timing both shows what the hash index buys.
+ *
+ * Usage:  bench_builder [grid size for AccumTri] [grid size for Obj8_Optimize]
+ */
+
+#include "XObjBuilder.h"
+#include "XObjDefs.h"
+#include "ObjConvert.h"
+#include "ObjPointPool.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// ObjPointPool's index before the hash table.
+class	map_pool {
+public:
+	int		accumulate(const float pt[])
+	{
+		map<vector<float>, int, lex_compare_vector<float> >::iterator i = mIndex.find(vector<float>(pt, pt + 8));
+		if (i != mIndex.end())
+			return i->second;
+		int ret = mData.size() / 8;
+		mData.insert(mData.end(), pt, pt + 8);
+		mIndex[vector<float>(pt, pt + 8)] = ret;
+		return ret;
+	}
+	int		count(void) const { return mData.size() / 8; }
+private:
+	vector<float>											mData;
+	map<vector<float>, int, lex_compare_vector<float> >		mIndex;
+};
+
+// Triangle t (0 or 1) of quad x,z in an n x n grid of quads, as AccumTri takes it: X Y Z nX nY nZ S T three
+// times.  Everything is a multiple of 1/256, so AccumTri's rounding changes nothing and neighbouring
+// triangles share their vertices exactly - the pool should end up with (n+1)^2 points.
+static void grid_tri(int n, int x, int z, int t, float tri[24])
+{
+	static const int corners[2][3][2] = { { { 0, 0 }, { 1, 0 }, { 1, 1 } }, { { 0, 0 }, { 1, 1 }, { 0, 1 } } };
+	for (int v = 0; v < 3; ++v)
+	{
+		int	gx = x + corners[t][v][0];
+		int	gz = z + corners[t][v][1];
+		float * p = tri + v * 8;
+		p[0] = gx * 0.5f;
+		p[1] = ((gx * 7 + gz * 13) % 64) / 4.0f;
+		p[2] = gz * 0.5f;
+		p[3] = 0.0f;
+		p[4] = 1.0f;
+		p[5] = 0.0f;
+		p[6] = (float) gx / 256.0f;
+		p[7] = (float) gz / 256.0f;
+	}
+}
+
+static void build_grid(XObj8& obj, int n)
+{
+	XObjBuilder	b(&obj);
+	float		tri[24];
+	for (int z = 0; z < n; ++z)
+	for (int x = 0; x < n; ++x)
+	for (int t = 0; t < 2; ++t)
+	{
+		grid_tri(n, x, z, t, tri);
+		b.AccumTri(tri);
+	}
+	b.Finish();
+}
+
+static double now_ms(void)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs one phase in a child, so each phase's peak RSS is its own.  The child sends its time back on a pipe.
+static bool run_phase(const char * name, int n, int phase, double idle_kb)
+{
+	int fd[2];
+	if (pipe(fd) != 0)
+		return false;
+	pid_t pid = fork();
+	if (pid == 0)
+	{
+		close(fd[0]);
+		double ms = 0.0;
+		if (phase == 1)
+		{
+			XObj8 obj;
+			double t0 = now_ms();
+			build_grid(obj, n);
+			ms = now_ms() - t0;
+		}
+		else if (phase == 2)
+		{
+			map_pool	pool;
+			vector<int>	indices;
+			float		tri[24];
+			double t0 = now_ms();
+			for (int z = 0; z < n; ++z)
+			for (int x = 0; x < n; ++x)
+			for (int t = 0; t < 2; ++t)
+			{
+				grid_tri(n, x, z, t, tri);
+				for (int v = 0; v < 3; ++v)
+					indices.push_back(pool.accumulate(tri + v * 8));
+			}
+			ms = now_ms() - t0;
+		}
+		else if (phase == 3)
+		{
+			XObj8 obj;
+			build_grid(obj, n);
+			double t0 = now_ms();
+			if (!Obj8_Optimize(obj))
+				_exit(1);
+			ms = now_ms() - t0;
+		}
+		ssize_t w = write(fd[1], &ms, sizeof(ms));
+		_exit(w == sizeof(ms) ? 0 : 1);
+	}
+	close(fd[1]);
+	double ms = -1.0;
+	bool got = read(fd[0], &ms, sizeof(ms)) == sizeof(ms);
+	close(fd[0]);
+	int status = 0;
+	struct rusage ru;
+	wait4(pid, &status, 0, &ru);
+	if (!got || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	{
+		printf("FAILED: %s did not finish\n", name);
+		return false;
+	}
+	if (phase)
+		printf("BENCH %s, %d x %d quads: %.1lf ms, peak %.1lf MB (%.1lf MB over idle)\n", name, n, n, ms,
+			ru.ru_maxrss / 1024.0, (ru.ru_maxrss - idle_kb) / 1024.0);
+	return true;
+}
+
+// Same triangles with the first vertex rotated to the lowest index, so winding is kept.
+static vector<vector<int> > tri_set(const vector<int>& idx)
+{
+	vector<vector<int> > tris;
+	for (int n = 0; n + 2 < idx.size(); n += 3)
+	{
+		int r = (idx[n] <= idx[n+1] && idx[n] <= idx[n+2]) ? 0 : (idx[n+1] <= idx[n+2] ? 1 : 2);
+		vector<int> t;
+		for (int v = 0; v < 3; ++v)
+			t.push_back(idx[n + (r + v) % 3]);
+		tris.push_back(t);
+	}
+	sort(tris.begin(), tris.end());
+	return tris;
+}
+
+static bool check(int n)
+{
+	XObj8		obj;
+	map_pool	pool;
+	vector<int>	ref;
+	float		tri[24];
+	build_grid(obj, n);
+	for (int z = 0; z < n; ++z)
+	for (int x = 0; x < n; ++x)
+	for (int t = 0; t < 2; ++t)
+	{
+		grid_tri(n, x, z, t, tri);
+		for (int v = 0; v < 3; ++v)
+			ref.push_back(pool.accumulate(tri + v * 8));
+	}
+
+	if (obj.geo_tri.count() != (n + 1) * (n + 1) || pool.count() != obj.geo_tri.count())
+	{
+		printf("FAILED: expected %d points, ObjPointPool has %d, the map index %d\n", (n + 1) * (n + 1), obj.geo_tri.count(), pool.count());
+		return false;
+	}
+	if (obj.indices != ref)
+	{
+		printf("FAILED: ObjPointPool and the map index hand out different indices\n");
+		return false;
+	}
+
+	vector<vector<int> > before = tri_set(obj.indices);
+	if (!Obj8_Optimize(obj) || tri_set(obj.indices) != before)
+	{
+		printf("FAILED: Obj8_Optimize changed the triangles\n");
+		return false;
+	}
+	printf("CHECK %d x %d quads: same %d points and indices as the map index, optimize keeps every triangle\n", n, n, obj.geo_tri.count());
+	return true;
+}
+
+int main(int argc, char * argv[])
+{
+	int big = argc > 1 ? atoi(argv[1]) : 1024;
+	int opt = argc > 2 ? atoi(argv[2]) : 64;
+
+	if (!check(50))
+		return 1;
+
+	// An idle child, so the numbers can be read as what each phase added.
+	struct rusage ru;
+	if (!run_phase("idle", 0, 0, 0))
+		return 1;
+	getrusage(RUSAGE_CHILDREN, &ru);
+	double idle_kb = ru.ru_maxrss;
+
+	if (!run_phase("XObjBuilder::AccumTri", big, 1, idle_kb) ||
+		!run_phase("std::map point index", big, 2, idle_kb) ||
+		!run_phase("Obj8_Optimize", opt, 3, idle_kb))
+		return 1;
+	return 0;
+}
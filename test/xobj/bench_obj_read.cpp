@@ -0,0 +1,183 @@
+/*
+ * Times XObj8Read over a corpus of OBJ files and checks that each one survives a round trip: read, write,
+ * read that back and write again must give the same bytes twice.
+ *
+ * Usage:  bench_obj_read --make <dir>						writes a synthetic corpus into <dir>
+ *         bench_obj_read <passes> <file or dir> [...]		times reads of every .obj under the paths
+ */
+
+#include "XObjReadWrite.h"
+#include "XObjBuilder.h"
+#include "XObjDefs.h"
+#include "FileUtils.h"
+#include "MemFileUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+static double now_ms(void)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Objects the size of typical scenery: a terrain-like grid with odd decimals, a second LOD, a few attributes
+// and lights, so most of the reader's keywords and number formats turn up.
+static bool make_corpus(const char * dir)
+{
+	for (int n = 0; n < 40; ++n)
+	{
+		XObj8		obj;
+		XObjBuilder	b(&obj);
+		int			size = 10 + n * 5;
+		obj.texture = "synthetic.png";
+		for (int lod = 0; lod < 2; ++lod)
+		{
+			b.BeginLOD(lod ? 1000.0f : 0.0f, lod ? 4000.0f : 1000.0f);
+			b.SetAttribute(lod ? attr_Shade_Flat : attr_Shade_Smooth);
+			if (!lod) b.SetAttribute1(attr_Offset, 1.0f);
+			int step = lod ? 2 : 1;
+			for (int z = 0; z < size; z += step)
+			for (int x = 0; x < size; x += step)
+			for (int t = 0; t < 2; ++t)
+			{
+				static const int corners[2][3][2] = { { { 0, 0 }, { 1, 0 }, { 1, 1 } }, { { 0, 0 }, { 1, 1 }, { 0, 1 } } };
+				float tri[24];
+				for (int v = 0; v < 3; ++v)
+				{
+					int gx = x + corners[t][v][0] * step, gz = z + corners[t][v][1] * step;
+					float * p = tri + v * 8;
+					p[0] = gx * 1.37f - size * 0.5f;
+					p[1] = sinf(gx * 0.3f) * cosf(gz * 0.2f) * 3.1f;
+					p[2] = gz * -1.37f;
+					p[3] = -0.1234f * sinf(gx * 0.3f);
+					p[4] = 0.9876f;
+					p[5] = 0.0456f * cosf(gz * 0.2f);
+					p[6] = (float) gx / size;
+					p[7] = (float) gz / size;
+				}
+				b.AccumTri(tri);
+			}
+			if (!lod)
+			for (int l = 0; l < 8; ++l)
+			{
+				float light[6] = { l * 2.5f, 5.0f, -l * 1.25f, 1.0f, 0.5f, 0.25f };
+				b.AccumLight(light);
+			}
+			b.EndLOD();
+		}
+		b.Finish();
+
+		char path[1024];
+		snprintf(path, sizeof(path), "%s/synthetic_%02d.obj", dir, n);
+		if (!XObj8Write(path, obj))
+		{
+			printf("FAILED: could not write %s\n", path);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool same_file(const string& a, const string& b)
+{
+	MFMemFile * fa = MemFile_Open(a.c_str());
+	MFMemFile * fb = MemFile_Open(b.c_str());
+	bool same = fa && fb &&
+		(MemFile_GetEnd(fa) - MemFile_GetBegin(fa)) == (MemFile_GetEnd(fb) - MemFile_GetBegin(fb)) &&
+		memcmp(MemFile_GetBegin(fa), MemFile_GetBegin(fb), MemFile_GetEnd(fa) - MemFile_GetBegin(fa)) == 0;
+	if (fa) MemFile_Close(fa);
+	if (fb) MemFile_Close(fb);
+	return same;
+}
+
+int main(int argc, char * argv[])
+{
+	if (argc == 3 && !strcmp(argv[1], "--make"))
+		return make_corpus(argv[2]) ? 0 : 1;
+	if (argc < 3)
+	{
+		printf("Usage: %s --make <dir> | <passes> <file or dir> [...]\n", argv[0]);
+		return 1;
+	}
+
+	int passes = std::max(atoi(argv[1]), 1);
+	vector<string> files;
+	for (int a = 2; a < argc; ++a)
+	{
+		vector<string> all, dirs;
+		if (FILE_get_directory_recursive(argv[a], all, dirs) < 0)
+			all.push_back(argv[a]);
+		for (vector<string>::iterator f = all.begin(); f != all.end(); ++f)
+		{
+			string ext = FILE_get_file_extension(*f);
+			if (ext == "obj" || ext == "OBJ")
+				files.push_back(*f);
+		}
+	}
+	sort(files.begin(), files.end());
+	if (files.empty())
+	{
+		printf("FAILED: no .obj files found\n");
+		return 1;
+	}
+
+	double bytes = 0.0;
+	for (vector<string>::iterator f = files.begin(); f != files.end(); ++f)
+	{
+		MFMemFile * fi = MemFile_Open(f->c_str());
+		if (fi)
+		{
+			bytes += MemFile_GetEnd(fi) - MemFile_GetBegin(fi);
+			MemFile_Close(fi);
+		}
+	}
+
+	int unreadable = 0, unstable = 0;
+	double ms = 0.0;
+	for (int p = 0; p < passes; ++p)
+	for (vector<string>::iterator f = files.begin(); f != files.end(); ++f)
+	{
+		XObj8 obj;
+		double t0 = now_ms();
+		bool ok = XObj8Read(f->c_str(), obj);
+		ms += now_ms() - t0;
+		if (!ok && p == 0)
+		{
+			printf("could not read %s\n", f->c_str());
+			++unreadable;
+		}
+	}
+
+	string dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+	string tmp[2] = { dir + "/bench_obj_read_1.obj", dir + "/bench_obj_read_2.obj" };
+	for (vector<string>::iterator f = files.begin(); f != files.end(); ++f)
+	{
+		XObj8 obj, again;
+		if (!XObj8Read(f->c_str(), obj))
+			continue;
+		if (!XObj8Write(tmp[0].c_str(), obj) || !XObj8Read(tmp[0].c_str(), again) || !XObj8Write(tmp[1].c_str(), again) ||
+			!same_file(tmp[0], tmp[1]))
+		{
+			printf("round trip changed %s\n", f->c_str());
+			++unstable;
+		}
+	}
+	remove(tmp[0].c_str());
+	remove(tmp[1].c_str());
+
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	double mb = bytes / (1024.0 * 1024.0);
+	printf("BENCH XObj8Read, %d files, %.1lf MB: %.1lf ms per pass, %.1lf MB/s, %.0lf files/s, peak %.1lf MB\n",
+		(int) files.size(), mb, ms / passes, mb * passes / (ms / 1000.0), files.size() * passes / (ms / 1000.0), ru.ru_maxrss / 1024.0);
+	if (unreadable || unstable)
+	{
+		printf("FAILED: %d unreadable, %d changed by a round trip\n", unreadable, unstable);
+		return 1;
+	}
+	return 0;
+}
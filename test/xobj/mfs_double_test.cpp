@@ -0,0 +1,105 @@
+/*
+ * Checks MFS_double against strtod: signs, exponents, leading zeros, long mantissas, and a few hundred
+ * thousand random numbers written the way OBJ exporters write them.  It must give exactly strtod's double,
+ * except past 19 significant digits, which it drops, so it may be one ulp off there.  It must also stop on
+ * the same character strtod does.
+ */
+
+#include "MemFileUtils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static int	failures = 0;
+
+static long long ordered_bits(double d)
+{
+	long long b;
+	memcpy(&b, &d, sizeof(b));
+	return b < 0 ? -(b & 0x7FFFFFFFFFFFFFFFLL) : b;
+}
+
+static int significant_digits(const char * str)
+{
+	int n = 0;
+	bool seen = false;
+	for (const char * c = str; *c && *c != 'e' && *c != 'E'; ++c)
+	if (*c >= '0' && *c <= '9')
+	{
+		if (*c != '0') seen = true;
+		if (seen) ++n;
+	}
+	return n;
+}
+
+static void check(const char * str)
+{
+	MFScanner	s;
+	MFS_init(&s, str, str + strlen(str));
+	double got = MFS_double(&s);
+
+	char * end;
+	double want = strtod(str, &end);
+
+	long long ulps = llabs(ordered_bits(got) - ordered_bits(want));
+	long long allowed = significant_digits(str) > 19 ? 1 : 0;
+	if (ulps > allowed || s.cur != end)
+	{
+		if (failures++ < 20)
+			printf("FAILED: \"%s\" reads as %.17g (%lld ulps off, %d chars), strtod gives %.17g (%d chars)\n",
+				str, got, ulps, (int) (s.cur - str), want, (int) (end - str));
+	}
+}
+
+int main(void)
+{
+	static const char * cases[] = {
+		"0", "-0", "+0", "0.0", "-0.0", "1", "-1", "+1", "1.", "-1.", ".5", "-.5", "+.25",
+		"0.1", "0.2", "0.3", "-0.7", "3.14159", "-2.718281828", "0.000123", "-0.0000001",
+		"000123.4500", "123456789012345", "0.123456789012345", "-98765.4321098765",
+		"1e5", "1E5", "1e+5", "1e-5", "-2.5e-3", "+6.02e23", "6.02E+23", "1.5e22", "1.5e-22",
+		"1e", "1e+", "2E-", "3e+x", "4.5.6", "-7-8", "9 10", "11\t12", "  13",
+		"1e23", "1e-23", "9.999e99", "1.234e-99", "1e300", "1e-300", "2.2250738585072014e-308",
+		"1.7976931348623157e308", "4.9e-324", "1e400", "1e-400", "0e999",
+		"1234567890123456", "12345678901234567890", "1234567890123456789012345",
+		"0.1234567890123456789", "-3.14159265358979323846264338327950288",
+		"0.00000000000000000000000000000000001", "100000000000000000000000000000000000",
+		"79228162514264337593543950336", "9007199254740993", "18446744073709551615",
+		"18446744073709551616.5",
+	};
+	for (int n = 0; n < sizeof(cases) / sizeof(cases[0]); ++n)
+		check(cases[n]);
+
+	// Random numbers the way exporters write them: %f/%g-ish, sometimes with an exponent.
+	srand(1);
+	char buf[64];
+	for (int n = 0; n < 300000; ++n)
+	{
+		char * p = buf;
+		int r = rand();
+		if (r & 1)			*p++ = '-';
+		else if (r & 2)		*p++ = '+';
+		int idig = (r >> 2) % 9;
+		int fdig = (r >> 6) % 12;
+		for (int i = 0; i < idig; ++i) *p++ = '0' + rand() % 10;
+		if (fdig || !idig)
+		{
+			*p++ = '.';
+			for (int i = 0; i < fdig; ++i) *p++ = '0' + rand() % 10;
+			if (!idig && !fdig) *p++ = '0';
+		}
+		if ((r >> 10) % 4 == 0)
+			p += sprintf(p, "%c%d", (r >> 12) & 1 ? 'e' : 'E', rand() % 80 - 40);
+		*p = 0;
+		check(buf);
+	}
+
+	if (failures)
+	{
+		printf("FAILED: %d numbers read differently from strtod\n", failures);
+		return 1;
+	}
+	printf("CHECK MFS_double matches strtod on %d fixed and 300000 random numbers\n", (int) (sizeof(cases) / sizeof(cases[0])));
+	return 0;
+}
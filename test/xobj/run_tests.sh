@@ -0,0 +1,33 @@
+#!/bin/sh
+#
+# Builds and runs the OBJ tests and benchmarks against the sources in src/Obj and src/Utils.  Any directories
+# after the compiler are added to the OBJ read benchmark's corpus (the synthetic objects and the OBJs under
+# test/ are always in it).
+#
+# Usage:  run_tests.sh [c++ compiler] [OBJ corpus dir ...]
+
+CXX=${1:-g++}
+CC=${CC:-cc}
+[ $# -gt 0 ] && shift
+HERE=$(cd "$(dirname "$0")" && pwd)
+TOP=$(cd "$HERE/../.." && pwd)
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+DEFS="-DLIN=1 -DIBM=0 -DAPL=0 -include $TOP/src/Obj/XDefs.h -I$TOP/src/Obj -I$TOP/src/Utils -I$TOP/src/GUI -I$TOP/src/DSF/tri_stripper_101"
+FLAGS="-std=c++14 -O2 -g -Wno-deprecated-declarations $DEFS"
+OBJ="$TOP/src/Obj/XObjBuilder.cpp $TOP/src/Obj/XObjDefs.cpp $TOP/src/Obj/ObjPointPool.cpp"
+UTILS="$TOP/src/Utils/MemFileUtils.cpp $TOP/src/Utils/FileUtils.cpp $TOP/src/Utils/AssertUtils.cpp $TMP/unzip.o -lz"
+
+$CC -O2 $DEFS -c -o "$TMP/unzip.o" "$TOP/src/Utils/unzip.c" || { echo "FAILED: could not build unzip.c"; exit 1; }
+
+$CXX $FLAGS -o "$TMP/mfs_double_test" "$HERE/mfs_double_test.cpp" $UTILS || { echo "FAILED: could not build mfs_double_test"; exit 1; }
+$CXX $FLAGS -o "$TMP/bench_builder" "$HERE/bench_builder.cpp" $OBJ "$TOP/src/Obj/ObjConvert.cpp" "$TOP/src/DSF/tri_stripper_101/tri_stripper.cpp" || { echo "FAILED: could not build bench_builder"; exit 1; }
+$CXX $FLAGS -o "$TMP/bench_obj_read" "$HERE/bench_obj_read.cpp" $OBJ "$TOP/src/Obj/XObjReadWrite.cpp" $UTILS || { echo "FAILED: could not build bench_obj_read"; exit 1; }
+
+"$TMP/mfs_double_test" || { echo "FAILED: mfs_double_test"; exit 1; }
+"$TMP/bench_builder" || { echo "FAILED: bench_builder"; exit 1; }
+mkdir "$TMP/corpus"
+"$TMP/bench_obj_read" --make "$TMP/corpus" || { echo "FAILED: could not write the synthetic OBJs"; exit 1; }
+TMPDIR="$TMP" "$TMP/bench_obj_read" 3 "$TMP/corpus" "$TOP/test" "$@" || { echo "FAILED: bench_obj_read"; exit 1; }
+echo "PASSED"